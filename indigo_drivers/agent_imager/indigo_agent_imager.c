@@ -1273,6 +1273,12 @@ static indigo_result agent_define_property(indigo_client *client, indigo_device
 				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_JPEG_ITEM_NAME) == 0) {
 					strcpy(CLIENT_PRIVATE_DATA->current_type, ".jpeg");
 					break;
+				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_FITS_RICE_ITEM_NAME) == 0) {
+					strcpy(CLIENT_PRIVATE_DATA->current_type, ".fits.fz");
+					break;
+				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_XISF_LZ4_ITEM_NAME) == 0) {
+					strcpy(CLIENT_PRIVATE_DATA->current_type, ".xisf");
+					break;
 				}
 			}
 			pthread_mutex_lock(&CLIENT_PRIVATE_DATA->mutex);
@@ -1366,6 +1372,12 @@ static indigo_result agent_update_property(indigo_client *client, indigo_device
 				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_JPEG_ITEM_NAME) == 0) {
 					strcpy(CLIENT_PRIVATE_DATA->current_type, ".jpeg");
 					break;
+				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_FITS_RICE_ITEM_NAME) == 0) {
+					strcpy(CLIENT_PRIVATE_DATA->current_type, ".fits.fz");
+					break;
+				} else if (item->sw.value && strcmp(item->name, CCD_IMAGE_FORMAT_XISF_LZ4_ITEM_NAME) == 0) {
+					strcpy(CLIENT_PRIVATE_DATA->current_type, ".xisf");
+					break;
 				}
 			}
 			pthread_mutex_lock(&CLIENT_PRIVATE_DATA->mutex);
@@ -87,6 +87,7 @@ static void pull_callback(unsigned event, void* callbackCtx) {
 			if (result >= 0) {
 				INDIGO_DRIVER_DEBUG(DRIVER_NAME, "Altaircam_PullImageV2(%d, ->[%d x %d, %x, %d]) -> %08x", PRIVATE_DATA->bits, frameInfo.width, frameInfo.height, frameInfo.flag, frameInfo.seq, result);
 				indigo_process_image(device, PRIVATE_DATA->buffer, frameInfo.width, frameInfo.height, PRIVATE_DATA->bits > 8 && PRIVATE_DATA->bits <= 16 ? 16 : PRIVATE_DATA->bits, true, true, NULL);
+				PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 				if (CCD_EXPOSURE_PROPERTY->state == INDIGO_BUSY_STATE) {
 					CCD_EXPOSURE_ITEM->number.value = 0;
 					CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
@@ -363,7 +364,7 @@ static indigo_result ccd_attach(indigo_device *device) {
 				return INDIGO_FAILED;
 			indigo_init_number_item(X_CCD_FAN_SPEED_ITEM, "FAN_SPEED", "Fan speed", 0, 0, 1, 0);
 		}
-		PRIVATE_DATA->buffer = (unsigned char *)indigo_alloc_blob_buffer(3 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
+		PRIVATE_DATA->buffer = (unsigned char *)indigo_alloc_shared_blob_buffer(3 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
 		pthread_mutex_init(&PRIVATE_DATA->mutex, NULL);
 		// --------------------------------------------------------------------------------
 		INDIGO_DEVICE_ATTACH_LOG(DRIVER_NAME, device->name);
@@ -489,7 +490,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 		} else {
 			indigo_cancel_timer(device, &PRIVATE_DATA->temperature_timer);
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 			if (PRIVATE_DATA->guider && PRIVATE_DATA->guider->gp_bits == 0) {
@@ -817,7 +818,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			}
 		} else {
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 			if (PRIVATE_DATA->camera && PRIVATE_DATA->camera->gp_bits == 0) {
@@ -263,7 +263,7 @@ static bool asi_open(indigo_device *device) {
 			else
 				PRIVATE_DATA->buffer_size = PRIVATE_DATA->info.MaxHeight*PRIVATE_DATA->info.MaxWidth*2 + FITS_HEADER_SIZE;
 
-			PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_blob_buffer(PRIVATE_DATA->buffer_size);
+			PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_shared_blob_buffer(PRIVATE_DATA->buffer_size);
 		}
 	}
 	PRIVATE_DATA->is_asi120 = strstr(PRIVATE_DATA->info.Name, "ASI120M") != NULL;
@@ -435,7 +435,7 @@ static void asi_close(indigo_device *device) {
 		INDIGO_DRIVER_DEBUG(DRIVER_NAME, "ASICloseCamera(%d, ASI_COOLER_POWER_PERC)", PRIVATE_DATA->dev_id);
 		indigo_global_unlock(device);
 		if (PRIVATE_DATA->buffer != NULL) {
-			free(PRIVATE_DATA->buffer);
+			indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 			PRIVATE_DATA->buffer = NULL;
 		}
 	}
@@ -469,6 +469,7 @@ static void exposure_timer_callback(indigo_device *device) {
 			} else {
 				indigo_process_image(device, PRIVATE_DATA->buffer, (int)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x), (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y), PRIVATE_DATA->exp_bpp, true, false, NULL);
 			}
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -515,6 +516,7 @@ static void streaming_timer_callback(indigo_device *device) {
 				} else {
 					indigo_process_image(device, PRIVATE_DATA->buffer, (int)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x), (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y), PRIVATE_DATA->exp_bpp, true, false, NULL);
 				}
+				PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 				if (CCD_STREAMING_COUNT_ITEM->number.value > 0)
 					CCD_STREAMING_COUNT_ITEM->number.value -= 1;
 				CCD_STREAMING_PROPERTY->state = INDIGO_BUSY_STATE;
@@ -578,7 +580,17 @@ static void ccd_temperature_callback(indigo_device *device) {
 }
 
 
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_ra != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_ra(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_ra = NULL;
 	int id = PRIVATE_DATA->dev_id;
 
@@ -589,18 +601,24 @@ static void guider_timer_callback_ra(indigo_device *device) {
 	ASIPulseGuideOff(id, ASI_GUIDE_WEST);
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
-	if (PRIVATE_DATA->guide_relays[ASI_GUIDE_EAST] || PRIVATE_DATA->guide_relays[ASI_GUIDE_WEST]) {
-		GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-		GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-		GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->guide_relays[ASI_GUIDE_EAST] || PRIVATE_DATA->guide_relays[ASI_GUIDE_WEST])
+		indigo_set_timer(device, 0, guider_finished_callback_ra);
 	PRIVATE_DATA->guide_relays[ASI_GUIDE_EAST] = false;
 	PRIVATE_DATA->guide_relays[ASI_GUIDE_WEST] = false;
 }
 
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_dec != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_dec(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_dec = NULL;
 	int id = PRIVATE_DATA->dev_id;
 
@@ -611,12 +629,8 @@ static void guider_timer_callback_dec(indigo_device *device) {
 	ASIPulseGuideOff(id, ASI_GUIDE_NORTH);
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
-	if (PRIVATE_DATA->guide_relays[ASI_GUIDE_NORTH] || PRIVATE_DATA->guide_relays[ASI_GUIDE_SOUTH]) {
-		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->guide_relays[ASI_GUIDE_NORTH] || PRIVATE_DATA->guide_relays[ASI_GUIDE_SOUTH])
+		indigo_set_timer(device, 0, guider_finished_callback_dec);
 	PRIVATE_DATA->guide_relays[ASI_GUIDE_SOUTH] = false;
 	PRIVATE_DATA->guide_relays[ASI_GUIDE_NORTH] = false;
 }
@@ -1362,7 +1376,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 			if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIPulseGuideOn(%d, ASI_GUIDE_NORTH) = %d", id, res);
-			PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+			PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 			PRIVATE_DATA->guide_relays[ASI_GUIDE_NORTH] = true;
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
@@ -1372,7 +1386,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 				if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIPulseGuideOn(%d, ASI_GUIDE_SOUTH) = %d", id, res);
-				PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+				PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 				PRIVATE_DATA->guide_relays[ASI_GUIDE_SOUTH] = true;
 			}
 		}
@@ -1395,7 +1409,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 			if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIPulseGuideOn(%d, ASI_GUIDE_EAST) = %d", id, res);
-			PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+			PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 			PRIVATE_DATA->guide_relays[ASI_GUIDE_EAST] = true;
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
@@ -1405,7 +1419,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 				if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIPulseGuideOn(%d, ASI_GUIDE_WEST) = %d", id, res);
-				PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+				PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 				PRIVATE_DATA->guide_relays[ASI_GUIDE_WEST] = true;
 			}
 		}
@@ -1626,7 +1640,7 @@ static void process_unplug_event(indigo_device *unused) {
 		if (private_data) {
 			ASICloseCamera(id);
 			if (private_data->buffer != NULL) {
-				free(private_data->buffer);
+				indigo_release_blob_buffer(private_data->buffer);
 				private_data->buffer = NULL;
 			}
 			free(private_data);
@@ -106,6 +106,7 @@ static void exposure_timer_callback(indigo_device *device) {
 		void *buffer = ArtemisImageBuffer(PRIVATE_DATA->handle);
 		memcpy(PRIVATE_DATA->buffer + FITS_HEADER_SIZE, buffer, width * height * 2);
 		indigo_process_image(device, PRIVATE_DATA->buffer, width, height, 16, true, true, NULL);
+		PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 		CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 	} else {
@@ -174,7 +175,7 @@ static void ccd_connect_callback(indigo_device *device) {
 				indigo_init_switch_item(CCD_MODE_ITEM + (i - 1), name, label, i == 1);
 				pw *= 2;
 			}
-			PRIVATE_DATA->buffer = indigo_alloc_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
+			PRIVATE_DATA->buffer = indigo_alloc_shared_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
 			assert(PRIVATE_DATA->buffer != NULL);
 			CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 			if (ArtemisTemperatureSensorInfo(PRIVATE_DATA->handle, 0, &temperature) == ARTEMIS_OK && temperature > 0 && ArtemisTemperatureSensorInfo(PRIVATE_DATA->handle, 1, &temperature) == ARTEMIS_OK) {
@@ -242,7 +243,7 @@ static void ccd_connect_callback(indigo_device *device) {
 	if (PRIVATE_DATA->handle == NULL) {
 		indigo_cancel_timer(device, &PRIVATE_DATA->temperature_timer);
 		if (PRIVATE_DATA->buffer != NULL) {
-			free(PRIVATE_DATA->buffer);
+			indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 			PRIVATE_DATA->buffer = NULL;
 		}
 		PRIVATE_DATA->device_count--;
@@ -312,7 +313,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 		} else {
 			indigo_cancel_timer(device, &PRIVATE_DATA->temperature_timer);
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 			if (--PRIVATE_DATA->device_count == 0) {
@@ -485,24 +486,35 @@ static indigo_result ccd_detach(indigo_device *device) {
 
 // -------------------------------------------------------------------------------- INDIGO guider device implementation
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer = NULL;
 	if (!CONNECTION_CONNECTED_ITEM->sw.value)
 		return;
 
 	ArtemisGuidePort(PRIVATE_DATA->handle, 0);
-	if (PRIVATE_DATA->relay_mask & (ATIK_GUIDE_NORTH | ATIK_GUIDE_SOUTH)) {
-		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
-	}
-	if (PRIVATE_DATA->relay_mask & (ATIK_GUIDE_EAST | ATIK_GUIDE_WEST)) {
-		GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-		GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-		GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->relay_mask & (ATIK_GUIDE_NORTH | ATIK_GUIDE_SOUTH))
+		indigo_set_timer(device, 0, guider_finished_callback_dec);
+	if (PRIVATE_DATA->relay_mask & (ATIK_GUIDE_EAST | ATIK_GUIDE_WEST))
+		indigo_set_timer(device, 0, guider_finished_callback_ra);
 	PRIVATE_DATA->relay_mask = 0;
 }
 
@@ -558,12 +570,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_NORTH_ITEM->number.value;
 		if (duration > 0) {
 			PRIVATE_DATA->relay_mask |= ATIK_GUIDE_NORTH;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
 			if (duration > 0) {
 				PRIVATE_DATA->relay_mask |= ATIK_GUIDE_SOUTH;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		ArtemisGuidePort(PRIVATE_DATA->handle, PRIVATE_DATA->relay_mask);
@@ -578,12 +590,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_EAST_ITEM->number.value;
 		if (duration > 0) {
 			PRIVATE_DATA->relay_mask |= ATIK_GUIDE_EAST;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
 			if (duration > 0) {
 				PRIVATE_DATA->relay_mask |= ATIK_GUIDE_WEST;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		ArtemisGuidePort(PRIVATE_DATA->handle, PRIVATE_DATA->relay_mask);
@@ -847,7 +859,7 @@ static void unplug_handler(indigo_device *device) {
 			indigo_detach_device(device);
 			if (PRIVATE_DATA) {
 				if (PRIVATE_DATA->buffer)
-					free(PRIVATE_DATA->buffer);
+					indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				free(PRIVATE_DATA);
 			}
 			free(device);
@@ -916,7 +928,7 @@ indigo_result indigo_ccd_atik(indigo_driver_action action, indigo_driver_info *i
 					indigo_detach_device(device);
 					if (PRIVATE_DATA) {
 						if (PRIVATE_DATA->buffer)
-						free(PRIVATE_DATA->buffer);
+						indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 						free(PRIVATE_DATA);
 					}
 					free(device);
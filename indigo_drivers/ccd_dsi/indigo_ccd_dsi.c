@@ -106,7 +106,7 @@ static bool camera_open(indigo_device *device) {
 		                            dsi_get_frame_height(PRIVATE_DATA->dsi) *
 		                            dsi_get_bytespp(PRIVATE_DATA->dsi) +
 		                            FITS_HEADER_SIZE;
-		PRIVATE_DATA->buffer = (char*)indigo_alloc_blob_buffer(PRIVATE_DATA->buffer_size);
+		PRIVATE_DATA->buffer = (char*)indigo_alloc_shared_blob_buffer(PRIVATE_DATA->buffer_size);
 		if (PRIVATE_DATA->buffer == NULL) {
 			dsi_close_camera(PRIVATE_DATA->dsi);
 			PRIVATE_DATA->dsi = NULL;
@@ -191,7 +191,7 @@ static void camera_close(indigo_device *device) {
 	indigo_global_unlock(device);
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 	if (PRIVATE_DATA->buffer != NULL) {
-		free(PRIVATE_DATA->buffer);
+		indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 		PRIVATE_DATA->buffer = NULL;
 	}
 }
@@ -235,6 +235,7 @@ static void exposure_timer_callback(indigo_device *device) {
 					true, true, NULL
 				);
 			}
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -655,7 +656,7 @@ static void process_unplug_event(indigo_device *unusued) {
 	}
 	if (private_data) {
 		if (private_data->buffer != NULL) {
-			free(private_data->buffer);
+			indigo_release_blob_buffer(private_data->buffer);
 			private_data->buffer = NULL;
 		}
 		free(private_data);
@@ -195,7 +195,7 @@ static bool fli_open(indigo_device *device) {
 
 	if (PRIVATE_DATA->buffer == NULL) {
 		PRIVATE_DATA->buffer_size = width * height * 2 + FITS_HEADER_SIZE;
-		PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_blob_buffer(PRIVATE_DATA->buffer_size);
+		PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_shared_blob_buffer(PRIVATE_DATA->buffer_size);
 	}
 
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
@@ -394,7 +394,7 @@ static void fli_close(indigo_device *device) {
 	}
 	indigo_global_unlock(device);
 	if (PRIVATE_DATA->buffer != NULL) {
-		free(PRIVATE_DATA->buffer);
+		indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 		PRIVATE_DATA->buffer = NULL;
 	}
 }
@@ -410,6 +410,7 @@ static void exposure_timer_callback(indigo_device *device) {
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		if (fli_read_pixels(device)) {
 			indigo_process_image(device, PRIVATE_DATA->buffer, (int)(PRIVATE_DATA->frame_params.width / PRIVATE_DATA->frame_params.bin_x), (int)(PRIVATE_DATA->frame_params.height / PRIVATE_DATA->frame_params.bin_y), PRIVATE_DATA->frame_params.bpp, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -1049,7 +1050,7 @@ static void process_unplug_event(indigo_device *unused) {
 		}
 		indigo_detach_device(*device);
 		fli_private_data *private_data = (*device)->private_data;
-		if (private_data->buffer) free(private_data->buffer);
+		if (private_data->buffer) indigo_release_blob_buffer(private_data->buffer);
 		free((*device)->private_data);
 		free(*device);
 		*device = NULL;
@@ -1089,7 +1090,7 @@ static void remove_all_devices() {
 			continue;
 		indigo_detach_device(*device);
 		fli_private_data *private_data = (*device)->private_data;
-		if (private_data->buffer) free(private_data->buffer);
+		if (private_data->buffer) indigo_release_blob_buffer(private_data->buffer);
 		free((*device)->private_data);
 		free(*device);
 		*device = NULL;
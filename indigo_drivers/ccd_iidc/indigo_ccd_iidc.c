@@ -225,6 +225,7 @@ static void exposure_timer_callback(indigo_device *device) {
         err = dc1394_capture_enqueue(PRIVATE_DATA->camera, frame);
         INDIGO_DRIVER_DEBUG(DRIVER_NAME, "dc1394_capture_enqueue() -> %s", dc1394_error_get_string(err));
         indigo_process_image(device, PRIVATE_DATA->buffer, width, height, bpp, frame->little_endian, true, NULL);
+        PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 				CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 				indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 			} else {
@@ -271,6 +272,7 @@ static void streaming_timer_callback(indigo_device *device) {
         err = dc1394_capture_enqueue(PRIVATE_DATA->camera, frame);
         INDIGO_DRIVER_DEBUG(DRIVER_NAME, "dc1394_capture_enqueue() -> %s", dc1394_error_get_string(err));
         indigo_process_image(device, PRIVATE_DATA->buffer, width, height, bpp, frame->little_endian, true, NULL);
+        PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			} else {
         if (frame != NULL) {
           err = dc1394_capture_enqueue(PRIVATE_DATA->camera, frame);
@@ -436,7 +438,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 		// -------------------------------------------------------------------------------- CONNECTION -> CCD_INFO, CCD_COOLER, CCD_TEMPERATURE
 		indigo_property_copy_values(CONNECTION_PROPERTY, property, false);
 		if (CONNECTION_CONNECTED_ITEM->sw.value) {
-			PRIVATE_DATA->buffer = indigo_alloc_blob_buffer(FITS_HEADER_SIZE + 2 * 3 * (CCD_INFO_WIDTH_ITEM->number.value + 8) * (CCD_INFO_HEIGHT_ITEM->number.value + 8));
+			PRIVATE_DATA->buffer = indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + 2 * 3 * (CCD_INFO_WIDTH_ITEM->number.value + 8) * (CCD_INFO_HEIGHT_ITEM->number.value + 8));
 			assert(PRIVATE_DATA->buffer != NULL);
 			if (PRIVATE_DATA->temperature_is_present) {
 				PRIVATE_DATA->temperture_timer = indigo_set_timer(device, 0, ccd_temperature_callback);
@@ -445,7 +447,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_cancel_timer(device, &PRIVATE_DATA->temperture_timer);
 			stop_camera(device);
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 		}
@@ -717,7 +719,7 @@ static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotp
 						indigo_detach_device(device);
 						dc1394_camera_free(private_data->camera);
 						if (private_data->buffer)
-							free(private_data->buffer);
+							indigo_release_blob_buffer(private_data->buffer);
 						free(private_data);
 						free(device);
 						devices[j] = NULL;
@@ -860,7 +862,7 @@ indigo_result indigo_ccd_iidc(indigo_driver_action action, indigo_driver_info *i
 			if (device != NULL) {
 				if (PRIVATE_DATA != NULL) {
 					if (PRIVATE_DATA->buffer)
-						free(PRIVATE_DATA->buffer);
+						indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 					free(PRIVATE_DATA);
 				}
 				indigo_detach_device(device);
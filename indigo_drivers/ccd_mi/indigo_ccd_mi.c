@@ -95,6 +95,7 @@ static void exposure_timer_callback(indigo_device *device) {
 			state = gxccd_read_image(PRIVATE_DATA->camera, (char *)(PRIVATE_DATA->buffer + FITS_HEADER_SIZE), PRIVATE_DATA->image_width * PRIVATE_DATA->image_height * 2);
 		if (state != -1) {
 			indigo_process_image(device, PRIVATE_DATA->buffer, PRIVATE_DATA->image_width, PRIVATE_DATA->image_height, 16, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -236,14 +237,14 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 					}
 				}
 
-				PRIVATE_DATA->buffer = indigo_alloc_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
+				PRIVATE_DATA->buffer = indigo_alloc_shared_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
 				assert(PRIVATE_DATA->buffer != NULL);
 				CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 			} else {
 				indigo_cancel_timer(device, &PRIVATE_DATA->temperature_timer);
 				indigo_cancel_timer(device, &PRIVATE_DATA->power_util_timer);
 				if (PRIVATE_DATA->buffer != NULL) {
-					free(PRIVATE_DATA->buffer);
+					indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 					PRIVATE_DATA->buffer = NULL;
 				}
 				PRIVATE_DATA->device_count--;
@@ -254,7 +255,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_cancel_timer(device, &PRIVATE_DATA->temperature_timer);
 			indigo_cancel_timer(device, &PRIVATE_DATA->power_util_timer);
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 			if (--PRIVATE_DATA->device_count == 0) {
@@ -363,8 +364,9 @@ static indigo_result ccd_detach(indigo_device *device) {
 
 // -------------------------------------------------------------------------------- INDIGO guider device implementation
 
-static void guider_timer_callback(indigo_device *device) {
-	PRIVATE_DATA->guider_timer = NULL;
+static void guider_finished_callback(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
 	if (!CONNECTION_CONNECTED_ITEM->sw.value)
 		return;
 	if (GUIDER_GUIDE_NORTH_ITEM->number.value != 0 || GUIDER_GUIDE_SOUTH_ITEM->number.value != 0) {
@@ -381,6 +383,12 @@ static void guider_timer_callback(indigo_device *device) {
 	}
 }
 
+static void guider_timer_callback(indigo_device *device) {
+	// runs on pulse scheduler thread, there is nothing to stop, property update is left to regular timer
+	PRIVATE_DATA->guider_timer = NULL;
+	indigo_set_timer(device, 0, guider_finished_callback);
+}
+
 static indigo_result guider_attach(indigo_device *device) {
 	assert(device != NULL);
 	assert(PRIVATE_DATA != NULL);
@@ -432,13 +440,13 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		if (duration > 0) {
 			gxccd_move_telescope(PRIVATE_DATA->camera, 0, duration);
 			GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
 			if (duration > 0) {
 				gxccd_move_telescope(PRIVATE_DATA->camera, 0, -duration);
 				GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
@@ -451,14 +459,14 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_EAST_ITEM->number.value;
 		if (duration > 0) {
 			gxccd_move_telescope(PRIVATE_DATA->camera, duration, 0);
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
 			if (duration > 0) {
 				gxccd_move_telescope(PRIVATE_DATA->camera, -duration, 0);
 				GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
@@ -675,7 +683,7 @@ static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotp
 					if (device->master_device == device) {
 						mi_private_data *private_data = PRIVATE_DATA;
 						if (private_data->buffer != NULL)
-							free(private_data->buffer);
+							indigo_release_blob_buffer(private_data->buffer);
 						free(private_data);
 					}
 					free(device);
@@ -721,7 +729,7 @@ indigo_result indigo_ccd_mi(indigo_driver_action action, indigo_driver_info *inf
 					if (device->master_device == device) {
 						mi_private_data *private_data = PRIVATE_DATA;
 						if (private_data->buffer != NULL)
-							free(private_data->buffer);
+							indigo_release_blob_buffer(private_data->buffer);
 						free(private_data);
 					}
 					free(device);
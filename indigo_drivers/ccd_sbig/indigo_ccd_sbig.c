@@ -887,6 +887,10 @@ static void imager_ccd_exposure_timer_callback(indigo_device *device) {
 			// FIXME: race between capture and frame size/bpp
 			indigo_process_image(device, frame_buffer, (int)(CCD_FRAME_WIDTH_ITEM->number.value / CCD_BIN_HORIZONTAL_ITEM->number.value),
 			                    (int)(CCD_FRAME_HEIGHT_ITEM->number.value / CCD_BIN_VERTICAL_ITEM->number.value), (int)(CCD_FRAME_BITS_PER_PIXEL_ITEM->number.value), true, true, bayer_keys);
+			if (PRIMARY_CCD)
+				PRIVATE_DATA->imager_buffer = indigo_claim_blob_buffer(PRIVATE_DATA->imager_buffer);
+			else
+				PRIVATE_DATA->guider_buffer = indigo_claim_blob_buffer(PRIVATE_DATA->guider_buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -1160,7 +1164,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 						CCD_COOLER_POWER_PROPERTY->hidden = false;
 						CCD_COOLER_POWER_PROPERTY->perm = INDIGO_RO_PERM;
 
-						PRIVATE_DATA->imager_buffer = indigo_alloc_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
+						PRIVATE_DATA->imager_buffer = indigo_alloc_shared_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
 						assert(PRIVATE_DATA->imager_buffer != NULL);
 
 						PRIVATE_DATA->imager_ccd_temperature_timer = indigo_set_timer(device, 0, imager_ccd_temperature_callback);
@@ -1259,7 +1263,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 
 						CCD_COOLER_POWER_PROPERTY->hidden = true;
 
-						PRIVATE_DATA->guider_buffer = indigo_alloc_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
+						PRIVATE_DATA->guider_buffer = indigo_alloc_shared_blob_buffer(2 * CCD_INFO_WIDTH_ITEM->number.value * CCD_INFO_HEIGHT_ITEM->number.value + FITS_HEADER_SIZE);
 						assert(PRIVATE_DATA->guider_buffer != NULL);
 
 						PRIVATE_DATA->guider_ccd_temperature_timer = indigo_set_timer(device, 0, guider_ccd_temperature_callback);
@@ -1280,14 +1284,14 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 					indigo_delete_property(device, SBIG_ABG_PROPERTY, NULL);
 					indigo_cancel_timer(device, &PRIVATE_DATA->imager_ccd_temperature_timer);
 					if (PRIVATE_DATA->imager_buffer != NULL) {
-						free(PRIVATE_DATA->imager_buffer);
+						indigo_release_blob_buffer(PRIVATE_DATA->imager_buffer);
 						PRIVATE_DATA->imager_buffer = NULL;
 					}
 				} else { /* Secondary CCD */
 					PRIVATE_DATA->guider_no_check_temperature = false;
 					indigo_cancel_timer(device, &PRIVATE_DATA->guider_ccd_temperature_timer);
 					if (PRIVATE_DATA->guider_buffer != NULL) {
-						free(PRIVATE_DATA->guider_buffer);
+						indigo_release_blob_buffer(PRIVATE_DATA->guider_buffer);
 						PRIVATE_DATA->guider_buffer = NULL;
 					}
 				}
@@ -1450,7 +1454,17 @@ static indigo_result guider_attach(indigo_device *device) {
 }
 
 
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_ra != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_ra(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	int res;
 	ushort relay_map = 0;
 
@@ -1473,19 +1487,25 @@ static void guider_timer_callback_ra(indigo_device *device) {
 		INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relaymap(%d) = %d (%s)", driver_handle, res, sbig_error_string(res));
 	}
 
-	if (PRIVATE_DATA->relay_map & (RELAY_EAST | RELAY_WEST)) {
-		GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-		GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-		GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->relay_map & (RELAY_EAST | RELAY_WEST))
+		indigo_set_timer(device, 0, guider_finished_callback_ra);
 	PRIVATE_DATA->relay_map = relay_map;
 
 	pthread_mutex_unlock(&driver_mutex);
 }
 
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_dec != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_dec(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	int res;
 	ushort relay_map = 0;
 
@@ -1493,7 +1513,7 @@ static void guider_timer_callback_dec(indigo_device *device) {
 
 	pthread_mutex_lock(&driver_mutex);
 
-	PRIVATE_DATA->guider_timer_ra = NULL;
+	PRIVATE_DATA->guider_timer_dec = NULL;
 	int driver_handle = PRIVATE_DATA->driver_handle;
 
 	res = sbig_get_relaymap(driver_handle, &relay_map);
@@ -1508,12 +1528,8 @@ static void guider_timer_callback_dec(indigo_device *device) {
 		INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relaymap(%d) = %d (%s)", driver_handle, res, sbig_error_string(res));
 	}
 
-	if (PRIVATE_DATA->relay_map & (RELAY_NORTH | RELAY_SOUTH)) {
-		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->relay_map & (RELAY_NORTH | RELAY_SOUTH))
+		indigo_set_timer(device, 0, guider_finished_callback_dec);
 	PRIVATE_DATA->relay_map = relay_map;
 
 	pthread_mutex_unlock(&driver_mutex);
@@ -1560,7 +1576,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_lock(&driver_mutex);
 			res = sbig_set_relays(driver_handle, RELAY_NORTH);
 			if (res != CE_NO_ERROR) INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relays(%d, RELAY_NORTH) = %d (%s)", driver_handle, res, sbig_error_string(res));
-			PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+			PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 			PRIVATE_DATA->relay_map |= RELAY_NORTH;
 			pthread_mutex_unlock(&driver_mutex);
 		} else {
@@ -1569,7 +1585,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_lock(&driver_mutex);
 				res = sbig_set_relays(driver_handle, RELAY_SOUTH);
 				if (res != CE_NO_ERROR) INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relays(%d, RELAY_SOUTH) = %d (%s)", driver_handle, res, sbig_error_string(res));
-				PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+				PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 				PRIVATE_DATA->relay_map |= RELAY_SOUTH;
 				pthread_mutex_unlock(&driver_mutex);
 			}
@@ -1591,7 +1607,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_lock(&driver_mutex);
 			res = sbig_set_relays(driver_handle, RELAY_EAST);
 			if (res != CE_NO_ERROR) INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relays(%d, RELAY_EAST) = %d (%s)", driver_handle, res, sbig_error_string(res));
-			PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+			PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 			PRIVATE_DATA->relay_map |= RELAY_EAST;
 			pthread_mutex_unlock(&driver_mutex);
 		} else {
@@ -1600,7 +1616,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_lock(&driver_mutex);
 				res = sbig_set_relays(driver_handle, RELAY_WEST);
 				if (res != CE_NO_ERROR) INDIGO_DRIVER_ERROR(DRIVER_NAME, "sbig_set_relays(%d, RELAY_WEST) = %d (%s)", driver_handle, res, sbig_error_string(res));
-				PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+				PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 				PRIVATE_DATA->relay_map |= RELAY_WEST;
 				pthread_mutex_unlock(&driver_mutex);
 			}
@@ -2499,8 +2515,8 @@ static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotp
 
 				if (private_data) {
 					/* close driver and device here */
-					if (private_data->imager_buffer) free(private_data->imager_buffer);
-					if (private_data->guider_buffer) free(private_data->guider_buffer);
+					if (private_data->imager_buffer) indigo_release_blob_buffer(private_data->imager_buffer);
+					if (private_data->guider_buffer) indigo_release_blob_buffer(private_data->guider_buffer);
 					free(private_data);
 					private_data = NULL;
 				}
@@ -2536,8 +2552,8 @@ static void remove_usb_devices() {
 	for(i = 0; i < MAX_USB_DEVICES; i++) {
 		if (pds[i]) {
 			sbig_private_data *private_data = (sbig_private_data*)pds[i];
-			if (private_data->imager_buffer) free(private_data->imager_buffer);
-			if (private_data->guider_buffer) free(private_data->guider_buffer);
+			if (private_data->imager_buffer) indigo_release_blob_buffer(private_data->imager_buffer);
+			if (private_data->guider_buffer) indigo_release_blob_buffer(private_data->guider_buffer);
 			free(pds[i]);
 		}
 	}
@@ -2560,8 +2576,8 @@ static void remove_eth_devices() {
 		devices[i] = NULL;
 	}
 	if (private_data) {
-		if (private_data->imager_buffer) free(private_data->imager_buffer);
-		if (private_data->guider_buffer) free(private_data->guider_buffer);
+		if (private_data->imager_buffer) indigo_release_blob_buffer(private_data->imager_buffer);
+		if (private_data->guider_buffer) indigo_release_blob_buffer(private_data->guider_buffer);
 		free(private_data);
 	}
 }
@@ -84,9 +84,9 @@ typedef struct {
 	indigo_property *guider_settings_property;
 
 	int star_x[STARS], star_y[STARS], star_a[STARS];
-	char imager_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
-	char guider_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
-	char dslr_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
+	char *imager_image;
+	char *guider_image;
+	char *dslr_image;
 	pthread_mutex_t image_mutex;
 	double target_temperature, current_temperature;
 	int current_slot;
@@ -194,6 +194,7 @@ static void exposure_timer_callback(indigo_device *device) {
 					raw[i] = rgb;
 			}
 			indigo_process_image(device, private_data->dslr_image, WIDTH, HEIGHT, 24, true, true, NULL);
+			private_data->dslr_image = indigo_claim_blob_buffer(private_data->dslr_image);
 		} else {
 			unsigned short *raw = (unsigned short *)((device == PRIVATE_DATA->guider ? private_data->guider_image : private_data->imager_image) + FITS_HEADER_SIZE);
 			int horizontal_bin = (int)CCD_BIN_HORIZONTAL_ITEM->number.value;
@@ -318,7 +319,13 @@ static void exposure_timer_callback(indigo_device *device) {
 				memcpy(raw, tmp, 2 * size);
 				free(tmp);
 			}
-			indigo_process_image(device, device == PRIVATE_DATA->guider ? private_data->guider_image : private_data->imager_image, frame_width, frame_height, 16, true, true, NULL);
+			if (device == PRIVATE_DATA->guider) {
+				indigo_process_image(device, private_data->guider_image, frame_width, frame_height, 16, true, true, NULL);
+				private_data->guider_image = indigo_claim_blob_buffer(private_data->guider_image);
+			} else {
+				indigo_process_image(device, private_data->imager_image, frame_width, frame_height, 16, true, true, NULL);
+				private_data->imager_image = indigo_claim_blob_buffer(private_data->imager_image);
+			}
 		}
 		CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
@@ -670,8 +677,9 @@ static indigo_result ccd_detach(indigo_device *device) {
 
 // -------------------------------------------------------------------------------- INDIGO guider device implementation
 
-static void guider_timer_callback(indigo_device *device) {
-	PRIVATE_DATA->guider_timer = NULL;
+static void guider_finished_callback(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
 	if (GUIDER_GUIDE_NORTH_ITEM->number.value != 0 || GUIDER_GUIDE_SOUTH_ITEM->number.value != 0) {
 		PRIVATE_DATA->guider_dec_offset += PRIVATE_DATA->guide_rate * (GUIDER_GUIDE_NORTH_ITEM->number.value - GUIDER_GUIDE_SOUTH_ITEM->number.value) / 200;
 		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
@@ -688,6 +696,12 @@ static void guider_timer_callback(indigo_device *device) {
 	}
 }
 
+static void guider_timer_callback(indigo_device *device) {
+	// runs on pulse scheduler thread, there is nothing to stop, property update is left to regular timer
+	PRIVATE_DATA->guider_timer = NULL;
+	indigo_set_timer(device, 0, guider_finished_callback);
+}
+
 static indigo_result guider_attach(indigo_device *device) {
 	assert(device != NULL);
 	assert(PRIVATE_DATA != NULL);
@@ -716,12 +730,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_NORTH_ITEM->number.value;
 		if (duration > 0) {
 			GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
 			if (duration > 0) {
 				GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
@@ -734,12 +748,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_EAST_ITEM->number.value;
 		if (duration > 0) {
 			GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
 			if (duration > 0) {
 				GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
@@ -1123,6 +1137,10 @@ indigo_result indigo_ccd_simulator(indigo_driver_action action, indigo_driver_in
 			pthread_mutex_init(&private_data->image_mutex, NULL);
 			assert(private_data != NULL);
 			memset(private_data, 0, sizeof(simulator_private_data));
+			private_data->imager_image = indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880);
+			private_data->guider_image = indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880);
+			private_data->dslr_image = indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880);
+			assert(private_data->imager_image != NULL && private_data->guider_image != NULL && private_data->dslr_image != NULL);
 			imager_ccd = malloc(sizeof(indigo_device));
 			assert(imager_ccd != NULL);
 			memcpy(imager_ccd, &imager_camera_template, sizeof(indigo_device));
@@ -1203,6 +1221,9 @@ indigo_result indigo_ccd_simulator(indigo_driver_action action, indigo_driver_in
 			}
 			if (private_data != NULL) {
 				pthread_mutex_destroy(&private_data->image_mutex);
+				indigo_release_blob_buffer(private_data->imager_image);
+				indigo_release_blob_buffer(private_data->guider_image);
+				indigo_release_blob_buffer(private_data->dslr_image);
 				free(private_data);
 				private_data = NULL;
 			}
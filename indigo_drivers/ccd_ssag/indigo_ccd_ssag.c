@@ -267,7 +267,7 @@ static bool ssag_guide(indigo_device *device, guide_direction direction, int dur
 static void ssag_close(indigo_device *device) {
 	libusb_close(PRIVATE_DATA->handle);
 	INDIGO_DRIVER_DEBUG(DRIVER_NAME, "libusb_close");
-	free(PRIVATE_DATA->buffer);
+	indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 }
 
 // -------------------------------------------------------------------------------- INDIGO CCD device implementation
@@ -282,6 +282,7 @@ static void exposure_timer_callback(indigo_device *device) {
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		if (ssag_read_pixels(device)) {
 			indigo_process_image(device, PRIVATE_DATA->buffer, (int)(CCD_FRAME_WIDTH_ITEM->number.value / CCD_BIN_HORIZONTAL_ITEM->number.value), (int)(CCD_FRAME_HEIGHT_ITEM->number.value / CCD_BIN_VERTICAL_ITEM->number.value), 8, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -297,6 +298,7 @@ static void exposure_timer_callback(indigo_device *device) {
 //	while (CCD_STREAMING_COUNT_ITEM->number.value != 0) {
 //		if (ssag_read_pixels(device)) {
 //			indigo_process_image(device, PRIVATE_DATA->buffer, (int)(CCD_FRAME_WIDTH_ITEM->number.value / CCD_BIN_HORIZONTAL_ITEM->number.value), (int)(CCD_FRAME_HEIGHT_ITEM->number.value / CCD_BIN_VERTICAL_ITEM->number.value), 8, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 //		} else {
 //			CCD_STREAMING_PROPERTY->state = INDIGO_ALERT_STATE;
 //			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, "Exposure failed");
@@ -357,12 +359,12 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 				result = ssag_open(device);
 			}
 			if (result) {
-				PRIVATE_DATA->buffer = (unsigned char *)indigo_alloc_blob_buffer(FITS_HEADER_SIZE + BUFFER_SIZE);
+				PRIVATE_DATA->buffer = (unsigned char *)indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + BUFFER_SIZE);
 				assert(PRIVATE_DATA->buffer != NULL);
 				CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 			} else {
 				if (PRIVATE_DATA->buffer != NULL) {
-					free(PRIVATE_DATA->buffer);
+					indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 					PRIVATE_DATA->buffer = NULL;
 				}
 				PRIVATE_DATA->device_count--;
@@ -371,7 +373,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 			}
 		} else {
 			if (PRIVATE_DATA->buffer != NULL) {
-				free(PRIVATE_DATA->buffer);
+				indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 			if (--PRIVATE_DATA->device_count == 0) {
@@ -623,7 +625,7 @@ static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotp
 			if (private_data != NULL) {
 				libusb_unref_device(dev);
 				if (private_data->buffer)
-					free(private_data->buffer);
+					indigo_release_blob_buffer(private_data->buffer);
 				free(private_data);
 			}
 			break;
@@ -270,7 +270,7 @@ static bool sx_open(indigo_device *device) {
 					PRIVATE_DATA->ccd_height *= 2;
 					PRIVATE_DATA->pix_height /= 2;
 				}
-				PRIVATE_DATA->buffer = indigo_alloc_blob_buffer(2 * PRIVATE_DATA->ccd_width * PRIVATE_DATA->ccd_height + FITS_HEADER_SIZE + 512);
+				PRIVATE_DATA->buffer = indigo_alloc_shared_blob_buffer(2 * PRIVATE_DATA->ccd_width * PRIVATE_DATA->ccd_height + FITS_HEADER_SIZE + 512);
 				assert(PRIVATE_DATA->buffer != NULL);
 				if (PRIVATE_DATA->is_interlaced) {
 					PRIVATE_DATA->even = malloc(PRIVATE_DATA->ccd_width * PRIVATE_DATA->ccd_height + 512);
@@ -671,7 +671,7 @@ static void sx_close(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->usb_mutex);
 	libusb_close(PRIVATE_DATA->handle);
 	INDIGO_DRIVER_DEBUG(DRIVER_NAME, "libusb_close");
-	free(PRIVATE_DATA->buffer);
+	indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 	PRIVATE_DATA->buffer = NULL;
 	if (PRIVATE_DATA->is_interlaced) {
 		free(PRIVATE_DATA->even);
@@ -692,6 +692,7 @@ static void exposure_timer_callback(indigo_device *device) {
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		if (sx_read_pixels(device)) {
 			indigo_process_image(device, PRIVATE_DATA->buffer,PRIVATE_DATA->frame_width / PRIVATE_DATA->horizontal_bin, PRIVATE_DATA->frame_height / PRIVATE_DATA->vertical_bin, PRIVATE_DATA->bits_per_pixel, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 			indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		} else {
@@ -910,22 +911,33 @@ static indigo_result ccd_detach(indigo_device *device) {
 
 // -------------------------------------------------------------------------------- INDIGO guider device implementation
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	if (!CONNECTION_CONNECTED_ITEM->sw.value) return;
 	PRIVATE_DATA->guider_timer = NULL;
 	sx_guide_relays(device, 0);
-	if (PRIVATE_DATA->relay_mask & (SX_GUIDE_NORTH | SX_GUIDE_SOUTH)) {
-		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
-	}
-	if (PRIVATE_DATA->relay_mask & (SX_GUIDE_WEST | SX_GUIDE_EAST)) {
-		GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-		GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-		GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->relay_mask & (SX_GUIDE_NORTH | SX_GUIDE_SOUTH))
+		indigo_set_timer(device, 0, guider_finished_callback_dec);
+	if (PRIVATE_DATA->relay_mask & (SX_GUIDE_WEST | SX_GUIDE_EAST))
+		indigo_set_timer(device, 0, guider_finished_callback_ra);
 	PRIVATE_DATA->relay_mask = 0;
 }
 
@@ -988,12 +1000,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_NORTH_ITEM->number.value;
 		if (duration > 0) {
 			PRIVATE_DATA->relay_mask |= SX_GUIDE_NORTH;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
 			if (duration > 0) {
 				PRIVATE_DATA->relay_mask |= SX_GUIDE_SOUTH;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		sx_guide_relays(device, PRIVATE_DATA->relay_mask);
@@ -1008,12 +1020,12 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 		int duration = GUIDER_GUIDE_EAST_ITEM->number.value;
 		if (duration > 0) {
 			PRIVATE_DATA->relay_mask |= SX_GUIDE_EAST;
-			PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+			PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
 			if (duration > 0) {
 				PRIVATE_DATA->relay_mask |= SX_GUIDE_WEST;
-				PRIVATE_DATA->guider_timer = indigo_set_timer(device, duration/1000.0, guider_timer_callback);
+				PRIVATE_DATA->guider_timer = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback);
 			}
 		}
 		sx_guide_relays(device, PRIVATE_DATA->relay_mask);
@@ -1174,7 +1186,7 @@ static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotp
 		}
 		if (private_data != NULL) {
 			libusb_unref_device(dev);
-			if (private_data->buffer != NULL) free(private_data->buffer);
+			if (private_data->buffer != NULL) indigo_release_blob_buffer(private_data->buffer);
 			if (private_data->even != NULL) free(private_data->even);
 			if (private_data->odd != NULL) free(private_data->odd);
 			free(private_data);
@@ -78,6 +78,7 @@ static void exposure_callback(uvc_frame_t *frame, indigo_device *device) {
 			memcpy(PRIVATE_DATA->buffer + FITS_HEADER_SIZE, rgb->data, 3 * frame->width * frame->height);
 			uvc_free_frame(rgb);
 			indigo_process_image(device, PRIVATE_DATA->buffer, rgb->width, rgb->height, 24, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 			CCD_EXPOSURE_PROPERTY->state = INDIGO_OK_STATE;
 		}
 	}
@@ -102,6 +103,7 @@ static void streaming_callback(uvc_frame_t *frame, indigo_device *device) {
 			memcpy(PRIVATE_DATA->buffer + FITS_HEADER_SIZE, rgb->data, 3 * frame->width * frame->height);
 			uvc_free_frame(rgb);
 			indigo_process_image(device, PRIVATE_DATA->buffer, rgb->width, rgb->height, 24, true, true, NULL);
+			PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 		}
 	}
 	if (CCD_STREAMING_COUNT_ITEM->number.value != -1)
@@ -217,7 +219,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 						}
 						format = format->next;
 					}
-					PRIVATE_DATA->buffer = malloc(FITS_HEADER_SIZE + (int)CCD_INFO_WIDTH_ITEM->number.value * (int)CCD_INFO_HEIGHT_ITEM->number.value * 3);
+					PRIVATE_DATA->buffer = indigo_alloc_shared_blob_buffer(FITS_HEADER_SIZE + (int)CCD_INFO_WIDTH_ITEM->number.value * (int)CCD_INFO_HEIGHT_ITEM->number.value * 3);
 				}
 			}
 		} else {
@@ -229,7 +231,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 				INDIGO_DRIVER_DEBUG(DRIVER_NAME, "uvc_close() -> %s");
 				PRIVATE_DATA->handle = 0;
 				if (PRIVATE_DATA->buffer)
-					free(PRIVATE_DATA->buffer);
+					indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 				PRIVATE_DATA->buffer = NULL;
 			}
 		}
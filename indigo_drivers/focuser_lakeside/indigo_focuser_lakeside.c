@@ -66,23 +66,17 @@ typedef struct {
 
 static bool lakeside_command(indigo_device *device, char *command, char *response, int timeout) {
 	char c;
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000000;
-	tv.tv_usec = timeout % 1000000;
 	if (command != NULL) {
 		if (!indigo_write(PRIVATE_DATA->handle, command, strlen(command)))
 			return false;
 	}
 	if (response != NULL) {
 		int index = 0;
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, timeout);
 		while (index < 10) {
-			fd_set readout;
-			FD_ZERO(&readout);
-			FD_SET(PRIVATE_DATA->handle, &readout);
-			long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-			if (result <= 0)
+			long result = indigo_read(PRIVATE_DATA->handle, &c, 1);
+			if (result < 0 && errno == ETIMEDOUT)
 				break;
-			result = read(PRIVATE_DATA->handle, &c, 1);
 			if (result < 1) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to read from %s -> %s (%d)", DEVICE_PORT_ITEM->text.value, strerror(errno), errno);
 				return false;
@@ -209,10 +203,12 @@ static void focuser_connection_handler(indigo_device *device) {
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
 		PRIVATE_DATA->handle = indigo_open_serial_with_speed(DEVICE_PORT_ITEM->text.value, 9600);
 		if (PRIVATE_DATA->handle > 0) {
+			indigo_enable_read_buffer(PRIVATE_DATA->handle, 1000000);
 			if (lakeside_command(device, "??#", response, 1000000) && !strcmp("OK", response)) {
 				INDIGO_DRIVER_LOG(DRIVER_NAME, "Lakeside focuser detected");
 			} else {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Lakeside focuser not detected");
+				indigo_disable_read_buffer(PRIVATE_DATA->handle);
 				close(PRIVATE_DATA->handle);
 				PRIVATE_DATA->handle = 0;
 			}
@@ -282,6 +278,7 @@ static void focuser_connection_handler(indigo_device *device) {
 			indigo_cancel_timer(device, &PRIVATE_DATA->timer);
 			indigo_delete_property(device, X_FOCUSER_ACTIVE_SLOPE_PROPERTY, NULL);
 			INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected");
+			indigo_disable_read_buffer(PRIVATE_DATA->handle);
 			close(PRIVATE_DATA->handle);
 			PRIVATE_DATA->handle = 0;
 		}
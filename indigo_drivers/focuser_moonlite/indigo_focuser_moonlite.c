@@ -57,20 +57,13 @@ typedef struct {
 
 static bool moonlite_command(indigo_device *device, char *command, char *response, int max) {
 	char c;
-	struct timeval tv;
-	tv.tv_sec = 0;
-	tv.tv_usec = 500000;
 	indigo_write(PRIVATE_DATA->handle, command, strlen(command));
 	if (response != NULL) {
 		int index = 0;
 		while (index < max) {
-			fd_set readout;
-			FD_ZERO(&readout);
-			FD_SET(PRIVATE_DATA->handle, &readout);
-			long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-			if (result <= 0)
+			long result = indigo_read(PRIVATE_DATA->handle, &c, 1);
+			if (result < 0 && errno == ETIMEDOUT)
 				break;
-			result = read(PRIVATE_DATA->handle, &c, 1);
 			if (result < 1) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to read from %s -> %s (%d)", DEVICE_PORT_ITEM->text.value, strerror(errno), errno);
 				return false;
@@ -221,6 +214,7 @@ static void focuser_connection_handler(indigo_device *device) {
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
 		PRIVATE_DATA->handle = indigo_open_serial_with_speed(DEVICE_PORT_ITEM->text.value, 9600);
 		if (PRIVATE_DATA->handle > 0) {
+			indigo_enable_read_buffer(PRIVATE_DATA->handle, 500000);
 			for (int i = 0; true; i++) {
 				if (moonlite_command(device, ":GV#", response, sizeof(response)) && strlen(response) == 2) {
 					INDIGO_DRIVER_LOG(DRIVER_NAME, "MoonLite focuser %c.%c", response[0], response[1]);
@@ -230,6 +224,7 @@ static void focuser_connection_handler(indigo_device *device) {
 					indigo_usleep(2 * ONE_SECOND_DELAY);
 				} else {
 					INDIGO_DRIVER_ERROR(DRIVER_NAME, "MoonLite focuser not detected");
+					indigo_disable_read_buffer(PRIVATE_DATA->handle);
 					close(PRIVATE_DATA->handle);
 					PRIVATE_DATA->handle = 0;
 					break;
@@ -268,6 +263,7 @@ static void focuser_connection_handler(indigo_device *device) {
 			indigo_cancel_timer(device, &PRIVATE_DATA->timer);
 			indigo_delete_property(device, X_FOCUSER_STEPPING_MODE_PROPERTY, NULL);
 			INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected");
+			indigo_disable_read_buffer(PRIVATE_DATA->handle);
 			close(PRIVATE_DATA->handle);
 			PRIVATE_DATA->handle = 0;
 		}
@@ -58,6 +58,7 @@ static bool optec_open(indigo_device *device) {
 	if (PRIVATE_DATA->handle >= 0) {
 		char reply;
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 0);
 		if (indigo_printf(PRIVATE_DATA->handle, "FMMODE\r\n") && indigo_scanf(PRIVATE_DATA->handle, "%c\r\n", &reply) == 1 && reply == '!') {
 			double value;
 			indigo_printf(PRIVATE_DATA->handle, "FPOSRO\r\n");
@@ -98,6 +99,7 @@ static bool optec_open(indigo_device *device) {
 static void optec_close(indigo_device *device) {
 	if (PRIVATE_DATA->handle > 0) {
 		indigo_printf(PRIVATE_DATA->handle, "FFMODE\r\n");
+		indigo_disable_read_buffer(PRIVATE_DATA->handle);
 		close(PRIVATE_DATA->handle);
 		PRIVATE_DATA->handle = 0;
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
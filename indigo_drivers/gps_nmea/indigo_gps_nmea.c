@@ -68,6 +68,7 @@ static bool gps_open(indigo_device *device) {
 	}
 	if (PRIVATE_DATA->handle >= 0) {
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 0);
 		pthread_mutex_unlock(&PRIVATE_DATA->serial_mutex);
 		return true;
 	} else {
@@ -79,6 +80,7 @@ static bool gps_open(indigo_device *device) {
 
 static void gps_close(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->serial_mutex);
+	indigo_disable_read_buffer(PRIVATE_DATA->handle);
 	close(PRIVATE_DATA->handle);
 	PRIVATE_DATA->handle = -1;
 	INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
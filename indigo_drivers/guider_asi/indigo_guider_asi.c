@@ -107,7 +107,17 @@ static void asi_close(indigo_device *device) {
 }
 
 
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_ra != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_ra(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_ra = NULL;
 	int id = PRIVATE_DATA->dev_id;
 
@@ -118,18 +128,24 @@ static void guider_timer_callback_ra(indigo_device *device) {
 	USB2ST4PulseGuide(id, USB2ST4_WEST, false);
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
-	if (PRIVATE_DATA->guide_relays[USB2ST4_EAST] || PRIVATE_DATA->guide_relays[USB2ST4_WEST]) {
-		GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-		GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-		GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->guide_relays[USB2ST4_EAST] || PRIVATE_DATA->guide_relays[USB2ST4_WEST])
+		indigo_set_timer(device, 0, guider_finished_callback_ra);
 	PRIVATE_DATA->guide_relays[USB2ST4_EAST] = false;
 	PRIVATE_DATA->guide_relays[USB2ST4_WEST] = false;
 }
 
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_dec != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_dec(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_dec = NULL;
 	int id = PRIVATE_DATA->dev_id;
 
@@ -140,12 +156,8 @@ static void guider_timer_callback_dec(indigo_device *device) {
 	USB2ST4PulseGuide(id, USB2ST4_NORTH, false);
 	pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
-	if (PRIVATE_DATA->guide_relays[USB2ST4_NORTH] || PRIVATE_DATA->guide_relays[USB2ST4_SOUTH]) {
-		GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-		GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
-	}
+	if (PRIVATE_DATA->guide_relays[USB2ST4_NORTH] || PRIVATE_DATA->guide_relays[USB2ST4_SOUTH])
+		indigo_set_timer(device, 0, guider_finished_callback_dec);
 	PRIVATE_DATA->guide_relays[USB2ST4_SOUTH] = false;
 	PRIVATE_DATA->guide_relays[USB2ST4_NORTH] = false;
 }
@@ -202,7 +214,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 			if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "USB2ST4PulseGuide(%d, USB2ST4_NORTH) = %d", id, res);
-			PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+			PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 			PRIVATE_DATA->guide_relays[USB2ST4_NORTH] = true;
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
@@ -212,7 +224,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 				if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "USB2ST4PulseGuide(%d, USB2ST4_SOUTH) = %d", id, res);
-				PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+				PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 				PRIVATE_DATA->guide_relays[USB2ST4_SOUTH] = true;
 			}
 		}
@@ -235,7 +247,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 			pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 			if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "USB2ST4PulseGuide(%d, USB2ST4_EAST) = %d", id, res);
-			PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+			PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 			PRIVATE_DATA->guide_relays[USB2ST4_EAST] = true;
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
@@ -245,7 +257,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 
 				if (res) INDIGO_DRIVER_ERROR(DRIVER_NAME, "USB2ST4PulseGuide(%d, USB2ST4_WEST) = %d", id, res);
-				PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+				PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 				PRIVATE_DATA->guide_relays[USB2ST4_WEST] = true;
 			}
 		}
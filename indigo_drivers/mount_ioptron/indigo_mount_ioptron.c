@@ -68,23 +68,14 @@ typedef struct {
 
 static bool ieq_command(indigo_device *device, char *command, char *response, int max) {
 	pthread_mutex_lock(&PRIVATE_DATA->port_mutex);
-	char c;
-	struct timeval tv;
-	tv.tv_sec = 0;
-	tv.tv_usec = 10000;
+	char c, buffer[64];
 		// flush
+	indigo_discard_read_buffer(PRIVATE_DATA->handle);
+	indigo_enable_read_buffer(PRIVATE_DATA->handle, 10000);
 	while (true) {
-		fd_set readout;
-		FD_ZERO(&readout);
-		FD_SET(PRIVATE_DATA->handle, &readout);
-		long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-		if (result == 0)
+		long result = indigo_recv(PRIVATE_DATA->handle, buffer, sizeof(buffer));
+		if (result < 0 && errno == ETIMEDOUT)
 			break;
-		if (result < 0) {
-			pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
-			return false;
-		}
-		result = read(PRIVATE_DATA->handle, &c, 1);
 		if (result < 1) {
 			pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
 			return false;
@@ -96,16 +87,11 @@ static bool ieq_command(indigo_device *device, char *command, char *response, in
 	if (response != NULL) {
 		int index = 0;
 		*response = 0;
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 500000);
 		while (index < max) {
-			tv.tv_usec = 500000;
-			tv.tv_sec = 0;
-			fd_set readout;
-			FD_ZERO(&readout);
-			FD_SET(PRIVATE_DATA->handle, &readout);
-			long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-			if (result <= 0)
+			long result = indigo_read(PRIVATE_DATA->handle, &c, 1);
+			if (result < 0 && errno == ETIMEDOUT)
 				break;
-			result = read(PRIVATE_DATA->handle, &c, 1);
 			if (result < 1) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to read from %s -> %s (%d)", DEVICE_PORT_ITEM->text.value, strerror(errno), errno);
 				pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
@@ -227,6 +213,7 @@ static bool ieq_open(indigo_device *device) {
 		PRIVATE_DATA->handle = indigo_open_serial_with_speed(name, 9600);
 		if (PRIVATE_DATA->handle >= 0) {
 			if (!ieq_command(device, ":MountInfo#", response, sizeof(response)) || strlen(response) < 4 || strlen(response) > 5) {
+				indigo_disable_read_buffer(PRIVATE_DATA->handle);
 				close(PRIVATE_DATA->handle);
 				PRIVATE_DATA->handle = indigo_open_serial_with_speed(name, 115200);
 			}
@@ -245,6 +232,7 @@ static bool ieq_open(indigo_device *device) {
 		}
 	}
 	if (PRIVATE_DATA->handle >= 0) {
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 10000);
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
 		if (ieq_command(device, ":V#", response, sizeof(response))) {
 			INDIGO_DRIVER_LOG(DRIVER_NAME, "version:  %s", response);
@@ -472,6 +460,7 @@ static bool ieq_open(indigo_device *device) {
 
 static void ieq_close(indigo_device *device) {
 	if (PRIVATE_DATA->handle > 0) {
+		indigo_disable_read_buffer(PRIVATE_DATA->handle);
 		close(PRIVATE_DATA->handle);
 		PRIVATE_DATA->handle = 0;
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
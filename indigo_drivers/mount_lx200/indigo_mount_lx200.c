@@ -116,6 +116,7 @@ static bool meade_open(indigo_device *device) {
 		}
 	}
 	if (PRIVATE_DATA->handle >= 0) {
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 100000);
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
 		return true;
 	} else {
@@ -126,23 +127,13 @@ static bool meade_open(indigo_device *device) {
 
 static bool meade_command(indigo_device *device, char *command, char *response, int max, int sleep) {
 	pthread_mutex_lock(&PRIVATE_DATA->port_mutex);
-	char c;
-	struct timeval tv;
-	// flush
+	char c, buffer[64];
+	// flush, read-ahead buffer has 100ms timeout
+	indigo_discard_read_buffer(PRIVATE_DATA->handle);
 	while (true) {
-		fd_set readout;
-		FD_ZERO(&readout);
-		FD_SET(PRIVATE_DATA->handle, &readout);
-		tv.tv_sec = 0;
-		tv.tv_usec = 100000;
-		long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-		if (result == 0)
+		long result = indigo_recv(PRIVATE_DATA->handle, buffer, sizeof(buffer));
+		if (result < 0 && errno == ETIMEDOUT)
 			break;
-		if (result < 0) {
-			pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
-			return false;
-		}
-		result = read(PRIVATE_DATA->handle, &c, 1);
 		if (result < 1) {
 			pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
 			return false;
@@ -152,21 +143,16 @@ static bool meade_command(indigo_device *device, char *command, char *response,
 	indigo_write(PRIVATE_DATA->handle, command, strlen(command));
 	if (sleep > 0)
 		indigo_usleep(sleep);
-	// read response
+	// read response, the first character may take up to 3s
 	if (response != NULL) {
 		int index = 0;
-		int timeout = 3;
+		indigo_enable_read_buffer(PRIVATE_DATA->handle, 3100000);
 		while (index < max) {
-			fd_set readout;
-			FD_ZERO(&readout);
-			FD_SET(PRIVATE_DATA->handle, &readout);
-			tv.tv_sec = timeout;
-			tv.tv_usec = 100000;
-			timeout = 0;
-			long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-			if (result <= 0)
+			long result = indigo_read(PRIVATE_DATA->handle, &c, 1);
+			if (index == 0)
+				indigo_enable_read_buffer(PRIVATE_DATA->handle, 100000);
+			if (result < 0 && errno == ETIMEDOUT)
 				break;
-			result = read(PRIVATE_DATA->handle, &c, 1);
 			if (result < 1) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to read from %s -> %s (%d)", DEVICE_PORT_ITEM->text.value, strerror(errno), errno);
 				pthread_mutex_unlock(&PRIVATE_DATA->port_mutex);
@@ -198,6 +184,7 @@ static bool meade_command(indigo_device *device, char *command, char *response,
 
 static void meade_close(indigo_device *device) {
 	if (PRIVATE_DATA->handle > 0) {
+		indigo_disable_read_buffer(PRIVATE_DATA->handle);
 		close(PRIVATE_DATA->handle);
 		PRIVATE_DATA->handle = 0;
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
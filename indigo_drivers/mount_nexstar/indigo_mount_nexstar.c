@@ -85,6 +85,7 @@ static bool mount_open(indigo_device *device) {
 
 	pthread_mutex_lock(&PRIVATE_DATA->serial_mutex);
 	if (PRIVATE_DATA->count_open++ == 0) {
+		// no read-ahead buffer here, libnexstar reads the handle with raw read() calls
 		int dev_id = open_telescope(DEVICE_PORT_ITEM->text.value);
 		if (dev_id == -1) {
 			pthread_mutex_unlock(&PRIVATE_DATA->serial_mutex);
@@ -881,7 +882,17 @@ static indigo_result nexstar_guider_enumerate_properties(indigo_device *device,
 }
 
 
+static void guider_finished_callback_ra(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_ra != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
+	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
+	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_ra(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_ra = NULL;
 	int dev_id = PRIVATE_DATA->dev_id;
 	int res;
@@ -893,14 +904,21 @@ static void guider_timer_callback_ra(indigo_device *device) {
 		INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", dev_id, res, strerror(errno));
 	}
 
-	GUIDER_GUIDE_EAST_ITEM->number.value = 0;
-	GUIDER_GUIDE_WEST_ITEM->number.value = 0;
-	GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_OK_STATE;
-	indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
+	indigo_set_timer(device, 0, guider_finished_callback_ra);
 }
 
 
+static void guider_finished_callback_dec(indigo_device *device) {
+	if (PRIVATE_DATA->guider_timer_dec != NULL) // next pulse already started
+		return;
+	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
+	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+}
+
 static void guider_timer_callback_dec(indigo_device *device) {
+	// runs on pulse scheduler thread, just ends the pulse and leaves property update to regular timer
 	PRIVATE_DATA->guider_timer_dec = NULL;
 	int dev_id = PRIVATE_DATA->dev_id;
 	int res;
@@ -912,10 +930,7 @@ static void guider_timer_callback_dec(indigo_device *device) {
 		INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", dev_id, res, strerror(errno));
 	}
 
-	GUIDER_GUIDE_NORTH_ITEM->number.value = 0;
-	GUIDER_GUIDE_SOUTH_ITEM->number.value = 0;
-	GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_OK_STATE;
-	indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
+	indigo_set_timer(device, 0, guider_finished_callback_dec);
 }
 
 
@@ -996,7 +1011,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", PRIVATE_DATA->dev_id, res, strerror(errno));
 			}
 			GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-			PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+			PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 		} else {
 			int duration = GUIDER_GUIDE_SOUTH_ITEM->number.value;
 			if (duration > 0) {
@@ -1007,7 +1022,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 					INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", PRIVATE_DATA->dev_id, res, strerror(errno));
 				}
 				GUIDER_GUIDE_DEC_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer_dec = indigo_set_timer(device, duration/1000.0, guider_timer_callback_dec);
+				PRIVATE_DATA->guider_timer_dec = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_dec);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
@@ -1026,7 +1041,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", PRIVATE_DATA->dev_id, res, strerror(errno));
 			}
 			GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
-			PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+			PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 		} else {
 			int duration = GUIDER_GUIDE_WEST_ITEM->number.value;
 			if (duration > 0) {
@@ -1037,7 +1052,7 @@ static indigo_result guider_change_property(indigo_device *device, indigo_client
 					INDIGO_DRIVER_ERROR(DRIVER_NAME, "tc_slew_fixed(%d) = %d (%s)", PRIVATE_DATA->dev_id, res, strerror(errno));
 				}
 				GUIDER_GUIDE_RA_PROPERTY->state = INDIGO_BUSY_STATE;
-				PRIVATE_DATA->guider_timer_ra = indigo_set_timer(device, duration/1000.0, guider_timer_callback_ra);
+				PRIVATE_DATA->guider_timer_ra = indigo_guider_set_pulse_timer(device, duration, guider_timer_callback_ra);
 			}
 		}
 		indigo_update_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
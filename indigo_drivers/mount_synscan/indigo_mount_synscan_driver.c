@@ -83,6 +83,9 @@ bool synscan_open(indigo_device *device) {
 		PRIVATE_DATA->udp = false;
 	}
 	if (PRIVATE_DATA->handle > 0) {
+		// UDP responses are whole datagrams, only serial port is read through read-ahead buffer
+		if (!PRIVATE_DATA->udp)
+			indigo_enable_read_buffer(PRIVATE_DATA->handle, 0);
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s @ %s", name, PRIVATE_DATA->udp ? "UDP" : DEVICE_BAUDRATE_ITEM->text.value);
 		return true;
 	} else {
@@ -93,6 +96,7 @@ bool synscan_open(indigo_device *device) {
 
 void synscan_close(indigo_device *device) {
 	if (PRIVATE_DATA->handle > 0) {
+		indigo_disable_read_buffer(PRIVATE_DATA->handle);
 		close(PRIVATE_DATA->handle);
 		PRIVATE_DATA->handle = 0;
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
@@ -89,7 +89,11 @@ static long hexResponseToLong(const char* b) {
 }
 
 static bool synscan_flush(indigo_device* device) {
-	unsigned char c;
+	if (!PRIVATE_DATA->udp) {
+		// serial responses are read through read-ahead buffer, anything left there is stale
+		indigo_discard_read_buffer(PRIVATE_DATA->handle);
+		return true;
+	}
 	struct timeval tv;
 	while (true) {
 		fd_set readout;
@@ -104,12 +108,8 @@ static bool synscan_flush(indigo_device* device) {
 			INDIGO_DRIVER_ERROR(DRIVER_NAME, "SELECT FAIL 1");
 			return false;
 		}
-		if (PRIVATE_DATA->udp) {
-			char buf[64];
-			result = recv(PRIVATE_DATA->handle, buf, sizeof(buf), 0);
-		} else {
-			result = read(PRIVATE_DATA->handle, &c, 1);
-		}
+		char buf[64];
+		result = recv(PRIVATE_DATA->handle, buf, sizeof(buf), 0);
 		if (result < 1) {
 			INDIGO_DRIVER_ERROR(DRIVER_NAME, "READ FAIL 1");
 			return false;
@@ -148,8 +148,8 @@ static bool synscan_read_response(indigo_device* device, char* r) {
 	} else {
 		long total_bytes = 0;
 		while (total_bytes < sizeof(resp)) {
-			long bytes_read = read(PRIVATE_DATA->handle, &c, 1);
-			if (bytes_read == 0) {
+			long bytes_read = indigo_read(PRIVATE_DATA->handle, &c, 1);
+			if (bytes_read <= 0) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "SYNSCAN_TIMEOUT");
 				break;
 			}
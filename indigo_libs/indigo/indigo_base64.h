@@ -22,10 +22,25 @@
 #ifndef __BASE64_H
 #define __BASE64_H
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Encoder/decoder implementations, the best one supported by CPU is selected on first use.
+ */
+typedef enum {
+	BASE64_LUT,
+	BASE64_SSE41,
+	BASE64_AVX2,
+	BASE64_NEON
+} base64_impl;
+
+extern bool base64_supports_impl(base64_impl impl);
+extern bool base64_select_impl(base64_impl impl);
+extern const char *base64_impl_name(base64_impl impl);
+
 extern long base64_encode(unsigned char *out, const unsigned char *in, long inlen);
 extern long base64_decode_fast(unsigned char *out, const unsigned char *in, long inlen);
 extern long base64_decode_fast_nl(unsigned char *out, const unsigned char *in, long inlen);
@@ -0,0 +1,178 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary wire protocol parser
+ \file indigo_binary.h
+ */
+
+#ifndef indigo_binary_h
+#define indigo_binary_h
+
+#include <stdint.h>
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_io.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** First byte of the binary protocol preamble, the server uses it to recognize the protocol.
+ */
+#define INDIGO_BINARY_MAGIC			0xB1
+
+/** Binary protocol version sent in the preamble.
+ */
+#define INDIGO_BINARY_VERSION		1
+
+/** Preamble sent by the client and echoed by the server to accept the protocol.
+ */
+#define INDIGO_BINARY_PREAMBLE_SIZE	4
+
+/** Frame header size (1 byte type, 4 bytes little endian body length).
+ */
+#define INDIGO_BINARY_HEADER_SIZE	5
+
+/** Largest BLOB content accepted in a single frame, frames above it plus property size are rejected.
+ */
+#define INDIGO_BINARY_MAX_BLOB_SIZE	(1024L * 1024L * 1024L)
+
+/** Largest property id accepted from the wire.
+ */
+#define INDIGO_BINARY_MAX_ID		(1 << 20)
+
+/** Binary protocol frame types.
+ */
+typedef enum {
+	INDIGO_BINARY_GET_PROPERTIES = 1,	///< client -> server: device, name
+	INDIGO_BINARY_ENABLE_BLOB,				///< client -> server: device, name, mode
+	INDIGO_BINARY_NEW_VECTOR,					///< client -> server: id, count, (index, value)*
+	INDIGO_BINARY_DEF_VECTOR,					///< server -> client: id, type, state, perm, rule, count, device, name, group, label, hints, message, (name, label, hints, value)*
+	INDIGO_BINARY_SET_VECTOR,					///< server -> client: id, state, message, count, (index, value)*
+	INDIGO_BINARY_DEL_PROPERTY,				///< server -> client: device, name, message
+	INDIGO_BINARY_MESSAGE,						///< server -> client: device, message
+	INDIGO_BINARY_UPDATE_INTERVAL			///< client -> server: device, name, interval
+} indigo_binary_frame_type;
+
+/** Property id table and frame scratch buffer shared by protocol adapter and parser of one connection.
+ */
+typedef struct indigo_binary_context indigo_binary_context;
+
+/** Binary wire protocol parser state.
+ */
+typedef struct indigo_binary_parser indigo_binary_parser;
+
+/** Create binary protocol connection state.
+ */
+extern indigo_binary_context *indigo_binary_context_create();
+
+/** Release binary protocol connection state (including cached client side properties).
+ */
+extern void indigo_binary_context_release(indigo_binary_context *context);
+
+/** Lock connection state.
+ */
+extern void indigo_binary_lock(indigo_binary_context *context);
+
+/** Unlock connection state.
+ */
+extern void indigo_binary_unlock(indigo_binary_context *context);
+
+/** Find property id by device and property name, returns 0 if property is not known (call with context locked).
+ */
+extern uint32_t indigo_binary_find_id(indigo_binary_context *context, const char *device, const char *name);
+
+/** Remember names of property items and assign id if the property is not known yet, returns property id and sets *changed if the client has to get a new definition (call with context locked).
+ */
+extern uint32_t indigo_binary_register(indigo_binary_context *context, indigo_property *property, bool *changed);
+
+/** Forget property or all device properties if name is empty (call with context locked).
+ */
+extern void indigo_binary_forget(indigo_binary_context *context, const char *device, const char *name);
+
+/** Get client side copy of remote property by id, returns NULL if property is not known (call with context locked).
+ */
+extern indigo_property *indigo_binary_property(indigo_binary_context *context, uint32_t id);
+
+/** Start new frame in context scratch buffer.
+ */
+extern void indigo_binary_begin(indigo_binary_context *context, indigo_binary_frame_type type);
+
+/** Append unsigned byte to the frame.
+ */
+extern void indigo_binary_put_u8(indigo_binary_context *context, uint8_t value);
+
+/** Append unsigned 16 bit integer to the frame.
+ */
+extern void indigo_binary_put_u16(indigo_binary_context *context, uint16_t value);
+
+/** Append unsigned 32 bit integer to the frame.
+ */
+extern void indigo_binary_put_u32(indigo_binary_context *context, uint32_t value);
+
+/** Append unsigned 64 bit integer to the frame.
+ */
+extern void indigo_binary_put_u64(indigo_binary_context *context, uint64_t value);
+
+/** Append double to the frame.
+ */
+extern void indigo_binary_put_double(indigo_binary_context *context, double value);
+
+/** Append string (16 bit length and bytes without terminating zero) to the frame, NULL is sent as empty string.
+ */
+extern void indigo_binary_put_string(indigo_binary_context *context, const char *value);
+
+/** Get current length of the frame (offset of the next value).
+ */
+extern long indigo_binary_length(indigo_binary_context *context);
+
+/** Overwrite unsigned 16 bit integer at given offset of the frame (e.g. item count known after items are written).
+ */
+extern void indigo_binary_patch_u16(indigo_binary_context *context, long offset, uint16_t value);
+
+/** Write the frame, payload_length bytes of raw payload written by caller right after it are counted in the frame length.
+ */
+extern void indigo_binary_end(indigo_binary_context *context, indigo_output_buffer *output, long payload_length);
+
+/** Write protocol preamble.
+ */
+extern void indigo_binary_write_preamble(indigo_output_buffer *output);
+
+/** Create binary wire protocol parser state for incremental parsing (enumerates device properties if device is set).
+ */
+extern indigo_binary_parser *indigo_binary_parser_create(indigo_device *device, indigo_client *client);
+
+/** Parse next chunk of input, returns false on protocol error.
+ */
+extern bool indigo_binary_parser_feed(indigo_binary_parser *parser, char *data, long length);
+
+/** Release binary wire protocol parser state.
+ */
+extern void indigo_binary_parser_release(indigo_binary_parser *parser);
+
+/** Parse and process binary protocol stream until the connection is closed, returns false if the peer didn't accept the protocol.
+ */
+extern bool indigo_binary_parse(indigo_device *device, indigo_client *client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_binary_h */
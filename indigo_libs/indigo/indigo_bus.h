@@ -49,11 +49,20 @@ extern "C" {
  */
 #define INDIGO_MAX_ITEMS      128
 
+/** Thread local storage class specifier (used for static buffers of wire protocol adapters).
+ */
+#if defined(INDIGO_WINDOWS)
+#define INDIGO_THREAD_LOCAL __declspec(thread)
+#else
+#define INDIGO_THREAD_LOCAL __thread
+#endif
+
 // forward definitions
 
 typedef int indigo_glock;
 typedef struct indigo_client indigo_client;
 typedef struct indigo_device indigo_device;
+typedef struct indigo_client_queue indigo_client_queue;
 
 /** Device interface (value should be used for INFO_DEVICE_INTERFACE_ITEM->text.value)
  */
@@ -200,6 +209,7 @@ typedef struct {/* there is no .name =  because of g++ C99 bug affecting string
 	char name[INDIGO_NAME_SIZE];        ///< property wide unique item name
 	char label[INDIGO_VALUE_SIZE];      ///< item description in human readable form
 	char hints[INDIGO_VALUE_SIZE];			///< item GUI hints
+	bool changed;                       ///< item value changed since the previous update (valid in update only, see indigo_property.partial)
 	union {
 		/** Text property item specific fields.
 		 */
@@ -251,6 +261,7 @@ typedef struct {
 	indigo_rule rule;                   ///< switch behaviour rule (for switch properties)
 	short version;                      ///< property version INDIGO_VERSION_NONE, INDIGO_VERSION_LEGACY or INDIGO_VERSION_2_0
 	bool hidden;                        ///< property is hidden/unused by  driver (for optional properties)
+	bool partial;                       ///< update carries valid item changed flags, protocol adapters can send changed items only
 	int count;                          ///< number of property items
 	indigo_item items[];                ///< property items
 } indigo_property;
@@ -330,25 +341,52 @@ typedef struct indigo_client {
 	/** callback called when client is detached from the bus
 	 */
 	indigo_result (*detach)(indigo_client *client);
+	indigo_client_queue *queue;																///< asynchronous dispatch queue (see indigo_enable_client_queue())
 } indigo_client;
 
+/** Client dispatch queue overflow policy.
+ */
+typedef enum {
+	INDIGO_QUEUE_BLOCK,					///< block sender until there is a free slot in the queue
+	INDIGO_QUEUE_DROP_OLDEST,		///< drop the oldest queued property update (except one changing property state) or message
+	INDIGO_QUEUE_DROP_NEWEST		///< drop property update (except one changing property state) or message being queued
+} indigo_queue_policy;
+
+/** Client dispatch queue statistics.
+ */
+typedef struct {
+	char client[INDIGO_NAME_SIZE];	///< client name
+	int depth;											///< number of queued messages
+	int max_depth;									///< queue high-water mark
+	long delivered;									///< number of delivered messages
+	long coalesced;									///< number of updates merged with already queued update of the same property
+	long dropped;										///< number of dropped updates and messages
+} indigo_queue_stats;
+
 /** Wire protocol adapter private data structure.
  */
 typedef struct {
 	int input;													///< input handle
 	int output;													///< output handle
 	bool web_socket;										///< connection over WebSocket (RFC6455)
+	bool partial_updates;								///< client asked for set vectors with changed items only (getProperties 'partial' attribute)
 	char url_prefix[INDIGO_NAME_SIZE];	///< server url prefix (for BLOB download)
+	pthread_mutex_t output_mutex;				///< output handle mutex
+	struct indigo_output_buffer *output_buffer;	///< buffered output (see indigo_output_create())
+	struct indigo_binary_context *binary_context;	///< property ids of binary protocol connection (see indigo_binary.h)
 } indigo_adapter_context;
 
-/** BLOB entry type.
+/** BLOB entry type - immutable reference counted snapshot of BLOB item content.
  */
-typedef struct {
+typedef struct indigo_blob_entry {
 	indigo_item *item;     							///< BLOB item
 	void *content;            					///< BLOB content
 	long size;              						///< BLOB size
 	char format[INDIGO_NAME_SIZE];  		///< BLOB format, known file type suffix like ".fits" or ".jpeg"
-	pthread_mutex_t mutext;							///< BLOB mutex
+	void *buffer;												///< shared BLOB buffer record holding the content (NULL if content is a private copy)
+	int ref_count;											///< number of references (cache and readers)
+	struct indigo_blob_entry *prev;			///< previous entry in cache LRU list
+	struct indigo_blob_entry *next;			///< next entry in cache LRU list
 } indigo_blob_entry;
 
 /** Last diagnostic messages.
@@ -417,6 +455,26 @@ extern indigo_result indigo_attach_client(indigo_client *client);
  */
 extern indigo_result indigo_detach_client(indigo_client *client);
 
+/** Deliver messages to client asynchronously through bounded queue served by a dedicated writer thread.
+ Must be called before the client is attached. Queued updates of the same property with the same state are coalesced, BLOB vectors are handed over synchronously.
+ Callbacks of clients without queue are called from the sending thread one at a time, serialized with device requests by the device mutex.
+ */
+extern indigo_result indigo_enable_client_queue(indigo_client *client, int size, indigo_queue_policy policy);
+
+/** Get dispatch queue statistics for attached clients with queue enabled, returns number of filled records.
+ */
+extern int indigo_get_client_queue_stats(indigo_queue_stats *stats, int max);
+
+/** Deliver updates of property (all device properties if name is empty, all properties if device is empty too) to client at most once per interval seconds,
+ intermediate updates with the same state are coalesced and the latest one is delivered when interval expires, state changes are delivered immediately.
+ Works for clients with dispatch queue only, interval 0 removes the limit.
+ */
+extern indigo_result indigo_set_update_interval(indigo_client *client, const char *device, const char *name, double interval);
+
+/** Get number of messages waiting in client dispatch queue (0 if queue is not enabled), adapters keep output corked while it is not 0.
+ */
+extern int indigo_client_queue_depth(indigo_client *client);
+
 /** Broadcast property definition.
  */
 extern indigo_result indigo_define_property(indigo_device *device, indigo_property *property, const char *format, ...);
@@ -471,12 +529,28 @@ extern indigo_property *indigo_resize_property(indigo_property *property, int co
 /** Allocate blob buffer (rounded up to 2880 bytes).
  */
 extern void *indigo_alloc_blob_buffer(long size);
+/** Allocate reference counted blob buffer (rounded up to 2880 bytes), BLOB cache shares it instead of copying the content.
+ */
+extern void *indigo_alloc_shared_blob_buffer(long size);
+/** Add reference to shared blob buffer.
+ */
+extern void *indigo_retain_blob_buffer(void *buffer);
+/** Remove reference from shared blob buffer, buffer is freed with the last reference.
+ */
+extern void indigo_release_blob_buffer(void *buffer);
+/** Get shared blob buffer for new content - the same buffer if nobody else holds it or a new one of the same size.
+ Camera drivers allocating the frame buffer with indigo_alloc_shared_blob_buffer() call it after indigo_process_image().
+ */
+extern void *indigo_claim_blob_buffer(void *buffer);
 /** Resize property.
  */
 extern void indigo_release_property(indigo_property *property);
-/** Validate address of item of registered BLOB property.
+/** Validate address of item of registered BLOB property, returns cached content snapshot to be released with indigo_release_blob_entry().
  */
 extern indigo_blob_entry *indigo_validate_blob(indigo_item *item);
+/** Release BLOB content snapshot.
+ */
+extern void indigo_release_blob_entry(indigo_blob_entry *entry);
 
 /** Initialize text item.
  */
@@ -634,6 +708,14 @@ extern bool indigo_is_sandboxed;
  */
 extern bool indigo_use_blob_caching;
 
+/** BLOB cache size limit in bytes, least recently used content is evicted above it.
+ */
+extern long indigo_blob_cache_limit;
+
+/** Track changed items of updated properties, protocol adapters send only changed items to INDIGO 2.0 clients.
+ */
+extern bool indigo_use_delta_updates;
+
 /** Use recursive locks for dispaching all bus messages
  */
 extern bool indigo_use_strict_locking;
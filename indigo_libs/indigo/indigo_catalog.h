@@ -0,0 +1,119 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary star/DSO catalog with spatial index
+ \file indigo_catalog.h
+ */
+
+#ifndef indigo_catalog_h
+#define indigo_catalog_h
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Catalog file signature.
+ */
+#define INDIGO_CATALOG_MAGIC		"INDIGOCT"
+
+/** Catalog file format version.
+ */
+#define INDIGO_CATALOG_VERSION	1
+
+/** Number of declination zones of the spatial index (1 degree each).
+ */
+#define INDIGO_CATALOG_ZONES		180
+
+/** Name of star catalog file in cache folder (Hipparcos stars shipped with server, J2000).
+ */
+#define INDIGO_CATALOG_STARS_FILE	"stars.icat"
+
+/** Name of DSO catalog file in cache folder (J2000).
+ */
+#define INDIGO_CATALOG_DSOS_FILE	"dsos.icat"
+
+/** Catalog entry as passed to indigo_catalog_create() and returned by queries.
+ */
+typedef struct {
+	double ra;											///< right ascension [h]
+	double dec;											///< declination [deg]
+	double promora;									///< proper motion in RA [mas/yr]
+	double promodec;								///< proper motion in Dec [mas/yr]
+	double px;											///< parallax [mas]
+	double rv;											///< radial velocity [km/s]
+	float mag;											///< magnitude
+	uint32_t id;										///< numeric id (e.g. HIP number or index in source table)
+	const char *designation;				///< designation (never NULL in query results)
+	const char *name;								///< common name (never NULL in query results)
+} indigo_catalog_entry;
+
+/** Catalog loaded in memory (image of the file).
+ */
+typedef struct indigo_catalog indigo_catalog;
+
+/** Create catalog from entries, positions are for given epoch (JD), source_hash identifies source data and can be used to detect stale files.
+ */
+extern indigo_catalog *indigo_catalog_create(const indigo_catalog_entry *entries, int count, double epoch, uint32_t source_hash);
+
+/** Load catalog from file, returns NULL if file doesn't exist or is not valid catalog.
+ */
+extern indigo_catalog *indigo_catalog_load(const char *path);
+
+/** Save catalog to file (written to temporary file and renamed).
+ */
+extern bool indigo_catalog_save(const indigo_catalog *catalog, const char *path);
+
+/** Release catalog.
+ */
+extern void indigo_catalog_free(indigo_catalog *catalog);
+
+/** Number of entries.
+ */
+extern int indigo_catalog_count(const indigo_catalog *catalog);
+
+/** Epoch of positions (JD).
+ */
+extern double indigo_catalog_epoch(const indigo_catalog *catalog);
+
+/** Hash of source data passed to indigo_catalog_create().
+ */
+extern uint32_t indigo_catalog_source_hash(const indigo_catalog *catalog);
+
+/** Get entry at index (entries are ordered by declination zone and RA).
+ */
+extern bool indigo_catalog_get(const indigo_catalog *catalog, int index, indigo_catalog_entry *entry);
+
+/** Find entries within radius [deg] from ra [h], dec [deg] not fainter than max_mag. Up to max_count entries are stored to result, total number of matching entries is returned.
+ */
+extern int indigo_catalog_cone(const indigo_catalog *catalog, double ra, double dec, double radius, double max_mag, indigo_catalog_entry *result, int max_count);
+
+/** Make path of file in INDIGO cache folder (~/.indigo/cache), folder is created if needed.
+ */
+extern bool indigo_catalog_cache_path(const char *file_name, char *path, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_catalog_h */
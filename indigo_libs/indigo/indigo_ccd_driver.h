@@ -125,6 +125,50 @@ extern "C" {
  */
 #define CCD_LOCAL_MODE_PREFIX_ITEM        (CCD_LOCAL_MODE_PROPERTY->items+1)
 
+/** CCD_LOCAL_SYNC property pointer, property is mandatory, property change request is fully handled by indigo_ccd_change_property().
+ */
+#define CCD_LOCAL_SYNC_PROPERTY           (CCD_CONTEXT->ccd_local_sync_property)
+
+/** CCD_LOCAL_SYNC.NONE property item pointer, files are left to the operating system cache.
+ */
+#define CCD_LOCAL_SYNC_NONE_ITEM          (CCD_LOCAL_SYNC_PROPERTY->items+0)
+
+/** CCD_LOCAL_SYNC.FRAME property item pointer, every file is synced before it is reported.
+ */
+#define CCD_LOCAL_SYNC_FRAME_ITEM         (CCD_LOCAL_SYNC_PROPERTY->items+1)
+
+/** CCD_LOCAL_SYNC.IDLE property item pointer, files are synced when the storage queue is empty.
+ */
+#define CCD_LOCAL_SYNC_IDLE_ITEM          (CCD_LOCAL_SYNC_PROPERTY->items+2)
+
+/** CCD_LOCAL_DIRECT property pointer, property is mandatory, property change request is fully handled by indigo_ccd_change_property().
+ */
+#define CCD_LOCAL_DIRECT_PROPERTY         (CCD_CONTEXT->ccd_local_direct_property)
+
+/** CCD_LOCAL_DIRECT.ENABLED property item pointer, large frames are preallocated and written bypassing the page cache.
+ */
+#define CCD_LOCAL_DIRECT_ENABLED_ITEM     (CCD_LOCAL_DIRECT_PROPERTY->items+0)
+
+/** CCD_LOCAL_DIRECT.DISABLED property item pointer.
+ */
+#define CCD_LOCAL_DIRECT_DISABLED_ITEM    (CCD_LOCAL_DIRECT_PROPERTY->items+1)
+
+/** CCD_LOCAL_QUEUE property pointer, property is mandatory, read-only property.
+ */
+#define CCD_LOCAL_QUEUE_PROPERTY          (CCD_CONTEXT->ccd_local_queue_property)
+
+/** CCD_LOCAL_QUEUE.QUEUED property item pointer.
+ */
+#define CCD_LOCAL_QUEUE_QUEUED_ITEM       (CCD_LOCAL_QUEUE_PROPERTY->items+0)
+
+/** CCD_LOCAL_QUEUE.WRITTEN property item pointer.
+ */
+#define CCD_LOCAL_QUEUE_WRITTEN_ITEM      (CCD_LOCAL_QUEUE_PROPERTY->items+1)
+
+/** CCD_LOCAL_QUEUE.THROUGHPUT property item pointer.
+ */
+#define CCD_LOCAL_QUEUE_THROUGHPUT_ITEM   (CCD_LOCAL_QUEUE_PROPERTY->items+2)
+
 /** CCD_EXPOSURE property pointer, property is mandatory, property change request handler should set property items and state and call indigo_ccd_change_property().
  */
 #define CCD_EXPOSURE_PROPERTY             (CCD_CONTEXT->ccd_exposure_property)
@@ -189,6 +233,38 @@ extern "C" {
  */
 #define CCD_BIN_VERTICAL_ITEM             (CCD_BIN_PROPERTY->items+1)
 
+/** CCD_SOFTWARE_FRAME property pointer, property is mandatory, property change request is fully handled by indigo_ccd_change_property().
+ */
+#define CCD_SOFTWARE_FRAME_PROPERTY       (CCD_CONTEXT->ccd_software_frame_property)
+
+/** CCD_SOFTWARE_FRAME.LEFT property item pointer, offset in the frame delivered by the camera.
+ */
+#define CCD_SOFTWARE_FRAME_LEFT_ITEM      (CCD_SOFTWARE_FRAME_PROPERTY->items+0)
+
+/** CCD_SOFTWARE_FRAME.TOP property item pointer, offset in the frame delivered by the camera.
+ */
+#define CCD_SOFTWARE_FRAME_TOP_ITEM       (CCD_SOFTWARE_FRAME_PROPERTY->items+1)
+
+/** CCD_SOFTWARE_FRAME.WIDTH property item pointer, 0 means up to the right edge.
+ */
+#define CCD_SOFTWARE_FRAME_WIDTH_ITEM     (CCD_SOFTWARE_FRAME_PROPERTY->items+2)
+
+/** CCD_SOFTWARE_FRAME.HEIGHT property item pointer, 0 means up to the bottom edge.
+ */
+#define CCD_SOFTWARE_FRAME_HEIGHT_ITEM    (CCD_SOFTWARE_FRAME_PROPERTY->items+3)
+
+/** CCD_SOFTWARE_BIN property pointer, property is mandatory, property change request is fully handled by indigo_ccd_change_property().
+ */
+#define CCD_SOFTWARE_BIN_PROPERTY         (CCD_CONTEXT->ccd_software_bin_property)
+
+/** CCD_SOFTWARE_BIN.HORIZONTAL property item pointer.
+ */
+#define CCD_SOFTWARE_BIN_HORIZONTAL_ITEM  (CCD_SOFTWARE_BIN_PROPERTY->items+0)
+
+/** CCD_SOFTWARE_BIN.VERTICAL property item pointer.
+ */
+#define CCD_SOFTWARE_BIN_VERTICAL_ITEM    (CCD_SOFTWARE_BIN_PROPERTY->items+1)
+
 /** CCD_MODE property pointer, property is mandatory.
  */
 #define CCD_MODE_PROPERTY									(CCD_CONTEXT->ccd_mode_property)
@@ -273,6 +349,14 @@ extern "C" {
  */
 #define CCD_IMAGE_FORMAT_JPEG_ITEM        (CCD_IMAGE_FORMAT_PROPERTY->items+3)
 
+/** CCD_IMAGE_FORMAT.FITS_RICE property item pointer.
+ */
+#define CCD_IMAGE_FORMAT_FITS_RICE_ITEM   (CCD_IMAGE_FORMAT_PROPERTY->items+4)
+
+/** CCD_IMAGE_FORMAT.XISF_LZ4 property item pointer.
+ */
+#define CCD_IMAGE_FORMAT_XISF_LZ4_ITEM    (CCD_IMAGE_FORMAT_PROPERTY->items+5)
+
 /** CCD_IMAGE_FILE property pointer, property is mandatory, read-only property.
  */
 #define CCD_IMAGE_FILE_PROPERTY           (CCD_CONTEXT->ccd_image_file_property)
@@ -357,6 +441,10 @@ extern "C" {
  */
 #define CCD_JPEG_SETTINGS_WHITE_TRESHOLD_ITEM     (CCD_JPEG_SETTINGS_PROPERTY->items+4)
 
+/** CCD_JPEG_SETTINGS.PREVIEW_SCALE property item pointer, preview is downscaled by this factor unless JPEG image format is selected.
+ */
+#define CCD_JPEG_SETTINGS_PREVIEW_SCALE_ITEM     (CCD_JPEG_SETTINGS_PROPERTY->items+5)
+
 /** CCD_RBI_FLUSH property pointer.
  */
 #define CCD_RBI_FLUSH_PROPERTY          (CCD_CONTEXT->ccd_rbi_flush_property)
@@ -381,6 +469,10 @@ extern "C" {
 #define CCD_RBI_FLUSH_DISABLED_ITEM     (CCD_RBI_FLUSH_ENABLE_PROPERTY->items + 1)
 
 
+/** Background writer of locally saved frames.
+ */
+typedef struct indigo_ccd_writer indigo_ccd_writer;
+
 /** CCD device context structure.
  */
 typedef struct {
@@ -389,10 +481,16 @@ typedef struct {
 	indigo_timer *countdown_timer;								///< countdown timer
 	void *preview_image;													///< preview image buffer
 	unsigned long preview_image_size;												///< preview image buffer size
+	void *compressed_image;												///< compressed FITS/XISF image buffer
+	unsigned long compressed_image_size;									///< compressed image buffer size
+	indigo_ccd_writer *writer;										///< local save writer (created on the first local save)
 	indigo_property *ccd_info_property;           ///< CCD_INFO property pointer
 	indigo_property *ccd_upload_mode_property;    ///< CCD_UPLOAD_MODE property pointer
 	indigo_property *ccd_preview_property;				///< CCD_PREVIEW property pointer
 	indigo_property *ccd_local_mode_property;     ///< CCD_LOCAL_MODE property pointer
+	indigo_property *ccd_local_sync_property;     ///< CCD_LOCAL_SYNC property pointer
+	indigo_property *ccd_local_direct_property;   ///< CCD_LOCAL_DIRECT property pointer
+	indigo_property *ccd_local_queue_property;    ///< CCD_LOCAL_QUEUE property pointer
 	indigo_property *ccd_mode_property;	          ///< CCD_MODE property pointer
 	indigo_property *ccd_read_mode_property;	  	///< CCD_READ_MODE property pointer
 	indigo_property *ccd_exposure_property;       ///< CCD_EXPOSURE property pointer
@@ -400,6 +498,8 @@ typedef struct {
 	indigo_property *ccd_abort_exposure_property; ///< CCD_ABORT_EXPOSURE property pointer
 	indigo_property *ccd_frame_property;          ///< CCD_FRAME property pointer
 	indigo_property *ccd_bin_property;            ///< CCD_BIN property pointer
+	indigo_property *ccd_software_frame_property; ///< CCD_SOFTWARE_FRAME property pointer
+	indigo_property *ccd_software_bin_property;   ///< CCD_SOFTWARE_BIN property pointer
 	indigo_property *ccd_offset_property;         ///< CCD_OFFSET property pointer
 	indigo_property *ccd_gain_property;           ///< CCD_GAIN property pointer
 	indigo_property *ccd_gamma_property;          ///< CCD_GAMMA property pointer
@@ -108,9 +108,14 @@ typedef struct {
 	int socket;                             ///< stream socket
 	indigo_device *protocol_adapter;        ///< server protocol adapter
 	char last_error[256];										///< last error reported within client thread
+	bool binary_protocol;                   ///< use binary wire protocol (cleared if server doesn't support it)
 } indigo_server_entry;
 
 
+/** Connect to new servers with binary wire protocol (with fallback to XML).
+ */
+extern bool indigo_use_binary_protocol;
+
 /** Array of all available servers.
  */
 extern indigo_server_entry indigo_available_servers[INDIGO_MAX_SERVERS];
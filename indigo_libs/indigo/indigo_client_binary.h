@@ -0,0 +1,48 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following
+// disclaimer in the documentation and/or other materials provided
+// with the distribution.
+//
+// 3. The name of the author may not be used to endorse or promote
+// products derived from this software without specific prior
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary wire protocol driver side adapter
+ \file indigo_client_binary.h
+ */
+
+#ifndef indigo_client_binary_h
+#define indigo_client_binary_h
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_binary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Create initialized instance of binary wire protocol driver side adapter (sends protocol preamble).
+ */
+extern indigo_device *indigo_binary_client_adapter(char *name, char *url_prefix, int input, int output);
+
+/** Release instance of binary wire protocol driver side adapter.
+ */
+extern void indigo_release_binary_client_adapter(indigo_device *device);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_client_binary_h */
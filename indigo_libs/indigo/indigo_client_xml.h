@@ -36,6 +36,11 @@ extern "C" {
 /** Create initialized instance of XML wire protocol driver side adapter.
  */
 extern indigo_device *indigo_xml_client_adapter(char *name, char *url_prefix, int input, int output);
+
+/** Release instance of XML wire protocol driver side adapter.
+ */
+extern void indigo_release_xml_client_adapter(indigo_device *device);
+
 extern void indigo_release_xml_device_adapter(indigo_client *client);
 
 #ifdef __cplusplus
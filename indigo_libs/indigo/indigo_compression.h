@@ -0,0 +1,79 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO lossless image compression
+ \file indigo_compression.h
+ */
+
+#ifndef indigo_compression_h
+#define indigo_compression_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Rice block size (pixels per block), stored as BLOCKSIZE parameter of RICE_1 compressed FITS.
+ */
+#define INDIGO_RICE_BLOCK_SIZE	32
+
+/** Size of LZ4 hash table in entries.
+ */
+#define INDIGO_LZ4_HASH_SIZE		(1 << 14)
+
+/** Worst case size of Rice compressed tile of count pixels with bytes per pixel.
+ */
+#define INDIGO_RICE_BOUND(count, bytes)	((long)(count) * (bytes) + (long)(count) / 8 + 16)
+
+/** Worst case size of LZ4 compressed block of size bytes.
+ */
+#define INDIGO_LZ4_BOUND(size)	((long)(size) + (long)(size) / 255 + 16)
+
+/** Compress tile of count big-endian 8 or 16 bit pixels with FITS RICE_1 algorithm, return compressed size or -1 if output doesn't fit.
+ */
+extern long indigo_rice_compress(const void *data, long count, int bytes, uint8_t *out, long out_size);
+
+/** Decompress RICE_1 compressed tile to count big-endian 8 or 16 bit pixels, return number of bytes consumed or -1 on malformed input.
+ */
+extern long indigo_rice_decompress(const uint8_t *in, long in_size, void *data, long count, int bytes);
+
+/** Compress block with LZ4 block format (no frame), hash_table must have INDIGO_LZ4_HASH_SIZE entries, return compressed size or -1 if output doesn't fit.
+ */
+extern long indigo_lz4_compress(const uint8_t *in, long in_size, uint8_t *out, long out_size, uint32_t *hash_table);
+
+/** Decompress LZ4 block, return decompressed size or -1 on malformed input.
+ */
+extern long indigo_lz4_decompress(const uint8_t *in, long in_size, uint8_t *out, long out_size);
+
+/** Byte shuffle count items of item_size bytes (all first bytes, all second bytes, ...).
+ */
+extern void indigo_byte_shuffle(const uint8_t *in, uint8_t *out, long count, int item_size);
+
+/** Reverse indigo_byte_shuffle().
+ */
+extern void indigo_byte_unshuffle(const uint8_t *in, uint8_t *out, long count, int item_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_compression_h */
@@ -77,6 +77,38 @@ extern "C" {
  */
 #define GUIDER_DEC_RATE_ITEM               		(GUIDER_RATE_PROPERTY->items+1)
 
+/** GUIDER_PULSE_STATISTICS property pointer, property is optional, it is maintained for pulses timed by indigo_guider_set_pulse_timer().
+ */
+#define GUIDER_PULSE_STATISTICS_PROPERTY			(GUIDER_CONTEXT->guider_pulse_statistics_property)
+
+/** GUIDER_PULSE_STATISTICS.COUNT property item pointer.
+ */
+#define GUIDER_PULSE_COUNT_ITEM								(GUIDER_PULSE_STATISTICS_PROPERTY->items+0)
+
+/** GUIDER_PULSE_STATISTICS.REQUESTED property item pointer.
+ */
+#define GUIDER_PULSE_REQUESTED_ITEM						(GUIDER_PULSE_STATISTICS_PROPERTY->items+1)
+
+/** GUIDER_PULSE_STATISTICS.ACTUAL property item pointer.
+ */
+#define GUIDER_PULSE_ACTUAL_ITEM							(GUIDER_PULSE_STATISTICS_PROPERTY->items+2)
+
+/** GUIDER_PULSE_STATISTICS.MEAN_ERROR property item pointer.
+ */
+#define GUIDER_PULSE_MEAN_ERROR_ITEM					(GUIDER_PULSE_STATISTICS_PROPERTY->items+3)
+
+/** GUIDER_PULSE_STATISTICS.MAX_ERROR property item pointer.
+ */
+#define GUIDER_PULSE_MAX_ERROR_ITEM						(GUIDER_PULSE_STATISTICS_PROPERTY->items+4)
+
+/** GUIDER_PULSE_STATISTICS.ERROR_0_1MS property item pointer (first item of error histogram).
+ */
+#define GUIDER_PULSE_HISTOGRAM_ITEM						(GUIDER_PULSE_STATISTICS_PROPERTY->items+5)
+
+/** Number of error histogram items.
+ */
+#define GUIDER_PULSE_HISTOGRAM_SIZE						6
+
 
 	
 /** Guider device context structure.
@@ -86,6 +118,11 @@ typedef struct {
 	indigo_property *guider_guide_dec_property;   ///< GUIDER_GUIDE_DEC property pointer
 	indigo_property *guider_guide_ra_property;    ///< GUIDER_GUIDE_RA property pointer
 	indigo_property *guider_rate_property;  			///< GUIDER_RATE property pointer
+	indigo_property *guider_pulse_statistics_property;	///< GUIDER_PULSE_STATISTICS property pointer
+	double guider_pulse_error_sum;								///< sum of pulse errors for GUIDER_PULSE_STATISTICS.MEAN_ERROR
+	pthread_mutex_t guider_pulse_mutex;						///< guards pulse measurements recorded by the pulse timer thread
+	double guider_pulse_values[5 + GUIDER_PULSE_HISTOGRAM_SIZE];	///< recorded GUIDER_PULSE_STATISTICS item values, published by a regular timer
+	bool guider_pulse_publish_pending;						///< publishing timer is already scheduled
 } indigo_guider_context;
 
 /** Attach callback function.
@@ -101,6 +138,11 @@ extern indigo_result indigo_guider_change_property(indigo_device *device, indigo
  */
 extern indigo_result indigo_guider_detach(indigo_device *device);
 
+/** Set timer ending guide pulse of given duration (in ms) on high resolution pulse scheduler and record its accuracy in GUIDER_PULSE_STATISTICS property.
+ Callback runs on the pulse scheduler thread, it should just stop the pulse and leave GUIDER_GUIDE_* update to a regular timer.
+ */
+extern indigo_timer *indigo_guider_set_pulse_timer(indigo_device *device, double duration, indigo_timer_callback callback);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,7 +24,16 @@
 
 #include <stdio.h>
 
-typedef enum { none = 0, centroid, donuts } indigo_guide_algorithm;
+typedef enum { none = 0, centroid, donuts, multistar } indigo_guide_algorithm;
+
+#define INDIGO_MAX_GUIDE_STARS	24
+
+typedef struct {
+	double x;
+	double y;
+	double flux;
+	double snr;
+} indigo_star_detection;
 
 typedef struct {
 	indigo_guide_algorithm algorithm;
@@ -33,10 +42,12 @@ typedef struct {
 	union {
 		double (*fft_x)[2];
 		double centroid_x;
+		indigo_star_detection *stars;
 	};
 	union {
 		double (*fft_y)[2];
 		double centroid_y;
+		int star_count;
 	};
 	double snr;
 } indigo_frame_digest;
@@ -46,6 +57,8 @@ extern indigo_result indigo_selection_psf(indigo_raw_type raw_type, const void *
 extern indigo_result indigo_selection_frame_digest(indigo_raw_type raw_type, const void *data, double *x, double *y, const int radius, const int width, const int height, indigo_frame_digest *c);
 extern indigo_result indigo_centroid_frame_digest(indigo_raw_type raw_type, const void *data, const int width, const int height, indigo_frame_digest *c);
 extern indigo_result indigo_donuts_frame_digest(indigo_raw_type raw_type, const void *data, const int width, const int height, indigo_frame_digest *fdigest);
+extern indigo_result indigo_find_stars(indigo_raw_type raw_type, const void *data, const int width, const int height, const int max_stars, indigo_star_detection star_list[], int *stars_found);
+extern indigo_result indigo_multistar_frame_digest(indigo_raw_type raw_type, const void *data, const int width, const int height, const int max_stars, indigo_frame_digest *c);
 extern indigo_result indigo_calculate_drift(const indigo_frame_digest *ref, const indigo_frame_digest *new, double *drift_x, double *drift_y);
 extern indigo_result indigo_delete_frame_digest(indigo_frame_digest *fdigest);
 
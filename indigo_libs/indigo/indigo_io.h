@@ -55,16 +55,35 @@ extern int indigo_open_tcp(const char *host, int port);
  */
 extern int indigo_open_udp(const char *host, int port);
 
+/** Attach read-ahead buffer to the handle (timeout in microseconds, 0 = wait forever).
+ Once attached, indigo_read(), indigo_recv(), indigo_read_line() and indigo_scanf() are served from the buffer,
+ so the handle must not be read directly until the buffer is detached. Detach it before the handle is closed.
+ Calling it for a handle with attached buffer changes the timeout only, buffered data are kept.
+ */
+extern bool indigo_enable_read_buffer(int handle, long timeout);
+
+/** Detach read-ahead buffer from the handle, unread data are lost.
+ */
+extern void indigo_disable_read_buffer(int handle);
+
+/** Drop data waiting in read-ahead buffer (e.g. together with tcflush()).
+ */
+extern void indigo_discard_read_buffer(int handle);
+
+/** Peek next character from buffered handle without consuming it, unbuffered socket is peeked with recv(MSG_PEEK).
+ */
+extern int indigo_peek(int handle, char *c);
+
 /** Read buffer.
  */
 extern int indigo_read(int handle, char *buffer, long length);
 
-#if defined(INDIGO_WINDOWS)
-/** Read buffer from socket.
+/** Read available data (at most length bytes).
  */
 extern int indigo_recv(int handle, char *buffer, long length);
 
-/** Read buffer from socket.
+#if defined(INDIGO_WINDOWS)
+/** Close socket.
  */
 extern int indigo_close(int handle);
 #endif
@@ -82,6 +101,30 @@ extern bool indigo_write(int handle, const char *buffer, long length);
 
 extern bool indigo_printf(int handle, const char *format, ...);
 
+/** Output buffer type (opaque), protocol adapters assemble whole messages in it.
+ */
+typedef struct indigo_output_buffer indigo_output_buffer;
+
+/** Create growable output buffer for handle.
+ */
+extern indigo_output_buffer *indigo_output_create(int handle);
+
+/** Append data to output buffer, large blocks are not copied but sent together with the buffered content by one writev().
+ */
+extern bool indigo_output_write(indigo_output_buffer *buffer, const char *data, long length);
+
+/** Append formatted text to output buffer.
+ */
+extern bool indigo_output_printf(indigo_output_buffer *buffer, const char *format, ...);
+
+/** Send buffered content.
+ */
+extern bool indigo_output_flush(indigo_output_buffer *buffer);
+
+/** Release output buffer, content not flushed yet is dropped.
+ */
+extern void indigo_output_release(indigo_output_buffer *buffer);
+
 /** Read formatted.
  */
 
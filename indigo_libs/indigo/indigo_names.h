@@ -305,6 +305,53 @@
  */
 #define CCD_LOCAL_MODE_PREFIX_ITEM_NAME       "PREFIX"
 
+//----------------------------------------------------------------------
+/** CCD_LOCAL_SYNC property name.
+ */
+#define CCD_LOCAL_SYNC_PROPERTY_NAME          "CCD_LOCAL_SYNC"
+
+/** CCD_LOCAL_SYNC.NONE property item name.
+ */
+#define CCD_LOCAL_SYNC_NONE_ITEM_NAME         "NONE"
+
+/** CCD_LOCAL_SYNC.FRAME property item name.
+ */
+#define CCD_LOCAL_SYNC_FRAME_ITEM_NAME        "FRAME"
+
+/** CCD_LOCAL_SYNC.IDLE property item name.
+ */
+#define CCD_LOCAL_SYNC_IDLE_ITEM_NAME         "IDLE"
+
+//----------------------------------------------------------------------
+/** CCD_LOCAL_DIRECT property name.
+ */
+#define CCD_LOCAL_DIRECT_PROPERTY_NAME        "CCD_LOCAL_DIRECT"
+
+/** CCD_LOCAL_DIRECT.ENABLED property item name.
+ */
+#define CCD_LOCAL_DIRECT_ENABLED_ITEM_NAME    "ENABLED"
+
+/** CCD_LOCAL_DIRECT.DISABLED property item name.
+ */
+#define CCD_LOCAL_DIRECT_DISABLED_ITEM_NAME   "DISABLED"
+
+//----------------------------------------------------------------------
+/** CCD_LOCAL_QUEUE property name.
+ */
+#define CCD_LOCAL_QUEUE_PROPERTY_NAME         "CCD_LOCAL_QUEUE"
+
+/** CCD_LOCAL_QUEUE.QUEUED property item name.
+ */
+#define CCD_LOCAL_QUEUE_QUEUED_ITEM_NAME      "QUEUED"
+
+/** CCD_LOCAL_QUEUE.WRITTEN property item name.
+ */
+#define CCD_LOCAL_QUEUE_WRITTEN_ITEM_NAME     "WRITTEN"
+
+/** CCD_LOCAL_QUEUE.THROUGHPUT property item name.
+ */
+#define CCD_LOCAL_QUEUE_THROUGHPUT_ITEM_NAME  "THROUGHPUT"
+
 //----------------------------------------------------------------------
 /** CCD_EXPOSURE property name.
  */
@@ -375,6 +422,40 @@
  */
 #define CCD_BIN_VERTICAL_ITEM_NAME            "VERTICAL"
 
+//----------------------------------------------------------------------
+/** CCD_SOFTWARE_FRAME property name.
+ */
+#define CCD_SOFTWARE_FRAME_PROPERTY_NAME      "CCD_SOFTWARE_FRAME"
+
+/** CCD_SOFTWARE_FRAME.LEFT property item name.
+ */
+#define CCD_SOFTWARE_FRAME_LEFT_ITEM_NAME     "LEFT"
+
+/** CCD_SOFTWARE_FRAME.TOP property item name.
+ */
+#define CCD_SOFTWARE_FRAME_TOP_ITEM_NAME      "TOP"
+
+/** CCD_SOFTWARE_FRAME.WIDTH property item name.
+ */
+#define CCD_SOFTWARE_FRAME_WIDTH_ITEM_NAME    "WIDTH"
+
+/** CCD_SOFTWARE_FRAME.HEIGHT property item name.
+ */
+#define CCD_SOFTWARE_FRAME_HEIGHT_ITEM_NAME   "HEIGHT"
+
+//----------------------------------------------------------------------
+/** CCD_SOFTWARE_BIN property name.
+ */
+#define CCD_SOFTWARE_BIN_PROPERTY_NAME        "CCD_SOFTWARE_BIN"
+
+/** CCD_SOFTWARE_BIN.HORIZONTAL property item name.
+ */
+#define CCD_SOFTWARE_BIN_HORIZONTAL_ITEM_NAME "HORIZONTAL"
+
+/** CCD_SOFTWARE_BIN.VERTICAL property item name.
+ */
+#define CCD_SOFTWARE_BIN_VERTICAL_ITEM_NAME   "VERTICAL"
+
 //----------------------------------------------------------------------
 /** CCD_MODE property name.
  */
@@ -462,6 +543,14 @@
  */
 #define CCD_IMAGE_FORMAT_JPEG_ITEM_NAME       "JPEG"
 
+/** CCD_IMAGE_FORMAT.FITS_RICE property item name.
+ */
+#define CCD_IMAGE_FORMAT_FITS_RICE_ITEM_NAME  "FITS_RICE"
+
+/** CCD_IMAGE_FORMAT.XISF_LZ4 property item name.
+ */
+#define CCD_IMAGE_FORMAT_XISF_LZ4_ITEM_NAME   "XISF_LZ4"
+
 //----------------------------------------------------------------------
 /** CCD_IMAGE_FILE property name.
  */
@@ -545,6 +634,10 @@
  */
 #define CCD_JPEG_SETTINGS_WHITE_TRESHOLD_ITEM_NAME			"WHITE_TRESHOLD"
 
+/** CCD_JPEG_SETTINGS.PREVIEW_SCALE property item name.
+ */
+#define CCD_JPEG_SETTINGS_PREVIEW_SCALE_ITEM_NAME			"PREVIEW_SCALE"
+
 /** CCD_RBI_FLUSH_ENABLE property name.
  */
 #define CCD_RBI_FLUSH_PROPERTY_NAME          "CCD_RBI_FLUSH_ENABLE"
@@ -810,6 +903,55 @@
 #define GUIDER_RATE_ITEM_NAME           			"RATE"
 #define GUIDER_DEC_RATE_ITEM_NAME           	"DEC_RATE"
 
+//----------------------------------------------------------------------
+/** GUIDER_PULSE_STATISTICS property name.
+ */
+#define GUIDER_PULSE_STATISTICS_PROPERTY_NAME	"GUIDER_PULSE_STATISTICS"
+
+/** GUIDER_PULSE_STATISTICS.COUNT property item name.
+ */
+#define GUIDER_PULSE_COUNT_ITEM_NAME					"COUNT"
+
+/** GUIDER_PULSE_STATISTICS.REQUESTED property item name.
+ */
+#define GUIDER_PULSE_REQUESTED_ITEM_NAME			"REQUESTED"
+
+/** GUIDER_PULSE_STATISTICS.ACTUAL property item name.
+ */
+#define GUIDER_PULSE_ACTUAL_ITEM_NAME					"ACTUAL"
+
+/** GUIDER_PULSE_STATISTICS.MEAN_ERROR property item name.
+ */
+#define GUIDER_PULSE_MEAN_ERROR_ITEM_NAME			"MEAN_ERROR"
+
+/** GUIDER_PULSE_STATISTICS.MAX_ERROR property item name.
+ */
+#define GUIDER_PULSE_MAX_ERROR_ITEM_NAME			"MAX_ERROR"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_0_1MS property item name.
+ */
+#define GUIDER_PULSE_ERROR_0_1MS_ITEM_NAME		"ERROR_0_1MS"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_0_5MS property item name.
+ */
+#define GUIDER_PULSE_ERROR_0_5MS_ITEM_NAME		"ERROR_0_5MS"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_1MS property item name.
+ */
+#define GUIDER_PULSE_ERROR_1MS_ITEM_NAME			"ERROR_1MS"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_5MS property item name.
+ */
+#define GUIDER_PULSE_ERROR_5MS_ITEM_NAME			"ERROR_5MS"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_10MS property item name.
+ */
+#define GUIDER_PULSE_ERROR_10MS_ITEM_NAME			"ERROR_10MS"
+
+/** GUIDER_PULSE_STATISTICS.ERROR_MORE property item name.
+ */
+#define GUIDER_PULSE_ERROR_MORE_ITEM_NAME			"ERROR_MORE"
+
 //----------------------------------------------------------------------
 /** AO_GUIDE_DEC property name
  */
@@ -2063,6 +2205,7 @@
 #define AGENT_GUIDER_DETECTION_DONUTS_ITEM_NAME  			"DONUTS"
 #define AGENT_GUIDER_DETECTION_CENTROID_ITEM_NAME    	"CENTROID"
 #define AGENT_GUIDER_DETECTION_SELECTION_ITEM_NAME    "SELECTION"
+#define AGENT_GUIDER_DETECTION_MULTISTAR_ITEM_NAME    "MULTISTAR"
 
 #define AGENT_GUIDER_DEC_MODE_PROPERTY_NAME						"AGENT_GUIDER_DEC_MODE"
 #define AGENT_GUIDER_DEC_MODE_BOTH_ITEM_NAME    			"BOTH"
@@ -2090,6 +2233,7 @@
 #define AGENT_GUIDER_SETTINGS_DITH_X_ITEM_NAME				"DITHERING_X"
 #define AGENT_GUIDER_SETTINGS_DITH_Y_ITEM_NAME				"DITHERING_Y"
 #define AGENT_GUIDER_SETTINGS_STACK_ITEM_NAME					"STACK"
+#define AGENT_GUIDER_SETTINGS_STARS_ITEM_NAME					"STARS"
 
 #define AGENT_GUIDER_SELECTION_PROPERTY_NAME					"AGENT_GUIDER_SELECTION"
 #define AGENT_GUIDER_SELECTION_X_ITEM_NAME						"X"
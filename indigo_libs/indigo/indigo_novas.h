@@ -28,6 +28,9 @@
 
 #include <time.h>
 #include <stdio.h>
+#include <stdbool.h>
+
+#include <indigo/indigo_catalog.h>
 
 #define UT2JD(t) ((t) / 86400.0 + 2440587.5 + DELTA_UTC_UT1)
 #define JD UT2JD(time(NULL))
@@ -36,9 +39,28 @@
 extern double DELTA_T;
 extern double DELTA_UTC_UT1;
 
+/** Epoch dependent terms of apparent place transformation shared by all stars.
+ */
+typedef struct {
+	double jd_tdb;									///< TDB Julian date
+	double earth_pos[3];						///< barycentric position of Earth [AU] (ICRS)
+	double earth_vel[3];						///< barycentric velocity of Earth [AU/day] (ICRS)
+	double sun_pos[3];							///< barycentric position of Sun [AU] (ICRS)
+	double matrix[3][3];						///< frame tie, precession and nutation (ICRS to true equator and equinox of date)
+	bool ephemeris;									///< JPL ephemeris was used (otherwise low precision analytic Earth position)
+} indigo_app_star_epoch;
+
 extern double indigo_lst(time_t *utc, double longitude);
 extern void indigo_eq2hor(time_t *utc, double latitude, double longitude, double elevation, double ra, double dec, double *alt, double *az);
 extern void indigo_app_star(double promora, double promodec, double parallax, double rv, double *ra, double *dec);
+/** Compute epoch dependent terms for given UTC time (NULL for current time).
+ */
+extern void indigo_app_star_epoch_init(time_t *utc, indigo_app_star_epoch *epoch);
+
+/** Apparent place (true equator and equinox of date) of count catalog entries (J2000, ra [h], dec [deg], proper motion [mas/yr], parallax [mas], radial velocity [km/s]) stored to ra [h] and dec [deg] arrays.
+ */
+extern void indigo_app_star_batch(const indigo_app_star_epoch *epoch, const indigo_catalog_entry *entries, int count, double *ra, double *dec);
+
 extern void indigo_topo_star(double latitude, double longitude, double elevation, double promora, double promodec, double parallax, double rv, double *ra, double *dec);
 extern void indigo_topo_planet(double latitude, double longitude, double elevation, int id, double *ra, double *dec);
 
@@ -44,6 +44,10 @@ extern int indigo_server_tcp_port;
  */
 extern bool indigo_is_ephemeral_port;
 
+/** Serve connections from epoll event loop with small worker pool instead of thread per connection (Linux only).
+ */
+extern bool indigo_server_tcp_reactor;
+
 /** Add static document.
  */
 extern void indigo_server_add_resource(const char *path, unsigned char *data, unsigned length, const char *content_type);
@@ -27,6 +27,7 @@
 #define indigo_timer_h
 
 #include <stdio.h>
+#include <stdint.h>
 #include <pthread.h>
 
 #include <indigo/indigo_bus.h>
@@ -35,24 +36,40 @@
 extern "C" {
 #endif
 
+/** Running callback of the device doesn't block other callbacks of the same device after this time (in seconds).
+ */
+#define INDIGO_TIMER_HANDOFF	1.0
+
+/** Pulse timers sleep until this time (in seconds) before the deadline and busy-wait for the rest.
+ */
+#define INDIGO_PULSE_SPIN			0.0005
+
 /** Timer callback function prototype.
  */
 typedef void (*indigo_timer_callback)(indigo_device *device);
 
+/** Pulse measurement callback function prototype (requested and actual pulse duration in seconds).
+ */
+typedef void (*indigo_pulse_callback)(indigo_device *device, double requested, double actual);
+
 /** Timer structure.
  */
 typedef struct indigo_timer {
 	indigo_device *device;                    ///< device associated with timer
 	indigo_timer_callback callback;           ///< callback function pointer
-	bool canceled;                            ///< timer is canceled (darwin only)
-	bool scheduled;
-	double delay;
-	bool wake;
-	int timer_id;
-	pthread_cond_t cond;
-	pthread_mutex_t mutex;
-	pthread_t thread;
-	struct indigo_timer *next;
+	bool canceled;                            ///< timer is canceled
+	bool scheduled;                           ///< timer is rescheduled from its callback
+	double delay;                             ///< delay of the next callback
+	int timer_id;                             ///< timer id (for debugging)
+	int state;                                ///< timer state (free, pending, due, ready, pulse or running)
+	bool pulse;                               ///< timer is served by pulse scheduler
+	indigo_pulse_callback measured;           ///< pulse measurement callback
+	void *owner;                              ///< device callbacks are serialized for
+	uint64_t expires;                         ///< expiration tick
+	uint64_t deadline;                        ///< expiration time (or time when the timer became ready) in ns
+	struct indigo_timer *wheel_next;          ///< next timer in wheel slot, ready or free list
+	struct indigo_timer **wheel_previous;     ///< pointer to this timer in wheel slot or ready list
+	struct indigo_timer *next;                ///< next timer of the same device
 } indigo_timer;
 
 /* fix timespec so that abs(tv_nsec) < 1s */
@@ -80,10 +97,27 @@ static inline void normalize_timespec(struct timespec *ts) {
 }
 
 /** Set timer.
+ Timers are kept in a hierarchical timer wheel with 1ms resolution and callbacks are executed by a small pool of worker threads.
+ Callbacks for one device are never executed concurrently, unless the running one takes longer than INDIGO_TIMER_HANDOFF seconds
+ (e.g. long running agent process), then other callbacks of the device are not blocked by it any more.
  */
 extern indigo_timer *indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback callback);
 
-/** Rescheduled timer (if not null).
+/** Use SCHED_FIFO scheduling policy for pulse scheduler thread (if permitted).
+ */
+extern bool indigo_use_realtime_pulses;
+
+/** Set timer ending a pulse (e.g. guide pulse) on high resolution pulse scheduler.
+ Pulse timers use monotonic clock and a dedicated thread (with SCHED_FIFO policy if permitted) which busy-waits for the last
+ INDIGO_PULSE_SPIN seconds. Callback should just end the pulse, it is not serialized with other callbacks of the device and
+ property updates it implies should be done by a regular timer (e.g. indigo_set_timer(device, 0, ...)).
+ If measured is not NULL, it is called after the callback with requested and actual duration of the pulse, it runs on the pulse
+ thread as well, so it should only record the measurement and leave bus updates to a regular timer.
+ Timer can be rescheduled and canceled as any other timer.
+ */
+extern indigo_timer *indigo_set_pulse_timer(indigo_device *device, double duration, indigo_timer_callback callback, indigo_pulse_callback measured);
+
+/** Rescheduled timer (if not null), if called from the timer callback the callback is executed again after the delay.
  */
 extern bool indigo_reschedule_timer(indigo_device *device, double delay, indigo_timer **timer);
 
@@ -38,6 +38,27 @@ extern "C" {
 
 extern bool indigo_use_blob_urls;
 
+/** Tokenize complete elements with memchr and replay them to the parser handlers instead of walking them byte by byte.
+ */
+
+extern bool indigo_use_fast_xml_parser;
+
+/** XML wire protocol parser state.
+ */
+typedef struct indigo_xml_parser indigo_xml_parser;
+
+/** Create XML wire protocol parser state for incremental parsing (enumerates device properties if device is set).
+ */
+extern indigo_xml_parser *indigo_xml_parser_create(indigo_device *device, indigo_client *client);
+
+/** Parse next chunk of input, returns false on syntax error.
+ */
+extern bool indigo_xml_parser_feed(indigo_xml_parser *parser, char *data, long length);
+
+/** Release XML wire protocol parser state.
+ */
+extern void indigo_xml_parser_release(indigo_xml_parser *parser);
+
 /** XML wire protocol parser.
  */
 extern void indigo_xml_parse(indigo_device *device, indigo_client *client);
@@ -24,11 +24,9 @@
 #include <indigo/indigo_base64.h>
 #include <indigo/indigo_base64_luts.h>
 #include <stdio.h>
+#include <stdbool.h>
 
-/* out size should be at least 4*inlen/3 + 4.
- * returns length of out (without trailing NULL).
- */
-long base64_encode(unsigned char *out, const unsigned char *in, long inlen) {
+static long base64_encode_lut(unsigned char *out, const unsigned char *in, long inlen) {
 	uint16_t* b64lut = (uint16_t*)base64lut;
 	long dlen = ((inlen+2)/3)*4; /* 4/3, rounded up */
 	uint16_t* wbuf = (uint16_t*)out;
@@ -58,8 +56,7 @@ long base64_encode(unsigned char *out, const unsigned char *in, long inlen) {
 }
 
 
-/* base64 should not contain whitespaces.*/
-long base64_decode_fast(unsigned char* out, const unsigned char* in, long inlen) {
+static long base64_decode_fast_lut(unsigned char* out, const unsigned char* in, long inlen) {
 	long outlen = 0;
 	uint8_t b1, b2, b3;
 	uint16_t s1, s2;
@@ -118,6 +115,291 @@ long base64_decode_fast(unsigned char* out, const unsigned char* in, long inlen)
 }
 
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+#define BASE64_X86
+#include <immintrin.h>
+
+/* SSE4.1/AVX2 kernels translate 16/32 characters at once, the algorithm is described by Wojciech Mula and Daniel Lemire
+ * in "Faster Base64 Encoding and Decoding using AVX2 Instructions" (ACM Transactions on the Web, 2018).
+ */
+
+__attribute__((target("sse4.1"))) static inline __m128i enc_reshuffle_sse(__m128i in) {
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	__m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+	__m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	__m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+	__m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i enc_translate_sse(__m128i in) {
+	const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+	__m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+	indices = _mm_sub_epi8(indices, _mm_cmpgt_epi8(in, _mm_set1_epi8(25)));
+	return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
+}
+
+__attribute__((target("sse4.1"))) static long base64_encode_sse41(unsigned char *out, const unsigned char *in, long inlen) {
+	long dlen = ((inlen + 2) / 3) * 4;
+	while (inlen >= 16) {
+		__m128i str = _mm_loadu_si128((const __m128i *)in);
+		_mm_storeu_si128((__m128i *)out, enc_translate_sse(enc_reshuffle_sse(str)));
+		in += 12;
+		inlen -= 12;
+		out += 16;
+	}
+	base64_encode_lut(out, in, inlen);
+	return dlen;
+}
+
+/* returns zero if block contains character outside of base64 alphabet (including padding) */
+__attribute__((target("sse4.1"))) static inline int dec_translate_sse(__m128i *str) {
+	const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask_2F = _mm_set1_epi8(0x2F);
+	__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(*str, 4), mask_2F);
+	__m128i lo_nibbles = _mm_and_si128(*str, mask_2F);
+	__m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+	__m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+	if (!_mm_testz_si128(lo, hi))
+		return 0;
+	__m128i eq_2F = _mm_cmpeq_epi8(*str, mask_2F);
+	__m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2F, hi_nibbles));
+	*str = _mm_add_epi8(*str, roll);
+	return 1;
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i dec_reshuffle_sse(__m128i in) {
+	__m128i merge_ab_and_bc = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+	__m128i out = _mm_madd_epi16(merge_ab_and_bc, _mm_set1_epi32(0x00011000));
+	return _mm_shuffle_epi8(out, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("sse4.1"))) static long base64_decode_fast_sse41(unsigned char *out, const unsigned char *in, long inlen) {
+	long outlen = 0;
+	/* 16 bytes are stored for every 12 decoded, keep at least two more quadruples for the scalar tail to overwrite them */
+	while (inlen >= 24) {
+		__m128i str = _mm_loadu_si128((const __m128i *)in);
+		if (!dec_translate_sse(&str))
+			break;
+		_mm_storeu_si128((__m128i *)out, dec_reshuffle_sse(str));
+		in += 16;
+		inlen -= 16;
+		out += 12;
+		outlen += 12;
+	}
+	return outlen + base64_decode_fast_lut(out, in, inlen);
+}
+
+__attribute__((target("avx2"))) static long base64_encode_avx2(unsigned char *out, const unsigned char *in, long inlen) {
+	long dlen = ((inlen + 2) / 3) * 4;
+	const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	const __m256i lut = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0, 65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+	while (inlen >= 28) {
+		__m256i str = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)in)), _mm_loadu_si128((const __m128i *)(in + 12)), 1);
+		str = _mm256_shuffle_epi8(str, shuffle);
+		__m256i t0 = _mm256_and_si256(str, _mm256_set1_epi32(0x0FC0FC00));
+		__m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		__m256i t2 = _mm256_and_si256(str, _mm256_set1_epi32(0x003F03F0));
+		__m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+		str = _mm256_or_si256(t1, t3);
+		__m256i indices = _mm256_subs_epu8(str, _mm256_set1_epi8(51));
+		indices = _mm256_sub_epi8(indices, _mm256_cmpgt_epi8(str, _mm256_set1_epi8(25)));
+		str = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut, indices));
+		_mm256_storeu_si256((__m256i *)out, str);
+		in += 24;
+		inlen -= 24;
+		out += 32;
+	}
+	base64_encode_sse41(out, in, inlen);
+	return dlen;
+}
+
+__attribute__((target("avx2"))) static long base64_decode_fast_avx2(unsigned char *out, const unsigned char *in, long inlen) {
+	long outlen = 0;
+	const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i mask_2F = _mm256_set1_epi8(0x2F);
+	const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	/* 32 bytes are stored for every 24 decoded, keep at least four more quadruples for the tail to overwrite them */
+	while (inlen >= 48) {
+		__m256i str = _mm256_loadu_si256((const __m256i *)in);
+		__m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2F);
+		__m256i lo_nibbles = _mm256_and_si256(str, mask_2F);
+		__m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+		__m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+		if (!_mm256_testz_si256(lo, hi))
+			break;
+		__m256i eq_2F = _mm256_cmpeq_epi8(str, mask_2F);
+		str = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2F, hi_nibbles)));
+		str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+		str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+		str = _mm256_shuffle_epi8(str, shuffle);
+		str = _mm256_permutevar8x32_epi32(str, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		_mm256_storeu_si256((__m256i *)out, str);
+		in += 32;
+		inlen -= 32;
+		out += 24;
+		outlen += 24;
+	}
+	return outlen + base64_decode_fast_sse41(out, in, inlen);
+}
+
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+
+#define BASE64_NEON
+#include <arm_neon.h>
+
+/* ASCII -> 6 bit value, 0xFF for characters outside of base64 alphabet */
+static const uint8_t base64_neon_dlut[128] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 62, 0xFF, 0xFF, 0xFF, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static long base64_encode_neon(unsigned char *out, const unsigned char *in, long inlen) {
+	long dlen = ((inlen + 2) / 3) * 4;
+	uint8x16x4_t lut = { { vld1q_u8((const uint8_t *)base64digits), vld1q_u8((const uint8_t *)base64digits + 16), vld1q_u8((const uint8_t *)base64digits + 32), vld1q_u8((const uint8_t *)base64digits + 48) } };
+	const uint8x16_t mask = vdupq_n_u8(0x3F);
+	while (inlen >= 48) {
+		uint8x16x3_t src = vld3q_u8(in);
+		uint8x16x4_t dst;
+		dst.val[0] = vshrq_n_u8(src.val[0], 2);
+		dst.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(src.val[1], 4), vshlq_n_u8(src.val[0], 4)), mask);
+		dst.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(src.val[2], 6), vshlq_n_u8(src.val[1], 2)), mask);
+		dst.val[3] = vandq_u8(src.val[2], mask);
+		for (int i = 0; i < 4; i++)
+			dst.val[i] = vqtbl4q_u8(lut, dst.val[i]);
+		vst4q_u8(out, dst);
+		in += 48;
+		inlen -= 48;
+		out += 64;
+	}
+	base64_encode_lut(out, in, inlen);
+	return dlen;
+}
+
+static long base64_decode_fast_neon(unsigned char *out, const unsigned char *in, long inlen) {
+	long outlen = 0;
+	uint8x16x4_t lut_lo = { { vld1q_u8(base64_neon_dlut), vld1q_u8(base64_neon_dlut + 16), vld1q_u8(base64_neon_dlut + 32), vld1q_u8(base64_neon_dlut + 48) } };
+	uint8x16x4_t lut_hi = { { vld1q_u8(base64_neon_dlut + 64), vld1q_u8(base64_neon_dlut + 80), vld1q_u8(base64_neon_dlut + 96), vld1q_u8(base64_neon_dlut + 112) } };
+	const uint8x16_t offset = vdupq_n_u8(64);
+	/* the last quadruple (possibly with padding) is always left for the scalar tail */
+	while (inlen >= 68) {
+		uint8x16x4_t str = vld4q_u8(in);
+		uint8x16_t error = vdupq_n_u8(0);
+		for (int i = 0; i < 4; i++) {
+			uint8x16_t c = str.val[i];
+			uint8x16_t value = vqtbx4q_u8(vqtbl4q_u8(lut_lo, c), lut_hi, vsubq_u8(c, offset));
+			error = vorrq_u8(error, vorrq_u8(vcgeq_u8(c, vdupq_n_u8(0x80)), vcgeq_u8(value, offset)));
+			str.val[i] = value;
+		}
+		if (vmaxvq_u8(error))
+			break;
+		uint8x16x3_t dst;
+		dst.val[0] = vorrq_u8(vshlq_n_u8(str.val[0], 2), vshrq_n_u8(str.val[1], 4));
+		dst.val[1] = vorrq_u8(vshlq_n_u8(str.val[1], 4), vshrq_n_u8(str.val[2], 2));
+		dst.val[2] = vorrq_u8(vshlq_n_u8(str.val[2], 6), str.val[3]);
+		vst3q_u8(out, dst);
+		in += 64;
+		inlen -= 64;
+		out += 48;
+		outlen += 48;
+	}
+	return outlen + base64_decode_fast_lut(out, in, inlen);
+}
+
+#endif
+
+static long (*encode_impl)(unsigned char *out, const unsigned char *in, long inlen) = NULL;
+static long (*decode_impl)(unsigned char *out, const unsigned char *in, long inlen) = NULL;
+
+bool base64_supports_impl(base64_impl impl) {
+	switch (impl) {
+		case BASE64_LUT:
+			return true;
+#ifdef BASE64_X86
+		case BASE64_SSE41:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse4.1");
+		case BASE64_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+#ifdef BASE64_NEON
+		case BASE64_NEON:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+bool base64_select_impl(base64_impl impl) {
+	if (!base64_supports_impl(impl))
+		return false;
+	switch (impl) {
+#ifdef BASE64_X86
+		case BASE64_SSE41:
+			encode_impl = base64_encode_sse41;
+			decode_impl = base64_decode_fast_sse41;
+			break;
+		case BASE64_AVX2:
+			encode_impl = base64_encode_avx2;
+			decode_impl = base64_decode_fast_avx2;
+			break;
+#endif
+#ifdef BASE64_NEON
+		case BASE64_NEON:
+			encode_impl = base64_encode_neon;
+			decode_impl = base64_decode_fast_neon;
+			break;
+#endif
+		default:
+			encode_impl = base64_encode_lut;
+			decode_impl = base64_decode_fast_lut;
+			break;
+	}
+	return true;
+}
+
+const char *base64_impl_name(base64_impl impl) {
+	static const char *names[] = { "LUT", "SSE4.1", "AVX2", "NEON" };
+	return impl >= BASE64_LUT && impl <= BASE64_NEON ? names[impl] : "?";
+}
+
+static void select_best_impl() {
+	if (!base64_select_impl(BASE64_AVX2) && !base64_select_impl(BASE64_SSE41) && !base64_select_impl(BASE64_NEON))
+		base64_select_impl(BASE64_LUT);
+}
+
+/* out size should be at least 4*inlen/3 + 4.
+ * returns length of out (without trailing NULL).
+ */
+long base64_encode(unsigned char *out, const unsigned char *in, long inlen) {
+	if (encode_impl == NULL)
+		select_best_impl();
+	return encode_impl(out, in, inlen);
+}
+
+/* base64 should not contain whitespaces.*/
+long base64_decode_fast(unsigned char *out, const unsigned char *in, long inlen) {
+	if (decode_impl == NULL)
+		select_best_impl();
+	return decode_impl(out, in, inlen);
+}
+
+
 long base64_decode_fast_nl(unsigned char* out, const unsigned char* in, long inlen) {
 	long outlen = 0;
 	uint8_t b1, b2, b3;
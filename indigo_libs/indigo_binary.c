@@ -0,0 +1,873 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary wire protocol parser
+ \file indigo_binary.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+#include <unistd.h>
+#endif
+#if defined(INDIGO_WINDOWS)
+#include <io.h>
+#define close indigo_close
+#pragma warning(disable:4996)
+#endif
+
+#include <indigo/indigo_binary.h>
+#include <indigo/indigo_io.h>
+
+#define BUFFER_SIZE			65536
+#define FRAME_SIZE			4096
+
+#define PROPERTY_SIZE sizeof(indigo_property)+INDIGO_MAX_ITEMS*(sizeof(indigo_item))
+#define MAX_SERVER_FRAME_SIZE	(INDIGO_BINARY_MAX_BLOB_SIZE + PROPERTY_SIZE)
+#define MAX_CLIENT_FRAME_SIZE	PROPERTY_SIZE
+
+typedef struct {
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	indigo_property_type type;
+	int count;
+	char (*items)[INDIGO_NAME_SIZE];	///< item names in definition order, item index is sent instead of name
+	indigo_property *property;				///< client side copy of remote property
+	uint32_t hash;
+} binary_entry;
+
+struct indigo_binary_context {
+	pthread_mutex_t mutex;
+	binary_entry **entries;		///< indexed by property id, id 0 is not used
+	uint32_t entry_count;
+	uint32_t next_id;
+	uint32_t *slots;					///< open addressing hash of device and property name to property id
+	uint32_t slot_count;
+	unsigned char *frame;
+	long frame_length;
+	long frame_size;
+};
+
+struct indigo_binary_parser {
+	indigo_device *device;
+	indigo_client *client;
+	indigo_binary_context *context;
+	int handle;
+	unsigned char preamble[INDIGO_BINARY_PREAMBLE_SIZE];
+	int preamble_length;
+	bool accepted;
+	unsigned char header[INDIGO_BINARY_HEADER_SIZE];
+	int header_length;
+	unsigned char *frame;
+	long frame_size;
+	long frame_length;
+	long frame_offset;
+	indigo_property *property;
+};
+
+static const unsigned char preamble[INDIGO_BINARY_PREAMBLE_SIZE] = { INDIGO_BINARY_MAGIC, 'I', 'B', INDIGO_BINARY_VERSION };
+
+// property ids
+
+static uint32_t name_hash(const char *device, const char *name) {
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < INDIGO_NAME_SIZE && device[i]; i++)
+		hash = (hash ^ (unsigned char)device[i]) * 16777619u;
+	hash *= 16777619u;
+	for (int i = 0; i < INDIGO_NAME_SIZE && name[i]; i++)
+		hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+	return hash;
+}
+
+static void insert_slot(indigo_binary_context *context, uint32_t hash, uint32_t id) {
+	uint32_t mask = context->slot_count - 1;
+	uint32_t i = hash & mask;
+	while (context->slots[i])
+		i = (i + 1) & mask;
+	context->slots[i] = id;
+}
+
+static void rebuild_slots(indigo_binary_context *context) {
+	uint32_t used = 0;
+	for (uint32_t id = 1; id < context->next_id; id++)
+		if (context->entries[id])
+			used++;
+	uint32_t count = 64;
+	while (count < 2 * used + 2)
+		count *= 2;
+	if (count != context->slot_count) {
+		free(context->slots);
+		context->slots = malloc(count * sizeof(uint32_t));
+		assert(context->slots != NULL);
+		context->slot_count = count;
+	}
+	memset(context->slots, 0, count * sizeof(uint32_t));
+	for (uint32_t id = 1; id < context->next_id; id++)
+		if (context->entries[id])
+			insert_slot(context, context->entries[id]->hash, id);
+}
+
+static binary_entry *set_entry(indigo_binary_context *context, uint32_t id, const char *device, const char *name) {
+	if (id == 0 || id > INDIGO_BINARY_MAX_ID)
+		return NULL;
+	if (id >= context->entry_count) {
+		size_t count = context->entry_count;
+		while (count <= id)
+			count *= 2;
+		binary_entry **entries = realloc(context->entries, count * sizeof(binary_entry *));
+		if (entries == NULL)
+			return NULL;
+		memset(entries + context->entry_count, 0, (count - context->entry_count) * sizeof(binary_entry *));
+		context->entries = entries;
+		context->entry_count = (uint32_t)count;
+	}
+	binary_entry *entry = context->entries[id];
+	if (entry == NULL) {
+		entry = context->entries[id] = malloc(sizeof(binary_entry));
+		assert(entry != NULL);
+		memset(entry, 0, sizeof(binary_entry));
+		strncpy(entry->device, device, INDIGO_NAME_SIZE - 1);
+		strncpy(entry->name, name, INDIGO_NAME_SIZE - 1);
+		entry->hash = name_hash(entry->device, entry->name);
+		if (id >= context->next_id)
+			context->next_id = id + 1;
+		if (2 * (context->next_id + 1) > context->slot_count)
+			rebuild_slots(context);
+		else
+			insert_slot(context, entry->hash, id);
+	}
+	return entry;
+}
+
+static void release_entry(binary_entry *entry) {
+	if (entry->property) {
+		if (entry->property->type == INDIGO_BLOB_VECTOR) {
+			for (int i = 0; i < entry->property->count; i++) {
+				if (entry->property->items[i].blob.value)
+					free(entry->property->items[i].blob.value);
+			}
+		}
+		indigo_release_property(entry->property);
+	}
+	free(entry->items);
+	free(entry);
+}
+
+indigo_binary_context *indigo_binary_context_create() {
+	indigo_binary_context *context = malloc(sizeof(indigo_binary_context));
+	assert(context != NULL);
+	memset(context, 0, sizeof(indigo_binary_context));
+	pthread_mutex_init(&context->mutex, NULL);
+	context->entry_count = 64;
+	context->entries = calloc(context->entry_count, sizeof(binary_entry *));
+	context->next_id = 1;
+	context->frame_size = FRAME_SIZE;
+	context->frame = malloc(context->frame_size);
+	assert(context->entries != NULL && context->frame != NULL);
+	rebuild_slots(context);
+	return context;
+}
+
+void indigo_binary_context_release(indigo_binary_context *context) {
+	for (uint32_t id = 1; id < context->next_id; id++) {
+		if (context->entries[id])
+			release_entry(context->entries[id]);
+	}
+	pthread_mutex_destroy(&context->mutex);
+	free(context->entries);
+	free(context->slots);
+	free(context->frame);
+	free(context);
+}
+
+void indigo_binary_lock(indigo_binary_context *context) {
+	pthread_mutex_lock(&context->mutex);
+}
+
+void indigo_binary_unlock(indigo_binary_context *context) {
+	pthread_mutex_unlock(&context->mutex);
+}
+
+uint32_t indigo_binary_find_id(indigo_binary_context *context, const char *device, const char *name) {
+	uint32_t hash = name_hash(device, name);
+	uint32_t mask = context->slot_count - 1;
+	for (uint32_t i = hash & mask; context->slots[i]; i = (i + 1) & mask) {
+		binary_entry *entry = context->entries[context->slots[i]];
+		if (entry->hash == hash && !strncmp(entry->device, device, INDIGO_NAME_SIZE) && !strncmp(entry->name, name, INDIGO_NAME_SIZE))
+			return context->slots[i];
+	}
+	return 0;
+}
+
+uint32_t indigo_binary_register(indigo_binary_context *context, indigo_property *property, bool *changed) {
+	uint32_t id = indigo_binary_find_id(context, property->device, property->name);
+	binary_entry *entry = id ? context->entries[id] : set_entry(context, id = context->next_id, property->device, property->name);
+	assert(entry != NULL);
+	bool same = entry->items != NULL && entry->type == property->type && entry->count == property->count;
+	for (int i = 0; same && i < property->count; i++)
+		same = !strncmp(entry->items[i], property->items[i].name, INDIGO_NAME_SIZE);
+	if (!same) {
+		entry->type = property->type;
+		entry->count = property->count;
+		entry->items = realloc(entry->items, (property->count + 1) * INDIGO_NAME_SIZE);
+		assert(entry->items != NULL);
+		for (int i = 0; i < property->count; i++)
+			strncpy(entry->items[i], property->items[i].name, INDIGO_NAME_SIZE);
+	}
+	*changed = !same;
+	return id;
+}
+
+void indigo_binary_forget(indigo_binary_context *context, const char *device, const char *name) {
+	bool found = false;
+	for (uint32_t id = 1; id < context->next_id; id++) {
+		binary_entry *entry = context->entries[id];
+		if (entry && !strncmp(entry->device, device, INDIGO_NAME_SIZE) && (*name == 0 || !strncmp(entry->name, name, INDIGO_NAME_SIZE))) {
+			release_entry(entry);
+			context->entries[id] = NULL;
+			found = true;
+		}
+	}
+	if (found)
+		rebuild_slots(context);
+}
+
+indigo_property *indigo_binary_property(indigo_binary_context *context, uint32_t id) {
+	if (id < context->next_id && context->entries[id])
+		return context->entries[id]->property;
+	return NULL;
+}
+
+// frame encoding, all values are little endian
+
+static unsigned char *frame_space(indigo_binary_context *context, long length) {
+	if (context->frame_length + length > context->frame_size) {
+		while (context->frame_length + length > context->frame_size)
+			context->frame_size *= 2;
+		context->frame = realloc(context->frame, context->frame_size);
+		assert(context->frame != NULL);
+	}
+	unsigned char *space = context->frame + context->frame_length;
+	context->frame_length += length;
+	return space;
+}
+
+static void put_le(unsigned char *space, uint64_t value, int length) {
+	for (int i = 0; i < length; i++, value >>= 8)
+		space[i] = (unsigned char)value;
+}
+
+void indigo_binary_begin(indigo_binary_context *context, indigo_binary_frame_type type) {
+	context->frame_length = 0;
+	unsigned char *space = frame_space(context, INDIGO_BINARY_HEADER_SIZE);
+	*space = (unsigned char)type;
+}
+
+void indigo_binary_put_u8(indigo_binary_context *context, uint8_t value) {
+	*frame_space(context, 1) = value;
+}
+
+void indigo_binary_put_u16(indigo_binary_context *context, uint16_t value) {
+	put_le(frame_space(context, 2), value, 2);
+}
+
+void indigo_binary_put_u32(indigo_binary_context *context, uint32_t value) {
+	put_le(frame_space(context, 4), value, 4);
+}
+
+void indigo_binary_put_u64(indigo_binary_context *context, uint64_t value) {
+	put_le(frame_space(context, 8), value, 8);
+}
+
+void indigo_binary_put_double(indigo_binary_context *context, double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	put_le(frame_space(context, 8), bits, 8);
+}
+
+void indigo_binary_put_string(indigo_binary_context *context, const char *value) {
+	long length = value ? strlen(value) : 0;
+	if (length > UINT16_MAX)
+		length = UINT16_MAX;
+	put_le(frame_space(context, 2), length, 2);
+	memcpy(frame_space(context, length), value, length);
+}
+
+long indigo_binary_length(indigo_binary_context *context) {
+	return context->frame_length;
+}
+
+void indigo_binary_patch_u16(indigo_binary_context *context, long offset, uint16_t value) {
+	put_le(context->frame + offset, value, 2);
+}
+
+void indigo_binary_end(indigo_binary_context *context, indigo_output_buffer *output, long payload_length) {
+	put_le(context->frame + 1, context->frame_length - INDIGO_BINARY_HEADER_SIZE + payload_length, 4);
+	indigo_output_write(output, (char *)context->frame, context->frame_length);
+}
+
+void indigo_binary_write_preamble(indigo_output_buffer *output) {
+	indigo_output_write(output, (const char *)preamble, INDIGO_BINARY_PREAMBLE_SIZE);
+}
+
+// frame decoding
+
+typedef struct {
+	unsigned char *pointer;
+	unsigned char *end;
+	bool error;
+} frame_reader;
+
+static uint64_t get_le(frame_reader *reader, int length) {
+	if (reader->end - reader->pointer < length) {
+		reader->error = true;
+		return 0;
+	}
+	uint64_t value = 0;
+	for (int i = length - 1; i >= 0; i--)
+		value = (value << 8) | reader->pointer[i];
+	reader->pointer += length;
+	return value;
+}
+
+static double get_double(frame_reader *reader) {
+	uint64_t bits = get_le(reader, 8);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void get_string(frame_reader *reader, char *buffer, long size) {
+	long length = (long)get_le(reader, 2);
+	if (reader->end - reader->pointer < length) {
+		reader->error = true;
+		length = 0;
+	}
+	long copy = length < size ? length : size - 1;
+	memcpy(buffer, reader->pointer, copy);
+	buffer[copy] = 0;
+	reader->pointer += length;
+}
+
+static void remote_device_name(indigo_binary_parser *parser, char *device_name, const char *device) {
+	if (indigo_use_host_suffix)
+		snprintf(device_name, INDIGO_NAME_SIZE, "%s %s", device, parser->device->name);
+	else
+		strncpy(device_name, device, INDIGO_NAME_SIZE);
+}
+
+// server side, frames received from client
+
+static void enable_blob(indigo_client *client, indigo_property *property, indigo_enable_blob_mode mode) {
+	indigo_enable_blob_mode_record *record = client->enable_blob_mode_records;
+	indigo_enable_blob_mode_record *prev = NULL;
+	while (record) {
+		if (!strcmp(property->device, record->device) && (*record->name == 0 || !strcmp(property->name, record->name))) {
+			if (prev) {
+				prev->next = record->next;
+				free(record);
+				record = prev->next;
+			} else {
+				client->enable_blob_mode_records = record->next;
+				free(record);
+				record = client->enable_blob_mode_records;
+			}
+		} else {
+			prev = record;
+			record = record->next;
+		}
+	}
+	if (mode != INDIGO_ENABLE_BLOB_NEVER) {
+		record = malloc(sizeof(indigo_enable_blob_mode_record));
+		assert(record != NULL);
+		strncpy(record->device, property->device, INDIGO_NAME_SIZE);
+		strncpy(record->name, property->name, INDIGO_NAME_SIZE);
+		record->mode = mode;
+		record->next = client->enable_blob_mode_records;
+		client->enable_blob_mode_records = record;
+	}
+	indigo_enable_blob(client, property, mode);
+}
+
+static bool process_client_frame(indigo_binary_parser *parser, uint8_t type, frame_reader *reader) {
+	indigo_client *client = parser->client;
+	indigo_property *property = parser->property;
+	memset(property, 0, sizeof(indigo_property));
+	switch (type) {
+		case INDIGO_BINARY_GET_PROPERTIES:
+			get_string(reader, property->device, INDIGO_NAME_SIZE);
+			get_string(reader, property->name, INDIGO_NAME_SIZE);
+			if (reader->error)
+				return false;
+			indigo_enumerate_properties(client, property);
+			break;
+		case INDIGO_BINARY_ENABLE_BLOB: {
+			get_string(reader, property->device, INDIGO_NAME_SIZE);
+			get_string(reader, property->name, INDIGO_NAME_SIZE);
+			indigo_enable_blob_mode mode = (indigo_enable_blob_mode)get_le(reader, 1);
+			if (reader->error || mode > INDIGO_ENABLE_BLOB_URL)
+				return false;
+			enable_blob(client, property, mode);
+			break;
+		}
+		case INDIGO_BINARY_NEW_VECTOR: {
+			uint32_t id = (uint32_t)get_le(reader, 4);
+			int count = (int)get_le(reader, 2);
+			indigo_binary_context *context = parser->context;
+			indigo_binary_lock(context);
+			binary_entry *entry = id < context->next_id ? context->entries[id] : NULL;
+			if (entry == NULL || entry->items == NULL || count > entry->count) {
+				indigo_binary_unlock(context);
+				INDIGO_DEBUG_PROTOCOL(indigo_debug("Binary protocol: change of unknown property %u ignored", id));
+				break;
+			}
+			strncpy(property->device, entry->device, INDIGO_NAME_SIZE);
+			strncpy(property->name, entry->name, INDIGO_NAME_SIZE);
+			property->type = entry->type;
+			property->version = INDIGO_VERSION_CURRENT;
+			property->count = count;
+			for (int i = 0; i < count && !reader->error; i++) {
+				indigo_item *item = property->items + i;
+				int index = (int)get_le(reader, 2);
+				if (index >= entry->count) {
+					reader->error = true;
+					break;
+				}
+				memset(item, 0, sizeof(indigo_item));
+				strncpy(item->name, entry->items[index], INDIGO_NAME_SIZE);
+				switch (entry->type) {
+					case INDIGO_TEXT_VECTOR:
+						get_string(reader, item->text.value, INDIGO_VALUE_SIZE);
+						break;
+					case INDIGO_NUMBER_VECTOR:
+						item->number.value = get_double(reader);
+						break;
+					case INDIGO_SWITCH_VECTOR:
+						item->sw.value = get_le(reader, 1) != 0;
+						break;
+					default:
+						reader->error = true;
+						break;
+				}
+			}
+			indigo_binary_unlock(context);
+			if (reader->error)
+				return false;
+			indigo_change_property(client, property);
+			break;
+		}
+		case INDIGO_BINARY_UPDATE_INTERVAL: {
+			get_string(reader, property->device, INDIGO_NAME_SIZE);
+			get_string(reader, property->name, INDIGO_NAME_SIZE);
+			double interval = get_double(reader);
+			if (reader->error)
+				return false;
+			indigo_set_update_interval(client, property->device, property->name, interval);
+			break;
+		}
+		default:
+			INDIGO_DEBUG_PROTOCOL(indigo_debug("Binary protocol: frame type %d ignored", type));
+			break;
+	}
+	return true;
+}
+
+// client side, frames received from server
+
+static bool define_remote_property(indigo_binary_parser *parser, frame_reader *reader) {
+	indigo_device *device = parser->device;
+	indigo_binary_context *context = parser->context;
+	uint32_t id = (uint32_t)get_le(reader, 4);
+	indigo_property_type type = (indigo_property_type)get_le(reader, 1);
+	indigo_property_state state = (indigo_property_state)get_le(reader, 1);
+	indigo_property_perm perm = (indigo_property_perm)get_le(reader, 1);
+	indigo_rule rule = (indigo_rule)get_le(reader, 1);
+	int count = (int)get_le(reader, 2);
+	if (reader->error || id == 0 || id > INDIGO_BINARY_MAX_ID || count > INDIGO_MAX_ITEMS)
+		return false;
+	int size = sizeof(indigo_property) + count * sizeof(indigo_item);
+	indigo_property *property = malloc(size);
+	assert(property != NULL);
+	memset(property, 0, size);
+	char device_name[INDIGO_NAME_SIZE];
+	get_string(reader, device_name, INDIGO_NAME_SIZE);
+	remote_device_name(parser, property->device, device_name);
+	get_string(reader, property->name, INDIGO_NAME_SIZE);
+	get_string(reader, property->group, INDIGO_NAME_SIZE);
+	get_string(reader, property->label, INDIGO_VALUE_SIZE);
+	get_string(reader, property->hints, INDIGO_VALUE_SIZE);
+	char message[INDIGO_VALUE_SIZE];
+	get_string(reader, message, INDIGO_VALUE_SIZE);
+	property->type = type;
+	property->state = state;
+	property->perm = perm;
+	property->rule = rule;
+	property->version = INDIGO_VERSION_CURRENT;
+	property->count = count;
+	for (int i = 0; i < count; i++) {
+		indigo_item *item = property->items + i;
+		get_string(reader, item->name, INDIGO_NAME_SIZE);
+		get_string(reader, item->label, INDIGO_VALUE_SIZE);
+		get_string(reader, item->hints, INDIGO_VALUE_SIZE);
+		switch (type) {
+			case INDIGO_TEXT_VECTOR:
+				get_string(reader, item->text.value, INDIGO_VALUE_SIZE);
+				break;
+			case INDIGO_NUMBER_VECTOR:
+				get_string(reader, item->number.format, INDIGO_VALUE_SIZE);
+				item->number.min = get_double(reader);
+				item->number.max = get_double(reader);
+				item->number.step = get_double(reader);
+				item->number.value = get_double(reader);
+				item->number.target = get_double(reader);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				item->sw.value = get_le(reader, 1) != 0;
+				break;
+			case INDIGO_LIGHT_VECTOR:
+				item->light.value = (indigo_property_state)get_le(reader, 1);
+				break;
+			default:
+				break;
+		}
+	}
+	if (reader->error) {
+		free(property);
+		return false;
+	}
+	indigo_binary_lock(context);
+	binary_entry *entry = set_entry(context, id, property->device, property->name);
+	if (entry == NULL) {
+		indigo_binary_unlock(context);
+		free(property);
+		return false;
+	}
+	indigo_property *old = entry->property;
+	if (old != NULL && (old->type != type || old->count != count || strcmp(old->device, property->device) || strcmp(old->name, property->name))) {
+		// the id is reused for different shape, client must forget the old one
+		indigo_binary_unlock(context);
+		indigo_delete_property(device, old, NULL);
+		indigo_binary_lock(context);
+		release_entry(entry);
+		context->entries[id] = NULL;
+		rebuild_slots(context);
+		entry = set_entry(context, id, property->device, property->name);
+		if (entry == NULL) {
+			indigo_binary_unlock(context);
+			free(property);
+			return false;
+		}
+		old = NULL;
+	}
+	if (old != NULL) {
+		// redefinition of known property, pointer seen by clients must stay valid
+		if (type == INDIGO_BLOB_VECTOR) {
+			for (int i = 0; i < count; i++) {
+				property->items[i].blob.value = old->items[i].blob.value;
+				property->items[i].blob.size = old->items[i].blob.size;
+			}
+		}
+		memcpy(old, property, sizeof(indigo_property));
+		memcpy(old->items, property->items, count * sizeof(indigo_item));
+		free(property);
+		property = old;
+	} else {
+		entry->property = property;
+	}
+	entry->type = type;
+	entry->count = count;
+	indigo_binary_unlock(context);
+	INDIGO_TRACE_PARSER(indigo_trace("Binary parser: define '%s' '%s' %u", property->device, property->name, id));
+	indigo_define_property(device, property, *message ? message : NULL);
+	return true;
+}
+
+static bool update_remote_property(indigo_binary_parser *parser, frame_reader *reader) {
+	indigo_device *device = parser->device;
+	indigo_binary_context *context = parser->context;
+	uint32_t id = (uint32_t)get_le(reader, 4);
+	indigo_property_state state = (indigo_property_state)get_le(reader, 1);
+	char message[INDIGO_VALUE_SIZE];
+	get_string(reader, message, INDIGO_VALUE_SIZE);
+	int count = (int)get_le(reader, 2);
+	if (reader->error)
+		return false;
+	indigo_binary_lock(context);
+	binary_entry *entry = id < context->next_id ? context->entries[id] : NULL;
+	indigo_binary_unlock(context);
+	// entries are changed only by this thread, so the property can be used without lock
+	indigo_property *property = entry ? entry->property : NULL;
+	if (property == NULL) {
+		INDIGO_DEBUG_PROTOCOL(indigo_debug("Binary protocol: update of unknown property %u ignored", id));
+		return true;
+	}
+	property->state = state;
+	if (property->type == INDIGO_SWITCH_VECTOR && property->rule != INDIGO_ANY_OF_MANY_RULE) {
+		for (int i = 0; i < property->count; i++)
+			property->items[i].sw.value = false;
+	}
+	int blobs[INDIGO_MAX_ITEMS];
+	int blob_count = 0;
+	for (int i = 0; i < count && !reader->error; i++) {
+		int index = (int)get_le(reader, 2);
+		if (index >= property->count)
+			return false;
+		indigo_item *item = property->items + index;
+		switch (property->type) {
+			case INDIGO_TEXT_VECTOR:
+				get_string(reader, item->text.value, INDIGO_VALUE_SIZE);
+				break;
+			case INDIGO_NUMBER_VECTOR:
+				item->number.value = get_double(reader);
+				item->number.target = get_double(reader);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				item->sw.value = get_le(reader, 1) != 0;
+				break;
+			case INDIGO_LIGHT_VECTOR:
+				item->light.value = (indigo_property_state)get_le(reader, 1);
+				break;
+			case INDIGO_BLOB_VECTOR: {
+				char url[INDIGO_VALUE_SIZE];
+				get_string(reader, item->blob.format, INDIGO_NAME_SIZE);
+				get_string(reader, url, INDIGO_VALUE_SIZE);
+				long size = (long)get_le(reader, 8);
+				if (*url == '/')
+					snprintf(item->blob.url, INDIGO_VALUE_SIZE, "%s%s", ((indigo_adapter_context *)device->device_context)->url_prefix, url);
+				else
+					strcpy(item->blob.url, url);
+				if (*url == 0 && size > 0 && blob_count < INDIGO_MAX_ITEMS) {
+					if (size > reader->end - reader->pointer)
+						return false;
+					item->blob.size = size;
+					blobs[blob_count++] = index;
+				}
+				break;
+			}
+		}
+	}
+	for (int i = 0; i < blob_count && !reader->error; i++) {
+		// raw content of inline BLOBs follows item descriptions
+		indigo_item *item = property->items + blobs[i];
+		if (reader->end - reader->pointer < item->blob.size)
+			return false;
+		item->blob.value = realloc(item->blob.value, item->blob.size);
+		assert(item->blob.value != NULL);
+		memcpy(item->blob.value, reader->pointer, item->blob.size);
+		reader->pointer += item->blob.size;
+	}
+	if (reader->error)
+		return false;
+	INDIGO_TRACE_PARSER(indigo_trace("Binary parser: update '%s' '%s' %u", property->device, property->name, id));
+	indigo_update_property(device, property, *message ? message : NULL);
+	return true;
+}
+
+static bool delete_remote_property(indigo_binary_parser *parser, frame_reader *reader) {
+	indigo_device *device = parser->device;
+	indigo_binary_context *context = parser->context;
+	char device_name[INDIGO_NAME_SIZE], remote_name[INDIGO_NAME_SIZE], name[INDIGO_NAME_SIZE], message[INDIGO_VALUE_SIZE];
+	get_string(reader, remote_name, INDIGO_NAME_SIZE);
+	get_string(reader, name, INDIGO_NAME_SIZE);
+	get_string(reader, message, INDIGO_VALUE_SIZE);
+	if (reader->error)
+		return false;
+	remote_device_name(parser, device_name, remote_name);
+	for (uint32_t id = 1; id < context->next_id; id++) {
+		binary_entry *entry = context->entries[id];
+		if (entry && entry->property && !strncmp(entry->device, device_name, INDIGO_NAME_SIZE) && (*name == 0 || !strncmp(entry->name, name, INDIGO_NAME_SIZE)))
+			indigo_delete_property(device, entry->property, *message ? message : NULL);
+	}
+	indigo_binary_lock(context);
+	indigo_binary_forget(context, device_name, name);
+	indigo_binary_unlock(context);
+	return true;
+}
+
+static bool process_server_frame(indigo_binary_parser *parser, uint8_t type, frame_reader *reader) {
+	switch (type) {
+		case INDIGO_BINARY_DEF_VECTOR:
+			return define_remote_property(parser, reader);
+		case INDIGO_BINARY_SET_VECTOR:
+			return update_remote_property(parser, reader);
+		case INDIGO_BINARY_DEL_PROPERTY:
+			return delete_remote_property(parser, reader);
+		case INDIGO_BINARY_MESSAGE: {
+			char device_name[INDIGO_NAME_SIZE], message[INDIGO_VALUE_SIZE], text[INDIGO_VALUE_SIZE];
+			get_string(reader, device_name, INDIGO_NAME_SIZE);
+			get_string(reader, message, INDIGO_VALUE_SIZE);
+			if (reader->error)
+				return false;
+			if (*device_name == 0)
+				strcpy(text, message);
+			else if (indigo_use_host_suffix)
+				snprintf(text, INDIGO_VALUE_SIZE, "%s %s: %s", device_name, parser->device->name, message);
+			else
+				snprintf(text, INDIGO_VALUE_SIZE, "%s: %s", device_name, message);
+			indigo_send_message(parser->device, text);
+			return true;
+		}
+		default:
+			INDIGO_DEBUG_PROTOCOL(indigo_debug("Binary protocol: frame type %d ignored", type));
+			return true;
+	}
+}
+
+// stream parser
+
+indigo_binary_parser *indigo_binary_parser_create(indigo_device *device, indigo_client *client) {
+	indigo_binary_parser *parser = malloc(sizeof(indigo_binary_parser));
+	assert(parser != NULL);
+	memset(parser, 0, sizeof(indigo_binary_parser));
+	parser->device = device;
+	parser->client = client;
+	parser->property = malloc(PROPERTY_SIZE);
+	assert(parser->property != NULL);
+	indigo_adapter_context *adapter_context = device != NULL ? (indigo_adapter_context *)device->device_context : (indigo_adapter_context *)client->client_context;
+	parser->context = adapter_context->binary_context;
+	parser->handle = adapter_context->input;
+	if (device != NULL)
+		device->enumerate_properties(device, client, NULL);
+	return parser;
+}
+
+static bool accept_preamble(indigo_binary_parser *parser) {
+	if (parser->preamble[0] != INDIGO_BINARY_MAGIC || parser->preamble[1] != 'I' || parser->preamble[2] != 'B' || parser->preamble[3] == 0) {
+		indigo_error("Binary protocol: invalid preamble");
+		return false;
+	}
+	if (parser->client != NULL) {
+		// server side, accept protocol and start sending frames to the client
+		indigo_adapter_context *client_context = (indigo_adapter_context *)parser->client->client_context;
+		pthread_mutex_lock(&client_context->output_mutex);
+		indigo_binary_write_preamble(client_context->output_buffer);
+		indigo_output_flush(client_context->output_buffer);
+		parser->client->version = INDIGO_VERSION_CURRENT;
+		pthread_mutex_unlock(&client_context->output_mutex);
+	}
+	INDIGO_LOG(indigo_log("Binary protocol version %d accepted", parser->preamble[3]));
+	return parser->accepted = true;
+}
+
+bool indigo_binary_parser_feed(indigo_binary_parser *parser, char *data, long length) {
+	unsigned char *pointer = (unsigned char *)data;
+	unsigned char *end = pointer + length;
+	while (pointer < end) {
+		if (parser->preamble_length < INDIGO_BINARY_PREAMBLE_SIZE) {
+			parser->preamble[parser->preamble_length++] = *pointer++;
+			if (parser->preamble_length == INDIGO_BINARY_PREAMBLE_SIZE && !accept_preamble(parser))
+				return false;
+			continue;
+		}
+		if (parser->header_length < INDIGO_BINARY_HEADER_SIZE) {
+			parser->header[parser->header_length++] = *pointer++;
+			if (parser->header_length == INDIGO_BINARY_HEADER_SIZE) {
+				frame_reader reader = { parser->header + 1, parser->header + INDIGO_BINARY_HEADER_SIZE, false };
+				parser->frame_length = (long)get_le(&reader, 4);
+				parser->frame_offset = 0;
+				// only server to client frames carry BLOBs, client frames are limited to one property
+				if (parser->frame_length > (parser->device != NULL ? MAX_SERVER_FRAME_SIZE : MAX_CLIENT_FRAME_SIZE)) {
+					indigo_error("Binary protocol: frame %d too long (%ld bytes)", parser->header[0], parser->frame_length);
+					return false;
+				}
+				if (parser->frame_length > parser->frame_size) {
+					free(parser->frame);
+					parser->frame = malloc(parser->frame_length);
+					if (parser->frame == NULL) {
+						indigo_error("Binary protocol: can't allocate %ld bytes frame", parser->frame_length);
+						parser->frame_size = 0;
+						return false;
+					}
+					parser->frame_size = parser->frame_length;
+				}
+			} else {
+				continue;
+			}
+		} else {
+			long count = end - pointer;
+			if (count > parser->frame_length - parser->frame_offset)
+				count = parser->frame_length - parser->frame_offset;
+			memcpy(parser->frame + parser->frame_offset, pointer, count);
+			parser->frame_offset += count;
+			pointer += count;
+		}
+		if (parser->frame_offset == parser->frame_length) {
+			uint8_t type = parser->header[0];
+			frame_reader reader = { parser->frame, parser->frame + parser->frame_length, false };
+			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → binary frame %d (%ld bytes)", parser->handle, type, parser->frame_length));
+			parser->header_length = 0;
+			if (!(parser->device != NULL ? process_server_frame(parser, type, &reader) : process_client_frame(parser, type, &reader))) {
+				indigo_error("Binary protocol: malformed frame %d", type);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void indigo_binary_parser_release(indigo_binary_parser *parser) {
+	if (parser->device != NULL) {
+		// remote properties disappear with the connection
+		indigo_binary_context *context = parser->context;
+		for (uint32_t id = 1; id < context->next_id; id++) {
+			binary_entry *entry = context->entries[id];
+			if (entry && entry->property) {
+				indigo_delete_property(parser->device, entry->property, NULL);
+				indigo_binary_lock(context);
+				release_entry(entry);
+				context->entries[id] = NULL;
+				indigo_binary_unlock(context);
+			}
+		}
+		indigo_binary_lock(context);
+		rebuild_slots(context);
+		indigo_binary_unlock(context);
+	}
+	free(parser->frame);
+	free(parser->property);
+	free(parser);
+}
+
+bool indigo_binary_parse(indigo_device *device, indigo_client *client) {
+	char *buffer = malloc(BUFFER_SIZE);
+	assert(buffer != NULL);
+	indigo_binary_parser *parser = indigo_binary_parser_create(device, client);
+	int handle = parser->handle;
+	while (true) {
+		int count = indigo_recv(handle, buffer, BUFFER_SIZE);
+		if (count <= 0)
+			break;
+		if (!indigo_binary_parser_feed(parser, buffer, count))
+			break;
+	}
+	bool accepted = parser->accepted;
+	indigo_binary_parser_release(parser);
+	free(buffer);
+	indigo_disable_read_buffer(handle);
+	close(handle);
+	INDIGO_TRACE_PARSER(indigo_trace("Binary parser: parser finished"));
+	return accepted;
+}
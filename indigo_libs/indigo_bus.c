@@ -34,6 +34,7 @@
 #include <time.h>
 #include <math.h>
 #include <assert.h>
+#include <errno.h>
 #include <pthread.h>
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
 #include <sys/time.h>
@@ -54,22 +55,72 @@
 
 #define MAX_DEVICES 256
 #define MAX_CLIENTS 256
-#define MAX_BLOBS	32
+
+#define DEVICE_HASH_SIZE	512
+#define SHADOW_HASH_SIZE	1024
 
 #define BUFFER_SIZE	1024
 
 static indigo_device *devices[MAX_DEVICES];
+static int device_hash[DEVICE_HASH_SIZE];
+static int device_hash_next[MAX_DEVICES];
+static unsigned device_hash_value[MAX_DEVICES];
+static int remote_devices[MAX_DEVICES];
+static int remote_device_count = 0;
 static indigo_client *clients[MAX_CLIENTS];
-static indigo_blob_entry *blobs[MAX_BLOBS];
+static indigo_blob_entry *blob_cache_head = NULL;
+static indigo_blob_entry *blob_cache_tail = NULL;
+static long blob_cache_size = 0;
+
+typedef struct blob_buffer {
+	void *data;
+	long capacity;
+	int ref_count;
+	struct blob_buffer *next;
+} blob_buffer;
+
+static blob_buffer *shared_blob_buffers = NULL;
+
+// Shared/exclusive lock guarding client and device tables. Property traffic (definitions, updates, messages
+// and requests) holds it shared, so fan-outs from different drivers run in parallel, attach/detach hold it
+// exclusively. It is reentrant per thread, the outermost acquisition decides the mode. Readers wait for an active
+// writer only, so a thread inside the bus never blocks another one entering it.
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int readers;
+	bool writer;
+} bus_lock_state;
+
+static bus_lock_state bus_lock = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, false };
+static INDIGO_THREAD_LOCAL int bus_lock_depth = 0;
+static INDIGO_THREAD_LOCAL bool bus_lock_exclusive = false;
 
-static pthread_mutex_t bus_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
-#define client_mutex bus_mutex
-#define device_mutex bus_mutex
+// Serializes requests sent to devices (enumerate, change, enable BLOB) in strict locking mode, always nested in shared bus lock.
+
+static pthread_mutex_t device_mutex = PTHREAD_MUTEX_INITIALIZER;
+static INDIGO_THREAD_LOCAL int device_mutex_depth = 0;
 
 bool indigo_use_strict_locking = true;
 
 static pthread_mutex_t blob_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Item values of defined properties as sent in the last definition or update, used to flag changed items.
+
+typedef struct property_shadow {
+	indigo_property *property;
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	indigo_property_type type;
+	int count;
+	struct property_shadow *next;
+	char values[];
+} property_shadow;
+
+static property_shadow *shadow_hash[SHADOW_HASH_SIZE];
+static pthread_mutex_t shadow_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static bool is_started = false;
 
 char *indigo_property_type_text[] = {
@@ -114,6 +165,8 @@ bool indigo_reshare_remote_devices = false;
 bool indigo_use_host_suffix = true;
 bool indigo_is_sandboxed = false;
 bool indigo_use_blob_caching = false;
+long indigo_blob_cache_limit = 512L * 1024 * 1024;
+bool indigo_use_delta_updates = true;
 
 const char **indigo_main_argv = NULL;
 int indigo_main_argc = 0;
@@ -316,6 +369,181 @@ void indigo_trace_property(const char *message, indigo_property *property, bool
 	}
 }
 
+static void bus_read_lock() {
+	if (bus_lock_depth++ > 0)
+		return;
+	pthread_mutex_lock(&bus_lock.mutex);
+	while (bus_lock.writer)
+		pthread_cond_wait(&bus_lock.cond, &bus_lock.mutex);
+	bus_lock.readers++;
+	pthread_mutex_unlock(&bus_lock.mutex);
+}
+
+static void bus_read_unlock() {
+	if (--bus_lock_depth > 0)
+		return;
+	pthread_mutex_lock(&bus_lock.mutex);
+	if (--bus_lock.readers == 0)
+		pthread_cond_broadcast(&bus_lock.cond);
+	pthread_mutex_unlock(&bus_lock.mutex);
+}
+
+static int bus_write_lock() {
+	if (bus_lock_exclusive) {
+		bus_lock_depth++;
+		return -1;
+	}
+	// device requests are nested in shared lock, device mutex is released while waiting for readers to leave
+	int device_depth = device_mutex_depth;
+	if (device_depth > 0) {
+		device_mutex_depth = 0;
+		pthread_mutex_unlock(&device_mutex);
+	}
+	pthread_mutex_lock(&bus_lock.mutex);
+	if (bus_lock_depth > 0 && --bus_lock.readers == 0) // called from bus callback, shared hold is given up while waiting
+		pthread_cond_broadcast(&bus_lock.cond);
+	while (bus_lock.writer || bus_lock.readers > 0)
+		pthread_cond_wait(&bus_lock.cond, &bus_lock.mutex);
+	bus_lock.writer = true;
+	pthread_mutex_unlock(&bus_lock.mutex);
+	bus_lock_exclusive = true;
+	bus_lock_depth++;
+	return device_depth;
+}
+
+static void bus_write_unlock(int device_depth) {
+	if (device_depth < 0) {
+		bus_lock_depth--;
+		return;
+	}
+	bus_lock_exclusive = false;
+	pthread_mutex_lock(&bus_lock.mutex);
+	bus_lock.writer = false;
+	if (--bus_lock_depth > 0)
+		bus_lock.readers++;
+	pthread_cond_broadcast(&bus_lock.cond);
+	pthread_mutex_unlock(&bus_lock.mutex);
+	if (device_depth > 0) {
+		pthread_mutex_lock(&device_mutex);
+		device_mutex_depth = device_depth;
+	}
+}
+
+static void device_lock() {
+	if (device_mutex_depth++ == 0)
+		pthread_mutex_lock(&device_mutex);
+}
+
+static void device_unlock() {
+	if (--device_mutex_depth == 0)
+		pthread_mutex_unlock(&device_mutex);
+}
+
+static blob_buffer *find_blob_buffer(void *data, long size) {
+	for (blob_buffer *buffer = shared_blob_buffers; buffer; buffer = buffer->next) {
+		if (size == 0 ? data == buffer->data : (char *)data >= (char *)buffer->data && (char *)data + size <= (char *)buffer->data + buffer->capacity)
+			return buffer;
+	}
+	return NULL;
+}
+
+static void release_blob_buffer(blob_buffer *buffer) {
+	if (--buffer->ref_count > 0)
+		return;
+	for (blob_buffer **link = &shared_blob_buffers; *link; link = &(*link)->next) {
+		if (*link == buffer) {
+			*link = buffer->next;
+			break;
+		}
+	}
+	free(buffer->data);
+	free(buffer);
+}
+
+static indigo_blob_entry *find_blob_entry(indigo_item *item) {
+	for (indigo_blob_entry *entry = blob_cache_head; entry; entry = entry->next) {
+		if (entry->item == item)
+			return entry;
+	}
+	return NULL;
+}
+
+static void link_blob_entry(indigo_blob_entry *entry) {
+	entry->prev = NULL;
+	entry->next = blob_cache_head;
+	if (blob_cache_head)
+		blob_cache_head->prev = entry;
+	else
+		blob_cache_tail = entry;
+	blob_cache_head = entry;
+	blob_cache_size += entry->size;
+}
+
+static void unlink_blob_entry(indigo_blob_entry *entry) {
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		blob_cache_head = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		blob_cache_tail = entry->prev;
+	entry->prev = entry->next = NULL;
+	blob_cache_size -= entry->size;
+}
+
+static void release_blob_entry(indigo_blob_entry *entry) {
+	if (--entry->ref_count > 0)
+		return;
+	if (entry->buffer)
+		release_blob_buffer(entry->buffer);
+	else
+		free(entry->content);
+	free(entry);
+}
+
+static bool cache_blob_item(indigo_item *item) {
+	indigo_blob_entry *entry = malloc(sizeof(indigo_blob_entry));
+	if (entry == NULL)
+		return false;
+	memset(entry, 0, sizeof(indigo_blob_entry));
+	entry->item = item;
+	entry->size = item->blob.value ? item->blob.size : 0;
+	strcpy(entry->format, item->blob.format);
+	entry->ref_count = 1;
+	pthread_mutex_lock(&blob_mutex);
+	blob_buffer *buffer = item->blob.value ? find_blob_buffer(item->blob.value, item->blob.size) : NULL;
+	if (buffer) {
+		buffer->ref_count++;
+		entry->buffer = buffer;
+		entry->content = item->blob.value;
+	}
+	pthread_mutex_unlock(&blob_mutex);
+	if (entry->buffer == NULL && entry->size > 0) {
+		// content is owned by driver and will be overwritten by the next frame, private copy is needed
+		entry->content = malloc(entry->size);
+		if (entry->content == NULL) {
+			free(entry);
+			return false;
+		}
+		memcpy(entry->content, item->blob.value, entry->size);
+	}
+	pthread_mutex_lock(&blob_mutex);
+	indigo_blob_entry *previous = find_blob_entry(item);
+	if (previous) {
+		unlink_blob_entry(previous);
+		release_blob_entry(previous);
+	}
+	link_blob_entry(entry);
+	while (blob_cache_size > indigo_blob_cache_limit && blob_cache_tail != entry) {
+		indigo_blob_entry *victim = blob_cache_tail;
+		unlink_blob_entry(victim);
+		release_blob_entry(victim);
+	}
+	pthread_mutex_unlock(&blob_mutex);
+	return true;
+}
+
 indigo_result indigo_start() {
 	for (int i = 1; i < indigo_main_argc; i++) {
 		if (!strcmp(indigo_main_argv[i], "-v") || !strcmp(indigo_main_argv[i], "--enable-info")) {
@@ -326,12 +554,17 @@ indigo_result indigo_start() {
 			indigo_log_level = INDIGO_LOG_TRACE;
 		}
 	}
-	pthread_mutex_lock(&device_mutex);
-	pthread_mutex_lock(&client_mutex);
+	int device_depth = bus_write_lock();
 	if (!is_started) {
 		memset(devices, 0, MAX_DEVICES * sizeof(indigo_device *));
+		for (int i = 0; i < DEVICE_HASH_SIZE; i++)
+			device_hash[i] = -1;
+		for (int i = 0; i < MAX_DEVICES; i++)
+			device_hash_next[i] = -1;
+		remote_device_count = 0;
 		memset(clients, 0, MAX_CLIENTS * sizeof(indigo_client *));
-		memset(blobs, 0, MAX_BLOBS * sizeof(indigo_property *));
+		blob_cache_head = blob_cache_tail = NULL;
+		blob_cache_size = 0;
 		memset(&INDIGO_ALL_PROPERTIES, 0, sizeof(INDIGO_ALL_PROPERTIES));
 		is_started = true;
 	}
@@ -340,19 +573,774 @@ indigo_result indigo_start() {
   WSADATA data;
   WSAStartup(version_requested, &data);
 #endif
-	pthread_mutex_unlock(&client_mutex);
-	pthread_mutex_unlock(&device_mutex);
+	bus_write_unlock(device_depth);
 	return INDIGO_OK;
 }
 
+typedef enum {
+	DEFINE_PROPERTY,
+	UPDATE_PROPERTY,
+	DELETE_PROPERTY,
+	SEND_MESSAGE
+} queue_command;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int pending;
+} queue_barrier;
+
+typedef struct queue_entry {
+	queue_command command;
+	indigo_device device;
+	bool has_device;
+	indigo_property *property;
+	bool owns_property;
+	char message[INDIGO_VALUE_SIZE];
+	bool has_message;
+	queue_barrier *barrier;
+	bool transition;					///< update changes property state seen by client, it is never dropped
+	struct queue_entry *prev;
+	struct queue_entry *next;
+} queue_entry;
+
+#define QUEUE_STATE_HASH_SIZE	64
+
+typedef struct queue_state {
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	indigo_property_state state;
+	struct queue_state *next;
+} queue_state;
+
+typedef struct queue_resync {
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	struct queue_resync *next;
+} queue_resync;
+
+typedef struct queue_rate {
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	double interval;
+	struct queue_rate *next;
+} queue_rate;
+
+typedef struct queue_throttle {
+	char device[INDIGO_NAME_SIZE];
+	char name[INDIGO_NAME_SIZE];
+	double interval;
+	double last_time;
+	indigo_property_state last_state;
+	queue_entry *deferred;		///< the latest update held back until last_time + interval
+	struct queue_throttle *next;
+} queue_throttle;
+
+struct indigo_client_queue {
+	indigo_client *client;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	queue_entry *head;
+	queue_entry *tail;
+	int size;
+	int depth;
+	int max_depth;
+	indigo_queue_policy policy;
+	long delivered;
+	long coalesced;
+	long dropped;
+	queue_resync *resync;			///< properties with dropped partial update, next update is delivered in full
+	queue_rate *rates;				///< minimal update intervals requested by client
+	queue_throttle *throttles;	///< state of rate limited properties
+	queue_state *states[QUEUE_STATE_HASH_SIZE];	///< property states in the order they are queued
+	bool running;
+};
+
+static unsigned name_hash(const char *name);
+
+static queue_state **queue_find_state(indigo_client_queue *queue, indigo_property *property) {
+	queue_state **state = &queue->states[(name_hash(property->device) ^ name_hash(property->name)) % QUEUE_STATE_HASH_SIZE];
+	while (*state && (strcmp((*state)->name, property->name) || strcmp((*state)->device, property->device)))
+		state = &(*state)->next;
+	return state;
+}
+
+static bool queue_is_transition(indigo_client_queue *queue, indigo_property *property) {
+	queue_state *state = *queue_find_state(queue, property);
+	return state == NULL || state->state != property->state;
+}
+
+static void queue_note_state(indigo_client_queue *queue, queue_entry *entry) {
+	// client sees states in the order they are queued, because updates changing state are not dropped
+	indigo_property *property = entry->property;
+	if (property == NULL)
+		return;
+	if (entry->command == UPDATE_PROPERTY || entry->command == DEFINE_PROPERTY) {
+		queue_state **state = queue_find_state(queue, property);
+		if (*state == NULL) {
+			*state = malloc(sizeof(queue_state));
+			assert(*state != NULL);
+			strncpy((*state)->device, property->device, INDIGO_NAME_SIZE);
+			strncpy((*state)->name, property->name, INDIGO_NAME_SIZE);
+			(*state)->next = NULL;
+			entry->transition = true;
+		} else if ((*state)->state != property->state) {
+			entry->transition = true;
+		}
+		(*state)->state = property->state;
+	} else if (entry->command == DELETE_PROPERTY) {
+		const char *device_name = *property->device || !entry->has_device ? property->device : entry->device.name;
+		for (int i = 0; i < QUEUE_STATE_HASH_SIZE; i++) {
+			queue_state **state = &queue->states[i];
+			while (*state) {
+				queue_state *current = *state;
+				if (!strcmp(current->device, device_name) && (*property->name == 0 || !strcmp(current->name, property->name))) {
+					*state = current->next;
+					free(current);
+				} else {
+					state = &current->next;
+				}
+			}
+		}
+	}
+}
+
+static void queue_unlink(indigo_client_queue *queue, queue_entry *entry) {
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		queue->head = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		queue->tail = entry->prev;
+	entry->prev = entry->next = NULL;
+	queue->depth--;
+}
+
+static void queue_append(indigo_client_queue *queue, queue_entry *entry) {
+	entry->next = NULL;
+	entry->prev = queue->tail;
+	if (queue->tail)
+		queue->tail->next = entry;
+	else
+		queue->head = entry;
+	queue->tail = entry;
+	if (++queue->depth > queue->max_depth)
+		queue->max_depth = queue->depth;
+	queue_note_state(queue, entry);
+	pthread_cond_signal(&queue->not_empty);
+}
+
+static void queue_release_entry(queue_entry *entry) {
+	if (entry->barrier) {
+		pthread_mutex_lock(&entry->barrier->mutex);
+		entry->barrier->pending--;
+		pthread_cond_signal(&entry->barrier->cond);
+		pthread_mutex_unlock(&entry->barrier->mutex);
+	}
+	if (entry->owns_property)
+		free(entry->property);
+	free(entry);
+}
+
+static void queue_set_content(queue_entry *entry, indigo_property *property, const char *message) {
+	if (property != NULL && entry->barrier == NULL) {
+		long size = sizeof(indigo_property) + property->count * sizeof(indigo_item);
+		entry->property = realloc(entry->owns_property ? entry->property : NULL, size);
+		memcpy(entry->property, property, size);
+		entry->owns_property = true;
+	} else {
+		if (entry->owns_property)
+			free(entry->property);
+		entry->property = property;
+		entry->owns_property = false;
+	}
+	// message of coalesced update is kept if the newer one has none
+	if (message != NULL) {
+		strncpy(entry->message, message, INDIGO_VALUE_SIZE);
+		entry->has_message = true;
+	}
+}
+
+static void merge_changes(indigo_property *property, indigo_property *older) {
+	// changes carried by replaced or dropped update must be delivered by the newer one
+	if (!property->partial)
+		return;
+	if (!older->partial || older->count != property->count) {
+		property->partial = false;
+		return;
+	}
+	for (int i = 0; i < property->count; i++)
+		property->items[i].changed |= older->items[i].changed;
+}
+
+static void queue_lost_update(indigo_client_queue *queue, queue_entry *dropped, indigo_property *property) {
+	if (!property->partial)
+		return;
+	if (dropped != NULL) {
+		for (queue_entry *entry = dropped->next; entry; entry = entry->next) {
+			if (entry->command == UPDATE_PROPERTY && entry->owns_property && !strcmp(entry->property->name, property->name) && !strcmp(entry->property->device, property->device)) {
+				merge_changes(entry->property, property);
+				return;
+			}
+		}
+	}
+	for (queue_resync *resync = queue->resync; resync; resync = resync->next) {
+		if (!strcmp(resync->name, property->name) && !strcmp(resync->device, property->device))
+			return;
+	}
+	queue_resync *resync = malloc(sizeof(queue_resync));
+	assert(resync != NULL);
+	strncpy(resync->device, property->device, INDIGO_NAME_SIZE);
+	strncpy(resync->name, property->name, INDIGO_NAME_SIZE);
+	resync->next = queue->resync;
+	queue->resync = resync;
+}
+
+static bool queue_resync_property(indigo_client_queue *queue, indigo_property *property) {
+	for (queue_resync **resync = &queue->resync; *resync; resync = &(*resync)->next) {
+		if (!strcmp((*resync)->name, property->name) && !strcmp((*resync)->device, property->device)) {
+			queue_resync *found = *resync;
+			*resync = found->next;
+			free(found);
+			return true;
+		}
+	}
+	return false;
+}
+
+static queue_entry *queue_new_entry(queue_command command, indigo_device *device, indigo_property *property, const char *message, queue_barrier *barrier) {
+	queue_entry *entry = malloc(sizeof(queue_entry));
+	memset(entry, 0, sizeof(queue_entry));
+	entry->command = command;
+	if ((entry->has_device = device != NULL))
+		memcpy(&entry->device, device, sizeof(indigo_device));
+	entry->barrier = barrier;
+	queue_set_content(entry, property, message);
+	return entry;
+}
+
+static double queue_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static queue_throttle *queue_find_throttle(indigo_client_queue *queue, indigo_property *property) {
+	for (queue_throttle *throttle = queue->throttles; throttle; throttle = throttle->next) {
+		if (!strcmp(throttle->name, property->name) && !strcmp(throttle->device, property->device))
+			return throttle;
+	}
+	// the most specific rule wins: property, device, everything
+	queue_rate *best = NULL;
+	int best_level = -1;
+	for (queue_rate *rate = queue->rates; rate; rate = rate->next) {
+		int level = *rate->device ? (*rate->name ? 2 : 1) : 0;
+		if (level > best_level && (*rate->device == 0 || !strcmp(rate->device, property->device)) && (*rate->name == 0 || !strcmp(rate->name, property->name))) {
+			best = rate;
+			best_level = level;
+		}
+	}
+	if (best == NULL)
+		return NULL;
+	queue_throttle *throttle = malloc(sizeof(queue_throttle));
+	assert(throttle != NULL);
+	memset(throttle, 0, sizeof(queue_throttle));
+	strncpy(throttle->device, property->device, INDIGO_NAME_SIZE);
+	strncpy(throttle->name, property->name, INDIGO_NAME_SIZE);
+	throttle->interval = best->interval;
+	throttle->last_state = -1;
+	throttle->next = queue->throttles;
+	queue->throttles = throttle;
+	return throttle;
+}
+
+static void queue_forget_throttles(indigo_client_queue *queue, indigo_device *device, indigo_property *property, bool deliver) {
+	// held updates are delivered or discarded (property is redefined or deleted), NULL property means all
+	const char *device_name = property == NULL ? NULL : *property->device || device == NULL ? property->device : device->name;
+	queue_throttle **throttle = &queue->throttles;
+	while (*throttle) {
+		queue_throttle *current = *throttle;
+		if (property == NULL || (!strcmp(current->device, device_name) && (*property->name == 0 || !strcmp(current->name, property->name)))) {
+			if (current->deferred) {
+				if (deliver)
+					queue_append(queue, current->deferred);
+				else
+					queue_release_entry(current->deferred);
+			}
+			*throttle = current->next;
+			free(current);
+		} else {
+			throttle = &current->next;
+		}
+	}
+}
+
+static double queue_release_deferred(indigo_client_queue *queue) {
+	// moves held updates with expired interval to the queue, returns the time of the next one or 0
+	double next = 0, now = 0;
+	for (queue_throttle *throttle = queue->throttles; throttle; throttle = throttle->next) {
+		if (throttle->deferred) {
+			if (now == 0)
+				now = queue_time();
+			double due = throttle->last_time + throttle->interval;
+			if (due <= now || now < throttle->last_time) {
+				queue_append(queue, throttle->deferred);
+				throttle->deferred = NULL;
+				throttle->last_time = now;
+			} else if (next == 0 || due < next) {
+				next = due;
+			}
+		}
+	}
+	return next;
+}
+
+static bool queue_dispatch(indigo_client_queue *queue, queue_command command, indigo_device *device, indigo_property *property, const char *message, queue_barrier *barrier) {
+	pthread_mutex_lock(&queue->mutex);
+	if (!queue->running) {
+		pthread_mutex_unlock(&queue->mutex);
+		return false;
+	}
+	if (command == UPDATE_PROPERTY && barrier == NULL && queue->rates != NULL) {
+		queue_throttle *throttle = queue_find_throttle(queue, property);
+		if (throttle != NULL) {
+			double now = queue_time();
+			if (throttle->deferred != NULL) {
+				if (throttle->deferred->property->state == property->state && !(throttle->deferred->has_message && message != NULL)) {
+					indigo_property *held = throttle->deferred->property;
+					throttle->deferred->owns_property = false;
+					queue_set_content(throttle->deferred, property, message);
+					merge_changes(throttle->deferred->property, held);
+					free(held);
+					queue->coalesced++;
+					pthread_mutex_unlock(&queue->mutex);
+					return true;
+				}
+				// state transition or another message, the held update goes first
+				queue_append(queue, throttle->deferred);
+				throttle->deferred = NULL;
+			} else if (property->state == throttle->last_state && now >= throttle->last_time && now - throttle->last_time < throttle->interval) {
+				throttle->deferred = queue_new_entry(command, device, property, message, NULL);
+				// wake up writer to wait for the new deadline
+				pthread_cond_signal(&queue->not_empty);
+				pthread_mutex_unlock(&queue->mutex);
+				return true;
+			}
+			throttle->last_time = now;
+			throttle->last_state = property->state;
+		}
+	} else if ((command == DEFINE_PROPERTY || command == DELETE_PROPERTY) && queue->throttles != NULL) {
+		queue_forget_throttles(queue, device, property, false);
+	}
+	if (command == UPDATE_PROPERTY && barrier == NULL) {
+		for (queue_entry *entry = queue->tail; entry; entry = entry->prev) {
+			if (entry->property && !strcmp(entry->property->name, property->name) && !strcmp(entry->property->device, property->device)) {
+				if (entry->command == UPDATE_PROPERTY && entry->barrier == NULL && entry->property->state == property->state && !(entry->has_message && message != NULL)) {
+					indigo_property *queued = entry->property;
+					queue_unlink(queue, entry);
+					entry->owns_property = false;
+					queue_set_content(entry, property, message);
+					merge_changes(entry->property, queued);
+					free(queued);
+					queue_append(queue, entry);
+					queue->coalesced++;
+					pthread_mutex_unlock(&queue->mutex);
+					return true;
+				}
+				break;
+			}
+		}
+	}
+	if ((command == UPDATE_PROPERTY || command == SEND_MESSAGE) && barrier == NULL) {
+		while (queue->running && queue->depth >= queue->size) {
+			if (queue->policy == INDIGO_QUEUE_BLOCK) {
+				pthread_cond_wait(&queue->not_full, &queue->mutex);
+			} else if (queue->policy == INDIGO_QUEUE_DROP_NEWEST) {
+				if (command == UPDATE_PROPERTY && queue_is_transition(queue, property))
+					break;
+				if (command == UPDATE_PROPERTY)
+					queue_lost_update(queue, NULL, property);
+				queue->dropped++;
+				pthread_mutex_unlock(&queue->mutex);
+				return false;
+			} else {
+				queue_entry *oldest = queue->head;
+				while (oldest && (oldest->barrier || oldest->transition || (oldest->command != UPDATE_PROPERTY && oldest->command != SEND_MESSAGE)))
+					oldest = oldest->next;
+				if (oldest == NULL)
+					break;
+				if (oldest->command == UPDATE_PROPERTY)
+					queue_lost_update(queue, oldest, oldest->property);
+				queue_unlink(queue, oldest);
+				queue_release_entry(oldest);
+				queue->dropped++;
+			}
+		}
+		if (!queue->running) {
+			pthread_mutex_unlock(&queue->mutex);
+			return false;
+		}
+	}
+	queue_append(queue, queue_new_entry(command, device, property, message, barrier));
+	pthread_mutex_unlock(&queue->mutex);
+	return true;
+}
+
+static void *queue_writer(indigo_client_queue *queue) {
+	indigo_client *client = queue->client;
+	pthread_mutex_lock(&queue->mutex);
+	while (true) {
+		double due = queue->throttles != NULL ? queue_release_deferred(queue) : 0;
+		while (queue->running && queue->head == NULL) {
+			if (due > 0) {
+				struct timespec deadline = { (time_t)due, (long)((due - (time_t)due) * 1000000000.0) };
+				pthread_cond_timedwait(&queue->not_empty, &queue->mutex, &deadline);
+			} else {
+				pthread_cond_wait(&queue->not_empty, &queue->mutex);
+			}
+			due = queue->throttles != NULL ? queue_release_deferred(queue) : 0;
+		}
+		if (!queue->running)
+			break;
+		queue_entry *entry = queue->head;
+		queue_unlink(queue, entry);
+		if (queue->resync != NULL && entry->property != NULL && (entry->command == DEFINE_PROPERTY || entry->command == UPDATE_PROPERTY)) {
+			if (queue_resync_property(queue, entry->property) && entry->owns_property)
+				entry->property->partial = false;
+		}
+		pthread_cond_signal(&queue->not_full);
+		pthread_mutex_unlock(&queue->mutex);
+		indigo_device *device = entry->has_device ? &entry->device : NULL;
+		const char *message = entry->has_message ? entry->message : NULL;
+		switch (entry->command) {
+			case DEFINE_PROPERTY:
+				client->last_result = client->define_property(client, device, entry->property, message);
+				break;
+			case UPDATE_PROPERTY:
+				client->last_result = client->update_property(client, device, entry->property, message);
+				break;
+			case DELETE_PROPERTY:
+				client->last_result = client->delete_property(client, device, entry->property, message);
+				break;
+			case SEND_MESSAGE:
+				client->last_result = client->send_message(client, device, message);
+				break;
+		}
+		queue_release_entry(entry);
+		pthread_mutex_lock(&queue->mutex);
+		queue->delivered++;
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return NULL;
+}
+
+static void release_client_queue(indigo_client *client) {
+	indigo_client_queue *queue = client->queue;
+	if (queue == NULL)
+		return;
+	pthread_mutex_lock(&queue->mutex);
+	queue->running = false;
+	pthread_cond_broadcast(&queue->not_empty);
+	pthread_cond_broadcast(&queue->not_full);
+	pthread_mutex_unlock(&queue->mutex);
+	pthread_join(queue->thread, NULL);
+	queue_entry *entry;
+	while ((entry = queue->head) != NULL) {
+		queue_unlink(queue, entry);
+		queue_release_entry(entry);
+	}
+	while (queue->resync != NULL) {
+		queue_resync *resync = queue->resync;
+		queue->resync = resync->next;
+		free(resync);
+	}
+	for (int i = 0; i < QUEUE_STATE_HASH_SIZE; i++) {
+		while (queue->states[i] != NULL) {
+			queue_state *state = queue->states[i];
+			queue->states[i] = state->next;
+			free(state);
+		}
+	}
+	queue_forget_throttles(queue, NULL, NULL, false);
+	while (queue->rates != NULL) {
+		queue_rate *rate = queue->rates;
+		queue->rates = rate->next;
+		free(rate);
+	}
+	pthread_cond_destroy(&queue->not_empty);
+	pthread_cond_destroy(&queue->not_full);
+	pthread_mutex_destroy(&queue->mutex);
+	client->queue = NULL;
+	free(queue);
+}
+
+indigo_result indigo_enable_client_queue(indigo_client *client, int size, indigo_queue_policy policy) {
+	if (client == NULL || size <= 0)
+		return INDIGO_FAILED;
+	if (client->queue != NULL)
+		return INDIGO_DUPLICATED;
+	indigo_client_queue *queue = malloc(sizeof(indigo_client_queue));
+	memset(queue, 0, sizeof(indigo_client_queue));
+	queue->client = client;
+	queue->size = size;
+	queue->policy = policy;
+	queue->running = true;
+	pthread_mutex_init(&queue->mutex, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+	if (pthread_create(&queue->thread, NULL, (void *(*)(void *))queue_writer, queue) != 0) {
+		indigo_error("Can't create writer thread for client %s (%s)", client->name, strerror(errno));
+		pthread_cond_destroy(&queue->not_empty);
+		pthread_cond_destroy(&queue->not_full);
+		pthread_mutex_destroy(&queue->mutex);
+		free(queue);
+		return INDIGO_FAILED;
+	}
+	client->queue = queue;
+	return INDIGO_OK;
+}
+
+int indigo_get_client_queue_stats(indigo_queue_stats *stats, int max) {
+	int count = 0;
+	bus_read_lock();
+	for (int i = 0; i < MAX_CLIENTS && count < max; i++) {
+		indigo_client *client = clients[i];
+		if (client != NULL && client->queue != NULL) {
+			indigo_client_queue *queue = client->queue;
+			indigo_queue_stats *record = stats + count++;
+			strncpy(record->client, client->name, INDIGO_NAME_SIZE);
+			pthread_mutex_lock(&queue->mutex);
+			record->depth = queue->depth;
+			record->max_depth = queue->max_depth;
+			record->delivered = queue->delivered;
+			record->coalesced = queue->coalesced;
+			record->dropped = queue->dropped;
+			pthread_mutex_unlock(&queue->mutex);
+		}
+	}
+	bus_read_unlock();
+	return count;
+}
+
+indigo_result indigo_set_update_interval(indigo_client *client, const char *device, const char *name, double interval) {
+	indigo_client_queue *queue = client != NULL ? client->queue : NULL;
+	if (queue == NULL)
+		return INDIGO_FAILED;
+	if (device == NULL)
+		device = "";
+	if (name == NULL)
+		name = "";
+	pthread_mutex_lock(&queue->mutex);
+	for (queue_rate **rate = &queue->rates; *rate; rate = &(*rate)->next) {
+		if (!strcmp((*rate)->device, device) && !strcmp((*rate)->name, name)) {
+			queue_rate *found = *rate;
+			*rate = found->next;
+			free(found);
+			break;
+		}
+	}
+	if (interval > 0) {
+		queue_rate *rate = malloc(sizeof(queue_rate));
+		assert(rate != NULL);
+		strncpy(rate->device, device, INDIGO_NAME_SIZE);
+		strncpy(rate->name, name, INDIGO_NAME_SIZE);
+		rate->interval = interval;
+		rate->next = queue->rates;
+		queue->rates = rate;
+	}
+	// per property state is rebuilt with new rules, held updates are delivered now
+	queue_forget_throttles(queue, NULL, NULL, true);
+	pthread_mutex_unlock(&queue->mutex);
+	INDIGO_DEBUG(indigo_debug("INDIGO Bus: update interval of '%s' '%s' for '%s' set to %gs", device, name, client->name, interval));
+	return INDIGO_OK;
+}
+
+int indigo_client_queue_depth(indigo_client *client) {
+	indigo_client_queue *queue = client->queue;
+	if (queue == NULL)
+		return 0;
+	pthread_mutex_lock(&queue->mutex);
+	int depth = queue->depth;
+	pthread_mutex_unlock(&queue->mutex);
+	return depth;
+}
+
+static void init_barrier(queue_barrier *barrier) {
+	pthread_mutex_init(&barrier->mutex, NULL);
+	pthread_cond_init(&barrier->cond, NULL);
+	barrier->pending = 0;
+}
+
+static void wait_for_barrier(queue_barrier *barrier) {
+	pthread_mutex_lock(&barrier->mutex);
+	while (barrier->pending > 0)
+		pthread_cond_wait(&barrier->cond, &barrier->mutex);
+	pthread_mutex_unlock(&barrier->mutex);
+	pthread_cond_destroy(&barrier->cond);
+	pthread_mutex_destroy(&barrier->mutex);
+}
+
+static void queued_dispatch(indigo_client *client, queue_command command, indigo_device *device, indigo_property *property, const char *message, queue_barrier *barrier) {
+	if (property != NULL && property->type == INDIGO_BLOB_VECTOR) {
+		// BLOB items are referenced by address (/blob/<item> URLs) and their content is owned by the driver, so the handover is synchronous
+		pthread_mutex_lock(&barrier->mutex);
+		barrier->pending++;
+		pthread_mutex_unlock(&barrier->mutex);
+		if (!queue_dispatch(client->queue, command, device, property, message, barrier)) {
+			pthread_mutex_lock(&barrier->mutex);
+			barrier->pending--;
+			pthread_mutex_unlock(&barrier->mutex);
+		}
+	} else {
+		queue_dispatch(client->queue, command, device, property, message, NULL);
+	}
+}
+
+static void direct_dispatch(indigo_client *client, queue_command command, indigo_device *device, indigo_property *property, const char *message) {
+	switch (command) {
+		case DEFINE_PROPERTY:
+			client->last_result = client->define_property(client, device, property, message);
+			break;
+		case UPDATE_PROPERTY:
+			client->last_result = client->update_property(client, device, property, message);
+			break;
+		case DELETE_PROPERTY:
+			client->last_result = client->delete_property(client, device, property, message);
+			break;
+		case SEND_MESSAGE:
+			client->last_result = client->send_message(client, device, message);
+			break;
+	}
+}
+
+static bool has_callback(indigo_client *client, queue_command command) {
+	switch (command) {
+		case DEFINE_PROPERTY:
+			return client->define_property != NULL;
+		case UPDATE_PROPERTY:
+			return client->update_property != NULL;
+		case DELETE_PROPERTY:
+			return client->delete_property != NULL;
+		case SEND_MESSAGE:
+			return client->send_message != NULL;
+	}
+	return false;
+}
+
+static void fan_out(queue_command command, indigo_device *device, indigo_property *property, const char *message) {
+	// queued clients are dispatched concurrently under the shared lock, clients without queue are called directly and get their callbacks one at a time under the device mutex
+	// (the shared hold is never given up here, so targets of a device request being processed on this thread can't be detached)
+	bool synchronous = false;
+	queue_barrier barrier;
+	init_barrier(&barrier);
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		indigo_client *client = clients[i];
+		if (client == NULL || !has_callback(client, command))
+			continue;
+		if (client->queue != NULL)
+			queued_dispatch(client, command, device, property, message, &barrier);
+		else
+			synchronous = true;
+	}
+	wait_for_barrier(&barrier);
+	if (!synchronous)
+		return;
+	// the device mutex is recursive per thread and serializes device requests too, so a local agent never gets its client callback
+	// concurrently with its own change_property() and requests issued from callbacks take it in the same order as the bus does
+	if (indigo_use_strict_locking)
+		device_lock();
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		indigo_client *client = clients[i];
+		if (client != NULL && client->queue == NULL && has_callback(client, command))
+			direct_dispatch(client, command, device, property, message);
+	}
+	if (indigo_use_strict_locking)
+		device_unlock();
+}
+
+static unsigned name_hash(const char *name) {
+	unsigned hash = 2166136261u;
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void index_device(int slot) {
+	indigo_device *device = devices[slot];
+	unsigned hash = device_hash_value[slot] = name_hash(device->name);
+	device_hash_next[slot] = device_hash[hash % DEVICE_HASH_SIZE];
+	device_hash[hash % DEVICE_HASH_SIZE] = slot;
+	if (*device->name == '@')
+		remote_devices[remote_device_count++] = slot;
+}
+
+static void unindex_device(int slot) {
+	int *link = &device_hash[device_hash_value[slot] % DEVICE_HASH_SIZE];
+	while (*link >= 0) {
+		if (*link == slot) {
+			*link = device_hash_next[slot];
+			break;
+		}
+		link = &device_hash_next[*link];
+	}
+	device_hash_next[slot] = -1;
+	for (int i = 0; i < remote_device_count; i++) {
+		if (remote_devices[i] == slot) {
+			remote_devices[i] = remote_devices[--remote_device_count];
+			break;
+		}
+	}
+}
+
+static int device_slot(indigo_device *device) {
+	for (int slot = device_hash[name_hash(device->name) % DEVICE_HASH_SIZE]; slot >= 0; slot = device_hash_next[slot])
+		if (devices[slot] == device)
+			return slot;
+	for (int slot = 0; slot < MAX_DEVICES; slot++) // name was changed after attach
+		if (devices[slot] == device)
+			return slot;
+	return -1;
+}
+
+static int route_property(indigo_property *property, indigo_device **targets) {
+	int count = 0;
+	bus_read_lock();
+	if (*property->device == 0) {
+		for (int slot = 0; slot < MAX_DEVICES; slot++)
+			if (devices[slot] != NULL)
+				targets[count++] = devices[slot];
+	} else {
+		unsigned hash = name_hash(property->device);
+		for (int slot = device_hash[hash % DEVICE_HASH_SIZE]; slot >= 0; slot = device_hash_next[slot])
+			if (device_hash_value[slot] == hash && !strcmp(property->device, devices[slot]->name))
+				targets[count++] = devices[slot];
+		for (int i = 0; i < remote_device_count; i++) {
+			indigo_device *device = devices[remote_devices[i]];
+			if (!strcmp(property->device, device->name))
+				continue;
+			if ((indigo_use_host_suffix && strstr(property->device, device->name)) || !indigo_use_host_suffix)
+				targets[count++] = device;
+		}
+	}
+	bus_read_unlock();
+	return count;
+}
+
 indigo_result indigo_attach_device(indigo_device *device) {
 	if ((!is_started) || (device == NULL))
 		return INDIGO_FAILED;
-	pthread_mutex_lock(&device_mutex);
+	int device_depth = bus_write_lock();
 	for (int i = 0; i < MAX_DEVICES; i++) {
 		if (devices[i] == NULL) {
 			devices[i] = device;
-			pthread_mutex_unlock(&device_mutex);
+			index_device(i);
+			bus_write_unlock(device_depth);
 			if (device->attach != NULL)
 				device->last_result = device->attach(device);
 			if (device->change_property) {
@@ -364,134 +1352,239 @@ indigo_result indigo_attach_device(indigo_device *device) {
 			return INDIGO_OK;
 		}
 	}
-	pthread_mutex_unlock(&device_mutex);
+	bus_write_unlock(device_depth);
 	return INDIGO_TOO_MANY_ELEMENTS;
 }
 
 indigo_result indigo_attach_client(indigo_client *client) {
 	if ((!is_started) || (client == NULL))
 		return INDIGO_FAILED;
-	pthread_mutex_lock(&client_mutex);
+	int device_depth = bus_write_lock();
 	for (int i = 0; i < MAX_CLIENTS; i++) {
 		if (clients[i] == NULL) {
 			clients[i] = client;
-			pthread_mutex_unlock(&client_mutex);
+			bus_write_unlock(device_depth);
 			if (client->attach != NULL)
 				client->last_result = client->attach(client);
 			return INDIGO_OK;
 		}
 	}
-	pthread_mutex_unlock(&client_mutex);
+	bus_write_unlock(device_depth);
 	return INDIGO_TOO_MANY_ELEMENTS;
 }
 
 indigo_result indigo_detach_device(indigo_device *device) {
 	if ((!is_started) || (device == NULL))
 		return INDIGO_FAILED;
-	pthread_mutex_lock(&device_mutex);
-	for (int i = 0; i < MAX_DEVICES; i++) {
-		if (devices[i] == device) {
-			if (device->detach != NULL)
-				device->last_result = device->detach(device);
-			devices[i] = NULL;
-			pthread_mutex_unlock(&device_mutex);
-			return INDIGO_OK;
-		}
+	// device is removed from routing first, detach callback is called once no other thread can be inside of it
+	int device_depth = bus_write_lock();
+	int slot = device_slot(device);
+	if (slot >= 0) {
+		unindex_device(slot);
+		devices[slot] = NULL;
 	}
-	pthread_mutex_unlock(&device_mutex);
+	bus_write_unlock(device_depth);
+	if (slot >= 0 && device->detach != NULL)
+		device->last_result = device->detach(device);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_detach_client(indigo_client *client) {
 	if ((!is_started) || (client == NULL))
 		return INDIGO_FAILED;
-	pthread_mutex_lock(&client_mutex);
+	int device_depth = bus_write_lock();
 	for (int i = 0; i < MAX_CLIENTS; i++) {
 		if (clients[i] == client) {
 			clients[i] = NULL;
-			pthread_mutex_unlock(&client_mutex);
+			bus_write_unlock(device_depth);
+			release_client_queue(client);
 			if (client->detach != NULL)
 				client->last_result = client->detach(client);
 			return INDIGO_OK;
 		}
 	}
-	pthread_mutex_unlock(&client_mutex);
+	bus_write_unlock(device_depth);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_enumerate_properties(indigo_client *client, indigo_property *property) {
 	if (!is_started)
 		return INDIGO_FAILED;
-	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+	if (indigo_use_strict_locking) {
+		bus_read_lock();
+		device_lock();
+	}
 	INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property enumeration request", property, false, true));
-	for (int i = 0; i < MAX_DEVICES; i++) {
-		indigo_device *device = devices[i];
-		if (device != NULL && device->enumerate_properties != NULL) {
-			bool route = *property->device == 0;
-			route = route || !strcmp(property->device, device->name);
-			route = route || (indigo_use_host_suffix && *device->name == '@' && strstr(property->device, device->name));
-			route = route || (!indigo_use_host_suffix && *device->name == '@');
-			if (route)
-				device->last_result = device->enumerate_properties(device, client, property);
-		}
+	indigo_device *targets[MAX_DEVICES];
+	int count = route_property(property, targets);
+	for (int i = 0; i < count; i++) {
+		indigo_device *device = targets[i];
+		if (device->enumerate_properties != NULL)
+			device->last_result = device->enumerate_properties(device, client, property);
+	}
+	if (indigo_use_strict_locking) {
+		device_unlock();
+		bus_read_unlock();
 	}
-	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_change_property(indigo_client *client, indigo_property *property) {
 	if ((!is_started) || (property == NULL) || (property->perm == INDIGO_RO_PERM))
 		return INDIGO_FAILED;
-	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+	if (indigo_use_strict_locking) {
+		bus_read_lock();
+		device_lock();
+	}
 	INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property change request", property, false, true));
-	for (int i = 0; i < MAX_DEVICES; i++) {
-		indigo_device *device = devices[i];
-		if (device != NULL && device->change_property != NULL) {
-			bool route = *property->device == 0;
-			route = route || !strcmp(property->device, device->name);
-			route = route || (indigo_use_host_suffix && *device->name == '@' && strstr(property->device, device->name));
-			route = route || (!indigo_use_host_suffix && *device->name == '@');
-			if (route)
-				device->last_result = device->change_property(device, client, property);
-		}
+	indigo_device *targets[MAX_DEVICES];
+	int count = route_property(property, targets);
+	for (int i = 0; i < count; i++) {
+		indigo_device *device = targets[i];
+		if (device->change_property != NULL)
+			device->last_result = device->change_property(device, client, property);
+	}
+	if (indigo_use_strict_locking) {
+		device_unlock();
+		bus_read_unlock();
 	}
-	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_enable_blob(indigo_client *client, indigo_property *property, indigo_enable_blob_mode mode) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
-	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+	if (indigo_use_strict_locking) {
+		bus_read_lock();
+		device_lock();
+	}
 	INDIGO_TRACE(indigo_trace_property("INDIGO Bus: enable BLOB mode change request", property, false, true));
-	for (int i = 0; i < MAX_DEVICES; i++) {
-		indigo_device *device = devices[i];
-		if (device != NULL && device->enable_blob != NULL) {
-			bool route = *property->device == 0;
-			route = route || !strcmp(property->device, device->name);
-			route = route || (indigo_use_host_suffix && *device->name == '@' && strstr(property->device, device->name));
-			route = route || (!indigo_use_host_suffix && *device->name == '@');
-			if (route)
-				device->last_result = device->enable_blob(device, client, property, mode);
-		}
+	indigo_device *targets[MAX_DEVICES];
+	int count = route_property(property, targets);
+	for (int i = 0; i < count; i++) {
+		indigo_device *device = targets[i];
+		if (device->enable_blob != NULL)
+			device->last_result = device->enable_blob(device, client, property, mode);
+	}
+	if (indigo_use_strict_locking) {
+		device_unlock();
+		bus_read_unlock();
 	}
-	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
 	return INDIGO_OK;
 }
 
+static long shadow_value_size(indigo_property_type type) {
+	return type == INDIGO_TEXT_VECTOR ? INDIGO_VALUE_SIZE : 2 * sizeof(double);
+}
+
+static bool update_shadow_value(indigo_property_type type, indigo_item *item, char *value) {
+	// returns true if the shadow value differs from item value
+	switch (type) {
+		case INDIGO_TEXT_VECTOR:
+			if (!strncmp(value, item->text.value, INDIGO_VALUE_SIZE))
+				return false;
+			strncpy(value, item->text.value, INDIGO_VALUE_SIZE);
+			return true;
+		case INDIGO_NUMBER_VECTOR: {
+			double number[2] = { item->number.value, item->number.target };
+			if (!memcmp(value, number, sizeof(number)))
+				return false;
+			memcpy(value, number, sizeof(number));
+			return true;
+		}
+		case INDIGO_SWITCH_VECTOR:
+			if (*value == item->sw.value)
+				return false;
+			*value = item->sw.value;
+			return true;
+		case INDIGO_LIGHT_VECTOR:
+			if (memcmp(value, &item->light.value, sizeof(item->light.value)) == 0)
+				return false;
+			memcpy(value, &item->light.value, sizeof(item->light.value));
+			return true;
+		default:
+			return true;
+	}
+}
+
+static property_shadow **find_shadow(indigo_property *property) {
+	property_shadow **shadow = &shadow_hash[((uintptr_t)property >> 4) % SHADOW_HASH_SIZE];
+	while (*shadow != NULL && (*shadow)->property != property)
+		shadow = &(*shadow)->next;
+	return shadow;
+}
+
+static void track_changes(indigo_property *property, bool define) {
+	// flags items changed since the previous definition or update, partial updates are not used for BLOBs and for switches cleared by remote side
+	property->partial = false;
+	if (!indigo_use_delta_updates || property->type == INDIGO_BLOB_VECTOR || property->perm == INDIGO_WO_PERM)
+		return;
+	pthread_mutex_lock(&shadow_mutex);
+	property_shadow **slot = find_shadow(property);
+	property_shadow *shadow = *slot;
+	if (shadow != NULL && (shadow->type != property->type || shadow->count != property->count || strcmp(shadow->device, property->device) || strcmp(shadow->name, property->name))) {
+		// address reused by another property
+		*slot = shadow->next;
+		free(shadow);
+		shadow = NULL;
+	}
+	long value_size = shadow_value_size(property->type);
+	bool known = shadow != NULL;
+	if (!known) {
+		shadow = malloc(sizeof(property_shadow) + property->count * value_size);
+		assert(shadow != NULL);
+		memset(shadow, 0, sizeof(property_shadow) + property->count * value_size);
+		shadow->property = property;
+		strncpy(shadow->device, property->device, INDIGO_NAME_SIZE);
+		strncpy(shadow->name, property->name, INDIGO_NAME_SIZE);
+		shadow->type = property->type;
+		shadow->count = property->count;
+		shadow->next = *slot;
+		*slot = shadow;
+	}
+	for (int i = 0; i < property->count; i++)
+		property->items[i].changed = update_shadow_value(property->type, property->items + i, shadow->values + i * value_size) || !known || define;
+	property->partial = known && !define && (property->type != INDIGO_SWITCH_VECTOR || property->rule == INDIGO_ANY_OF_MANY_RULE);
+	pthread_mutex_unlock(&shadow_mutex);
+}
+
+static void forget_changes(indigo_device *device, indigo_property *property) {
+	if (!indigo_use_delta_updates)
+		return;
+	pthread_mutex_lock(&shadow_mutex);
+	if (*property->name) {
+		property_shadow **slot = find_shadow(property);
+		if (*slot) {
+			property_shadow *shadow = *slot;
+			*slot = shadow->next;
+			free(shadow);
+		}
+	} else {
+		const char *device_name = *property->device || device == NULL ? property->device : device->name;
+		for (int i = 0; i < SHADOW_HASH_SIZE; i++) {
+			property_shadow **slot = &shadow_hash[i];
+			while (*slot) {
+				property_shadow *shadow = *slot;
+				if (!strcmp(shadow->device, device_name)) {
+					*slot = shadow->next;
+					free(shadow);
+				} else {
+					slot = &shadow->next;
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&shadow_mutex);
+}
+
 indigo_result indigo_define_property(indigo_device *device, indigo_property *property, const char *format, ...) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		bus_read_lock();
 	if (!property->hidden) {
 		INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property definition", property, true, true));
+		track_changes(property, true);
 		char message[INDIGO_VALUE_SIZE];
 		if (format != NULL) {
 			va_list args;
@@ -499,14 +1592,10 @@ indigo_result indigo_define_property(indigo_device *device, indigo_property *pro
 			vsnprintf(message, INDIGO_VALUE_SIZE, format, args);
 			va_end(args);
 		}
-		for (int i = 0; i < MAX_CLIENTS; i++) {
-			indigo_client *client = clients[i];
-			if (client != NULL && client->define_property != NULL)
-				client->last_result = client->define_property(client, device, property, format != NULL ? message : NULL);
-		}
+		fan_out(DEFINE_PROPERTY, device, property, format != NULL ? message : NULL);
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		bus_read_unlock();
 	return INDIGO_OK;
 }
 
@@ -514,13 +1603,14 @@ indigo_result indigo_update_property(indigo_device *device, indigo_property *pro
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		bus_read_lock();
 	if (!property->hidden) {
 		char message[INDIGO_VALUE_SIZE];
 		int count = property->count;
 		if (property->perm == INDIGO_WO_PERM)
 			property->count = 0;
 		INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property update", property, false, true));
+		track_changes(property, false);
 		if (format != NULL) {
 			va_list args;
 			va_start(args, format);
@@ -528,48 +1618,20 @@ indigo_result indigo_update_property(indigo_device *device, indigo_property *pro
 			va_end(args);
 		}
 		if (indigo_use_blob_caching && property->type == INDIGO_BLOB_VECTOR && property->state == INDIGO_OK_STATE) {
-			pthread_mutex_lock(&blob_mutex);
 			for (int i = 0; i < property->count; i++) {
-				indigo_item *item = property->items + i;
-				indigo_blob_entry *entry = NULL;
-				int free_index = -1;
-				for (int j = 0; j < MAX_BLOBS; j++) {
-					entry = blobs[j];
-					if (entry && entry->item == item) {
-						break;
-					}
-					if (entry == NULL && free_index == -1)
-						free_index = j;
-					entry = NULL;
-				}
-				if (entry == NULL && free_index >= 0) {
-					blobs[free_index] = entry = malloc(sizeof(indigo_blob_entry));
-					memset(entry, 0, sizeof(indigo_blob_entry));
-					entry->item = item;
-					pthread_mutex_init(&entry->mutext, NULL);
-				}
-				if (entry) {
-					entry->content = realloc(entry->content, entry->size = item->blob.size);
-					memcpy(entry->content, item->blob.value, entry->size);
-					strcpy(entry->format, item->blob.format);
-				} else {
-					pthread_mutex_unlock(&blob_mutex);
+				if (!cache_blob_item(property->items + i)) {
+					property->count = count;
 					if (indigo_use_strict_locking)
-						pthread_mutex_unlock(&client_mutex);
-					return INDIGO_TOO_MANY_ELEMENTS;
+						bus_read_unlock();
+					return INDIGO_FAILED;
 				}
 			}
-			pthread_mutex_unlock(&blob_mutex);
-		}
-		for (int i = 0; i < MAX_CLIENTS; i++) {
-			indigo_client *client = clients[i];
-			if (client != NULL && client->update_property != NULL)
-				client->last_result = client->update_property(client, device, property, format != NULL ? message : NULL);
 		}
+		fan_out(UPDATE_PROPERTY, device, property, format != NULL ? message : NULL);
 		property->count = count;
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		bus_read_unlock();
 	return INDIGO_OK;
 }
 
@@ -577,24 +1639,21 @@ indigo_result indigo_delete_property(indigo_device *device, indigo_property *pro
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		bus_read_lock();
 	if (!property->hidden) {
 		char message[INDIGO_VALUE_SIZE];
 		INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property removal", property, false, false));
+		forget_changes(device, property);
 		if (format != NULL) {
 			va_list args;
 			va_start(args, format);
 			vsnprintf(message, INDIGO_VALUE_SIZE, format, args);
 			va_end(args);
 		}
-		for (int i = 0; i < MAX_CLIENTS; i++) {
-			indigo_client *client = clients[i];
-			if (client != NULL && client->delete_property != NULL)
-				client->last_result = client->delete_property(client, device, property, format != NULL ? message : NULL);
-		}
+		fan_out(DELETE_PROPERTY, device, property, format != NULL ? message : NULL);
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		bus_read_unlock();
 	return INDIGO_OK;
 }
 
@@ -602,7 +1661,7 @@ indigo_result indigo_send_message(indigo_device *device, const char *format, ...
 	if (!is_started)
 		return INDIGO_FAILED;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		bus_read_lock();
 	char message[INDIGO_VALUE_SIZE];
 	if (format != NULL) {
 		va_list args;
@@ -611,33 +1670,36 @@ indigo_result indigo_send_message(indigo_device *device, const char *format, ...
 		va_end(args);
 	}
 	INDIGO_DEBUG(indigo_debug("INDIGO Bus: message sent '%s'", message));
-	for (int i = 0; i < MAX_CLIENTS; i++) {
-		indigo_client *client = clients[i];
-		if (client != NULL && client->send_message != NULL)
-			client->last_result = client->send_message(client, device, format != NULL ? message : NULL);
-	}
+	fan_out(SEND_MESSAGE, device, NULL, format != NULL ? message : NULL);
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		bus_read_unlock();
 	return INDIGO_OK;
 }
 
 indigo_result indigo_stop() {
-	pthread_mutex_lock(&device_mutex);
-	pthread_mutex_lock(&client_mutex);
-	if (is_started) {
-		is_started = false;
-		for (int i = 0; i < MAX_CLIENTS; i++) {
-			indigo_client *client = clients[i];
-			if (client != NULL && client->detach != NULL)
+	indigo_client *detached_clients[MAX_CLIENTS];
+	indigo_device *detached_devices[MAX_DEVICES];
+	int device_depth = bus_write_lock();
+	if (!is_started) {
+		bus_write_unlock(device_depth);
+		return INDIGO_OK;
+	}
+	is_started = false;
+	memcpy(detached_clients, clients, sizeof(clients));
+	memcpy(detached_devices, devices, sizeof(devices));
+	bus_write_unlock(device_depth);
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		indigo_client *client = detached_clients[i];
+		if (client != NULL) {
+			release_client_queue(client);
+			if (client->detach != NULL)
 				client->last_result = client->detach(client);
 		}
-		for (int i = 0; i < MAX_DEVICES; i++) {
-			indigo_device *device = devices[i];
-			if (device != NULL && device->detach != NULL)
-				device->last_result = device->detach(device);
-		}
-		pthread_mutex_unlock(&client_mutex);
-		pthread_mutex_unlock(&device_mutex);
+	}
+	for (int i = 0; i < MAX_DEVICES; i++) {
+		indigo_device *device = detached_devices[i];
+		if (device != NULL && device->detach != NULL)
+			device->last_result = device->detach(device);
 	}
 	return INDIGO_OK;
 }
@@ -764,20 +1826,10 @@ void indigo_release_property(indigo_property *property) {
 	if (property->type == INDIGO_BLOB_VECTOR) {
 		pthread_mutex_lock(&blob_mutex);
 		for (int i = 0; i < property->count; i++) {
-			indigo_item *item = property->items + i;
-			for (int j = 0; j < MAX_BLOBS; j++) {
-				indigo_blob_entry *entry = blobs[j];
-				if (entry && entry->item == item) {
-					pthread_mutex_lock(&entry->mutext);
-					if (entry->content) {
-						free(entry->content);
-					}
-					pthread_mutex_unlock(&entry->mutext);
-					pthread_mutex_destroy(&entry->mutext);
-					free(entry);
-					blobs[j] = NULL;
-					break;
-				}
+			indigo_blob_entry *entry = find_blob_entry(property->items + i);
+			if (entry) {
+				unlink_blob_entry(entry);
+				release_blob_entry(entry);
 			}
 		}
 		pthread_mutex_unlock(&blob_mutex);
@@ -786,12 +1838,23 @@ void indigo_release_property(indigo_property *property) {
 }
 
 indigo_blob_entry *indigo_validate_blob(indigo_item *item) {
-	for (int j = 0; j < MAX_BLOBS; j++) {
-		indigo_blob_entry *entry = blobs[j];
-		if (entry && entry->item == item)
-			return entry;
+	pthread_mutex_lock(&blob_mutex);
+	indigo_blob_entry *entry = find_blob_entry(item);
+	if (entry) {
+		entry->ref_count++;
+		unlink_blob_entry(entry);
+		link_blob_entry(entry);
 	}
-	return NULL;
+	pthread_mutex_unlock(&blob_mutex);
+	return entry;
+}
+
+void indigo_release_blob_entry(indigo_blob_entry *entry) {
+	if (entry == NULL)
+		return;
+	pthread_mutex_lock(&blob_mutex);
+	release_blob_entry(entry);
+	pthread_mutex_unlock(&blob_mutex);
 }
 
 void indigo_init_text_item(indigo_item *item, const char *name, const char *label, const char *format, ...) {
@@ -853,6 +1916,61 @@ void *indigo_alloc_blob_buffer(long size) {
 	return malloc(size);
 }
 
+void *indigo_alloc_shared_blob_buffer(long size) {
+	blob_buffer *buffer = malloc(sizeof(blob_buffer));
+	if (buffer == NULL)
+		return NULL;
+	int mod2880 = size % 2880;
+	buffer->capacity = mod2880 ? size + 2880 - mod2880 : size;
+	buffer->data = malloc(buffer->capacity);
+	if (buffer->data == NULL) {
+		free(buffer);
+		return NULL;
+	}
+	buffer->ref_count = 1;
+	pthread_mutex_lock(&blob_mutex);
+	buffer->next = shared_blob_buffers;
+	shared_blob_buffers = buffer;
+	pthread_mutex_unlock(&blob_mutex);
+	return buffer->data;
+}
+
+void *indigo_retain_blob_buffer(void *data) {
+	pthread_mutex_lock(&blob_mutex);
+	blob_buffer *buffer = find_blob_buffer(data, 0);
+	if (buffer)
+		buffer->ref_count++;
+	pthread_mutex_unlock(&blob_mutex);
+	return buffer ? data : NULL;
+}
+
+void indigo_release_blob_buffer(void *data) {
+	pthread_mutex_lock(&blob_mutex);
+	blob_buffer *buffer = find_blob_buffer(data, 0);
+	if (buffer)
+		release_blob_buffer(buffer);
+	pthread_mutex_unlock(&blob_mutex);
+}
+
+void *indigo_claim_blob_buffer(void *data) {
+	pthread_mutex_lock(&blob_mutex);
+	blob_buffer *buffer = find_blob_buffer(data, 0);
+	if (buffer == NULL || buffer->ref_count == 1) {
+		pthread_mutex_unlock(&blob_mutex);
+		return data;
+	}
+	long capacity = buffer->capacity;
+	pthread_mutex_unlock(&blob_mutex);
+	// previous content is still read by BLOB cache or HTTP clients, new one goes to a fresh buffer
+	void *fresh = indigo_alloc_shared_blob_buffer(capacity);
+	if (fresh == NULL)
+		return data;
+	pthread_mutex_lock(&blob_mutex);
+	release_blob_buffer(buffer);
+	pthread_mutex_unlock(&blob_mutex);
+	return fresh;
+}
+
 bool indigo_populate_http_blob_item(indigo_item *blob_item) {
 	char host[BUFFER_SIZE] = {0};
 	int port = 80;
@@ -876,6 +1994,7 @@ bool indigo_populate_http_blob_item(indigo_item *blob_item) {
 	if (socket < 0) {
 		return false;
 	}
+	indigo_enable_read_buffer(socket, 0);
 
 	snprintf(request, BUFFER_SIZE, "GET /%s HTTP/1.1\r\n\r\n", file);
 	res = indigo_write(socket, request, strlen(request));
@@ -893,10 +2012,12 @@ bool indigo_populate_http_blob_item(indigo_item *blob_item) {
 		INDIGO_DEBUG(indigo_debug("%s(): http_line = \"%s\"", __FUNCTION__, http_line));
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
 		shutdown(socket, SHUT_RDWR);
+		indigo_disable_read_buffer(socket);
 		close(socket);
 #endif
 #if defined(INDIGO_WINDOWS)
 		shutdown(socket, SD_BOTH);
+		indigo_disable_read_buffer(socket);
 		closesocket(socket);
 #endif
 		return false;
@@ -929,10 +2050,12 @@ bool indigo_populate_http_blob_item(indigo_item *blob_item) {
 	INDIGO_DEBUG(indigo_debug("%s() -> %s", __FUNCTION__, res ? "OK" : "Failed"));
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
 	shutdown(socket, SHUT_RDWR);
+	indigo_disable_read_buffer(socket);
 	close(socket);
 #endif
 #if defined(INDIGO_WINDOWS)
 	shutdown(socket, SD_BOTH);
+	indigo_disable_read_buffer(socket);
 	closesocket(socket);
 #endif
 	return res;
@@ -0,0 +1,384 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary star/DSO catalog with spatial index
+ \file indigo_catalog.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#if defined(INDIGO_WINDOWS)
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#pragma warning(disable:4996)
+#endif
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_catalog.h>
+
+#define DEG2RAD	(M_PI / 180.0)
+
+// file layout: header, zone index (zones + 1 entry offsets), records ordered by zone and RA, string table (offset 0 is empty string), host byte order
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	uint32_t zones;
+	uint32_t strings_size;
+	double epoch;
+	uint32_t source_hash;
+	uint32_t reserved[7];
+} catalog_header;
+
+typedef struct {
+	uint32_t ra;										///< 2^32 per 24h
+	int32_t dec;										///< 2^31 - 1 per 90 deg
+	float promora, promodec, px, rv;
+	int16_t mag;										///< 0.01 mag
+	uint16_t reserved;
+	uint32_t id;
+	uint32_t designation;						///< string table offset
+	uint32_t name;									///< string table offset
+} catalog_record;
+
+struct indigo_catalog {
+	unsigned char *data;						///< file image
+	size_t size;
+	catalog_header *header;
+	uint32_t *zone_start;
+	catalog_record *records;
+	char *strings;
+};
+
+typedef struct {
+	uint32_t zone;
+	uint32_t ra;
+	int index;
+} catalog_key;
+
+static inline uint32_t encode_ra(double ra) {
+	double turns = ra / 24.0;
+	turns -= floor(turns);
+	return (uint32_t)(uint64_t)(turns * 4294967296.0 + 0.5);
+}
+
+static inline double decode_ra(uint32_t ra) {
+	return ra * (24.0 / 4294967296.0);
+}
+
+static inline int32_t encode_dec(double dec) {
+	if (dec > 90)
+		dec = 90;
+	else if (dec < -90)
+		dec = -90;
+	return (int32_t)lround(dec / 90.0 * 2147483647.0);
+}
+
+static inline double decode_dec(int32_t dec) {
+	return dec * (90.0 / 2147483647.0);
+}
+
+static inline uint32_t zone_of(double dec, uint32_t zones) {
+	int zone = (int)floor((dec + 90.0) / 180.0 * zones);
+	if (zone < 0)
+		return 0;
+	if (zone >= (int)zones)
+		return zones - 1;
+	return zone;
+}
+
+static int compare_keys(const void *a, const void *b) {
+	const catalog_key *key_a = a, *key_b = b;
+	if (key_a->zone != key_b->zone)
+		return key_a->zone < key_b->zone ? -1 : 1;
+	if (key_a->ra != key_b->ra)
+		return key_a->ra < key_b->ra ? -1 : 1;
+	return key_a->index - key_b->index;
+}
+
+static bool map_catalog(indigo_catalog *catalog) {
+	if (catalog->size < sizeof(catalog_header))
+		return false;
+	catalog_header *header = catalog->header = (catalog_header *)catalog->data;
+	if (memcmp(header->magic, INDIGO_CATALOG_MAGIC, sizeof(header->magic)) || header->version != INDIGO_CATALOG_VERSION || header->zones == 0 || header->strings_size == 0)
+		return false;
+	size_t size = sizeof(catalog_header) + (header->zones + 1) * sizeof(uint32_t) + (size_t)header->count * sizeof(catalog_record) + header->strings_size;
+	if (size != catalog->size)
+		return false;
+	catalog->zone_start = (uint32_t *)(catalog->data + sizeof(catalog_header));
+	catalog->records = (catalog_record *)(catalog->zone_start + header->zones + 1);
+	catalog->strings = (char *)(catalog->records + header->count);
+	if (catalog->zone_start[0] != 0 || catalog->zone_start[header->zones] != header->count || catalog->strings[header->strings_size - 1] != 0)
+		return false;
+	for (uint32_t zone = 0; zone < header->zones; zone++) {
+		if (catalog->zone_start[zone] > catalog->zone_start[zone + 1])
+			return false;
+	}
+	for (uint32_t i = 0; i < header->count; i++) {
+		if (catalog->records[i].designation >= header->strings_size || catalog->records[i].name >= header->strings_size)
+			return false;
+	}
+	return true;
+}
+
+indigo_catalog *indigo_catalog_create(const indigo_catalog_entry *entries, int count, double epoch, uint32_t source_hash) {
+	size_t strings_size = 1;
+	for (int i = 0; i < count; i++) {
+		if (entries[i].designation && *entries[i].designation)
+			strings_size += strlen(entries[i].designation) + 1;
+		if (entries[i].name && *entries[i].name)
+			strings_size += strlen(entries[i].name) + 1;
+	}
+	catalog_key *keys = malloc(count * sizeof(catalog_key));
+	indigo_catalog *catalog = malloc(sizeof(indigo_catalog));
+	catalog->size = sizeof(catalog_header) + (INDIGO_CATALOG_ZONES + 1) * sizeof(uint32_t) + (size_t)count * sizeof(catalog_record) + strings_size;
+	catalog->data = calloc(1, catalog->size);
+	if (keys == NULL || catalog->data == NULL) {
+		indigo_error("Failed to allocate catalog");
+		free(keys);
+		free(catalog->data);
+		free(catalog);
+		return NULL;
+	}
+	catalog_header *header = (catalog_header *)catalog->data;
+	memcpy(header->magic, INDIGO_CATALOG_MAGIC, sizeof(header->magic));
+	header->version = INDIGO_CATALOG_VERSION;
+	header->count = count;
+	header->zones = INDIGO_CATALOG_ZONES;
+	header->strings_size = (uint32_t)strings_size;
+	header->epoch = epoch;
+	header->source_hash = source_hash;
+	map_catalog(catalog);
+	for (int i = 0; i < count; i++) {
+		keys[i].zone = zone_of(entries[i].dec, INDIGO_CATALOG_ZONES);
+		keys[i].ra = encode_ra(entries[i].ra);
+		keys[i].index = i;
+	}
+	qsort(keys, count, sizeof(catalog_key), compare_keys);
+	uint32_t string_offset = 1;
+	int zone = 0;
+	for (int i = 0; i < count; i++) {
+		const indigo_catalog_entry *entry = entries + keys[i].index;
+		catalog_record *record = catalog->records + i;
+		while (zone <= (int)keys[i].zone)
+			catalog->zone_start[zone++] = i;
+		record->ra = keys[i].ra;
+		record->dec = encode_dec(entry->dec);
+		record->promora = (float)entry->promora;
+		record->promodec = (float)entry->promodec;
+		record->px = (float)entry->px;
+		record->rv = (float)entry->rv;
+		record->mag = (int16_t)lround(entry->mag * 100);
+		record->id = entry->id;
+		if (entry->designation && *entry->designation) {
+			record->designation = string_offset;
+			strcpy(catalog->strings + string_offset, entry->designation);
+			string_offset += (uint32_t)strlen(entry->designation) + 1;
+		}
+		if (entry->name && *entry->name) {
+			record->name = string_offset;
+			strcpy(catalog->strings + string_offset, entry->name);
+			string_offset += (uint32_t)strlen(entry->name) + 1;
+		}
+	}
+	while (zone <= INDIGO_CATALOG_ZONES)
+		catalog->zone_start[zone++] = count;
+	free(keys);
+	return catalog;
+}
+
+indigo_catalog *indigo_catalog_load(const char *path) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return NULL;
+	indigo_catalog *catalog = calloc(1, sizeof(indigo_catalog));
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size > 0 && (catalog->data = malloc(size)) && fread(catalog->data, 1, size, file) == (size_t)size) {
+		catalog->size = size;
+		if (map_catalog(catalog)) {
+			fclose(file);
+			INDIGO_DEBUG(indigo_debug("Catalog %s loaded (%d entries)", path, catalog->header->count));
+			return catalog;
+		}
+	}
+	indigo_error("Catalog %s is not valid", path);
+	fclose(file);
+	indigo_catalog_free(catalog);
+	return NULL;
+}
+
+bool indigo_catalog_save(const indigo_catalog *catalog, const char *path) {
+	char tmp_path[1024];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	FILE *file = fopen(tmp_path, "wb");
+	if (file == NULL) {
+		indigo_error("Can't create %s (%s)", tmp_path, strerror(errno));
+		return false;
+	}
+	bool result = fwrite(catalog->data, 1, catalog->size, file) == catalog->size;
+	result = fclose(file) == 0 && result;
+	if (result && rename(tmp_path, path) == 0)
+		return true;
+	indigo_error("Can't write %s (%s)", path, strerror(errno));
+	remove(tmp_path);
+	return false;
+}
+
+void indigo_catalog_free(indigo_catalog *catalog) {
+	if (catalog) {
+		free(catalog->data);
+		free(catalog);
+	}
+}
+
+int indigo_catalog_count(const indigo_catalog *catalog) {
+	return catalog->header->count;
+}
+
+double indigo_catalog_epoch(const indigo_catalog *catalog) {
+	return catalog->header->epoch;
+}
+
+uint32_t indigo_catalog_source_hash(const indigo_catalog *catalog) {
+	return catalog->header->source_hash;
+}
+
+static void decode_record(const indigo_catalog *catalog, const catalog_record *record, indigo_catalog_entry *entry) {
+	entry->ra = decode_ra(record->ra);
+	entry->dec = decode_dec(record->dec);
+	entry->promora = record->promora;
+	entry->promodec = record->promodec;
+	entry->px = record->px;
+	entry->rv = record->rv;
+	entry->mag = record->mag / 100.0f;
+	entry->id = record->id;
+	entry->designation = catalog->strings + record->designation;
+	entry->name = catalog->strings + record->name;
+}
+
+bool indigo_catalog_get(const indigo_catalog *catalog, int index, indigo_catalog_entry *entry) {
+	if (index < 0 || index >= (int)catalog->header->count)
+		return false;
+	decode_record(catalog, catalog->records + index, entry);
+	return true;
+}
+
+static uint32_t lower_bound(const catalog_record *records, uint32_t start, uint32_t end, uint32_t ra) {
+	while (start < end) {
+		uint32_t middle = start + (end - start) / 2;
+		if (records[middle].ra < ra)
+			start = middle + 1;
+		else
+			end = middle;
+	}
+	return start;
+}
+
+static uint32_t upper_bound(const catalog_record *records, uint32_t start, uint32_t end, uint32_t ra) {
+	while (start < end) {
+		uint32_t middle = start + (end - start) / 2;
+		if (records[middle].ra <= ra)
+			start = middle + 1;
+		else
+			end = middle;
+	}
+	return start;
+}
+
+int indigo_catalog_cone(const indigo_catalog *catalog, double ra, double dec, double radius, double max_mag, indigo_catalog_entry *result, int max_count) {
+	const uint32_t zones = catalog->header->zones;
+	const double cos_radius = cos(radius * DEG2RAD);
+	const double x = cos(dec * DEG2RAD) * cos(ra * 15 * DEG2RAD), y = cos(dec * DEG2RAD) * sin(ra * 15 * DEG2RAD), z = sin(dec * DEG2RAD);
+	const int16_t mag_limit = max_mag >= 327 ? INT16_MAX : (int16_t)lround(max_mag * 100);
+	// RA half width of the cone at the zone closest to the pole, the whole zone is scanned if the cone contains pole
+	bool full = false;
+	uint32_t half_width = 0;
+	if (radius >= 90 || fabs(dec) + radius >= 90) {
+		full = true;
+	} else {
+		double sin_half_width = sin(radius * DEG2RAD) / cos((fabs(dec) + radius) * DEG2RAD);
+		if (sin_half_width >= 1)
+			full = true;
+		else
+			half_width = (uint32_t)(asin(sin_half_width) / (2 * M_PI) * 4294967296.0) + 1024;
+	}
+	uint32_t center = encode_ra(ra);
+	uint32_t first_zone = zone_of(dec - radius, zones), last_zone = zone_of(dec + radius, zones);
+	int found = 0;
+	for (uint32_t zone = first_zone; zone <= last_zone; zone++) {
+		uint32_t start = catalog->zone_start[zone], end = catalog->zone_start[zone + 1];
+		uint32_t ranges[2][2];
+		int range_count = 1;
+		if (full) {
+			ranges[0][0] = start;
+			ranges[0][1] = end;
+		} else {
+			uint32_t low = center - half_width, high = center + half_width;
+			if (low <= high) {
+				ranges[0][0] = lower_bound(catalog->records, start, end, low);
+				ranges[0][1] = upper_bound(catalog->records, start, end, high);
+			} else {
+				// RA interval wraps around 0h
+				ranges[0][0] = lower_bound(catalog->records, start, end, low);
+				ranges[0][1] = end;
+				ranges[1][0] = start;
+				ranges[1][1] = upper_bound(catalog->records, start, end, high);
+				range_count = 2;
+			}
+		}
+		for (int r = 0; r < range_count; r++) {
+			for (uint32_t i = ranges[r][0]; i < ranges[r][1]; i++) {
+				const catalog_record *record = catalog->records + i;
+				if (record->mag > mag_limit)
+					continue;
+				double record_ra = decode_ra(record->ra) * 15 * DEG2RAD, record_dec = decode_dec(record->dec) * DEG2RAD;
+				double dot = cos(record_dec) * (x * cos(record_ra) + y * sin(record_ra)) + z * sin(record_dec);
+				if (dot < cos_radius)
+					continue;
+				if (found < max_count)
+					decode_record(catalog, record, result + found);
+				found++;
+			}
+		}
+	}
+	return found;
+}
+
+bool indigo_catalog_cache_path(const char *file_name, char *path, int size) {
+	const char *home = getenv("HOME");
+	if (home == NULL)
+		return false;
+	snprintf(path, size, "%s/.indigo", home);
+	if (mkdir(path, 0777) != 0 && errno != EEXIST)
+		return false;
+	int length = snprintf(path, size, "%s/.indigo/cache", home);
+	if (mkdir(path, 0777) != 0 && errno != EEXIST)
+		return false;
+	return snprintf(path + length, size - length, "/%s", file_name) < size - length;
+}
@@ -23,6 +23,10 @@
  \file indigo_ccd_driver.c
  */
 
+#if defined(INDIGO_LINUX)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -32,12 +36,362 @@
 #include <errno.h>
 #include <time.h>
 #include <math.h>
+#include <stdarg.h>
 #include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <jpeglib.h>
 
 #include <indigo/indigo_ccd_driver.h>
 #include <indigo/indigo_io.h>
+#include <indigo/indigo_compression.h>
+
+#define CCD_WRITER_QUEUE_SIZE				4
+#define CCD_WRITER_SYNC_BATCH				16
+#define CCD_WRITER_DIRECT_THRESHOLD	(16L * 1024 * 1024)
+#define CCD_WRITER_ALIGNMENT				4096
+
+#define CCD_SOFTWARE_BIN_MAX				16
+
+typedef enum {
+	WRITER_SYNC_NONE,
+	WRITER_SYNC_FRAME,
+	WRITER_SYNC_IDLE
+} writer_sync;
+
+typedef struct writer_sequence {
+	char head[INDIGO_VALUE_SIZE];
+	char tail[INDIGO_VALUE_SIZE];
+	int next;
+	struct writer_sequence *next_sequence;
+} writer_sequence;
+
+typedef struct {
+	char head[INDIGO_VALUE_SIZE];		///< directory and prefix up to the placeholder or the whole file name
+	char tail[INDIGO_VALUE_SIZE];		///< prefix after the placeholder and suffix
+	int digits;											///< placeholder width, 0 if there is no placeholder
+	void *data;											///< aligned copy of the frame
+	long size;
+	writer_sync sync;
+	bool direct;
+	int generation;									///< exposure the frame belongs to
+} writer_job;
+
+struct indigo_ccd_writer {
+	indigo_device *device;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	writer_job queue[CCD_WRITER_QUEUE_SIZE];	///< the first job is the one being written
+	int first, count;
+	bool stop;
+	writer_sequence *sequences;								///< next free sequence number per directory and prefix
+	int unsynced[CCD_WRITER_SYNC_BATCH];			///< files kept open until the queue is empty in WRITER_SYNC_IDLE mode
+	int unsynced_count;
+	double bytes, seconds;
+	int published;														///< queue length last published in CCD_LOCAL_QUEUE
+	int generation;														///< incremented with each exposure started in local upload mode
+	bool busy;																///< CCD_IMAGE_FILE should be published as busy
+	bool failed;															///< CCD_IMAGE_FILE should be published as alert with failure message
+	char failure[INDIGO_VALUE_SIZE];
+};
+
+static double writer_time() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static writer_sequence *writer_get_sequence(indigo_ccd_writer *writer, writer_job *job) {
+	for (writer_sequence *sequence = writer->sequences; sequence; sequence = sequence->next_sequence) {
+		if (!strcmp(sequence->head, job->head) && !strcmp(sequence->tail, job->tail))
+			return sequence;
+	}
+	writer_sequence *sequence = malloc(sizeof(writer_sequence));
+	strcpy(sequence->head, job->head);
+	strcpy(sequence->tail, job->tail);
+	sequence->next = 1;
+	sequence->next_sequence = writer->sequences;
+	writer->sequences = sequence;
+	// directory is scanned only once, later frames just increment the counter
+	char dir[INDIGO_VALUE_SIZE] = ".";
+	const char *name = job->head;
+	const char *slash = strrchr(job->head, '/');
+	if (slash) {
+		snprintf(dir, sizeof(dir), "%.*s", (int)(slash - job->head + 1), job->head);
+		name = slash + 1;
+	}
+	if (strchr(job->tail, '/'))
+		return sequence;
+	DIR *folder = opendir(dir);
+	if (folder == NULL)
+		return sequence;
+	long name_length = strlen(name), tail_length = strlen(job->tail);
+	struct dirent *entry;
+	while ((entry = readdir(folder)) != NULL) {
+		long length = strlen(entry->d_name) - name_length - tail_length;
+		if (length < job->digits || length > 9 || strncmp(entry->d_name, name, name_length) || strcmp(entry->d_name + name_length + length, job->tail))
+			continue;
+		int number = 0;
+		for (const char *digit = entry->d_name + name_length; length > 0; digit++, length--) {
+			if (!isdigit(*digit)) {
+				number = -1;
+				break;
+			}
+			number = number * 10 + *digit - '0';
+		}
+		if (number >= sequence->next)
+			sequence->next = number + 1;
+	}
+	closedir(folder);
+	return sequence;
+}
+
+static int writer_open(indigo_ccd_writer *writer, writer_job *job, char *file_name) {
+	if (job->digits == 0) {
+		strcpy(file_name, job->head);
+		return open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	writer_sequence *sequence = writer_get_sequence(writer, job);
+	while (true) {
+		snprintf(file_name, INDIGO_VALUE_SIZE, "%s%0*d%s", job->head, job->digits, sequence->next, job->tail);
+		int handle = open(file_name, O_WRONLY | O_CREAT | O_EXCL, 0644);
+		if (handle >= 0 || errno != EEXIST) {
+			if (handle >= 0)
+				sequence->next++;
+			return handle;
+		}
+		// somebody else is writing to the same sequence
+		sequence->next++;
+	}
+}
+
+static bool writer_write(int handle, writer_job *job) {
+	const char *data = job->data;
+	long size = job->size;
+	if (job->direct && size >= CCD_WRITER_DIRECT_THRESHOLD) {
+#if defined(INDIGO_LINUX)
+		fallocate(handle, FALLOC_FL_KEEP_SIZE, 0, size);
+		int flags = fcntl(handle, F_GETFL);
+		if (flags != -1 && fcntl(handle, F_SETFL, flags | O_DIRECT) == 0) {
+			long aligned = size & ~(long)(CCD_WRITER_ALIGNMENT - 1);
+			bool result = indigo_write(handle, data, aligned);
+			fcntl(handle, F_SETFL, flags);
+			if (result) {
+				data += aligned;
+				size -= aligned;
+			} else if (errno != EINVAL || lseek(handle, 0, SEEK_SET) != 0) {
+				return false;
+			}
+		}
+#elif defined(INDIGO_MACOS)
+		fcntl(handle, F_NOCACHE, 1);
+#endif
+	}
+	return indigo_write(handle, data, size);
+}
+
+static void writer_sync_all(indigo_ccd_writer *writer) {
+	for (int i = 0; i < writer->unsynced_count; i++) {
+		fsync(writer->unsynced[i]);
+		close(writer->unsynced[i]);
+	}
+	writer->unsynced_count = 0;
+}
+
+static void writer_publish_queue(indigo_device *device, indigo_ccd_writer *writer, int count) {
+	// CCD_LOCAL_QUEUE is changed and published by the writer thread only, save_local() just signals it
+	writer->published = count;
+	CCD_LOCAL_QUEUE_QUEUED_ITEM->number.value = count;
+	CCD_LOCAL_QUEUE_THROUGHPUT_ITEM->number.value = writer->seconds > 0 ? round(writer->bytes / writer->seconds / 1e4) / 1e2 : 0;
+	indigo_update_property(device, CCD_LOCAL_QUEUE_PROPERTY, NULL);
+}
+
+static void *writer_thread(void *arg) {
+	// CCD_IMAGE_FILE is published by the writer thread only, so the result of a frame can't overtake busy state of the next exposure
+	indigo_ccd_writer *writer = arg;
+	indigo_device *device = writer->device;
+	pthread_mutex_lock(&writer->mutex);
+	while (true) {
+		while (writer->count == 0 && !writer->busy && !writer->failed && !writer->stop)
+			pthread_cond_wait(&writer->cond, &writer->mutex);
+		// busy state of a new exposure goes out immediately, failures only after results of frames queued before them
+		if (writer->busy || (writer->failed && writer->count == 0)) {
+			bool busy = writer->busy, failed = writer->failed;
+			char message[INDIGO_VALUE_SIZE];
+			strcpy(message, writer->failure);
+			writer->busy = writer->failed = false;
+			pthread_mutex_unlock(&writer->mutex);
+			if (busy && CCD_IMAGE_FILE_PROPERTY->state != INDIGO_BUSY_STATE) {
+				CCD_IMAGE_FILE_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, NULL);
+			}
+			if (failed) {
+				CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
+				indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, message);
+			}
+			pthread_mutex_lock(&writer->mutex);
+			continue;
+		}
+		if (writer->count == 0)
+			break;
+		writer_job *job = writer->queue + writer->first;
+		long size = job->size;
+		int generation = job->generation;
+		int queued = writer->count;
+		pthread_mutex_unlock(&writer->mutex);
+		if (queued != writer->published)
+			writer_publish_queue(device, writer, queued);
+		char file_name[INDIGO_VALUE_SIZE];
+		char *message = NULL;
+		double start = writer_time();
+		int handle = writer_open(writer, job, file_name);
+		if (handle >= 0) {
+			if (!writer_write(handle, job))
+				message = strerror(errno);
+			if (job->sync == WRITER_SYNC_FRAME)
+				fsync(handle);
+			if (job->sync == WRITER_SYNC_IDLE && message == NULL) {
+				if (writer->unsynced_count == CCD_WRITER_SYNC_BATCH)
+					writer_sync_all(writer);
+				writer->unsynced[writer->unsynced_count++] = handle;
+			} else {
+				close(handle);
+			}
+		} else {
+			message = strerror(errno);
+		}
+		free(job->data);
+		pthread_mutex_lock(&writer->mutex);
+		writer->first = (writer->first + 1) % CCD_WRITER_QUEUE_SIZE;
+		writer->count--;
+		pthread_cond_broadcast(&writer->cond);
+		int count = writer->count;
+		// each frame reports its file, the state is ok only after the frame of the last started exposure
+		bool last = count == 0 && generation == writer->generation && !writer->busy;
+		pthread_mutex_unlock(&writer->mutex);
+		if (count == 0)
+			writer_sync_all(writer);
+		writer->seconds += writer_time() - start;
+		if (message == NULL)
+			writer->bytes += size;
+		if (handle >= 0)
+			strncpy(CCD_IMAGE_FILE_ITEM->text.value, file_name, INDIGO_VALUE_SIZE);
+		CCD_IMAGE_FILE_PROPERTY->state = message ? INDIGO_ALERT_STATE : last ? INDIGO_OK_STATE : INDIGO_BUSY_STATE;
+		indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, message);
+		if (message == NULL)
+			CCD_LOCAL_QUEUE_WRITTEN_ITEM->number.value++;
+		writer_publish_queue(device, writer, count);
+		INDIGO_DEBUG(indigo_debug("Local save of %s in %gs", file_name, writer_time() - start));
+		pthread_mutex_lock(&writer->mutex);
+	}
+	pthread_mutex_unlock(&writer->mutex);
+	writer_sync_all(writer);
+	return NULL;
+}
+
+static indigo_ccd_writer *writer_get(indigo_device *device) {
+	if (CCD_CONTEXT->writer == NULL) {
+		indigo_ccd_writer *writer = malloc(sizeof(indigo_ccd_writer));
+		memset(writer, 0, sizeof(indigo_ccd_writer));
+		writer->device = device;
+		pthread_mutex_init(&writer->mutex, NULL);
+		pthread_cond_init(&writer->cond, NULL);
+		if (pthread_create(&writer->thread, NULL, writer_thread, writer)) {
+			indigo_error("Failed to start local save writer for %s", device->name);
+			pthread_mutex_destroy(&writer->mutex);
+			pthread_cond_destroy(&writer->cond);
+			free(writer);
+			return NULL;
+		}
+		CCD_CONTEXT->writer = writer;
+	}
+	return CCD_CONTEXT->writer;
+}
+
+static void writer_release(indigo_device *device) {
+	indigo_ccd_writer *writer = CCD_CONTEXT->writer;
+	if (writer == NULL)
+		return;
+	pthread_mutex_lock(&writer->mutex);
+	writer->stop = true;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->mutex);
+	pthread_join(writer->thread, NULL);
+	while (writer->sequences) {
+		writer_sequence *sequence = writer->sequences;
+		writer->sequences = sequence->next_sequence;
+		free(sequence);
+	}
+	pthread_mutex_destroy(&writer->mutex);
+	pthread_cond_destroy(&writer->cond);
+	free(writer);
+	CCD_CONTEXT->writer = NULL;
+}
+
+static void writer_report(indigo_device *device, bool busy, const char *failure) {
+	// CCD_IMAGE_FILE state changes are handed over to the writer thread to be published in order with results of queued frames
+	indigo_ccd_writer *writer = writer_get(device);
+	if (writer == NULL) {
+		CCD_IMAGE_FILE_PROPERTY->state = failure ? INDIGO_ALERT_STATE : INDIGO_BUSY_STATE;
+		indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, failure);
+		return;
+	}
+	pthread_mutex_lock(&writer->mutex);
+	if (busy) {
+		writer->generation++;
+		writer->busy = true;
+	}
+	if (failure) {
+		strncpy(writer->failure, failure, INDIGO_VALUE_SIZE - 1);
+		writer->failed = true;
+	}
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->mutex);
+}
+
+static void save_local(indigo_device *device, const void *data, long size, const char *suffix) {
+	char *dir = CCD_LOCAL_MODE_DIR_ITEM->text.value;
+	char *prefix = CCD_LOCAL_MODE_PREFIX_ITEM->text.value;
+	if (strlen(dir) + strlen(prefix) + strlen(suffix) >= INDIGO_VALUE_SIZE) {
+		writer_report(device, false, "dir + prefix + suffix is too long");
+		return;
+	}
+	indigo_ccd_writer *writer = writer_get(device);
+	void *copy = NULL;
+	if (writer == NULL || posix_memalign(&copy, CCD_WRITER_ALIGNMENT, size)) {
+		writer_report(device, false, "Can't queue image for local save");
+		return;
+	}
+	memcpy(copy, data, size);
+	pthread_mutex_lock(&writer->mutex);
+	// bounded queue, exposure thread waits for the writer rather than dropping frames
+	while (writer->count == CCD_WRITER_QUEUE_SIZE)
+		pthread_cond_wait(&writer->cond, &writer->mutex);
+	writer_job *job = writer->queue + (writer->first + writer->count) % CCD_WRITER_QUEUE_SIZE;
+	char *placeholder = strstr(prefix, "XXX");
+	strcpy(job->head, dir);
+	if (placeholder == NULL) {
+		strcat(job->head, prefix);
+		strcat(job->head, suffix);
+		*job->tail = 0;
+		job->digits = 0;
+	} else {
+		job->digits = strncmp(placeholder, "XXXX", 4) ? 3 : 4;
+		strncat(job->head, prefix, placeholder - prefix);
+		strcpy(job->tail, placeholder + job->digits);
+		strcat(job->tail, suffix);
+	}
+	job->data = copy;
+	job->size = size;
+	job->sync = CCD_LOCAL_SYNC_FRAME_ITEM->sw.value ? WRITER_SYNC_FRAME : CCD_LOCAL_SYNC_IDLE_ITEM->sw.value ? WRITER_SYNC_IDLE : WRITER_SYNC_NONE;
+	job->direct = CCD_LOCAL_DIRECT_ENABLED_ITEM->sw.value;
+	job->generation = writer->generation;
+	writer->count++;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->mutex);
+}
 
 static void countdown_timer_callback(indigo_device *device) {
 	if (CCD_CONTEXT->countdown_enabled && CCD_EXPOSURE_PROPERTY->state == INDIGO_BUSY_STATE && CCD_EXPOSURE_ITEM->number.value >= 1) {
@@ -104,6 +458,26 @@ indigo_result indigo_ccd_attach(indigo_device *device, unsigned version) {
 				return INDIGO_FAILED;
 			indigo_init_text_item(CCD_LOCAL_MODE_DIR_ITEM, CCD_LOCAL_MODE_DIR_ITEM_NAME, "Directory", "%s/", getenv("HOME"));
 			indigo_init_text_item(CCD_LOCAL_MODE_PREFIX_ITEM, CCD_LOCAL_MODE_PREFIX_ITEM_NAME, "File name prefix", "IMAGE_XXX");
+			// -------------------------------------------------------------------------------- CCD_LOCAL_SYNC
+			CCD_LOCAL_SYNC_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_LOCAL_SYNC_PROPERTY_NAME, CCD_MAIN_GROUP, "Local file sync", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 3);
+			if (CCD_LOCAL_SYNC_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_switch_item(CCD_LOCAL_SYNC_NONE_ITEM, CCD_LOCAL_SYNC_NONE_ITEM_NAME, "Leave to OS", true);
+			indigo_init_switch_item(CCD_LOCAL_SYNC_FRAME_ITEM, CCD_LOCAL_SYNC_FRAME_ITEM_NAME, "Sync every frame", false);
+			indigo_init_switch_item(CCD_LOCAL_SYNC_IDLE_ITEM, CCD_LOCAL_SYNC_IDLE_ITEM_NAME, "Sync when queue is empty", false);
+			// -------------------------------------------------------------------------------- CCD_LOCAL_DIRECT
+			CCD_LOCAL_DIRECT_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_LOCAL_DIRECT_PROPERTY_NAME, CCD_MAIN_GROUP, "Direct I/O for large frames", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+			if (CCD_LOCAL_DIRECT_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_switch_item(CCD_LOCAL_DIRECT_ENABLED_ITEM, CCD_LOCAL_DIRECT_ENABLED_ITEM_NAME, "Enabled", false);
+			indigo_init_switch_item(CCD_LOCAL_DIRECT_DISABLED_ITEM, CCD_LOCAL_DIRECT_DISABLED_ITEM_NAME, "Disabled", true);
+			// -------------------------------------------------------------------------------- CCD_LOCAL_QUEUE
+			CCD_LOCAL_QUEUE_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_LOCAL_QUEUE_PROPERTY_NAME, CCD_MAIN_GROUP, "Local save queue", INDIGO_OK_STATE, INDIGO_RO_PERM, 3);
+			if (CCD_LOCAL_QUEUE_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_number_item(CCD_LOCAL_QUEUE_QUEUED_ITEM, CCD_LOCAL_QUEUE_QUEUED_ITEM_NAME, "Frames in queue", 0, CCD_WRITER_QUEUE_SIZE, 1, 0);
+			indigo_init_number_item(CCD_LOCAL_QUEUE_WRITTEN_ITEM, CCD_LOCAL_QUEUE_WRITTEN_ITEM_NAME, "Frames written", 0, 1e9, 1, 0);
+			indigo_init_number_item(CCD_LOCAL_QUEUE_THROUGHPUT_ITEM, CCD_LOCAL_QUEUE_THROUGHPUT_ITEM_NAME, "Throughput (MB/s)", 0, 1e6, 0, 0);
 			// -------------------------------------------------------------------------------- CCD_MODE
 			CCD_MODE_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_MODE_PROPERTY_NAME, CCD_MAIN_GROUP, "Capture mode", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 64);
 			if (CCD_MODE_PROPERTY == NULL)
@@ -153,6 +527,20 @@ indigo_result indigo_ccd_attach(indigo_device *device, unsigned version) {
 				return INDIGO_FAILED;
 			indigo_init_number_item(CCD_BIN_HORIZONTAL_ITEM, CCD_BIN_HORIZONTAL_ITEM_NAME, "Horizontal binning", 0, 1, 1, 1);
 			indigo_init_number_item(CCD_BIN_VERTICAL_ITEM, CCD_BIN_VERTICAL_ITEM_NAME, "Vertical binning", 0, 1, 1, 1);
+			// -------------------------------------------------------------------------------- CCD_SOFTWARE_FRAME
+			CCD_SOFTWARE_FRAME_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_SOFTWARE_FRAME_PROPERTY_NAME, CCD_IMAGE_GROUP, "Software frame", INDIGO_OK_STATE, INDIGO_RW_PERM, 4);
+			if (CCD_SOFTWARE_FRAME_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_number_item(CCD_SOFTWARE_FRAME_LEFT_ITEM, CCD_SOFTWARE_FRAME_LEFT_ITEM_NAME, "Left", 0, 0xFFFF, 1, 0);
+			indigo_init_number_item(CCD_SOFTWARE_FRAME_TOP_ITEM, CCD_SOFTWARE_FRAME_TOP_ITEM_NAME, "Top", 0, 0xFFFF, 1, 0);
+			indigo_init_number_item(CCD_SOFTWARE_FRAME_WIDTH_ITEM, CCD_SOFTWARE_FRAME_WIDTH_ITEM_NAME, "Width (0 = full)", 0, 0xFFFF, 1, 0);
+			indigo_init_number_item(CCD_SOFTWARE_FRAME_HEIGHT_ITEM, CCD_SOFTWARE_FRAME_HEIGHT_ITEM_NAME, "Height (0 = full)", 0, 0xFFFF, 1, 0);
+			// -------------------------------------------------------------------------------- CCD_SOFTWARE_BIN
+			CCD_SOFTWARE_BIN_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_SOFTWARE_BIN_PROPERTY_NAME, CCD_IMAGE_GROUP, "Software binning", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+			if (CCD_SOFTWARE_BIN_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_number_item(CCD_SOFTWARE_BIN_HORIZONTAL_ITEM, CCD_SOFTWARE_BIN_HORIZONTAL_ITEM_NAME, "Horizontal binning", 1, CCD_SOFTWARE_BIN_MAX, 1, 1);
+			indigo_init_number_item(CCD_SOFTWARE_BIN_VERTICAL_ITEM, CCD_SOFTWARE_BIN_VERTICAL_ITEM_NAME, "Vertical binning", 1, CCD_SOFTWARE_BIN_MAX, 1, 1);
 			// -------------------------------------------------------------------------------- CCD_GAIN
 			CCD_GAIN_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_GAIN_PROPERTY_NAME, CCD_MAIN_GROUP, "Gain", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
 			if (CCD_GAIN_PROPERTY == NULL)
@@ -180,13 +568,15 @@ indigo_result indigo_ccd_attach(indigo_device *device, unsigned version) {
 			indigo_init_switch_item(CCD_FRAME_TYPE_DARK_ITEM, CCD_FRAME_TYPE_DARK_ITEM_NAME, "Dark", false);
 			indigo_init_switch_item(CCD_FRAME_TYPE_FLAT_ITEM, CCD_FRAME_TYPE_FLAT_ITEM_NAME, "Flat", false);
 			// -------------------------------------------------------------------------------- CCD_IMAGE_FORMAT
-			CCD_IMAGE_FORMAT_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_IMAGE_FORMAT_PROPERTY_NAME, CCD_IMAGE_GROUP, "Image format", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 4);
+			CCD_IMAGE_FORMAT_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_IMAGE_FORMAT_PROPERTY_NAME, CCD_IMAGE_GROUP, "Image format", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 6);
 			if (CCD_IMAGE_FORMAT_PROPERTY == NULL)
 				return INDIGO_FAILED;
 			indigo_init_switch_item(CCD_IMAGE_FORMAT_FITS_ITEM, CCD_IMAGE_FORMAT_FITS_ITEM_NAME, "FITS format", true);
 			indigo_init_switch_item(CCD_IMAGE_FORMAT_XISF_ITEM, CCD_IMAGE_FORMAT_XISF_ITEM_NAME, "XISF format", false);
 			indigo_init_switch_item(CCD_IMAGE_FORMAT_RAW_ITEM, CCD_IMAGE_FORMAT_RAW_ITEM_NAME, "Raw data", false);
 			indigo_init_switch_item(CCD_IMAGE_FORMAT_JPEG_ITEM, CCD_IMAGE_FORMAT_JPEG_ITEM_NAME, "JPEG format", false);
+			indigo_init_switch_item(CCD_IMAGE_FORMAT_FITS_RICE_ITEM, CCD_IMAGE_FORMAT_FITS_RICE_ITEM_NAME, "FITS format (Rice compressed)", false);
+			indigo_init_switch_item(CCD_IMAGE_FORMAT_XISF_LZ4_ITEM, CCD_IMAGE_FORMAT_XISF_LZ4_ITEM_NAME, "XISF format (LZ4 compressed)", false);
 			// -------------------------------------------------------------------------------- CCD_IMAGE
 			CCD_IMAGE_PROPERTY = indigo_init_blob_property(NULL, device->name, CCD_IMAGE_PROPERTY_NAME, CCD_IMAGE_GROUP, "Image data", INDIGO_OK_STATE, 1);
 			if (CCD_IMAGE_PROPERTY == NULL)
@@ -233,7 +623,7 @@ indigo_result indigo_ccd_attach(indigo_device *device, unsigned version) {
 				indigo_init_text_item(CCD_FITS_HEADERS_PROPERTY->items + i, name, label, "");
 			}
 			// -------------------------------------------------------------------------------- CCD_JPEG_SETTINGS
-			CCD_JPEG_SETTINGS_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_JPEG_SETTINGS_PROPERTY_NAME, CCD_IMAGE_GROUP, "JPEG Settings", INDIGO_OK_STATE, INDIGO_RW_PERM, 5);
+			CCD_JPEG_SETTINGS_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_JPEG_SETTINGS_PROPERTY_NAME, CCD_IMAGE_GROUP, "JPEG Settings", INDIGO_OK_STATE, INDIGO_RW_PERM, 6);
 			if (CCD_JPEG_SETTINGS_PROPERTY == NULL)
 				return INDIGO_FAILED;
 			CCD_JPEG_SETTINGS_PROPERTY->hidden = true;
@@ -242,6 +632,7 @@ indigo_result indigo_ccd_attach(indigo_device *device, unsigned version) {
 			indigo_init_number_item(CCD_JPEG_SETTINGS_WHITE_ITEM, CCD_JPEG_SETTINGS_WHITE_ITEM_NAME, "White point", -1, 255, 0, -1);
 			indigo_init_number_item(CCD_JPEG_SETTINGS_BLACK_TRESHOLD_ITEM, CCD_JPEG_SETTINGS_BLACK_TRESHOLD_ITEM_NAME, "Black point treshold", 0, 1, 0, 0.005);
 			indigo_init_number_item(CCD_JPEG_SETTINGS_WHITE_TRESHOLD_ITEM, CCD_JPEG_SETTINGS_WHITE_TRESHOLD_ITEM_NAME, "White point treshold", 0, 1, 0, 0.002);
+			indigo_init_number_item(CCD_JPEG_SETTINGS_PREVIEW_SCALE_ITEM, CCD_JPEG_SETTINGS_PREVIEW_SCALE_ITEM_NAME, "Preview downscale", 1, 8, 1, 1);
 			// -------------------------------------------------------------------------------- CCD_RBI_FLUSH_ENABLE
 			CCD_RBI_FLUSH_ENABLE_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_RBI_FLUSH_ENABLE_PROPERTY_NAME, CCD_MAIN_GROUP, "RBI flush", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
 			if (CCD_RBI_FLUSH_ENABLE_PROPERTY == NULL)
@@ -271,6 +662,12 @@ indigo_result indigo_ccd_enumerate_properties(indigo_device *device, indigo_clie
 			indigo_define_property(device, CCD_INFO_PROPERTY, NULL);
 		if (indigo_property_match(CCD_LOCAL_MODE_PROPERTY, property))
 			indigo_define_property(device, CCD_LOCAL_MODE_PROPERTY, NULL);
+		if (indigo_property_match(CCD_LOCAL_SYNC_PROPERTY, property))
+			indigo_define_property(device, CCD_LOCAL_SYNC_PROPERTY, NULL);
+		if (indigo_property_match(CCD_LOCAL_DIRECT_PROPERTY, property))
+			indigo_define_property(device, CCD_LOCAL_DIRECT_PROPERTY, NULL);
+		if (indigo_property_match(CCD_LOCAL_QUEUE_PROPERTY, property))
+			indigo_define_property(device, CCD_LOCAL_QUEUE_PROPERTY, NULL);
 		if (indigo_property_match(CCD_IMAGE_FILE_PROPERTY, property))
 			indigo_define_property(device, CCD_IMAGE_FILE_PROPERTY, NULL);
 		if (indigo_property_match(CCD_MODE_PROPERTY, property))
@@ -287,6 +684,10 @@ indigo_result indigo_ccd_enumerate_properties(indigo_device *device, indigo_clie
 			indigo_define_property(device, CCD_FRAME_PROPERTY, NULL);
 		if (indigo_property_match(CCD_BIN_PROPERTY, property))
 			indigo_define_property(device, CCD_BIN_PROPERTY, NULL);
+		if (indigo_property_match(CCD_SOFTWARE_FRAME_PROPERTY, property))
+			indigo_define_property(device, CCD_SOFTWARE_FRAME_PROPERTY, NULL);
+		if (indigo_property_match(CCD_SOFTWARE_BIN_PROPERTY, property))
+			indigo_define_property(device, CCD_SOFTWARE_BIN_PROPERTY, NULL);
 		if (indigo_property_match(CCD_OFFSET_PROPERTY, property))
 			indigo_define_property(device, CCD_OFFSET_PROPERTY, NULL);
 		if (indigo_property_match(CCD_GAIN_PROPERTY, property))
@@ -334,6 +735,9 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_define_property(device, CCD_UPLOAD_MODE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_PREVIEW_PROPERTY, NULL);
 			indigo_define_property(device, CCD_LOCAL_MODE_PROPERTY, NULL);
+			indigo_define_property(device, CCD_LOCAL_SYNC_PROPERTY, NULL);
+			indigo_define_property(device, CCD_LOCAL_DIRECT_PROPERTY, NULL);
+			indigo_define_property(device, CCD_LOCAL_QUEUE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_MODE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_READ_MODE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_EXPOSURE_PROPERTY, NULL);
@@ -341,6 +745,8 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_define_property(device, CCD_ABORT_EXPOSURE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_FRAME_PROPERTY, NULL);
 			indigo_define_property(device, CCD_BIN_PROPERTY, NULL);
+			indigo_define_property(device, CCD_SOFTWARE_FRAME_PROPERTY, NULL);
+			indigo_define_property(device, CCD_SOFTWARE_BIN_PROPERTY, NULL);
 			indigo_define_property(device, CCD_OFFSET_PROPERTY, NULL);
 			indigo_define_property(device, CCD_GAIN_PROPERTY, NULL);
 			indigo_define_property(device, CCD_GAMMA_PROPERTY, NULL);
@@ -361,6 +767,9 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_delete_property(device, CCD_UPLOAD_MODE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_PREVIEW_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_LOCAL_MODE_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_LOCAL_SYNC_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_LOCAL_DIRECT_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_LOCAL_QUEUE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_MODE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_READ_MODE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_EXPOSURE_PROPERTY, NULL);
@@ -368,6 +777,8 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_delete_property(device, CCD_ABORT_EXPOSURE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_FRAME_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_BIN_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_SOFTWARE_FRAME_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_SOFTWARE_BIN_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_OFFSET_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_GAIN_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_GAMMA_PROPERTY, NULL);
@@ -391,8 +802,12 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_save_property(device, NULL, CCD_READ_MODE_PROPERTY);
 			indigo_save_property(device, NULL, CCD_UPLOAD_MODE_PROPERTY);
 			indigo_save_property(device, NULL, CCD_LOCAL_MODE_PROPERTY);
+			indigo_save_property(device, NULL, CCD_LOCAL_SYNC_PROPERTY);
+			indigo_save_property(device, NULL, CCD_LOCAL_DIRECT_PROPERTY);
 			indigo_save_property(device, NULL, CCD_FRAME_PROPERTY);
 			indigo_save_property(device, NULL, CCD_BIN_PROPERTY);
+			indigo_save_property(device, NULL, CCD_SOFTWARE_FRAME_PROPERTY);
+			indigo_save_property(device, NULL, CCD_SOFTWARE_BIN_PROPERTY);
 			indigo_save_property(device, NULL, CCD_OFFSET_PROPERTY);
 			indigo_save_property(device, NULL, CCD_GAMMA_PROPERTY);
 			indigo_save_property(device, NULL, CCD_GAIN_PROPERTY);
@@ -405,12 +820,8 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 	} else if (indigo_property_match(CCD_EXPOSURE_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- CCD_EXPOSURE
 		if (CCD_EXPOSURE_PROPERTY->state == INDIGO_BUSY_STATE) {
-			if (CCD_UPLOAD_MODE_LOCAL_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
-				if (CCD_IMAGE_FILE_PROPERTY->state != INDIGO_BUSY_STATE) {
-					CCD_IMAGE_FILE_PROPERTY->state = INDIGO_BUSY_STATE;
-					indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, NULL);
-				}
-			}
+			if (CCD_UPLOAD_MODE_LOCAL_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value)
+				writer_report(device, true, NULL);
 			if (CCD_UPLOAD_MODE_CLIENT_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
 				if (CCD_IMAGE_PROPERTY->state != INDIGO_BUSY_STATE) {
 					CCD_IMAGE_PROPERTY->state = INDIGO_BUSY_STATE;
@@ -472,6 +883,20 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_update_property(device, CCD_FRAME_PROPERTY, NULL);
 		}
 		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_SOFTWARE_FRAME_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_SOFTWARE_FRAME
+		indigo_property_copy_values(CCD_SOFTWARE_FRAME_PROPERTY, property, false);
+		CCD_SOFTWARE_FRAME_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_SOFTWARE_FRAME_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_SOFTWARE_BIN_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_SOFTWARE_BIN
+		indigo_property_copy_values(CCD_SOFTWARE_BIN_PROPERTY, property, false);
+		CCD_SOFTWARE_BIN_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_SOFTWARE_BIN_PROPERTY, NULL);
+		return INDIGO_OK;
 	} else if (indigo_property_match(CCD_BIN_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- CCD_BIN
 		indigo_property_copy_values(CCD_BIN_PROPERTY, property, false);
@@ -638,6 +1063,20 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 		if (IS_CONNECTED)
 			indigo_update_property(device, CCD_LOCAL_MODE_PROPERTY, NULL);
 		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_LOCAL_SYNC_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_LOCAL_SYNC
+		indigo_property_copy_values(CCD_LOCAL_SYNC_PROPERTY, property, false);
+		CCD_LOCAL_SYNC_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_LOCAL_SYNC_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_LOCAL_DIRECT_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_LOCAL_DIRECT
+		indigo_property_copy_values(CCD_LOCAL_DIRECT_PROPERTY, property, false);
+		CCD_LOCAL_DIRECT_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_LOCAL_DIRECT_PROPERTY, NULL);
+		return INDIGO_OK;
 	} else if (indigo_property_match(CCD_FITS_HEADERS_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- CCD_FITS_HEADERS
 		indigo_property_copy_values(CCD_FITS_HEADERS_PROPERTY, property, false);
@@ -723,10 +1162,14 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 
 indigo_result indigo_ccd_detach(indigo_device *device) {
 	assert(device != NULL);
+	writer_release(device);
 	indigo_release_property(CCD_INFO_PROPERTY);
 	indigo_release_property(CCD_UPLOAD_MODE_PROPERTY);
 	indigo_release_property(CCD_PREVIEW_PROPERTY);
 	indigo_release_property(CCD_LOCAL_MODE_PROPERTY);
+	indigo_release_property(CCD_LOCAL_SYNC_PROPERTY);
+	indigo_release_property(CCD_LOCAL_DIRECT_PROPERTY);
+	indigo_release_property(CCD_LOCAL_QUEUE_PROPERTY);
 	indigo_release_property(CCD_MODE_PROPERTY);
 	indigo_release_property(CCD_READ_MODE_PROPERTY);
 	indigo_release_property(CCD_EXPOSURE_PROPERTY);
@@ -734,6 +1177,8 @@ indigo_result indigo_ccd_detach(indigo_device *device) {
 	indigo_release_property(CCD_ABORT_EXPOSURE_PROPERTY);
 	indigo_release_property(CCD_FRAME_PROPERTY);
 	indigo_release_property(CCD_BIN_PROPERTY);
+	indigo_release_property(CCD_SOFTWARE_FRAME_PROPERTY);
+	indigo_release_property(CCD_SOFTWARE_BIN_PROPERTY);
 	indigo_release_property(CCD_GAIN_PROPERTY);
 	indigo_release_property(CCD_GAMMA_PROPERTY);
 	indigo_release_property(CCD_OFFSET_PROPERTY);
@@ -750,7 +1195,9 @@ indigo_result indigo_ccd_detach(indigo_device *device) {
 	indigo_release_property(CCD_RBI_FLUSH_ENABLE_PROPERTY);
 	indigo_release_property(CCD_RBI_FLUSH_PROPERTY);
 	if (CCD_CONTEXT->preview_image)
-		free(CCD_CONTEXT->preview_image);
+		indigo_release_blob_buffer(CCD_CONTEXT->preview_image);
+	if (CCD_CONTEXT->compressed_image)
+		indigo_release_blob_buffer(CCD_CONTEXT->compressed_image);
 	return indigo_device_detach(device);
 }
 
@@ -793,101 +1240,791 @@ static void set_black_white(indigo_device *device, long *histo, long count) {
 	}
 }
 
-static void raw_to_jpeg(indigo_device *device, void *data_in, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, void **data_out, unsigned long *size_out) {
-	INDIGO_DEBUG(clock_t start = clock());
-	int size_in = frame_width * frame_height;
-	void *copy = malloc(size_in * bpp / 8);
-	memcpy(copy, data_in + FITS_HEADER_SIZE, size_in * bpp / 8);
-	unsigned char *mem = NULL;
-	unsigned long mem_size = 0;
+#define PREVIEW_MAX_THREADS				16
+#define PREVIEW_MIN_BAND_PIXELS		(256 * 1024)
+
+typedef struct {
+	const unsigned char *data;			///< raw frame data (after FITS header)
+	unsigned char *out;							///< 8-bit output image
+	const unsigned char *lut;				///< stretch table indexed by sample value
+	int width, height;							///< raw frame size
+	int components;									///< 1 for mono, 3 for RGB
+	int bytes;											///< bytes per sample
+	bool swap_bytes;								///< 16-bit samples are not in host byte order
+	bool swap_rb;										///< R and B channels should be swapped
+	int scale;											///< downscale factor
+	int first_row, last_row;				///< band of rows (output rows for stretch)
+	long histo[256];								///< band histogram
+} preview_band;
+
+typedef struct {
+	const unsigned char *pixels;		///< first row of the strip
+	int width, height, components;
+	int quality;
+	unsigned char *mem;							///< standalone JPEG of the strip
+	unsigned long mem_size;
+} preview_strip;
+
+typedef struct {
+	preview_strip *strips;
+	int first, step, count;
+} preview_strip_job;
+
+static double preview_time() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int preview_threads(long pixels) {
+	long threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > pixels / PREVIEW_MIN_BAND_PIXELS)
+		threads = pixels / PREVIEW_MIN_BAND_PIXELS;
+	if (threads > PREVIEW_MAX_THREADS)
+		threads = PREVIEW_MAX_THREADS;
+	return threads < 1 ? 1 : (int)threads;
+}
+
+static void run_preview_jobs(void *(*worker)(void *), void *jobs, size_t job_size, int count) {
+	pthread_t threads[PREVIEW_MAX_THREADS];
+	bool started[PREVIEW_MAX_THREADS] = { false };
+	for (int i = 1; i < count; i++)
+		started[i] = pthread_create(&threads[i], NULL, worker, (char *)jobs + i * job_size) == 0;
+	worker(jobs);
+	for (int i = 1; i < count; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			worker((char *)jobs + i * job_size);
+	}
+}
+
+static inline int preview_sample(const preview_band *band, const unsigned char *row, int index) {
+	if (band->bytes == 1)
+		return row[index];
+	unsigned short value = ((const unsigned short *)row)[index];
+	return band->swap_bytes ? __builtin_bswap16(value) : value;
+}
+
+static void *preview_histogram_band(void *arg) {
+	preview_band *band = arg;
+	// four interleaved histograms avoid store-to-load stalls on runs of equal values
+	long histo[4][256];
+	memset(histo, 0, sizeof(histo));
+	size_t row_size = (size_t)band->width * band->components;
+	size_t count = (band->last_row - band->first_row) * row_size;
+	const unsigned char *p = band->data + band->first_row * row_size * band->bytes;
+	int stride = band->bytes;
+	if (stride == 2) {
+		// histogram is built from the most significant byte, read it in place
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		p += band->swap_bytes ? 0 : 1;
+#else
+		p += band->swap_bytes ? 1 : 0;
+#endif
+	}
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4, p += 4 * stride) {
+		histo[0][p[0]]++;
+		histo[1][p[stride]]++;
+		histo[2][p[2 * stride]]++;
+		histo[3][p[3 * stride]]++;
+	}
+	for (; i < count; i++, p += stride)
+		histo[0][*p]++;
+	for (int j = 0; j < 256; j++)
+		band->histo[j] = histo[0][j] + histo[1][j] + histo[2][j] + histo[3][j];
+	return NULL;
+}
+
+static void *preview_stretch_band(void *arg) {
+	preview_band *band = arg;
+	const unsigned char *lut = band->lut;
+	int components = band->components;
+	int scale = band->scale;
+	int out_width = band->width / scale;
+	size_t in_row_size = (size_t)band->width * components * band->bytes;
+	size_t out_row_size = (size_t)out_width * components;
+	// component order of the output, R and B are swapped while writing
+	int order[3] = { 0, 1, 2 };
+	if (components == 3 && band->swap_rb) {
+		order[0] = 2;
+		order[2] = 0;
+	}
+	for (int y = band->first_row; y < band->last_row; y++) {
+		unsigned char *out = band->out + y * out_row_size;
+		if (scale == 1) {
+			const unsigned char *row = band->data + y * in_row_size;
+			if (components == 1) {
+				if (band->bytes == 1) {
+					for (int x = 0; x < out_width; x++)
+						out[x] = lut[row[x]];
+				} else if (band->swap_bytes) {
+					for (int x = 0; x < out_width; x++)
+						out[x] = lut[__builtin_bswap16(((const unsigned short *)row)[x])];
+				} else {
+					for (int x = 0; x < out_width; x++)
+						out[x] = lut[((const unsigned short *)row)[x]];
+				}
+			} else {
+				for (int x = 0; x < out_width; x++, out += 3) {
+					int i = 3 * x;
+					out[0] = lut[preview_sample(band, row, i + order[0])];
+					out[1] = lut[preview_sample(band, row, i + 1)];
+					out[2] = lut[preview_sample(band, row, i + order[2])];
+				}
+			}
+		} else {
+			// box filter over scale x scale pixels
+			const unsigned char *rows = band->data + (size_t)y * scale * in_row_size;
+			int area = scale * scale;
+			for (int x = 0; x < out_width; x++) {
+				for (int c = 0; c < components; c++) {
+					long sum = 0;
+					for (int dy = 0; dy < scale; dy++) {
+						const unsigned char *row = rows + dy * in_row_size;
+						int i = x * scale * components + order[c];
+						for (int dx = 0; dx < scale; dx++, i += components)
+							sum += preview_sample(band, row, i);
+					}
+					*out++ = lut[sum / area];
+				}
+			}
+		}
+	}
+	return NULL;
+}
+
+static void preview_setup_compress(struct jpeg_compress_struct *cinfo, int width, int height, int components, int quality) {
+	cinfo->image_width = width;
+	cinfo->image_height = height;
+	cinfo->input_components = components;
+	cinfo->in_color_space = components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+	jpeg_set_defaults(cinfo);
+	jpeg_set_quality(cinfo, quality, true);
+}
+
+static void preview_compress(const unsigned char *pixels, int width, int height, int components, int quality, unsigned char **mem, unsigned long *mem_size) {
 	struct jpeg_compress_struct cinfo;
 	struct jpeg_error_mgr jerr;
 	cinfo.err = jpeg_std_error(&jerr);
 	jpeg_create_compress(&cinfo);
-	jpeg_mem_dest(&cinfo, &mem, &mem_size);
-	cinfo.image_width = frame_width;
-	cinfo.image_height = frame_height;
+	jpeg_mem_dest(&cinfo, mem, mem_size);
+	preview_setup_compress(&cinfo, width, height, components, quality);
+	JSAMPROW row_pointer[1];
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		row_pointer[0] = (JSAMPROW)pixels + (size_t)cinfo.next_scanline * width * components;
+		jpeg_write_scanlines(&cinfo, row_pointer, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+}
+
+static void *preview_compress_strips(void *arg) {
+	preview_strip_job *job = arg;
+	for (int i = job->first; i < job->count; i += job->step) {
+		preview_strip *strip = job->strips + i;
+		preview_compress(strip->pixels, strip->width, strip->height, strip->components, strip->quality, &strip->mem, &strip->mem_size);
+	}
+	return NULL;
+}
+
+static long jpeg_find_marker(const unsigned char *data, unsigned long size, unsigned char marker) {
+	unsigned long i = 2;
+	while (i + 4 <= size && data[i] == 0xFF) {
+		if (data[i + 1] == marker)
+			return i;
+		i += 2 + (data[i + 2] << 8 | data[i + 3]);
+	}
+	return -1;
+}
+
+static bool jpeg_scan_data(const preview_strip *strip, long *header_size, long *data_start) {
+	long sos = jpeg_find_marker(strip->mem, strip->mem_size, 0xDA);
+	if (sos < 0)
+		return false;
+	*header_size = sos;
+	*data_start = sos + 2 + (strip->mem[sos + 2] << 8 | strip->mem[sos + 3]);
+	return *data_start <= (long)strip->mem_size - 2;
+}
+
+/* Strips are compressed as standalone JPEGs by several threads and their entropy coded segments are joined with RSTn
+   markers. Each strip is a whole number of MCU rows and starts with reset DC predictors, which is exactly what
+   a decoder expects after a restart marker, so the result is a single baseline JPEG with DRI set to the strip size.
+ */
+static bool preview_compress_parallel(const unsigned char *pixels, int width, int height, int components, int quality, int threads, unsigned char **mem, unsigned long *mem_size) {
+	struct jpeg_compress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+	preview_setup_compress(&cinfo, width, height, components, quality);
+	int mcu_width = 0, mcu_height = 0;
+	for (int i = 0; i < cinfo.num_components; i++) {
+		if (cinfo.comp_info[i].h_samp_factor * DCTSIZE > mcu_width)
+			mcu_width = cinfo.comp_info[i].h_samp_factor * DCTSIZE;
+		if (cinfo.comp_info[i].v_samp_factor * DCTSIZE > mcu_height)
+			mcu_height = cinfo.comp_info[i].v_samp_factor * DCTSIZE;
+	}
+	jpeg_destroy_compress(&cinfo);
+	long mcus_per_row = (width + mcu_width - 1) / mcu_width;
+	int mcu_rows = (height + mcu_height - 1) / mcu_height;
+	int strip_mcu_rows = (mcu_rows + threads - 1) / threads;
+	if (strip_mcu_rows > 65535 / mcus_per_row)
+		strip_mcu_rows = (int)(65535 / mcus_per_row);
+	if (strip_mcu_rows < 1)
+		return false;
+	int strip_count = (mcu_rows + strip_mcu_rows - 1) / strip_mcu_rows;
+	if (strip_count < 2)
+		return false;
+	int strip_height = strip_mcu_rows * mcu_height;
+	preview_strip *strips = malloc(strip_count * sizeof(preview_strip));
+	for (int i = 0; i < strip_count; i++) {
+		preview_strip *strip = strips + i;
+		strip->pixels = pixels + (size_t)i * strip_height * width * components;
+		strip->width = width;
+		strip->height = i == strip_count - 1 ? height - i * strip_height : strip_height;
+		strip->components = components;
+		strip->quality = quality;
+		strip->mem = NULL;
+		strip->mem_size = 0;
+	}
+	if (threads > strip_count)
+		threads = strip_count;
+	preview_strip_job jobs[PREVIEW_MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		jobs[i].strips = strips;
+		jobs[i].first = i;
+		jobs[i].step = threads;
+		jobs[i].count = strip_count;
+	}
+	run_preview_jobs(preview_compress_strips, jobs, sizeof(preview_strip_job), threads);
+	bool result = true;
+	unsigned long total = 6;
+	long header_size = 0, data_start = 0;
+	for (int i = 0; i < strip_count && result; i++) {
+		result = jpeg_scan_data(strips + i, &header_size, &data_start);
+		total += strips[i].mem_size + 2;
+	}
+	long sof = result ? jpeg_find_marker(strips[0].mem, strips[0].mem_size, 0xC0) : -1;
+	if (sof >= 0) {
+		unsigned char *out = malloc(total);
+		unsigned char *p = out;
+		jpeg_scan_data(strips, &header_size, &data_start);
+		memcpy(p, strips[0].mem, header_size);
+		p[sof + 5] = height >> 8;
+		p[sof + 6] = height & 0xFF;
+		p += header_size;
+		int restart_interval = (int)(strip_mcu_rows * mcus_per_row);
+		*p++ = 0xFF;
+		*p++ = 0xDD;
+		*p++ = 0;
+		*p++ = 4;
+		*p++ = restart_interval >> 8;
+		*p++ = restart_interval & 0xFF;
+		memcpy(p, strips[0].mem + header_size, data_start - header_size);
+		p += data_start - header_size;
+		for (int i = 0; i < strip_count; i++) {
+			jpeg_scan_data(strips + i, &header_size, &data_start);
+			long length = strips[i].mem_size - 2 - data_start;
+			memcpy(p, strips[i].mem + data_start, length);
+			p += length;
+			*p++ = 0xFF;
+			*p++ = i == strip_count - 1 ? 0xD9 : 0xD0 + (i & 7);
+		}
+		*mem = out;
+		*mem_size = p - out;
+	} else {
+		result = false;
+	}
+	for (int i = 0; i < strip_count; i++)
+		free(strips[i].mem);
+	free(strips);
+	return result;
+}
+
+static void raw_to_jpeg(indigo_device *device, void *data_in, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, int scale, void **data_out, unsigned long *size_out) {
+	INDIGO_DEBUG(double start = preview_time());
+	int components = (bpp == 24 || bpp == 48) ? 3 : 1;
+	int bytes = (bpp == 16 || bpp == 48) ? 2 : 1;
+	if (scale < 1 || scale > frame_width || scale > frame_height)
+		scale = 1;
+	int out_width = frame_width / scale;
+	int out_height = frame_height / scale;
+	int threads = preview_threads((long)frame_width * frame_height);
+	preview_band bands[PREVIEW_MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		preview_band *band = bands + i;
+		band->data = (unsigned char *)data_in + FITS_HEADER_SIZE;
+		band->width = frame_width;
+		band->height = frame_height;
+		band->components = components;
+		band->bytes = bytes;
+		band->swap_bytes = bytes == 2 && !little_endian;
+		band->swap_rb = components == 3 && !byte_order_rgb;
+		band->scale = scale;
+		band->first_row = (int)((long)frame_height * i / threads);
+		band->last_row = (int)((long)frame_height * (i + 1) / threads);
+	}
+	run_preview_jobs(preview_histogram_band, bands, sizeof(preview_band), threads);
 	long histo[256] = { 0 };
-	if (bpp == 8 || bpp == 24) {
-		unsigned char *b8 = copy;
-		int count = size_in * (bpp == 8 ? 1 : 3);
-		for (int i = 0; i < count; i++) {
-			histo[*b8++]++;
-		}
-		set_black_white(device, histo, count);
-		double scale = (CCD_JPEG_SETTINGS_WHITE_ITEM->number.value - CCD_JPEG_SETTINGS_BLACK_ITEM->number.value) / 255;
-		int offset = CCD_JPEG_SETTINGS_BLACK_ITEM->number.value;
-		b8 = copy;
-		for (int i = 0; i < count; i++) {
-			int value = (*b8 - offset) / scale;
-			if (value < 0)
-				value = 0;
-			else if (value > 255)
-				value = 255;
-			*b8++ = value;
-		}
-	}
-	if (bpp == 16 || bpp == 48) {
-		unsigned short *b16 = copy;
-		int count = size_in * (bpp == 16 ? 1 : 3);
-		if (little_endian) {
-			for (int i = 0; i < count; i++) {
-				histo[*b16++ >> 8]++;
+	for (int i = 0; i < threads; i++)
+		for (int j = 0; j < 256; j++)
+			histo[j] += bands[i].histo[j];
+	long count = (long)frame_width * frame_height * components;
+	set_black_white(device, histo, count);
+	// stretch is tabulated for every possible sample value, so the per-pixel work is a single lookup
+	int offset = CCD_JPEG_SETTINGS_BLACK_ITEM->number.value;
+	double range = CCD_JPEG_SETTINGS_WHITE_ITEM->number.value - CCD_JPEG_SETTINGS_BLACK_ITEM->number.value;
+	if (bytes == 1)
+		range /= 255;
+	int lut_size = bytes == 1 ? 256 : 65536;
+	unsigned char *lut = malloc(lut_size);
+	for (int i = 0; i < lut_size; i++) {
+		int value = (i - offset) / range;
+		lut[i] = value < 0 ? 0 : value > 255 ? 255 : value;
+	}
+	unsigned char *pixels = malloc((size_t)out_width * out_height * components);
+	for (int i = 0; i < threads; i++) {
+		bands[i].lut = lut;
+		bands[i].out = pixels;
+		bands[i].first_row = (int)((long)out_height * i / threads);
+		bands[i].last_row = (int)((long)out_height * (i + 1) / threads);
+	}
+	run_preview_jobs(preview_stretch_band, bands, sizeof(preview_band), threads);
+	free(lut);
+	unsigned char *mem = NULL;
+	unsigned long mem_size = 0;
+	int quality = CCD_JPEG_SETTINGS_QUALITY_ITEM->number.target;
+	if (threads == 1 || !preview_compress_parallel(pixels, out_width, out_height, components, quality, threads, &mem, &mem_size))
+		preview_compress(pixels, out_width, out_height, components, quality, &mem, &mem_size);
+	free(pixels);
+	*data_out = mem;
+	*size_out = mem_size;
+	INDIGO_DEBUG(indigo_debug("RAW to preview conversion in %gs (%d threads)", preview_time() - start, threads));
+}
+
+/* Converts the frame in place to the byte order, channel order and pixel storage of the output format. Rows are processed
+   one at a time in a row sized scratch buffer; for planar output every row is first split into R, G and B row segments and
+   the segments are then moved to their planes by following permutation cycles, so no second frame sized buffer is needed.
+ */
+static void convert_frame(void *data, int width, int height, int components, int bytes, bool swap_in, bool swap_rb, bool swap_out, bool bzero, bool planar) {
+	if (bytes == 1 && (components == 1 || (!swap_rb && !planar)))
+		return;
+	if (bytes == 2 && components == 1 && swap_in == swap_out && !bzero)
+		return;
+	size_t segment_size = (size_t)width * bytes;
+	size_t row_size = segment_size * components;
+	int order[3] = { 0, 1, 2 };
+	if (components == 3 && swap_rb) {
+		order[0] = 2;
+		order[2] = 0;
+	}
+	unsigned short mask = bzero ? 0x8000 : 0;
+	unsigned char *scratch = planar ? malloc(row_size) : NULL;
+	for (int y = 0; y < height; y++) {
+		unsigned char *row = (unsigned char *)data + y * row_size;
+		if (bytes == 1) {
+			if (planar) {
+				for (int c = 0; c < 3; c++) {
+					unsigned char *out = scratch + c * segment_size;
+					const unsigned char *in = row + order[c];
+					for (int x = 0; x < width; x++, in += 3)
+						out[x] = *in;
+				}
+			} else {
+				for (int x = 0; x < width; x++, row += 3) {
+					unsigned char b = row[0];
+					row[0] = row[2];
+					row[2] = b;
+				}
 			}
 		} else {
-			for (int i = 0; i < count; i++) {
-				int value = *b16;
-				value = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-				*b16++ = value;
-				histo[value >> 8]++;
+			unsigned short *in = (unsigned short *)row;
+			unsigned short *out = (unsigned short *)scratch;
+			for (int x = 0; x < width; x++, in += components) {
+				unsigned short pixel[3];
+				for (int c = 0; c < components; c++) {
+					unsigned short value = in[order[c]];
+					if (swap_in)
+						value = __builtin_bswap16(value);
+					value ^= mask;
+					pixel[c] = swap_out ? __builtin_bswap16(value) : value;
+				}
+				for (int c = 0; c < components; c++) {
+					if (planar)
+						out[c * width + x] = pixel[c];
+					else
+						in[c] = pixel[c];
+				}
 			}
 		}
-		set_black_white(device, histo, count);
-		double scale = (CCD_JPEG_SETTINGS_WHITE_ITEM->number.value - CCD_JPEG_SETTINGS_BLACK_ITEM->number.value);
-		int offset = CCD_JPEG_SETTINGS_BLACK_ITEM->number.value;
-		unsigned char *b8 = copy;
-		b16 = copy;
-		for (int i = 0; i < count; i++) {
-			int value = (*b16++ - offset) / scale;
-			if (value < 0)
-				value = 0;
-			else if (value > 255)
-				value = 255;
-			*b8++ = value;
-		}
-	}
-	if (bpp == 8 || bpp == 16) {
-		cinfo.input_components = 1;
-		cinfo.in_color_space = JCS_GRAYSCALE;
-	}
-	if (bpp == 24 || bpp == 48) {
-		if (!byte_order_rgb) {
-			unsigned char *b8 = copy;
-			for (int i = 0; i < size_in; i++) {
-				unsigned char b = *b8;
-				unsigned char r = *(b8 + 2);
-				*b8 = r;
-				*(b8 + 2) = b;
-				b8 += 3;
+		if (planar)
+			memcpy(row, scratch, row_size);
+	}
+	if (planar) {
+		// segment s = 3 * y + c holds row y of plane c and belongs to c * height + y
+		size_t count = 3 * (size_t)height;
+		unsigned char *visited = calloc((count + 7) / 8, 1);
+		unsigned char *base = data;
+		for (size_t start = 0; start < count; start++) {
+			if (visited[start >> 3] & (1 << (start & 7)))
+				continue;
+			visited[start >> 3] |= 1 << (start & 7);
+			size_t source = 3 * (start % height) + start / height;
+			if (source == start)
+				continue;
+			memcpy(scratch, base + start * segment_size, segment_size);
+			size_t current = start;
+			while (source != start) {
+				memcpy(base + current * segment_size, base + source * segment_size, segment_size);
+				visited[source >> 3] |= 1 << (source & 7);
+				current = source;
+				source = 3 * (current % height) + current / height;
 			}
+			memcpy(base + current * segment_size, scratch, segment_size);
 		}
-		cinfo.input_components = 3;
-		cinfo.in_color_space = JCS_RGB;
+		free(visited);
+		free(scratch);
 	}
-	jpeg_set_defaults(&cinfo);
-	jpeg_set_quality(&cinfo, CCD_JPEG_SETTINGS_QUALITY_ITEM->number.target, true);
-	JSAMPROW row_pointer[1];
-	jpeg_start_compress( &cinfo, TRUE);
-	while( cinfo.next_scanline < cinfo.image_height ) {
-		row_pointer[0] = &((JSAMPROW)copy)[cinfo.next_scanline * cinfo.image_width *  cinfo.input_components];
-		jpeg_write_scanlines(&cinfo, row_pointer, 1);
+}
+
+// vertical pass sums whole rows into 32 bit accumulators (contiguous, vectorized by the compiler), horizontal pass then folds groups of columns
+
+static void software_bin_accumulate_8(uint32_t *sum, const uint8_t *row, long count) {
+	for (long i = 0; i < count; i++)
+		sum[i] += row[i];
+}
+
+static void software_bin_accumulate_16(uint32_t *sum, const uint16_t *row, long count, bool swap) {
+	if (swap) {
+		for (long i = 0; i < count; i++)
+			sum[i] += (uint16_t)(row[i] << 8 | row[i] >> 8);
+	} else {
+		for (long i = 0; i < count; i++)
+			sum[i] += row[i];
 	}
-	jpeg_finish_compress(&cinfo);
-	jpeg_destroy_compress(&cinfo);
-	*data_out = mem;
-	*size_out = mem_size;
-	free(copy);
-	INDIGO_DEBUG(indigo_debug("RAW to preview conversion in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+}
+
+static void software_bin(void *data, int width, int components, int bytes, bool swap, int left, int top, int out_width, int out_height, int horizontal_bin, int vertical_bin) {
+	long row_samples = (long)width * components;
+	long span = (long)out_width * horizontal_bin * components;
+	long out_samples = (long)out_width * components;
+	uint32_t count = horizontal_bin * vertical_bin;
+	uint32_t half = count / 2;
+	// (sum + half) / count as multiplication, exact for sums of up to 256 16 bit samples
+	uint64_t reciprocal = ((1ULL << 40) + count - 1) / count;
+	uint32_t *sum = malloc(span * sizeof(uint32_t));
+	for (int y = 0; y < out_height; y++) {
+		// output row y never overlaps input rows of the rows to come, so binning works in place
+		memset(sum, 0, span * sizeof(uint32_t));
+		for (int k = 0; k < vertical_bin; k++) {
+			long offset = (long)(top + y * vertical_bin + k) * row_samples + (long)left * components;
+			if (bytes == 1)
+				software_bin_accumulate_8(sum, (uint8_t *)data + offset, span);
+			else
+				software_bin_accumulate_16(sum, (uint16_t *)data + offset, span, swap);
+		}
+		if (horizontal_bin > 1 && components == 1) {
+			for (long x = 0; x < out_width; x++) {
+				uint32_t *group = sum + x * horizontal_bin;
+				uint32_t value = group[0];
+				for (int k = 1; k < horizontal_bin; k++)
+					value += group[k];
+				sum[x] = value;
+			}
+		} else if (horizontal_bin > 1) {
+			for (long x = 0; x < out_width; x++) {
+				uint32_t *group = sum + x * horizontal_bin * components;
+				for (int c = 0; c < components; c++) {
+					uint32_t value = group[c];
+					for (int k = 1; k < horizontal_bin; k++)
+						value += group[k * components + c];
+					sum[x * components + c] = value;
+				}
+			}
+		}
+		if (bytes == 1) {
+			uint8_t *out = (uint8_t *)data + y * out_samples;
+			for (long i = 0; i < out_samples; i++)
+				out[i] = ((sum[i] + half) * reciprocal) >> 40;
+		} else {
+			uint16_t *out = (uint16_t *)data + y * out_samples;
+			for (long i = 0; i < out_samples; i++) {
+				uint16_t value = ((sum[i] + half) * reciprocal) >> 40;
+				out[i] = swap ? (uint16_t)(value << 8 | value >> 8) : value;
+			}
+		}
+	}
+	free(sum);
+}
+
+static void software_crop(void *data, int width, int components, int bytes, int left, int top, int out_width, int out_height) {
+	long row_size = (long)width * components * bytes;
+	long out_size = (long)out_width * components * bytes;
+	for (int y = 0; y < out_height; y++)
+		memmove((char *)data + y * out_size, (char *)data + (top + y) * row_size + (long)left * components * bytes, out_size);
+}
+
+static bool software_frame(indigo_device *device, void *data, int *frame_width, int *frame_height, int bpp, bool little_endian, bool bayer, int *horizontal_bin, int *vertical_bin) {
+	int components = (bpp == 24 || bpp == 48) ? 3 : 1;
+	int bytes = (bpp == 16 || bpp == 48) ? 2 : 1;
+	int left = CCD_SOFTWARE_FRAME_LEFT_ITEM->number.value;
+	int top = CCD_SOFTWARE_FRAME_TOP_ITEM->number.value;
+	int width = CCD_SOFTWARE_FRAME_WIDTH_ITEM->number.value;
+	int height = CCD_SOFTWARE_FRAME_HEIGHT_ITEM->number.value;
+	int bin_x = CCD_SOFTWARE_BIN_HORIZONTAL_ITEM->number.value;
+	int bin_y = CCD_SOFTWARE_BIN_VERTICAL_ITEM->number.value;
+	if (bayer) {
+		// keep the colour filter pattern of the sub-frame the same
+		left &= ~1;
+		top &= ~1;
+	}
+	if (left >= *frame_width || top >= *frame_height)
+		left = top = 0;
+	if (width <= 0 || left + width > *frame_width)
+		width = *frame_width - left;
+	if (height <= 0 || top + height > *frame_height)
+		height = *frame_height - top;
+	if (bin_x < 1 || bin_x > width)
+		bin_x = 1;
+	if (bin_y < 1 || bin_y > height)
+		bin_y = 1;
+	if (left == 0 && top == 0 && width == *frame_width && height == *frame_height && bin_x == 1 && bin_y == 1)
+		return false;
+	INDIGO_DEBUG(double start = preview_time());
+	int out_width = width / bin_x;
+	int out_height = height / bin_y;
+	if (bin_x == 1 && bin_y == 1)
+		software_crop(data, *frame_width, components, bytes, left, top, out_width, out_height);
+	else
+		software_bin(data, *frame_width, components, bytes, bytes == 2 && !little_endian, left, top, out_width, out_height, bin_x, bin_y);
+	INDIGO_DEBUG(indigo_debug("Software frame %dx%d -> %dx%d (bin %dx%d) in %gs", *frame_width, *frame_height, out_width, out_height, bin_x, bin_y, preview_time() - start));
+	*frame_width = out_width;
+	*frame_height = out_height;
+	*horizontal_bin *= bin_x;
+	*vertical_bin *= bin_y;
+	return bin_x > 1 || bin_y > 1;
+}
+
+static bool skip_keyword(indigo_fits_keyword *keyword, bool binned) {
+	// binned Bayer data are not a colour filter array any more
+	return binned && (!strcmp(keyword->name, "BAYERPAT") || !strcmp(keyword->name, "XBAYROFF") || !strcmp(keyword->name, "YBAYROFF"));
+}
+
+#define XISF_MIN_SUBBLOCK_SIZE	(1024 * 1024)
+
+typedef struct {
+	const unsigned char *data;			///< uncompressed data
+	unsigned char *out;							///< output, tile_bound bytes reserved for each tile
+	long *sizes;										///< compressed tile sizes
+	long total;											///< uncompressed data size
+	long tile_size;									///< uncompressed tile size
+	long tile_bound;								///< worst case compressed tile size
+	int bytes;											///< bytes per pixel (Rice)
+	bool lz4;												///< LZ4 or Rice
+	int first, count;								///< band of tiles
+} compress_band;
+
+static void *compress_tiles_band(void *arg) {
+	compress_band *band = arg;
+	uint32_t hash_table[INDIGO_LZ4_HASH_SIZE];
+	for (int tile = band->first; tile < band->first + band->count; tile++) {
+		long offset = tile * band->tile_size;
+		long size = band->total - offset < band->tile_size ? band->total - offset : band->tile_size;
+		if (band->lz4)
+			band->sizes[tile] = indigo_lz4_compress(band->data + offset, size, band->out + tile * band->tile_bound, band->tile_bound, hash_table);
+		else
+			band->sizes[tile] = indigo_rice_compress(band->data + offset, size / band->bytes, band->bytes, band->out + tile * band->tile_bound, band->tile_bound);
+	}
+	return NULL;
+}
+
+/** Compress tiles in parallel bands and compact them to continuous stream at out, returns compressed size or -1.
+ */
+static long compress_tiles(const unsigned char *data, long total, long tile_size, int bytes, bool lz4, unsigned char *out, long tile_bound, long *sizes) {
+	int tiles = (int)((total + tile_size - 1) / tile_size);
+	int threads = preview_threads(total / bytes);
+	if (threads > tiles)
+		threads = tiles;
+	compress_band bands[PREVIEW_MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		compress_band *band = bands + i;
+		band->data = data;
+		band->out = out;
+		band->sizes = sizes;
+		band->total = total;
+		band->tile_size = tile_size;
+		band->tile_bound = tile_bound;
+		band->bytes = bytes;
+		band->lz4 = lz4;
+		band->first = (int)((long)tiles * i / threads);
+		band->count = (int)((long)tiles * (i + 1) / threads) - band->first;
+	}
+	run_preview_jobs(compress_tiles_band, bands, sizeof(compress_band), threads);
+	long size = 0;
+	for (int tile = 0; tile < tiles; tile++) {
+		if (sizes[tile] < 0)
+			return -1;
+		// compacted position never passes the reserved one, so moving forward is safe
+		memmove(out + size, out + tile * tile_bound, sizes[tile]);
+		size += sizes[tile];
+	}
+	return size;
+}
+
+static void *shared_image_buffer(void **buffer, unsigned long *capacity, unsigned long size) {
+	// published buffers are shared with BLOB cache instead of copied, content still referenced there is left alone and new one goes to a fresh buffer
+	if (*buffer != NULL && *capacity >= size) {
+		void *claimed = indigo_claim_blob_buffer(*buffer);
+		if (claimed != NULL)
+			return *buffer = claimed;
+	} else if (*buffer != NULL) {
+		indigo_release_blob_buffer(*buffer);
+	}
+	*buffer = indigo_alloc_shared_blob_buffer(size);
+	*capacity = *buffer != NULL ? size : 0;
+	return *buffer;
+}
+
+static unsigned char *compressed_buffer(indigo_device *device, unsigned long size) {
+	return shared_image_buffer(&CCD_CONTEXT->compressed_image, &CCD_CONTEXT->compressed_image_size, size);
+}
+
+static char *fits_card(char *card, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	int t = vsnprintf(card, 81, format, args);
+	va_end(args);
+	card[t < 80 ? t : 80] = ' ';
+	return card + 80;
+}
+
+static inline void put_be32(unsigned char *out, uint32_t value) {
+	out[0] = value >> 24;
+	out[1] = value >> 16;
+	out[2] = value >> 8;
+	out[3] = value;
+}
+
+/** Convert FITS image in data (header and big endian pixels) to RICE_1 tile compressed FITS in compressed_image buffer, one row per tile.
+ */
+static unsigned long compress_fits(indigo_device *device, const char *data, int width, int height, int planes, int bytes) {
+	char header[3 * FITS_HEADER_SIZE];
+	memset(header, ' ', sizeof(header));
+	int tiles = planes * height;
+	char *card = header, *pcount, *tform;
+	card = fits_card(card, "XTENSION= 'BINTABLE'           / binary table extension");
+	card = fits_card(card, "BITPIX  =                    8 / 8-bit bytes");
+	card = fits_card(card, "NAXIS   =                    2 / 2-dimensional binary table");
+	card = fits_card(card, "NAXIS1  =                    8 / width of table in bytes");
+	card = fits_card(card, "NAXIS2  = %20d / number of rows in table", tiles);
+	card = fits_card(pcount = card, "PCOUNT  = %20d / size of special data area", 0);
+	card = fits_card(card, "GCOUNT  =                    1 / one data group (required keyword)");
+	card = fits_card(card, "TFIELDS =                    1 / number of fields in each row");
+	card = fits_card(card, "TTYPE1  = 'COMPRESSED_DATA'    / label for field 1");
+	card = fits_card(tform = card, "TFORM1  = '1PB(0)'             / data format of field: variable length array");
+	card = fits_card(card, "ZIMAGE  =                    T / extension contains compressed image");
+	card = fits_card(card, "ZBITPIX = %20d / data type of original image", bytes * 8);
+	card = fits_card(card, "ZNAXIS  = %20d / dimension of original image", planes == 3 ? 3 : 2);
+	card = fits_card(card, "ZNAXIS1 = %20d / length of original image axis", width);
+	card = fits_card(card, "ZNAXIS2 = %20d / length of original image axis", height);
+	if (planes == 3)
+		card = fits_card(card, "ZNAXIS3 =                    3 / length of original image axis");
+	card = fits_card(card, "ZTILE1  = %20d / size of tiles to be compressed", width);
+	card = fits_card(card, "ZTILE2  =                    1 / size of tiles to be compressed");
+	if (planes == 3)
+		card = fits_card(card, "ZTILE3  =                    1 / size of tiles to be compressed");
+	card = fits_card(card, "ZCMPTYPE= 'RICE_1'             / compression algorithm");
+	card = fits_card(card, "ZNAME1  = 'BLOCKSIZE'          / compression block size");
+	card = fits_card(card, "ZVAL1   = %20d / pixels per block", INDIGO_RICE_BLOCK_SIZE);
+	card = fits_card(card, "ZNAME2  = 'BYTEPIX'            / bytes per pixel (1, 2, 4, or 8)");
+	card = fits_card(card, "ZVAL2   = %20d / bytes per pixel (1, 2, 4, or 8)", bytes);
+	// the rest of image header goes to the extension, keywords describing the uncompressed array are replaced by Z* ones
+	for (const char *image_card = data; image_card < data + FITS_HEADER_SIZE && strncmp(image_card, "END     ", 8); image_card += 80) {
+		if (strncmp(image_card, "SIMPLE  ", 8) && strncmp(image_card, "BITPIX  ", 8) && strncmp(image_card, "NAXIS", 5) && strncmp(image_card, "EXTEND  ", 8)) {
+			memcpy(card, image_card, 80);
+			card += 80;
+		}
+	}
+	card = fits_card(card, "END");
+	long header_size = (card - header + FITS_HEADER_SIZE - 1) / FITS_HEADER_SIZE * FITS_HEADER_SIZE;
+	long tile_size = (long)width * bytes;
+	long tile_bound = INDIGO_RICE_BOUND(width, bytes);
+	long table_offset = FITS_HEADER_SIZE + header_size;
+	long heap_offset = table_offset + 8L * tiles;
+	unsigned char *out = compressed_buffer(device, heap_offset + tiles * tile_bound + FITS_HEADER_SIZE);
+	long *sizes = malloc(tiles * sizeof(long));
+	if (out == NULL || sizes == NULL) {
+		indigo_error("Failed to allocate buffer for compressed image");
+		free(sizes);
+		return 0;
+	}
+	long heap_size = compress_tiles((const unsigned char *)data + FITS_HEADER_SIZE, tile_size * tiles, tile_size, bytes, false, out + heap_offset, tile_bound, sizes);
+	if (heap_size < 0) {
+		indigo_error("Rice compression failed");
+		free(sizes);
+		return 0;
+	}
+	long max_size = 0, offset = 0;
+	for (int tile = 0; tile < tiles; tile++) {
+		put_be32(out + table_offset + 8 * tile, (uint32_t)sizes[tile]);
+		put_be32(out + table_offset + 8 * tile + 4, (uint32_t)offset);
+		offset += sizes[tile];
+		if (max_size < sizes[tile])
+			max_size = sizes[tile];
+	}
+	free(sizes);
+	fits_card(pcount, "PCOUNT  = %20ld / size of special data area", heap_size);
+	fits_card(tform, "TFORM1  = '1PB(%ld)'%*c / data format of field: variable length array", max_size, (int)(13 - snprintf(NULL, 0, "%ld", max_size)), ' ');
+	memset(out, ' ', FITS_HEADER_SIZE);
+	card = fits_card((char *)out, "SIMPLE  =                    T / file conforms to FITS standard");
+	card = fits_card(card, "BITPIX  =                    8 / number of bits per data pixel");
+	card = fits_card(card, "NAXIS   =                    0 / number of data axes");
+	card = fits_card(card, "EXTEND  =                    T / FITS dataset may contain extensions");
+	fits_card(card, "END");
+	memcpy(out + FITS_HEADER_SIZE, header, header_size);
+	unsigned long size = heap_offset + heap_size;
+	int mod2880 = size % FITS_HEADER_SIZE;
+	if (mod2880) {
+		memset(out + size, 0, FITS_HEADER_SIZE - mod2880);
+		size += FITS_HEADER_SIZE - mod2880;
+	}
+	return size;
+}
+
+/** Byte shuffle and LZ4 compress XISF data block to compressed_image buffer after FITS_HEADER_SIZE bytes reserved for the XISF header, subblocks are compressed in parallel.
+ */
+static unsigned long compress_xisf(indigo_device *device, const unsigned char *data, unsigned long size, int bytes, char *subblocks) {
+	int count = preview_threads(size / bytes);
+	if (count > size / XISF_MIN_SUBBLOCK_SIZE)
+		count = (int)(size / XISF_MIN_SUBBLOCK_SIZE);
+	if (count < 1)
+		count = 1;
+	long subblock_size = (size + count - 1) / count;
+	long subblock_bound = INDIGO_LZ4_BOUND(subblock_size);
+	long sizes[PREVIEW_MAX_THREADS];
+	unsigned char *out = compressed_buffer(device, FITS_HEADER_SIZE + count * subblock_bound + (bytes > 1 ? size : 0));
+	if (out == NULL) {
+		indigo_error("Failed to allocate buffer for compressed image");
+		return 0;
+	}
+	if (bytes > 1) {
+		unsigned char *shuffled = out + FITS_HEADER_SIZE + count * subblock_bound;
+		indigo_byte_shuffle(data, shuffled, size / bytes, bytes);
+		data = shuffled;
+	}
+	long compressed_size = compress_tiles(data, size, subblock_size, 1, true, out + FITS_HEADER_SIZE, subblock_bound, sizes);
+	if (compressed_size < 0) {
+		indigo_error("LZ4 compression failed");
+		return 0;
+	}
+	*subblocks = 0;
+	for (int i = 0; count > 1 && i < count; i++) {
+		long uncompressed = size - i * subblock_size < subblock_size ? size - i * subblock_size : subblock_size;
+		subblocks += sprintf(subblocks, "%s%ld,%ld", i ? ":" : "", sizes[i], uncompressed);
+	}
+	return compressed_size;
 }
 
 void indigo_process_image(indigo_device *device, void *data, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, indigo_fits_keyword *keywords) {
@@ -897,6 +2034,10 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 
 	int horizontal_bin = CCD_BIN_HORIZONTAL_ITEM->number.value;
 	int vertical_bin = CCD_BIN_VERTICAL_ITEM->number.value;
+	bool bayer = false;
+	for (indigo_fits_keyword *keyword = keywords; keyword && keyword->type; keyword++)
+		bayer = bayer || !strcmp(keyword->name, "BAYERPAT");
+	bool binned = software_frame(device, data + FITS_HEADER_SIZE, &frame_width, &frame_height, bpp, little_endian, bayer, &horizontal_bin, &vertical_bin);
 	int byte_per_pixel = bpp / 8;
 	int naxis = 2;
 	unsigned long size = frame_width * frame_height;
@@ -911,17 +2052,12 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 
 	void *jpeg_data = NULL;
 	unsigned long jpeg_size = 0;
+	unsigned long compressed_size = 0;
 	if (CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value || CCD_PREVIEW_ENABLED_ITEM->sw.value) {
-		raw_to_jpeg(device, data, frame_width, frame_height, bpp, little_endian, byte_order_rgb, &jpeg_data, &jpeg_size);
+		int scale = CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value ? 1 : CCD_JPEG_SETTINGS_PREVIEW_SCALE_ITEM->number.target;
+		raw_to_jpeg(device, data, frame_width, frame_height, bpp, little_endian, byte_order_rgb, scale, &jpeg_data, &jpeg_size);
 		if (CCD_PREVIEW_ENABLED_ITEM->sw.value) {
-			if (jpeg_data) {
-				if (CCD_CONTEXT->preview_image) {
-					if (CCD_CONTEXT->preview_image_size < jpeg_size) {
-						CCD_CONTEXT->preview_image = realloc(CCD_CONTEXT->preview_image, CCD_CONTEXT->preview_image_size = jpeg_size);
-					}
-				} else {
-					CCD_CONTEXT->preview_image = malloc(CCD_CONTEXT->preview_image_size = jpeg_size);
-				}
+			if (jpeg_data && shared_image_buffer(&CCD_CONTEXT->preview_image, &CCD_CONTEXT->preview_image_size, jpeg_size)) {
 				memcpy(CCD_CONTEXT->preview_image, jpeg_data, jpeg_size);
 				CCD_PREVIEW_IMAGE_ITEM->blob.value = CCD_CONTEXT->preview_image;
 				CCD_PREVIEW_IMAGE_ITEM->blob.size = jpeg_size;
@@ -932,7 +2068,7 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		}
 	}
 
-	if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value) {
+	if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value || CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value) {
 		INDIGO_DEBUG(clock_t start = clock());
 		time_t timer;
 		struct tm* tm_info;
@@ -1025,6 +2161,10 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		header[t] = ' ';
 		if (keywords) {
 			while (keywords->type && (header - (char *)data) < (FITS_HEADER_SIZE - 80)) {
+				if (skip_keyword(keywords, binned)) {
+					keywords++;
+					continue;
+				}
 				switch (keywords->type) {
 					case INDIGO_FITS_NUMBER:
 						t = sprintf(header += 80, "%7s= %20f / %s", keywords->name, keywords->number, keywords->comment);
@@ -1050,84 +2190,11 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		}
 		t = sprintf(header += 80, "END");
 		header[t] = ' ';
-		if (byte_per_pixel == 2 && naxis == 2) {
-			short *raw = (short *)(data + FITS_HEADER_SIZE);
-			if (little_endian) {
-				for (int i = 0; i < size; i++) {
-					int value = *raw - 32768;
-					*raw++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-				}
-			} else {
-				for (int i = 0; i < size; i++) {
-					int value = *raw;
-					value = ((value & 0xff) << 8 | (value & 0xff00) >> 8 ) - 32768;
-					*raw++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-				}
-			}
-		} else if (byte_per_pixel == 1 && naxis == 3) {
-			unsigned char *raw = malloc(3 * size);
-			unsigned char *red = raw;
-			unsigned char *green = raw + size;
-			unsigned char *blue = raw + 2 * size;
-			unsigned char *tmp = data + FITS_HEADER_SIZE;
-			if (byte_order_rgb) {
-				for (int i = 0; i < size; i++) {
-					*red++ = *tmp++;
-					*green++ = *tmp++;
-					*blue++ = *tmp++;
-				}
-			} else {
-				for (int i = 0; i < size; i++) {
-					*blue++ = *tmp++;
-					*green++ = *tmp++;
-					*red++ = *tmp++;
-				}
-			}
-			memcpy(data + FITS_HEADER_SIZE, raw, 3 * size);
-			free(raw);
-		} else if (byte_per_pixel == 2 && naxis == 3) {
-			unsigned short *raw = malloc(6 * size);
-			unsigned short *red = raw;
-			unsigned short *green = raw + size;
-			unsigned short *blue = raw + 2 * size;
-			unsigned short *tmp = (unsigned short *)(data + FITS_HEADER_SIZE);
-			if (little_endian) {
-				if (byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						int value = *tmp++ - 32768;
-						*red++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *tmp++ - 32768;
-						*green++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *tmp++ - 32768;
-						*blue++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-					}
-				} else {
-					for (int i = 0; i < size; i++) {
-						int value = *tmp++ - 32768;
-						*blue++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *tmp++ - 32768;
-						*green++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *tmp++ - 32768;
-						*red++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-					}
-				}
-			} else {
-				if (byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						*red++ = *tmp++;
-						*green++ = *tmp++;
-						*blue++ = *tmp++;
-					}
-				} else {
-					for (int i = 0; i < size; i++) {
-						*blue++ = *tmp++;
-						*green++ = *tmp++;
-						*red++ = *tmp++;
-					}
-				}
-			}
-			memcpy(data + FITS_HEADER_SIZE, raw, 6 * size);
-			free(raw);
+		convert_frame(data + FITS_HEADER_SIZE, frame_width, frame_height, naxis == 3 ? 3 : 1, byte_per_pixel, !little_endian, !byte_order_rgb, true, byte_per_pixel == 2, naxis == 3);
+		if (CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value) {
+			INDIGO_DEBUG(double compression_start = preview_time());
+			compressed_size = compress_fits(device, data, frame_width, frame_height, naxis == 3 ? 3 : 1, byte_per_pixel);
+			INDIGO_DEBUG(indigo_debug("Rice compression %lu -> %lu bytes in %gs", blobsize, compressed_size, preview_time() - compression_start));
 		}
 		int mod2880 = blobsize % 2880;
 		if (mod2880) {
@@ -1138,7 +2205,7 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 			}
 		}
 		INDIGO_DEBUG(indigo_debug("RAW to FITS conversion in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
-	} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value) {
+	} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value || CCD_IMAGE_FORMAT_XISF_LZ4_ITEM->sw.value) {
 		INDIGO_DEBUG(clock_t start = clock());
 		time_t timer;
 		struct tm* tm_info;
@@ -1150,9 +2217,27 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		tm_info = gmtime(&timer);
 		strftime(date_time_start, 21, "%Y-%m-%dT%H:%M:%SZ", tm_info);
 		char *header = data;
+		convert_frame(data + FITS_HEADER_SIZE, frame_width, frame_height, naxis == 3 ? 3 : 1, byte_per_pixel, !little_endian, !byte_order_rgb, false, false, false);
+		char subblocks[PREVIEW_MAX_THREADS * 48], attachment[sizeof(subblocks) + 128];
+		if (CCD_IMAGE_FORMAT_XISF_LZ4_ITEM->sw.value) {
+			INDIGO_DEBUG(double compression_start = preview_time());
+			compressed_size = compress_xisf(device, data + FITS_HEADER_SIZE, blobsize, byte_per_pixel, subblocks);
+			INDIGO_DEBUG(indigo_debug("LZ4 compression %lu -> %lu bytes in %gs", blobsize, compressed_size, preview_time() - compression_start));
+		}
+		if (compressed_size == 0)
+			sprintf(attachment, "location='attachment:%d:%lu'", FITS_HEADER_SIZE, blobsize);
+		else if (byte_per_pixel == 1)
+			sprintf(attachment, "location='attachment:%d:%lu' compression='lz4:%lu'", FITS_HEADER_SIZE, compressed_size, blobsize);
+		else
+			sprintf(attachment, "location='attachment:%d:%lu' compression='lz4+sh:%lu:%d'", FITS_HEADER_SIZE, compressed_size, blobsize, byte_per_pixel);
+		if (compressed_size && *subblocks) {
+			strcat(attachment, " subblocks='");
+			strcat(attachment, subblocks);
+			strcat(attachment, "'");
+		}
 		strcpy(header, "XISF0100");
 		header += 16;
-		memset(header, 0, FITS_HEADER_SIZE);
+		memset(header, 0, FITS_HEADER_SIZE - 16);
 		sprintf(header, "<?xml version='1.0' encoding='UTF-8'?><xisf xmlns='http://www.pixinsight.com/xisf' xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance' version='1.0' xsi:schemaLocation='http://www.pixinsight.com/xisf http://pixinsight.com/xisf/xisf-1.0.xsd'>");
 		header += strlen(header);
 		char *frame_type = "Light";
@@ -1164,13 +2249,13 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		else if (CCD_FRAME_TYPE_DARK_ITEM->sw.value)
 			frame_type ="Dark";
 		if (naxis == 2 && byte_per_pixel == 1) {
-			sprintf(header, "<Image geometry='%d:%d:1' imageType='%s' sampleFormat='UInt8' colorSpace='Gray' location='attachment:%d:%lu'>", frame_width, frame_height, frame_type, FITS_HEADER_SIZE, blobsize);
+			sprintf(header, "<Image geometry='%d:%d:1' imageType='%s' sampleFormat='UInt8' colorSpace='Gray' %s>", frame_width, frame_height, frame_type, attachment);
 		} else if (naxis == 2 && byte_per_pixel == 2) {
-			sprintf(header, "<Image geometry='%d:%d:1' imageType='%s' sampleFormat='UInt16' colorSpace='Gray' location='attachment:%d:%lu'>", frame_width, frame_height, frame_type, FITS_HEADER_SIZE, blobsize);
+			sprintf(header, "<Image geometry='%d:%d:1' imageType='%s' sampleFormat='UInt16' colorSpace='Gray' %s>", frame_width, frame_height, frame_type, attachment);
 		} else if (naxis == 3 && byte_per_pixel == 1) {
-			sprintf(header, "<Image geometry='%d:%d:3' imageType='%s' pixelStorage='Normal' sampleFormat='UInt8' colorSpace='RGB' location='attachment:%d:%lu'>", frame_width, frame_height, frame_type, FITS_HEADER_SIZE, blobsize);
+			sprintf(header, "<Image geometry='%d:%d:3' imageType='%s' pixelStorage='Normal' sampleFormat='UInt8' colorSpace='RGB' %s>", frame_width, frame_height, frame_type, attachment);
 		} else if (naxis == 3 && byte_per_pixel == 2) {
-			sprintf(header, "<Image geometry='%d:%d:3' imageType='%s' pixelStorage='Normal' sampleFormat='UInt16' colorSpace='RGB' location='attachment:%d:%lu'>", frame_width, frame_height, frame_type, FITS_HEADER_SIZE, blobsize);
+			sprintf(header, "<Image geometry='%d:%d:3' imageType='%s' pixelStorage='Normal' sampleFormat='UInt16' colorSpace='RGB' %s>", frame_width, frame_height, frame_type, attachment);
 		}
 		header += strlen(header);
 		sprintf(header, "<Property id='Observation:Time:Start' type='TimePoint' value='%s'/><Property id='Observation:Time:End' type='TimePoint' value='%s'/>", date_time_start ,date_time_end);
@@ -1203,7 +2288,7 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		}
 		if (keywords) {
 			while (keywords->type) {
-				if (!strcmp(keywords->name, "BAYERPAT")) {
+				if (!strcmp(keywords->name, "BAYERPAT") && !skip_keyword(keywords, binned)) {
 					sprintf(header, "<ColorFilterArray pattern='%s' width='2' height='2'/>", keywords->string);
 					header += strlen(header);
 				}
@@ -1225,120 +2310,22 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		sprintf(header, "<Property id='XISF:BlockAlignmentSize' type='UInt16' value='2880'/></Metadata></xisf>");
 		header += strlen(header);
 		*(uint32_t *)(data + 8) = (uint32_t)(header - (char *)data) - 16;
-		if (naxis == 2 && byte_per_pixel == 2) {
-			if (!little_endian) {
-				short *b16 = (short *)(data + FITS_HEADER_SIZE);
-				for (int i = 0; i < size; i++) {
-					int value = *b16;
-					*b16++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-				}
-			}
-		} else if (naxis == 3 && byte_per_pixel == 1) {
-			if (!byte_order_rgb) {
-				unsigned char *b8 = data + FITS_HEADER_SIZE;
-				for (int i = 0; i < size; i++) {
-					unsigned char b = *b8;
-					unsigned char r = *(b8 + 2);
-					*b8 = r;
-					*(b8 + 2) = b;
-					b8 += 3;
-				}
-			}
-		} else if (naxis == 3 && byte_per_pixel == 2) {
-			unsigned char *b16 = data + FITS_HEADER_SIZE;
-			if (little_endian) {
-				if (!byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						unsigned char b = *b16;
-						unsigned char r = *(b16 + 2);
-						*b16 = r;
-						*(b16 + 2) = b;
-						b16 += 3;
-					}
-				}
-			} else {
-				if (byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						int value = *b16;
-						*b16++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-					}
-				} else {
-					for (int i = 0; i < size; i++) {
-						int value = *b16;
-						unsigned b = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *(b16 + 1);
-						unsigned g = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *(b16 + 2);
-						unsigned r = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						*b16 = r;
-						*(b16 + 1) = g;
-						*(b16 + 2) = b;
-						b16 += 3;
-					}
-				}
-			}
+		if (compressed_size) {
+			memcpy(CCD_CONTEXT->compressed_image, data, FITS_HEADER_SIZE);
+			compressed_size += FITS_HEADER_SIZE;
 		}
 		INDIGO_DEBUG(indigo_debug("RAW to XISF conversion in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
 	} else if (CCD_IMAGE_FORMAT_RAW_ITEM->sw.value) {
 		indigo_raw_header *header = (indigo_raw_header *)(data + FITS_HEADER_SIZE - sizeof(indigo_raw_header));
 		if (naxis == 2 && byte_per_pixel == 1)
 			header->signature = INDIGO_RAW_MONO8;
-		else if (naxis == 2 && byte_per_pixel == 2) {
+		else if (naxis == 2 && byte_per_pixel == 2)
 			header->signature = INDIGO_RAW_MONO16;
-			if (!little_endian) {
-				short *b16 = (short *)(data + FITS_HEADER_SIZE);
-				for (int i = 0; i < size; i++) {
-					int value = *b16;
-					*b16++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-				}
-			}
-		} else if (naxis == 3 && byte_per_pixel == 1) {
+		else if (naxis == 3 && byte_per_pixel == 1)
 			header->signature = INDIGO_RAW_RGB24;
-			if (!byte_order_rgb) {
-				unsigned char *b8 = data + FITS_HEADER_SIZE;
-				for (int i = 0; i < size; i++) {
-					unsigned char b = *b8;
-					unsigned char r = *(b8 + 2);
-					*b8 = r;
-					*(b8 + 2) = b;
-					b8 += 3;
-				}
-			}
-		} else if (naxis == 3 && byte_per_pixel == 2) {
+		else if (naxis == 3 && byte_per_pixel == 2)
 			header->signature = INDIGO_RAW_RGB48;
-			unsigned char *b16 = data + FITS_HEADER_SIZE;
-			if (little_endian) {
-				if (!byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						unsigned char b = *b16;
-						unsigned char r = *(b16 + 2);
-						*b16 = r;
-						*(b16 + 2) = b;
-						b16 += 3;
-					}
-				}
-			} else {
-				if (byte_order_rgb) {
-					for (int i = 0; i < size; i++) {
-						int value = *b16;
-						*b16++ = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-					}
-				} else {
-					for (int i = 0; i < size; i++) {
-						int value = *b16;
-						unsigned b = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *(b16 + 1);
-						unsigned g = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						value = *(b16 + 2);
-						unsigned r = (value & 0xff) << 8 | (value & 0xff00) >> 8;
-						*b16 = r;
-						*(b16 + 1) = g;
-						*(b16 + 2) = b;
-						b16 += 3;
-					}
-				}
-			}
-		}
+		convert_frame(data + FITS_HEADER_SIZE, frame_width, frame_height, naxis == 3 ? 3 : 1, byte_per_pixel, !little_endian, !byte_order_rgb, false, false, false);
 		header->width = frame_width;
 		header->height = frame_height;
 	} else if (CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value) {
@@ -1348,93 +2335,30 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		}
 	}
 	if (CCD_UPLOAD_MODE_LOCAL_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
-		char *dir = CCD_LOCAL_MODE_DIR_ITEM->text.value;
-		char *prefix = CCD_LOCAL_MODE_PREFIX_ITEM->text.value;
-		char *suffix = "";
-		if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value) {
-			suffix = ".fits";
-		} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value) {
-			suffix = ".xisf";
+		if (compressed_size) {
+			save_local(device, CCD_CONTEXT->compressed_image, compressed_size, CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value ? ".fits.fz" : ".xisf");
+		} else if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value || CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value) {
+			save_local(device, data, FITS_HEADER_SIZE + blobsize, ".fits");
+		} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value || CCD_IMAGE_FORMAT_XISF_LZ4_ITEM->sw.value) {
+			save_local(device, data, FITS_HEADER_SIZE + blobsize, ".xisf");
 		} else if (CCD_IMAGE_FORMAT_RAW_ITEM->sw.value) {
-			suffix = ".raw";
+			save_local(device, data + FITS_HEADER_SIZE - sizeof(indigo_raw_header), blobsize + sizeof(indigo_raw_header), ".raw");
 		} else if (CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value) {
-			suffix = ".jpeg";
+			save_local(device, data, blobsize, ".jpeg");
 		}
-		int handle = 0;
-		char *message = NULL;
-		if (strlen(dir) + strlen(prefix) + strlen(suffix) < INDIGO_VALUE_SIZE) {
-			char file_name[INDIGO_VALUE_SIZE];
-			char *placeholder = strstr(prefix, "XXX");
-			if (placeholder == NULL) {
-				strncpy(file_name, dir, INDIGO_VALUE_SIZE);
-				strcat(file_name, prefix);
-				strcat(file_name, suffix);
-			} else {
-				char format[INDIGO_VALUE_SIZE];
-				strcpy(format, dir);
-				strncat(format, prefix, placeholder - prefix);
-				if (!strncmp(placeholder, "XXXX", 4)) {
-					strcat(format, "%04d");
-					strcat(format, placeholder + 4);
-				} else {
-					strcat(format, "%03d");
-					strcat(format, placeholder + 3);
-				}
-				strcat(format, suffix);
-				struct stat sb;
-				int i = 1;
-				while (i < 10000) {
-					snprintf(file_name, sizeof(file_name), format, i);
-					if (stat(file_name, &sb) == 0 && S_ISREG(sb.st_mode))
-						i++;
-					else
-						break;
-				}
-			}
-			strncpy(CCD_IMAGE_FILE_ITEM->text.value, file_name, INDIGO_VALUE_SIZE);
-			CCD_IMAGE_FILE_PROPERTY->state = INDIGO_OK_STATE;
-			handle = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-			if (handle) {
-				if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value) {
-					if (!indigo_write(handle, data, FITS_HEADER_SIZE + blobsize)) {
-						CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-						message = strerror(errno);
-					}
-				} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value) {
-					if (!indigo_write(handle, data, FITS_HEADER_SIZE + blobsize)) {
-						CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-						message = strerror(errno);
-					}
-				} else if (CCD_IMAGE_FORMAT_RAW_ITEM->sw.value) {
-					if (!indigo_write(handle, data + FITS_HEADER_SIZE - sizeof(indigo_raw_header), blobsize + sizeof(indigo_raw_header))) {
-						CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-						message = strerror(errno);
-					}
-				} else if (CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value) {
-					if (!indigo_write(handle, data, blobsize)) {
-						CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-						message = strerror(errno);
-					}
-				}
-				close(handle);
-			} else {
-				CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-				message = strerror(errno);
-			}
-		} else {
-			CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-			message = "dir + prefix + suffix is too long";
-		}
-		indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, message);
-		INDIGO_DEBUG(indigo_debug("Local save in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+		INDIGO_DEBUG(indigo_debug("Local save queued in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
 	}
 	if (CCD_UPLOAD_MODE_CLIENT_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
 		*CCD_IMAGE_ITEM->blob.url = 0;
-		if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value) {
+		if (compressed_size) {
+			CCD_IMAGE_ITEM->blob.value = CCD_CONTEXT->compressed_image;
+			CCD_IMAGE_ITEM->blob.size = compressed_size;
+			strcpy(CCD_IMAGE_ITEM->blob.format, CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value ? ".fits.fz" : ".xisf");
+		} else if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value || CCD_IMAGE_FORMAT_FITS_RICE_ITEM->sw.value) {
 			CCD_IMAGE_ITEM->blob.value = data;
 			CCD_IMAGE_ITEM->blob.size = FITS_HEADER_SIZE + blobsize;
 			strcpy(CCD_IMAGE_ITEM->blob.format, ".fits");
-		} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value) {
+		} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value || CCD_IMAGE_FORMAT_XISF_LZ4_ITEM->sw.value) {
 			CCD_IMAGE_ITEM->blob.value = data;
 			CCD_IMAGE_ITEM->blob.size = FITS_HEADER_SIZE + blobsize;
 			strcpy(CCD_IMAGE_ITEM->blob.format, ".xisf");
@@ -1466,53 +2390,8 @@ void indigo_process_dslr_image(indigo_device *device, void *data, int blobsize,
 	if (!strcmp(standard_suffix, ".jpg"))
 		strcpy(standard_suffix, ".jpeg");
 	if (CCD_UPLOAD_MODE_LOCAL_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
-		char *dir = CCD_LOCAL_MODE_DIR_ITEM->text.value;
-		char *prefix = CCD_LOCAL_MODE_PREFIX_ITEM->text.value;
-		int handle = 0;
-		char *message = NULL;
-		if (strlen(dir) + strlen(prefix) + strlen(standard_suffix) < INDIGO_VALUE_SIZE) {
-			char file_name[INDIGO_VALUE_SIZE];
-			char *xxx = strstr(prefix, "XXX");
-			if (xxx == NULL) {
-				strncpy(file_name, dir, INDIGO_VALUE_SIZE - strlen(prefix) - strlen(standard_suffix));
-				strcat(file_name, prefix);
-				strcat(file_name, standard_suffix);
-			} else {
-				char format[INDIGO_VALUE_SIZE];
-				strncpy(format, dir, INDIGO_VALUE_SIZE);
-				strncat(format, prefix, xxx - prefix);
-				strcat(format, "%03d");
-				strcat(format, xxx+3);
-				strcat(format, standard_suffix);
-				struct stat sb;
-				int i = 1;
-				while (true) {
-					snprintf(file_name, sizeof(file_name), format, i);
-					if (stat(file_name, &sb) == 0 && S_ISREG(sb.st_mode))
-						i++;
-					else
-						break;
-				}
-			}
-			strncpy(CCD_IMAGE_FILE_ITEM->text.value, file_name, INDIGO_VALUE_SIZE);
-			CCD_IMAGE_FILE_PROPERTY->state = INDIGO_OK_STATE;
-			handle = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-			if (handle) {
-				if (!indigo_write(handle, data, blobsize)) {
-					CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-					message = strerror(errno);
-				}
-				close(handle);
-			} else {
-				CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-				message = strerror(errno);
-			}
-		} else {
-			CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
-			message = "dir + prefix + suffix is too long";
-		}
-		indigo_update_property(device, CCD_IMAGE_FILE_PROPERTY, message);
-		INDIGO_DEBUG(indigo_debug("Local save in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+		save_local(device, data, blobsize, standard_suffix);
+		INDIGO_DEBUG(indigo_debug("Local save queued in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
 	}
 	if (CCD_UPLOAD_MODE_CLIENT_ITEM->sw.value || CCD_UPLOAD_MODE_BOTH_ITEM->sw.value) {
 		*CCD_IMAGE_ITEM->blob.url = 0;
@@ -1526,13 +2405,8 @@ void indigo_process_dslr_image(indigo_device *device, void *data, int blobsize,
 }
 
 void indigo_process_dslr_preview_image(indigo_device *device, void *data, int blobsize) {
-	if (CCD_CONTEXT->preview_image) {
-		if (CCD_CONTEXT->preview_image_size < blobsize) {
-			CCD_CONTEXT->preview_image = realloc(CCD_CONTEXT->preview_image, CCD_CONTEXT->preview_image_size = blobsize);
-		}
-	} else {
-		CCD_CONTEXT->preview_image = malloc(CCD_CONTEXT->preview_image_size = blobsize);
-	}
+	if (shared_image_buffer(&CCD_CONTEXT->preview_image, &CCD_CONTEXT->preview_image_size, blobsize) == NULL)
+		return;
 	memcpy(CCD_CONTEXT->preview_image, data, blobsize);
 	CCD_PREVIEW_IMAGE_ITEM->blob.value = CCD_CONTEXT->preview_image;
 	CCD_PREVIEW_IMAGE_ITEM->blob.size = blobsize;
@@ -50,6 +50,7 @@
 #endif
 
 #include <indigo/indigo_client_xml.h>
+#include <indigo/indigo_client_binary.h>
 #include <indigo/indigo_client.h>
 
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -223,8 +224,7 @@ static void *subprocess_thread(indigo_subprocess_entry *subprocess) {
 			indigo_attach_device(subprocess->protocol_adapter);
 			indigo_xml_parse(subprocess->protocol_adapter, NULL);
 			indigo_detach_device(subprocess->protocol_adapter);
-			free(subprocess->protocol_adapter->device_context);
-			free(subprocess->protocol_adapter);
+			indigo_release_xml_client_adapter(subprocess->protocol_adapter);
 		}
 		if (subprocess->pid >= 0) {
 			 indigo_usleep(sleep_interval * 1000000);
@@ -295,6 +295,7 @@ indigo_result indigo_kill_subprocess(indigo_subprocess_entry *subprocess) {
 
 static int used_server_slots = 0;
 indigo_server_entry indigo_available_servers[INDIGO_MAX_SERVERS];
+bool indigo_use_binary_protocol = false;
 
 void indigo_service_name(const char *host, int port, char *name) {
   strncpy(name, host, INDIGO_NAME_SIZE);
@@ -379,12 +380,23 @@ static void *server_thread(indigo_server_entry *server) {
 #if defined(INDIGO_WINDOWS)
 			indigo_send_message(server->protocol_adapter, "connected");
 #endif
-			server->protocol_adapter = indigo_xml_client_adapter(server->name, url, server->socket, server->socket);
-			indigo_attach_device(server->protocol_adapter);
-			indigo_xml_parse(server->protocol_adapter, NULL);
-			indigo_detach_device(server->protocol_adapter);
-			free(server->protocol_adapter->device_context);
-			free(server->protocol_adapter);
+			if (server->binary_protocol) {
+				server->protocol_adapter = indigo_binary_client_adapter(server->name, url, server->socket, server->socket);
+				indigo_attach_device(server->protocol_adapter);
+				if (!indigo_binary_parse(server->protocol_adapter, NULL)) {
+					// older server closes connection on unknown protocol, reconnect with XML
+					INDIGO_LOG(indigo_log("Server %s:%d doesn't support binary protocol", server->host, server->port));
+					server->binary_protocol = false;
+				}
+				indigo_detach_device(server->protocol_adapter);
+				indigo_release_binary_client_adapter(server->protocol_adapter);
+			} else {
+				server->protocol_adapter = indigo_xml_client_adapter(server->name, url, server->socket, server->socket);
+				indigo_attach_device(server->protocol_adapter);
+				indigo_xml_parse(server->protocol_adapter, NULL);
+				indigo_detach_device(server->protocol_adapter);
+				indigo_release_xml_client_adapter(server->protocol_adapter);
+			}
 			server->protocol_adapter = NULL;
 			pthread_mutex_lock(&mutex);
 			reset_socket(server, 0);
@@ -431,6 +443,7 @@ indigo_result indigo_connect_server(const char *name, const char *host, int port
 	strncpy(indigo_available_servers[empty_slot].host, host, INDIGO_NAME_SIZE);
 	indigo_available_servers[empty_slot].port = port;
 	indigo_available_servers[empty_slot].socket = 0;
+	indigo_available_servers[empty_slot].binary_protocol = indigo_use_binary_protocol;
 	*indigo_available_servers[empty_slot].last_error = 0;
 	if (pthread_create(&indigo_available_servers[empty_slot].thread, NULL, (void*) (void *) server_thread, &indigo_available_servers[empty_slot]) != 0) {
 		pthread_mutex_unlock(&mutex);
@@ -0,0 +1,196 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following
+// disclaimer in the documentation and/or other materials provided
+// with the distribution.
+//
+// 3. The name of the author may not be used to endorse or promote
+// products derived from this software without specific prior
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary wire protocol driver side adapter
+ \file indigo_client_binary.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <assert.h>
+
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+#include <unistd.h>
+#endif
+
+#if defined(INDIGO_WINDOWS)
+#include <io.h>
+#include <winsock2.h>
+#define close closesocket
+#pragma warning(disable:4996)
+#endif
+
+#include <indigo/indigo_binary.h>
+#include <indigo/indigo_io.h>
+#include <indigo/indigo_client_binary.h>
+
+static void remote_device_name(char *device_name, const char *device) {
+	strncpy(device_name, device, INDIGO_NAME_SIZE);
+	if (indigo_use_host_suffix) {
+		char *at = strrchr(device_name, '@');
+		if (at != NULL) {
+			while (at > device_name && at[-1] == ' ')
+				at--;
+			*at = 0;
+		}
+	}
+}
+
+static indigo_result binary_client_parser_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	assert(device != NULL);
+	if (!indigo_reshare_remote_devices && client && client->is_remote)
+		return INDIGO_OK;
+	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
+	assert(device_context != NULL);
+	indigo_binary_context *context = device_context->binary_context;
+	char device_name[INDIGO_NAME_SIZE] = "";
+	if (property != NULL && *property->device)
+		remote_device_name(device_name, property->device);
+	indigo_binary_lock(context);
+	indigo_binary_begin(context, INDIGO_BINARY_GET_PROPERTIES);
+	indigo_binary_put_string(context, device_name);
+	indigo_binary_put_string(context, property != NULL ? property->name : "");
+	indigo_binary_end(context, device_context->output_buffer, 0);
+	indigo_output_flush(device_context->output_buffer);
+	indigo_binary_unlock(context);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_client_parser_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	assert(device != NULL);
+	assert(property != NULL);
+	if (!indigo_reshare_remote_devices && client && client->is_remote)
+		return INDIGO_OK;
+	if (property->type != INDIGO_TEXT_VECTOR && property->type != INDIGO_NUMBER_VECTOR && property->type != INDIGO_SWITCH_VECTOR)
+		return INDIGO_OK;
+	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
+	assert(device_context != NULL);
+	indigo_binary_context *context = device_context->binary_context;
+	indigo_binary_lock(context);
+	// ids are registered under the names with host suffix, exactly as defined on the bus
+	uint32_t id = indigo_binary_find_id(context, property->device, property->name);
+	indigo_property *remote = id ? indigo_binary_property(context, id) : NULL;
+	if (remote == NULL) {
+		indigo_binary_unlock(context);
+		return INDIGO_NOT_FOUND;
+	}
+	indigo_binary_begin(context, INDIGO_BINARY_NEW_VECTOR);
+	indigo_binary_put_u32(context, id);
+	long count_offset = indigo_binary_length(context);
+	indigo_binary_put_u16(context, 0);
+	int count = 0;
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = &property->items[i];
+		int index = 0;
+		while (index < remote->count && strncmp(remote->items[index].name, item->name, INDIGO_NAME_SIZE))
+			index++;
+		if (index == remote->count)
+			continue;
+		indigo_binary_put_u16(context, index);
+		switch (property->type) {
+			case INDIGO_TEXT_VECTOR:
+				indigo_binary_put_string(context, item->text.value);
+				break;
+			case INDIGO_NUMBER_VECTOR:
+				indigo_binary_put_double(context, item->number.value);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				indigo_binary_put_u8(context, item->sw.value);
+				break;
+			default:
+				break;
+		}
+		count++;
+	}
+	indigo_binary_patch_u16(context, count_offset, count);
+	indigo_binary_end(context, device_context->output_buffer, 0);
+	indigo_output_flush(device_context->output_buffer);
+	indigo_binary_unlock(context);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_client_parser_enable_blob(indigo_device *device, indigo_client *client, indigo_property *property, indigo_enable_blob_mode mode) {
+	assert(device != NULL);
+	assert(property != NULL);
+	if (!indigo_reshare_remote_devices && client && client->is_remote)
+		return INDIGO_OK;
+	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
+	assert(device_context != NULL);
+	indigo_binary_context *context = device_context->binary_context;
+	char device_name[INDIGO_NAME_SIZE];
+	remote_device_name(device_name, property->device);
+	indigo_binary_lock(context);
+	indigo_binary_begin(context, INDIGO_BINARY_ENABLE_BLOB);
+	indigo_binary_put_string(context, device_name);
+	indigo_binary_put_string(context, property->name);
+	indigo_binary_put_u8(context, mode);
+	indigo_binary_end(context, device_context->output_buffer, 0);
+	indigo_output_flush(device_context->output_buffer);
+	indigo_binary_unlock(context);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_client_parser_detach(indigo_device *device) {
+	assert(device != NULL);
+	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
+	close(device_context->input);
+	close(device_context->output);
+	return INDIGO_OK;
+}
+
+indigo_device *indigo_binary_client_adapter(char *name, char *url_prefix, int input, int output) {
+	static indigo_device device_template = INDIGO_DEVICE_INITIALIZER(
+		"", NULL,
+		binary_client_parser_enumerate_properties,
+		binary_client_parser_change_property,
+		binary_client_parser_enable_blob,
+		binary_client_parser_detach
+	);
+	indigo_device *device = malloc(sizeof(indigo_device));
+	assert(device != NULL);
+	memcpy(device, &device_template, sizeof(indigo_device));
+	sprintf(device->name, "@ %s", name);
+	device->is_remote = input == output; // is socket, otherwise is pipe
+	indigo_adapter_context *device_context = malloc(sizeof(indigo_adapter_context));
+	assert(device_context != NULL);
+	memset(device_context, 0, sizeof(indigo_adapter_context));
+	device_context->input = input;
+	device_context->output = output;
+	device_context->output_buffer = indigo_output_create(output);
+	device_context->binary_context = indigo_binary_context_create();
+	strncpy(device_context->url_prefix, url_prefix, INDIGO_NAME_SIZE);
+	device->device_context = device_context;
+	indigo_binary_write_preamble(device_context->output_buffer);
+	indigo_output_flush(device_context->output_buffer);
+	return device;
+}
+
+void indigo_release_binary_client_adapter(indigo_device *device) {
+	assert(device != NULL);
+	assert(device->device_context != NULL);
+	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
+	indigo_output_release(device_context->output_buffer);
+	indigo_binary_context_release(device_context->binary_context);
+	free(device_context);
+	free(device);
+}
@@ -58,7 +58,7 @@ static indigo_result xml_client_parser_enumerate_properties(indigo_device *devic
 	pthread_mutex_lock(&xml_mutex);
 	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
 	assert(device_context != NULL);
-	int handle = device_context->output;
+	indigo_output_buffer *output = device_context->output_buffer;
 	char device_name[INDIGO_NAME_SIZE];
 	if (property != NULL && *property->device) {
 		strncpy(device_name, property->device, INDIGO_NAME_SIZE);
@@ -73,17 +73,18 @@ static indigo_result xml_client_parser_enumerate_properties(indigo_device *devic
 	}
 	if (property != NULL) {
 		if (*property->device && *indigo_property_name(device->version, property)) {
-			indigo_printf(handle, "<getProperties version='1.7' switch='%d.%d' device='%s' name='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_xml_escape(device_name), indigo_property_name(device->version, property));
+			indigo_output_printf(output, "<getProperties version='1.7' switch='%d.%d' device='%s' name='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_xml_escape(device_name), indigo_property_name(device->version, property));
 		} else if (*property->device) {
-			indigo_printf(handle, "<getProperties version='1.7' switch='%d.%d' device='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_xml_escape(device_name));
+			indigo_output_printf(output, "<getProperties version='1.7' switch='%d.%d' device='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_xml_escape(device_name));
 		} else if (*indigo_property_name(device->version, property)) {
-			indigo_printf(handle, "<getProperties version='1.7' switch='%d.%d' name='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_property_name(device->version, property));
+			indigo_output_printf(output, "<getProperties version='1.7' switch='%d.%d' name='%s'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, indigo_property_name(device->version, property));
 		} else {
-			indigo_printf(handle, "<getProperties version='1.7' switch='%d.%d'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF);
+			indigo_output_printf(output, "<getProperties version='1.7' switch='%d.%d'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF);
 		}
 	} else {
-		indigo_printf(handle, "<getProperties version='1.7' switch='%d.%d'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF);
+		indigo_output_printf(output, "<getProperties version='1.7' switch='%d.%d'/>\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF);
 	}
+	indigo_output_flush(output);
 	pthread_mutex_unlock(&xml_mutex);
 	return INDIGO_OK;
 }
@@ -96,7 +97,7 @@ static indigo_result xml_client_parser_change_property(indigo_device *device, in
 	pthread_mutex_lock(&xml_mutex);
 	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
 	assert(device_context != NULL);
-	int handle = device_context->output;
+	indigo_output_buffer *output = device_context->output_buffer;
 	char device_name[INDIGO_NAME_SIZE];
 	char b1[32];
 	strncpy(device_name, property->device, INDIGO_NAME_SIZE);
@@ -110,32 +111,33 @@ static indigo_result xml_client_parser_change_property(indigo_device *device, in
 	}
 	switch (property->type) {
 	case INDIGO_TEXT_VECTOR:
-		indigo_printf(handle, "<newTextVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
+		indigo_output_printf(output, "<newTextVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<oneText name='%s'>%s</oneText>\n", indigo_item_name(device->version, property, item), indigo_xml_escape(item->text.value));
+			indigo_output_printf(output, "<oneText name='%s'>%s</oneText>\n", indigo_item_name(device->version, property, item), indigo_xml_escape(item->text.value));
 		}
-		indigo_printf(handle, "</newTextVector>\n");
+		indigo_output_printf(output, "</newTextVector>\n");
 		break;
 	case INDIGO_NUMBER_VECTOR:
-		indigo_printf(handle, "<newNumberVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
+		indigo_output_printf(output, "<newNumberVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<oneNumber name='%s'>%s</oneNumber>\n", indigo_item_name(device->version, property, item), indigo_dtoa(item->number.value, b1));
+			indigo_output_printf(output, "<oneNumber name='%s'>%s</oneNumber>\n", indigo_item_name(device->version, property, item), indigo_dtoa(item->number.value, b1));
 		}
-		indigo_printf(handle, "</newNumberVector>\n");
+		indigo_output_printf(output, "</newNumberVector>\n");
 		break;
 	case INDIGO_SWITCH_VECTOR:
-		indigo_printf(handle, "<newSwitchVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
+		indigo_output_printf(output, "<newSwitchVector device='%s' name='%s'>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), indigo_property_state_text[property->state]);
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<oneSwitch name='%s'>%s</oneSwitch>\n", indigo_item_name(device->version, property, item), item->sw.value ? "On" : "Off");
+			indigo_output_printf(output, "<oneSwitch name='%s'>%s</oneSwitch>\n", indigo_item_name(device->version, property, item), item->sw.value ? "On" : "Off");
 		}
-		indigo_printf(handle, "</newSwitchVector>\n");
+		indigo_output_printf(output, "</newSwitchVector>\n");
 		break;
 	default:
 		break;
 	}
+	indigo_output_flush(output);
 	pthread_mutex_unlock(&xml_mutex);
 	return INDIGO_OK;
 }
@@ -148,7 +150,7 @@ static indigo_result xml_client_parser_enable_blob(indigo_device *device, indigo
 	pthread_mutex_lock(&xml_mutex);
 	indigo_adapter_context *device_context = (indigo_adapter_context *)device->device_context;
 	assert(device_context != NULL);
-	int handle = device_context->output;
+	indigo_output_buffer *output = device_context->output_buffer;
 	char device_name[INDIGO_NAME_SIZE];
 	strncpy(device_name, property->device, INDIGO_NAME_SIZE);
 	if (indigo_use_host_suffix) {
@@ -165,9 +167,10 @@ static indigo_result xml_client_parser_enable_blob(indigo_device *device, indigo
 	else if (mode == INDIGO_ENABLE_BLOB_URL && device->version >= INDIGO_VERSION_2_0)
 		mode_text = "URL";
 	if (*property->name)
-		indigo_printf(handle, "<enableBLOB device='%s' name='%s'>%s</enableBLOB>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), mode_text);
+		indigo_output_printf(output, "<enableBLOB device='%s' name='%s'>%s</enableBLOB>\n", indigo_xml_escape(device_name), indigo_property_name(device->version, property), mode_text);
 	else
-		indigo_printf(handle, "<enableBLOB device='%s'>%s</enableBLOB>\n", indigo_xml_escape(device_name), mode_text);
+		indigo_output_printf(output, "<enableBLOB device='%s'>%s</enableBLOB>\n", indigo_xml_escape(device_name), mode_text);
+	indigo_output_flush(output);
 	pthread_mutex_unlock(&xml_mutex);
 	return INDIGO_OK;
 }
@@ -197,7 +200,16 @@ indigo_device *indigo_xml_client_adapter(char *name, char *url_prefix, int input
 	assert(device_context != NULL);
 	device_context->input = input;
 	device_context->output = output;
+	device_context->output_buffer = indigo_output_create(output);
 	strncpy(device_context->url_prefix, url_prefix, INDIGO_NAME_SIZE);
 	device->device_context = device_context;
 	return device;
 }
+
+void indigo_release_xml_client_adapter(indigo_device *device) {
+	assert(device != NULL);
+	assert(device->device_context != NULL);
+	indigo_output_release(((indigo_adapter_context *)device->device_context)->output_buffer);
+	free(device->device_context);
+	free(device);
+}
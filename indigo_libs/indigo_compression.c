@@ -0,0 +1,386 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO lossless image compression
+ \file indigo_compression.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <indigo/indigo_compression.h>
+
+// Rice coding, bitstream compatible with RICE_1 tile compression of cfitsio (fits_rcomp_short / fits_rcomp_byte)
+
+typedef struct {
+	uint8_t *out;
+	uint8_t *end;
+	uint64_t buffer;
+	int count;
+} rice_writer;
+
+typedef struct {
+	const uint8_t *in;
+	const uint8_t *end;
+	uint64_t buffer;
+	int count;
+} rice_reader;
+
+static inline bool rice_put(rice_writer *writer, uint32_t value, int bits) {
+	// less than 32 bits are pending, so up to 32 new bits still fit and whole 32 bit words are written out
+	writer->buffer = (writer->buffer << bits) | (value & (uint32_t)((1ULL << bits) - 1));
+	writer->count += bits;
+	if (writer->count >= 32) {
+		if (writer->end - writer->out < 4)
+			return false;
+		writer->count -= 32;
+		uint32_t word = (uint32_t)(writer->buffer >> writer->count);
+		writer->out[0] = (uint8_t)(word >> 24);
+		writer->out[1] = (uint8_t)(word >> 16);
+		writer->out[2] = (uint8_t)(word >> 8);
+		writer->out[3] = (uint8_t)word;
+		writer->out += 4;
+	}
+	return true;
+}
+
+static inline bool rice_get(rice_reader *reader, int bits, uint32_t *value) {
+	while (reader->count < bits) {
+		if (reader->in == reader->end)
+			return false;
+		reader->buffer = (reader->buffer << 8) | *reader->in++;
+		reader->count += 8;
+	}
+	reader->count -= bits;
+	*value = (uint32_t)(reader->buffer >> reader->count) & (uint32_t)((1ULL << bits) - 1);
+	return true;
+}
+
+static inline uint32_t rice_pixel(const uint8_t *pixels, long index, int bytes) {
+	if (bytes == 2)
+		return (pixels[2 * index] << 8) | pixels[2 * index + 1];
+	return pixels[index];
+}
+
+static inline __attribute__((always_inline)) long rice_compress(const uint8_t *pixels, long count, const int bytes, uint8_t *out, long out_size) {
+	const int fs_bits = bytes == 2 ? 4 : 3, fs_max = bytes == 2 ? 14 : 6, b_bits = bytes * 8;
+	rice_writer writer = { out, out + out_size, 0, 0 };
+	uint32_t diff[INDIGO_RICE_BLOCK_SIZE];
+	if (count <= 0)
+		return 0;
+	uint32_t last = rice_pixel(pixels, 0, bytes);
+	if (!rice_put(&writer, last, b_bits))
+		return -1;
+	for (long i = 0; i < count; i += INDIGO_RICE_BLOCK_SIZE) {
+		int block = count - i < INDIGO_RICE_BLOCK_SIZE ? (int)(count - i) : INDIGO_RICE_BLOCK_SIZE;
+		uint64_t sum = 0;
+		for (int j = 0; j < block; j++) {
+			uint32_t pixel = rice_pixel(pixels, i + j, bytes);
+			int32_t delta = bytes == 2 ? (int16_t)(pixel - last) : (int8_t)(pixel - last);
+			last = pixel;
+			sum += diff[j] = delta < 0 ? ~((uint32_t)delta << 1) : (uint32_t)delta << 1;
+		}
+		uint64_t mean = sum > (uint64_t)(block / 2 + 1) ? ((sum - block / 2 - 1) / block) >> 1 : 0;
+		int fs = 0;
+		while (mean) {
+			fs++;
+			mean >>= 1;
+		}
+		if (fs >= fs_max) {
+			// high entropy block, differences are stored verbatim
+			if (!rice_put(&writer, fs_max + 1, fs_bits))
+				return -1;
+			for (int j = 0; j < block; j++) {
+				if (!rice_put(&writer, diff[j], b_bits))
+					return -1;
+			}
+		} else if (fs == 0 && sum == 0) {
+			// flat block, just the code
+			if (!rice_put(&writer, 0, fs_bits))
+				return -1;
+		} else {
+			if (!rice_put(&writer, fs + 1, fs_bits))
+				return -1;
+			for (int j = 0; j < block; j++) {
+				uint32_t top = diff[j] >> fs;
+				// unary coded top bits (zeros terminated by one) followed by fs low bits
+				while (top + 1 + fs > 32) {
+					if (!rice_put(&writer, 0, 16))
+						return -1;
+					top -= 16;
+				}
+				if (!rice_put(&writer, (1U << fs) | (diff[j] & ((1U << fs) - 1)), top + 1 + fs))
+					return -1;
+			}
+		}
+	}
+	while (writer.count > 0) {
+		if (writer.out == writer.end)
+			return -1;
+		// the last byte is padded with zeros
+		*writer.out++ = (uint8_t)(writer.count >= 8 ? writer.buffer >> (writer.count - 8) : writer.buffer << (8 - writer.count));
+		writer.count -= 8;
+	}
+	return writer.out - out;
+}
+
+long indigo_rice_compress(const void *data, long count, int bytes, uint8_t *out, long out_size) {
+	// specialized copies for constant pixel size
+	if (bytes == 2)
+		return rice_compress(data, count, 2, out, out_size);
+	return rice_compress(data, count, 1, out, out_size);
+}
+
+long indigo_rice_decompress(const uint8_t *in, long in_size, void *data, long count, int bytes) {
+	uint8_t *pixels = data;
+	const int fs_bits = bytes == 2 ? 4 : 3, fs_max = bytes == 2 ? 14 : 6, b_bits = bytes * 8;
+	const uint32_t pixel_mask = bytes == 2 ? 0xFFFF : 0xFF;
+	rice_reader reader = { in, in + in_size, 0, 0 };
+	uint32_t last, code, value;
+	if (count <= 0)
+		return 0;
+	if (!rice_get(&reader, b_bits, &last))
+		return -1;
+	for (long i = 0; i < count; i += INDIGO_RICE_BLOCK_SIZE) {
+		int block = count - i < INDIGO_RICE_BLOCK_SIZE ? (int)(count - i) : INDIGO_RICE_BLOCK_SIZE;
+		if (!rice_get(&reader, fs_bits, &code))
+			return -1;
+		int fs = (int)code - 1;
+		for (int j = 0; j < block; j++) {
+			if (fs < 0) {
+				value = 0;
+			} else if (fs == fs_max) {
+				if (!rice_get(&reader, b_bits, &value))
+					return -1;
+			} else {
+				// count zeros before terminating one, pending bits are less than a byte
+				uint32_t top = 0;
+				while (true) {
+					if (reader.count == 0) {
+						if (reader.in == reader.end)
+							return -1;
+						reader.buffer = *reader.in++;
+						reader.count = 8;
+					}
+					uint32_t pending = (uint32_t)reader.buffer & ((1U << reader.count) - 1);
+					if (pending == 0) {
+						top += reader.count;
+						reader.count = 0;
+						continue;
+					}
+					int zeros = reader.count - (32 - __builtin_clz(pending));
+					top += zeros;
+					reader.count -= zeros + 1;
+					break;
+				}
+				if (!rice_get(&reader, fs, &value))
+					return -1;
+				value |= top << fs;
+			}
+			last = (last + ((value & 1) ? ~(value >> 1) : (value >> 1))) & pixel_mask;
+			if (bytes == 2) {
+				pixels[2 * (i + j)] = (uint8_t)(last >> 8);
+				pixels[2 * (i + j) + 1] = (uint8_t)last;
+			} else {
+				pixels[i + j] = (uint8_t)last;
+			}
+		}
+	}
+	return reader.in - in;
+}
+
+// LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+
+#define LZ4_MIN_MATCH				4
+#define LZ4_LAST_LITERALS		5
+#define LZ4_MATCH_FIND_LIMIT	12
+#define LZ4_MAX_OFFSET			65535
+#define LZ4_SKIP_TRIGGER		6
+#define LZ4_MAX_STEP				64
+
+static inline uint32_t lz4_read32(const uint8_t *pointer) {
+	uint32_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+static inline uint64_t lz4_read64(const uint8_t *pointer) {
+	uint64_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+static inline uint32_t lz4_hash(uint32_t sequence) {
+	return (sequence * 2654435761U) >> (32 - 14);
+}
+
+static inline const uint8_t *lz4_match_end(const uint8_t *in, const uint8_t *match, const uint8_t *limit) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while (in + 8 <= limit) {
+		uint64_t diff = lz4_read64(in) ^ lz4_read64(match);
+		if (diff)
+			return in + (__builtin_ctzll(diff) >> 3);
+		in += 8;
+		match += 8;
+	}
+#endif
+	while (in < limit && *in == *match) {
+		in++;
+		match++;
+	}
+	return in;
+}
+
+static inline uint8_t *lz4_put_length(uint8_t *out, long length) {
+	while (length >= 255) {
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = (uint8_t)length;
+	return out;
+}
+
+long indigo_lz4_compress(const uint8_t *in, long in_size, uint8_t *out, long out_size, uint32_t *hash_table) {
+	const uint8_t *ip = in, *anchor = in, *end = in + in_size;
+	uint8_t *op = out;
+	int misses = 0;
+	if (out_size < INDIGO_LZ4_BOUND(in_size))
+		return -1;
+	memset(hash_table, 0, INDIGO_LZ4_HASH_SIZE * sizeof(uint32_t));
+	if (in_size > LZ4_MATCH_FIND_LIMIT) {
+		const uint8_t *match_limit = end - LZ4_LAST_LITERALS, *search_limit = end - LZ4_MATCH_FIND_LIMIT;
+		ip++;
+		while (ip <= search_limit) {
+			uint32_t sequence = lz4_read32(ip);
+			uint32_t hash = lz4_hash(sequence);
+			const uint8_t *match = in + hash_table[hash];
+			hash_table[hash] = (uint32_t)(ip - in);
+			if (match >= ip || ip - match > LZ4_MAX_OFFSET || lz4_read32(match) != sequence) {
+				// skip faster over incompressible data, but not too far as e.g. high bytes plane of shuffled data may follow noisy low bytes plane
+				int step = 1 + (misses++ >> LZ4_SKIP_TRIGGER);
+				ip += step < LZ4_MAX_STEP ? step : LZ4_MAX_STEP;
+				continue;
+			}
+			misses = 0;
+			while (ip > anchor && match > in && ip[-1] == match[-1]) {
+				ip--;
+				match--;
+			}
+			const uint8_t *match_end = lz4_match_end(ip + LZ4_MIN_MATCH, match + LZ4_MIN_MATCH, match_limit);
+			long literals = ip - anchor, length = match_end - ip - LZ4_MIN_MATCH;
+			uint8_t *token = op++;
+			*token = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (length < 15 ? length : 15));
+			if (literals >= 15)
+				op = lz4_put_length(op, literals - 15);
+			memcpy(op, anchor, literals);
+			op += literals;
+			*op++ = (uint8_t)(ip - match);
+			*op++ = (uint8_t)((ip - match) >> 8);
+			if (length >= 15)
+				op = lz4_put_length(op, length - 15);
+			ip = anchor = match_end;
+			if (ip - 2 > in)
+				hash_table[lz4_hash(lz4_read32(ip - 2))] = (uint32_t)(ip - 2 - in);
+		}
+	}
+	long literals = end - anchor;
+	*op++ = (uint8_t)((literals < 15 ? literals : 15) << 4);
+	if (literals >= 15)
+		op = lz4_put_length(op, literals - 15);
+	memcpy(op, anchor, literals);
+	op += literals;
+	return op - out;
+}
+
+long indigo_lz4_decompress(const uint8_t *in, long in_size, uint8_t *out, long out_size) {
+	const uint8_t *ip = in, *in_end = in + in_size;
+	uint8_t *op = out, *out_end = out + out_size;
+	while (ip < in_end) {
+		int token = *ip++;
+		long length = token >> 4;
+		if (length == 15) {
+			int byte;
+			do {
+				if (ip == in_end)
+					return -1;
+				length += byte = *ip++;
+			} while (byte == 255);
+		}
+		if (length > in_end - ip || length > out_end - op)
+			return -1;
+		memcpy(op, ip, length);
+		op += length;
+		ip += length;
+		if (ip == in_end)
+			break;
+		if (in_end - ip < 2)
+			return -1;
+		long offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - out)
+			return -1;
+		length = token & 15;
+		if (length == 15) {
+			int byte;
+			do {
+				if (ip == in_end)
+					return -1;
+				length += byte = *ip++;
+			} while (byte == 255);
+		}
+		length += LZ4_MIN_MATCH;
+		if (length > out_end - op)
+			return -1;
+		const uint8_t *match = op - offset;
+		if (offset >= length) {
+			memcpy(op, match, length);
+			op += length;
+		} else {
+			while (length--)
+				*op++ = *match++;
+		}
+	}
+	return op - out;
+}
+
+void indigo_byte_shuffle(const uint8_t *in, uint8_t *out, long count, int item_size) {
+	if (item_size == 2) {
+		uint8_t *low = out, *high = out + count;
+		for (long i = 0; i < count; i++) {
+			low[i] = in[2 * i];
+			high[i] = in[2 * i + 1];
+		}
+	} else {
+		for (int j = 0; j < item_size; j++) {
+			for (long i = 0; i < count; i++)
+				out[j * count + i] = in[i * item_size + j];
+		}
+	}
+}
+
+void indigo_byte_unshuffle(const uint8_t *in, uint8_t *out, long count, int item_size) {
+	for (int j = 0; j < item_size; j++) {
+		for (long i = 0; i < count; i++)
+			out[i * item_size + j] = in[j * count + i];
+	}
+}
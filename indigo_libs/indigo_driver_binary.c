@@ -0,0 +1,305 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following
+// disclaimer in the documentation and/or other materials provided
+// with the distribution.
+//
+// 3. The name of the author may not be used to endorse or promote
+// products derived from this software without specific prior
+
+// version history
+// 2.0 by INDIGO contributors
+
+/** INDIGO binary wire protocol client side adapter
+ \file indigo_driver_binary.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include <indigo/indigo_binary.h>
+#include <indigo/indigo_io.h>
+#include <indigo/indigo_driver_binary.h>
+
+static void flush_output(indigo_client *client, indigo_adapter_context *client_context) {
+	// output is corked while more messages for the client are queued
+	if (indigo_client_queue_depth(client) == 0)
+		indigo_output_flush(client_context->output_buffer);
+}
+
+static indigo_result skip_message(indigo_client *client) {
+	// nothing to send, but output corked by previous messages must not wait for the next one
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	pthread_mutex_lock(&client_context->output_mutex);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
+static void write_definition(indigo_binary_context *context, indigo_output_buffer *output, uint32_t id, indigo_property *property, const char *message) {
+	indigo_binary_begin(context, INDIGO_BINARY_DEF_VECTOR);
+	indigo_binary_put_u32(context, id);
+	indigo_binary_put_u8(context, property->type);
+	indigo_binary_put_u8(context, property->state);
+	indigo_binary_put_u8(context, property->perm);
+	indigo_binary_put_u8(context, property->rule);
+	indigo_binary_put_u16(context, property->count);
+	indigo_binary_put_string(context, property->device);
+	indigo_binary_put_string(context, property->name);
+	indigo_binary_put_string(context, property->group);
+	indigo_binary_put_string(context, property->label);
+	indigo_binary_put_string(context, property->hints);
+	indigo_binary_put_string(context, message);
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = &property->items[i];
+		indigo_binary_put_string(context, item->name);
+		indigo_binary_put_string(context, item->label);
+		indigo_binary_put_string(context, item->hints);
+		switch (property->type) {
+			case INDIGO_TEXT_VECTOR:
+				indigo_binary_put_string(context, item->text.value);
+				break;
+			case INDIGO_NUMBER_VECTOR:
+				indigo_binary_put_string(context, item->number.format);
+				indigo_binary_put_double(context, item->number.min);
+				indigo_binary_put_double(context, item->number.max);
+				indigo_binary_put_double(context, item->number.step);
+				indigo_binary_put_double(context, item->number.value);
+				indigo_binary_put_double(context, item->number.target);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				indigo_binary_put_u8(context, item->sw.value);
+				break;
+			case INDIGO_LIGHT_VECTOR:
+				indigo_binary_put_u8(context, item->light.value);
+				break;
+			case INDIGO_BLOB_VECTOR:
+				break;
+		}
+	}
+	indigo_binary_end(context, output, 0);
+}
+
+static indigo_result binary_device_adapter_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	assert(device != NULL);
+	assert(client != NULL);
+	assert(property != NULL);
+	if (!indigo_reshare_remote_devices && device->is_remote)
+		return skip_message(client);
+	if (client->version == INDIGO_VERSION_NONE)
+		return INDIGO_OK;
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	assert(client_context != NULL);
+	indigo_binary_context *context = client_context->binary_context;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_binary_lock(context);
+	bool changed;
+	uint32_t id = indigo_binary_register(context, property, &changed);
+	write_definition(context, client_context->output_buffer, id, property, message);
+	indigo_binary_unlock(context);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_device_adapter_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	assert(device != NULL);
+	assert(client != NULL);
+	assert(property != NULL);
+	if (!indigo_reshare_remote_devices && device->is_remote)
+		return skip_message(client);
+	if (client->version == INDIGO_VERSION_NONE)
+		return INDIGO_OK;
+	indigo_enable_blob_mode mode = INDIGO_ENABLE_BLOB_NEVER;
+	if (property->type == INDIGO_BLOB_VECTOR) {
+		indigo_enable_blob_mode_record *record = client->enable_blob_mode_records;
+		while (record) {
+			if ((*record->device == 0 || !strcmp(property->device, record->device)) && (*record->name == 0 || !strcmp(property->name, record->name))) {
+				mode = record->mode;
+				break;
+			}
+			record = record->next;
+		}
+		if (mode == INDIGO_ENABLE_BLOB_NEVER)
+			return skip_message(client);
+	}
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	assert(client_context != NULL);
+	indigo_binary_context *context = client_context->binary_context;
+	indigo_output_buffer *output = client_context->output_buffer;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_binary_lock(context);
+	bool changed;
+	uint32_t id = indigo_binary_register(context, property, &changed);
+	if (changed) {
+		// item indices known to the client are no longer valid
+		write_definition(context, output, id, property, NULL);
+	}
+	indigo_blob_entry *entries[INDIGO_MAX_ITEMS] = { NULL };
+	long payload_length = 0;
+	indigo_binary_begin(context, INDIGO_BINARY_SET_VECTOR);
+	indigo_binary_put_u32(context, id);
+	indigo_binary_put_u8(context, property->state);
+	indigo_binary_put_string(context, message);
+	int count = property->type == INDIGO_BLOB_VECTOR && property->state != INDIGO_OK_STATE ? 0 : property->count;
+	long count_offset = indigo_binary_length(context);
+	indigo_binary_put_u16(context, 0);
+	int sent = 0;
+	for (int i = 0; i < count; i++) {
+		indigo_item *item = &property->items[i];
+		// unchanged items are skipped unless the property was just redefined
+		if (property->partial && !item->changed && !changed)
+			continue;
+		indigo_binary_put_u16(context, i);
+		sent++;
+		switch (property->type) {
+			case INDIGO_TEXT_VECTOR:
+				indigo_binary_put_string(context, item->text.value);
+				break;
+			case INDIGO_NUMBER_VECTOR:
+				indigo_binary_put_double(context, item->number.value);
+				indigo_binary_put_double(context, item->number.target);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				indigo_binary_put_u8(context, item->sw.value);
+				break;
+			case INDIGO_LIGHT_VECTOR:
+				indigo_binary_put_u8(context, item->light.value);
+				break;
+			case INDIGO_BLOB_VECTOR:
+				indigo_binary_put_string(context, item->blob.format);
+				if (mode == INDIGO_ENABLE_BLOB_URL) {
+					char url[INDIGO_VALUE_SIZE];
+					if (*item->blob.url == 0)
+						snprintf(url, INDIGO_VALUE_SIZE, "/blob/%p%s", item, item->blob.format);
+					else
+						strncpy(url, item->blob.url, INDIGO_VALUE_SIZE);
+					indigo_binary_put_string(context, url);
+					indigo_binary_put_u64(context, 0);
+				} else {
+					indigo_blob_entry *entry = entries[i] = indigo_use_blob_caching ? indigo_validate_blob(item) : NULL;
+					long size = entry ? entry->size : item->blob.size;
+					indigo_binary_put_string(context, "");
+					indigo_binary_put_u64(context, item->blob.value || entry ? size : 0);
+					payload_length += item->blob.value || entry ? size : 0;
+				}
+				break;
+		}
+	}
+	indigo_binary_patch_u16(context, count_offset, sent);
+	indigo_binary_end(context, output, payload_length);
+	indigo_binary_unlock(context);
+	if (payload_length > 0) {
+		// raw BLOB content is written directly, without any encoding
+		for (int i = 0; i < count; i++) {
+			indigo_item *item = &property->items[i];
+			if (entries[i])
+				indigo_output_write(output, (const char *)entries[i]->content, entries[i]->size);
+			else if (item->blob.value && item->blob.size > 0)
+				indigo_output_write(output, (const char *)item->blob.value, item->blob.size);
+			indigo_release_blob_entry(entries[i]);
+		}
+	}
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_device_adapter_delete_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	assert(device != NULL);
+	assert(client != NULL);
+	assert(property != NULL);
+	if (!indigo_reshare_remote_devices && device->is_remote)
+		return skip_message(client);
+	if (client->version == INDIGO_VERSION_NONE)
+		return INDIGO_OK;
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	assert(client_context != NULL);
+	indigo_binary_context *context = client_context->binary_context;
+	const char *device_name = *property->name ? property->device : device->name;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_binary_lock(context);
+	indigo_binary_forget(context, device_name, property->name);
+	indigo_binary_begin(context, INDIGO_BINARY_DEL_PROPERTY);
+	indigo_binary_put_string(context, device_name);
+	indigo_binary_put_string(context, property->name);
+	indigo_binary_put_string(context, message);
+	indigo_binary_end(context, client_context->output_buffer, 0);
+	indigo_binary_unlock(context);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
+static indigo_result binary_device_adapter_send_message(indigo_client *client, indigo_device *device, const char *message) {
+	assert(device != NULL);
+	assert(client != NULL);
+	if (!indigo_reshare_remote_devices && device->is_remote)
+		return skip_message(client);
+	if (client->version == INDIGO_VERSION_NONE)
+		return INDIGO_OK;
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	assert(client_context != NULL);
+	indigo_binary_context *context = client_context->binary_context;
+	pthread_mutex_lock(&client_context->output_mutex);
+	if (message) {
+		indigo_binary_lock(context);
+		indigo_binary_begin(context, INDIGO_BINARY_MESSAGE);
+		indigo_binary_put_string(context, "");
+		indigo_binary_put_string(context, message);
+		indigo_binary_end(context, client_context->output_buffer, 0);
+		indigo_binary_unlock(context);
+	}
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
+indigo_client *indigo_binary_device_adapter(int input, int ouput) {
+	static indigo_client client_template = {
+		"", false, NULL, INDIGO_OK, INDIGO_VERSION_NONE, NULL,
+		NULL,
+		binary_device_adapter_define_property,
+		binary_device_adapter_update_property,
+		binary_device_adapter_delete_property,
+		binary_device_adapter_send_message,
+		NULL
+	};
+	indigo_client *client = malloc(sizeof(indigo_client));
+	assert(client != NULL);
+	memcpy(client, &client_template, sizeof(indigo_client));
+	indigo_adapter_context *client_context = malloc(sizeof(indigo_adapter_context));
+	assert(client_context != NULL);
+	memset(client_context, 0, sizeof(indigo_adapter_context));
+	client_context->input = input;
+	client_context->output = ouput;
+	client_context->output_buffer = indigo_output_create(ouput);
+	client_context->binary_context = indigo_binary_context_create();
+	pthread_mutex_init(&client_context->output_mutex, NULL);
+	client->client_context = client_context;
+	client->is_remote = input == ouput;
+	return client;
+}
+
+void indigo_release_binary_device_adapter(indigo_client *client) {
+	assert(client != NULL);
+	assert(client->client_context != NULL);
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	pthread_mutex_destroy(&client_context->output_mutex);
+	indigo_output_release(client_context->output_buffer);
+	indigo_binary_context_release(client_context->binary_context);
+	free(client_context);
+	free(client);
+}
@@ -41,32 +41,46 @@
 //#undef INDIGO_TRACE_PROTOCOL
 //#define INDIGO_TRACE_PROTOCOL(c) c
 
-static pthread_mutex_t json_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-static void ws_write(int handle, const char *buffer, long length) {
+static void ws_write(indigo_output_buffer *output, const char *buffer, long length) {
 	uint8_t header[10] = { 0x81 };
 	if (length <= 0x7D) {
 		header[1] = length;
-		indigo_write(handle, (char *)header, 2);
+		indigo_output_write(output, (char *)header, 2);
 	} else if (length <= 0xFFFF) {
 		header[1] = 0x7E;
 		uint16_t payloadLength = htons(length);
 		memcpy(header+2, &payloadLength, 2);
-		indigo_write(handle, (char *)header, 4);
+		indigo_output_write(output, (char *)header, 4);
 	} else {
 		header[1] = 0x7F;
 		uint64_t payloadLength = htonll(length);
 		memcpy(header+2, &payloadLength, 8);
-		indigo_write(handle, (char *)header, 10);
+		indigo_output_write(output, (char *)header, 10);
 	}
-	indigo_write(handle, buffer, length);
+	indigo_output_write(output, buffer, length);
+}
+
+static void flush_output(indigo_client *client, indigo_adapter_context *client_context) {
+	// output is corked while more messages for the client are queued
+	if (indigo_client_queue_depth(client) == 0)
+		indigo_output_flush(client_context->output_buffer);
+}
+
+static indigo_result skip_message(indigo_client *client) {
+	// nothing to send, but output corked by previous messages must not wait for the next one
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	pthread_mutex_lock(&client_context->output_mutex);
+	flush_output(client, client_context);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
 }
 
 static const char *escape(const char *s) {
 	char *q = strchr(s, '"');
 	if (q == NULL)
 		return s;
-	static char tmp[INDIGO_VALUE_SIZE * 2];
+	static INDIGO_THREAD_LOCAL char tmp[INDIGO_VALUE_SIZE * 2];
 	char *t = tmp;
 	while (q) {
 		long l = q - s;
@@ -86,13 +100,13 @@ static indigo_result json_define_property(indigo_client *client, indigo_device *
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&json_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char output_buffer[JSON_BUFFER_SIZE];
 	char *pnt = output_buffer;
 	int size;
@@ -217,11 +231,12 @@ static indigo_result json_define_property(indigo_client *client, indigo_device *
 			break;
 	}
 	if (client_context->web_socket)
-		ws_write(handle, output_buffer, size);
+		ws_write(output, output_buffer, size);
 	else
-		indigo_write(handle, output_buffer, size);
-	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", handle, output_buffer));
-	pthread_mutex_unlock(&json_mutex);
+		indigo_output_write(output, output_buffer, size);
+	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", client_context->output, output_buffer));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -230,17 +245,20 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&json_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char output_buffer[JSON_BUFFER_SIZE];
 	char *pnt = output_buffer;
 	int size;
 	char b1[32], b2[32];
+	// unchanged items are skipped only if the client asked for partial updates
+	bool partial = property->partial && client_context->partial_updates && client->version >= INDIGO_VERSION_2_0;
+	int sent = 0;
 	switch (property->type) {
 		case INDIGO_TEXT_VECTOR:
 			size = sprintf(pnt, "{ \"setTextVector\": { \"device\": \"%s\", \"name\": \"%s\", \"state\": \"%s\"", property->device, property->name, indigo_property_state_text[property->state]);
@@ -254,7 +272,9 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 			}
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": \"%s\" }",  i > 0 ? "," : "", item->name, item->text.value);
+				if (partial && !item->changed)
+					continue;
+				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": \"%s\" }",  sent++ > 0 ? "," : "", item->name, item->text.value);
 				pnt += size;
 			}
 			size = sprintf(pnt, " ] } }");
@@ -272,10 +292,12 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 			}
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
+				if (partial && !item->changed)
+					continue;
 				if (property->perm != INDIGO_RO_PERM)
-					size = sprintf(pnt, "%s { \"name\": \"%s\", \"target\": %s, \"value\": %s }",  i > 0 ? "," : "", item->name, indigo_dtoa(item->number.target, b1), indigo_dtoa(item->number.value, b2));
+					size = sprintf(pnt, "%s { \"name\": \"%s\", \"target\": %s, \"value\": %s }",  sent++ > 0 ? "," : "", item->name, indigo_dtoa(item->number.target, b1), indigo_dtoa(item->number.value, b2));
 				else
-					size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": %s }",  i > 0 ? "," : "", item->name, indigo_dtoa(item->number.value, b1));
+					size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": %s }",  sent++ > 0 ? "," : "", item->name, indigo_dtoa(item->number.value, b1));
 				pnt += size;
 			}
 			size = sprintf(pnt, " ] } }");
@@ -293,7 +315,9 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 			}
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": %s }",  i > 0 ? "," : "", item->name, item->sw.value ? "true" : "false");
+				if (partial && !item->changed)
+					continue;
+				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": %s }",  sent++ > 0 ? "," : "", item->name, item->sw.value ? "true" : "false");
 				pnt += size;
 			}
 			size = sprintf(pnt, " ] } }");
@@ -311,7 +335,9 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 			}
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": \"%s\" }",  i > 0 ? "," : "", item->name, indigo_property_state_text[item->light.value]);
+				if (partial && !item->changed)
+					continue;
+				size = sprintf(pnt, "%s { \"name\": \"%s\", \"value\": \"%s\" }",  sent++ > 0 ? "," : "", item->name, indigo_property_state_text[item->light.value]);
 				pnt += size;
 			}
 			size = sprintf(pnt, " ] } }");
@@ -340,11 +366,12 @@ static indigo_result json_update_property(indigo_client *client, indigo_device *
 			break;
 	}
 	if (client_context->web_socket)
-		ws_write(handle, output_buffer, size);
+		ws_write(output, output_buffer, size);
 	else
-		indigo_write(handle, output_buffer, size);
-	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", handle, output_buffer));
-	pthread_mutex_unlock(&json_mutex);
+		indigo_output_write(output, output_buffer, size);
+	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", client_context->output, output_buffer));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -353,13 +380,13 @@ static indigo_result json_delete_property(indigo_client *client, indigo_device *
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&json_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char output_buffer[JSON_BUFFER_SIZE];
 	char *pnt = output_buffer;
 	int size;
@@ -375,11 +402,12 @@ static indigo_result json_delete_property(indigo_client *client, indigo_device *
 	}
 	size += pnt - output_buffer;
 	if (client_context->web_socket)
-		ws_write(handle, output_buffer, size);
+		ws_write(output, output_buffer, size);
 	else
-		indigo_write(handle, output_buffer, size);
-	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", handle, output_buffer));
-	pthread_mutex_unlock(&json_mutex);
+		indigo_output_write(output, output_buffer, size);
+	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", client_context->output, output_buffer));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -387,20 +415,21 @@ static indigo_result json_message_property(indigo_client *client, indigo_device
 	assert(device != NULL);
 	assert(client != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
-	pthread_mutex_lock(&json_mutex);
+		return skip_message(client);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char output_buffer[JSON_BUFFER_SIZE];
 	char *pnt = output_buffer;
 	int size = sprintf(pnt, "{ \"message\": \"%s\" }", message);
 	if (client_context->web_socket)
-		ws_write(handle, output_buffer, size);
+		ws_write(output, output_buffer, size);
 	else
-		indigo_write(handle, output_buffer, size);
-	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", handle, output_buffer));
-	pthread_mutex_unlock(&json_mutex);
+		indigo_output_write(output, output_buffer, size);
+	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s\n", client_context->output, output_buffer));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -431,6 +460,9 @@ indigo_client *indigo_json_device_adapter(int input, int ouput, bool web_socket)
 	client_context->input = input;
 	client_context->output = ouput;
 	client_context->web_socket = web_socket;
+	client_context->partial_updates = false;
+	client_context->output_buffer = indigo_output_create(ouput);
+	pthread_mutex_init(&client_context->output_mutex, NULL);
 	client->client_context = client_context;
 	client->is_remote = input == ouput;
 	indigo_enable_blob_mode_record *record = (indigo_enable_blob_mode_record *)malloc(sizeof(indigo_enable_blob_mode_record));
@@ -449,6 +481,8 @@ void indigo_release_json_device_adapter(indigo_client *client) {
 		record = record->next;
 		free(tmp);
 	}
+	pthread_mutex_destroy(&((indigo_adapter_context *)client->client_context)->output_mutex);
+	indigo_output_release(((indigo_adapter_context *)client->client_context)->output_buffer);
 	free(client->client_context);
 	free(client);
 }
@@ -54,11 +54,9 @@
 #define RAW_BUF_SIZE 98304
 #define BASE64_BUF_SIZE 131072  /* BASE64_BUF_SIZE >= (RAW_BUF_SIZE + 2) / 3 * 4 */
 
-static pthread_mutex_t write_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 static const char *message_attribute(const char *message) {
 	if (message) {
-		static char buffer[INDIGO_VALUE_SIZE];
+		static INDIGO_THREAD_LOCAL char buffer[INDIGO_VALUE_SIZE];
 		snprintf(buffer, INDIGO_VALUE_SIZE, " message='%s'", indigo_xml_escape((char *)message));
 		return buffer;
 	}
@@ -67,125 +65,149 @@ static const char *message_attribute(const char *message) {
 
 static const char *hints_attribute(const char *hints) {
 	if (*hints) {
-		static char buffer[INDIGO_VALUE_SIZE];
+		static INDIGO_THREAD_LOCAL char buffer[INDIGO_VALUE_SIZE];
 		snprintf(buffer, INDIGO_VALUE_SIZE, " hints='%s'", indigo_xml_escape((char *)hints));
 		return buffer;
 	}
 	return "";
 }
 
+static void flush_output(indigo_client *client, indigo_adapter_context *client_context) {
+	// output is corked while more messages for the client are queued
+	if (indigo_client_queue_depth(client) == 0)
+		indigo_output_flush(client_context->output_buffer);
+}
+
+static indigo_result skip_message(indigo_client *client) {
+	// nothing to send, but output corked by previous messages must not wait for the next one
+	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+	pthread_mutex_lock(&client_context->output_mutex);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
+	return INDIGO_OK;
+}
+
 static indigo_result xml_device_adapter_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
 	assert(device != NULL);
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&write_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char b1[32], b2[32], b3[32], b4[32], b5[32];
 	switch (property->type) {
 	case INDIGO_TEXT_VECTOR:
-		indigo_printf(handle, "<defTextVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
+		indigo_output_printf(output, "<defTextVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<defText name='%s' label='%s'%s>%s</defText>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->text.value);
+			indigo_output_printf(output, "<defText name='%s' label='%s'%s>%s</defText>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->text.value);
 		}
-		indigo_printf(handle, "</defTextVector>\n");
+		indigo_output_printf(output, "</defTextVector>\n");
 		break;
 	case INDIGO_NUMBER_VECTOR:
-		indigo_printf(handle, "<defNumberVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
+		indigo_output_printf(output, "<defNumberVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
 			if (client->version >= INDIGO_VERSION_2_0 && property->perm != INDIGO_RO_PERM)
-				indigo_printf(handle, "<defNumber name='%s' label='%s' format='%s' min='%s' max='%s' step='%s' target='%s'>%s</defNumber>\n", indigo_item_name(client->version, property, item), item->label, item->number.format, indigo_dtoa(item->number.min, b1), indigo_dtoa(item->number.max, b2), indigo_dtoa(item->number.step, b3), indigo_dtoa(item->number.target, b4), indigo_dtoa(item->number.value, b5));
+				indigo_output_printf(output, "<defNumber name='%s' label='%s' format='%s' min='%s' max='%s' step='%s' target='%s'>%s</defNumber>\n", indigo_item_name(client->version, property, item), item->label, item->number.format, indigo_dtoa(item->number.min, b1), indigo_dtoa(item->number.max, b2), indigo_dtoa(item->number.step, b3), indigo_dtoa(item->number.target, b4), indigo_dtoa(item->number.value, b5));
 			else
-				indigo_printf(handle, "<defNumber name='%s' label='%s'%s format='%s' min='%s' max='%s' step='%s'>%s</defNumber>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->number.format, indigo_dtoa(item->number.min, b1), indigo_dtoa(item->number.max, b2), indigo_dtoa(item->number.step, b3), indigo_dtoa(item->number.value, b4));
+				indigo_output_printf(output, "<defNumber name='%s' label='%s'%s format='%s' min='%s' max='%s' step='%s'>%s</defNumber>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->number.format, indigo_dtoa(item->number.min, b1), indigo_dtoa(item->number.max, b2), indigo_dtoa(item->number.step, b3), indigo_dtoa(item->number.value, b4));
 		}
-		indigo_printf(handle, "</defNumberVector>\n");
+		indigo_output_printf(output, "</defNumberVector>\n");
 		break;
 	case INDIGO_SWITCH_VECTOR:
-		indigo_printf(handle, "<defSwitchVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s' rule='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], indigo_switch_rule_text[property->rule], hints_attribute(property->hints), message_attribute(message));
+		indigo_output_printf(output, "<defSwitchVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s' rule='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], indigo_switch_rule_text[property->rule], hints_attribute(property->hints), message_attribute(message));
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<defSwitch name='%s' label='%s'%s>%s</defSwitch>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->sw.value ? "On" : "Off");
+			indigo_output_printf(output, "<defSwitch name='%s' label='%s'%s>%s</defSwitch>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), item->sw.value ? "On" : "Off");
 		}
-		indigo_printf(handle, "</defSwitchVector>\n");
+		indigo_output_printf(output, "</defSwitchVector>\n");
 		break;
 	case INDIGO_LIGHT_VECTOR:
-		indigo_printf(handle, "<defLightVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
+		indigo_output_printf(output, "<defLightVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, " <defLight name='%s' label='%s'%s>%s</defLight>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), indigo_property_state_text[item->light.value]);
+			indigo_output_printf(output, " <defLight name='%s' label='%s'%s>%s</defLight>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints), indigo_property_state_text[item->light.value]);
 		}
-		indigo_printf(handle, "</defLightVector>\n");
+		indigo_output_printf(output, "</defLightVector>\n");
 		break;
 	case INDIGO_BLOB_VECTOR:
-		indigo_printf(handle, "<defBLOBVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
+		indigo_output_printf(output, "<defBLOBVector device='%s' name='%s' group='%s' label='%s' perm='%s' state='%s'%s%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_xml_escape(property->group), indigo_xml_escape(property->label), indigo_property_perm_text[property->perm], indigo_property_state_text[property->state], hints_attribute(property->hints), message_attribute(message));
 		for (int i = 0; i < property->count; i++) {
 			indigo_item *item = &property->items[i];
-			indigo_printf(handle, "<defBLOB name='%s' label='%s'%s/>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints));
+			indigo_output_printf(output, "<defBLOB name='%s' label='%s'%s/>\n", indigo_item_name(client->version, property, item), item->label, hints_attribute(item->hints));
 		}
-		indigo_printf(handle, "</defBLOBVector>\n");
+		indigo_output_printf(output, "</defBLOBVector>\n");
 		break;
 	}
-	pthread_mutex_unlock(&write_mutex);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
 static indigo_result xml_device_adapter_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
-	FILE* fh;
-	int handle2;
 	assert(device != NULL);
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&write_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	char b1[32], b2[32];
+	// unchanged items are skipped only if the client asked for partial updates
+	bool partial = property->partial && client_context->partial_updates && client->version >= INDIGO_VERSION_2_0;
 	switch (property->type) {
 		case INDIGO_TEXT_VECTOR:
-			indigo_printf(handle, "<setTextVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
+			indigo_output_printf(output, "<setTextVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneText name='%s'>%s</oneText>\n", indigo_item_name(client->version, property, item), indigo_xml_escape(item->text.value));
+				if (partial && !item->changed)
+					continue;
+				indigo_output_printf(output, "<oneText name='%s'>%s</oneText>\n", indigo_item_name(client->version, property, item), indigo_xml_escape(item->text.value));
 			}
-			indigo_printf(handle, "</setTextVector>\n");
+			indigo_output_printf(output, "</setTextVector>\n");
 			break;
 		case INDIGO_NUMBER_VECTOR:
-			indigo_printf(handle, "<setNumberVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
+			indigo_output_printf(output, "<setNumberVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
+				if (partial && !item->changed)
+					continue;
 				if (client->version >= INDIGO_VERSION_2_0 && property->perm != INDIGO_RO_PERM)
-					indigo_printf(handle, "<oneNumber name='%s' target='%s'>%s</oneNumber>\n", indigo_item_name(client->version, property, item), indigo_dtoa(item->number.target, b1), indigo_dtoa(item->number.value, b2));
+					indigo_output_printf(output, "<oneNumber name='%s' target='%s'>%s</oneNumber>\n", indigo_item_name(client->version, property, item), indigo_dtoa(item->number.target, b1), indigo_dtoa(item->number.value, b2));
 				else
-					indigo_printf(handle, "<oneNumber name='%s'>%s</oneNumber>\n", indigo_item_name(client->version, property, item), indigo_dtoa(item->number.value, b1));
+					indigo_output_printf(output, "<oneNumber name='%s'>%s</oneNumber>\n", indigo_item_name(client->version, property, item), indigo_dtoa(item->number.value, b1));
 			}
-			indigo_printf(handle, "</setNumberVector>\n");
+			indigo_output_printf(output, "</setNumberVector>\n");
 			break;
 		case INDIGO_SWITCH_VECTOR:
-			indigo_printf(handle, "<setSwitchVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
+			indigo_output_printf(output, "<setSwitchVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneSwitch name='%s'>%s</oneSwitch>\n", indigo_item_name(client->version, property, item), item->sw.value ? "On" : "Off");
+				if (partial && !item->changed)
+					continue;
+				indigo_output_printf(output, "<oneSwitch name='%s'>%s</oneSwitch>\n", indigo_item_name(client->version, property, item), item->sw.value ? "On" : "Off");
 			}
-			indigo_printf(handle, "</setSwitchVector>\n");
+			indigo_output_printf(output, "</setSwitchVector>\n");
 			break;
 		case INDIGO_LIGHT_VECTOR:
-			indigo_printf(handle, "<setLightVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
+			indigo_output_printf(output, "<setLightVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
 			for (int i = 0; i < property->count; i++) {
 				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneLight name='%s'>%s</oneLight>\n", indigo_item_name(client->version, property, item), indigo_property_state_text[item->light.value]);
+				if (partial && !item->changed)
+					continue;
+				indigo_output_printf(output, "<oneLight name='%s'>%s</oneLight>\n", indigo_item_name(client->version, property, item), indigo_property_state_text[item->light.value]);
 			}
-			indigo_printf(handle, "</setLightVector>\n");
+			indigo_output_printf(output, "</setLightVector>\n");
 			break;
 		case INDIGO_BLOB_VECTOR: {
 			indigo_enable_blob_mode mode = INDIGO_ENABLE_BLOB_NEVER;
@@ -198,7 +220,7 @@ static indigo_result xml_device_adapter_update_property(indigo_client *client, i
 				record = record->next;
 			}
 			if (mode != INDIGO_ENABLE_BLOB_NEVER) {
-				indigo_printf(handle, "<setBLOBVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
+				indigo_output_printf(output, "<setBLOBVector device='%s' name='%s' state='%s'%s>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), indigo_property_state_text[property->state], message_attribute(message));
 				if (property->state == INDIGO_OK_STATE) {
 					for (int i = 0; i < property->count; i++) {
 						indigo_item *item = &property->items[i];
@@ -206,46 +228,50 @@ static indigo_result xml_device_adapter_update_property(indigo_client *client, i
 						unsigned char *data = item->blob.value;
 						if (mode == INDIGO_ENABLE_BLOB_URL && client->version >= INDIGO_VERSION_2_0) {
 							if (*item->blob.url == 0)
-								indigo_printf(handle, "<oneBLOB name='%s' path='/blob/%p%s'/>\n", indigo_item_name(client->version, property, item), item, item->blob.format);
+								indigo_output_printf(output, "<oneBLOB name='%s' path='/blob/%p%s'/>\n", indigo_item_name(client->version, property, item), item, item->blob.format);
 							else
-								indigo_printf(handle, "<oneBLOB name='%s' url='%s'/>\n", indigo_item_name(client->version, property, item), item->blob.url);
+								indigo_output_printf(output, "<oneBLOB name='%s' url='%s'/>\n", indigo_item_name(client->version, property, item), item->blob.url);
 						} else {
-							indigo_printf(handle, "<oneBLOB name='%s' format='%s' size='%ld'>\n", indigo_item_name(client->version, property, item), item->blob.format, item->blob.size);
-							handle2 = dup(handle);
-							fh = fdopen(handle2, "w");
+							indigo_blob_entry *entry = indigo_use_blob_caching ? indigo_validate_blob(item) : NULL;
+							if (entry) {
+								// the same snapshot is served by /blob/ handler
+								input_length = entry->size;
+								data = entry->content;
+							}
+							indigo_output_printf(output, "<oneBLOB name='%s' format='%s' size='%ld'>\n", indigo_item_name(client->version, property, item), item->blob.format, input_length);
 							if (client->version >= INDIGO_VERSION_2_0) {
 								while (input_length) {
 									char encoded_data[BASE64_BUF_SIZE + 1];
 									long len = (RAW_BUF_SIZE < input_length) ?  RAW_BUF_SIZE : input_length;
 									long enclen = base64_encode((unsigned char*)encoded_data, (unsigned char*)data, len);
-									fwrite(encoded_data, 1, enclen, fh);
+									indigo_output_write(output, encoded_data, enclen);
 									input_length -= len;
 									data += len;
 								}
 							} else {
-								static char encoded_data[74];
+								char encoded_data[74];
 								while (input_length) {
 									/* 54 raw = 72 encoded */
 									long len = (54 < input_length) ?  54 : input_length;
 									long enclen = base64_encode((unsigned char*)encoded_data, (unsigned char*)data, len);
 									encoded_data[enclen] = '\n';
-									fwrite(encoded_data, 1, enclen, fh);
+									indigo_output_write(output, encoded_data, enclen);
 									input_length -= len;
 									data += len;
 								}
 							}
-							fflush(fh);
-							fclose(fh);
-							indigo_printf(handle, "</oneBLOB>\n");
+							indigo_release_blob_entry(entry);
+							indigo_output_printf(output, "</oneBLOB>\n");
 						}
 					}
 				}
-				indigo_printf(handle, "</setBLOBVector>\n");
+				indigo_output_printf(output, "</setBLOBVector>\n");
 			}
 			break;
 		}
 	}
-	pthread_mutex_unlock(&write_mutex);
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -254,18 +280,19 @@ static indigo_result xml_device_adapter_delete_property(indigo_client *client, i
 	assert(client != NULL);
 	assert(property != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&write_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	if (*property->name)
-		indigo_printf(handle, "<delProperty device='%s' name='%s'%s/>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), message_attribute(message));
+		indigo_output_printf(output, "<delProperty device='%s' name='%s'%s/>\n", indigo_xml_escape(property->device), indigo_property_name(client->version, property), message_attribute(message));
 	else
-		indigo_printf(handle, "<delProperty device='%s'%s/>\n", device->name, message_attribute(message));
-	pthread_mutex_unlock(&write_mutex);
+		indigo_output_printf(output, "<delProperty device='%s'%s/>\n", device->name, message_attribute(message));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -273,16 +300,17 @@ static indigo_result xml_device_adapter_send_message(indigo_client *client, indi
 	assert(device != NULL);
 	assert(client != NULL);
 	if (!indigo_reshare_remote_devices && device->is_remote)
-		return INDIGO_OK;
+		return skip_message(client);
 	if (client->version == INDIGO_VERSION_NONE)
 		return INDIGO_OK;
-	pthread_mutex_lock(&write_mutex);
 	indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
 	assert(client_context != NULL);
-	int handle = client_context->output;
+	pthread_mutex_lock(&client_context->output_mutex);
+	indigo_output_buffer *output = client_context->output_buffer;
 	if (message)
-		indigo_printf(handle, "<message%s/>\n", message_attribute(message));
-	pthread_mutex_unlock(&write_mutex);
+		indigo_output_printf(output, "<message%s/>\n", message_attribute(message));
+	flush_output(client, client_context);
+	pthread_mutex_unlock(&client_context->output_mutex);
 	return INDIGO_OK;
 }
 
@@ -303,6 +331,9 @@ indigo_client *indigo_xml_device_adapter(int input, int ouput) {
 	assert(client_context != NULL);
 	client_context->input = input;
 	client_context->output = ouput;
+	client_context->partial_updates = false;
+	client_context->output_buffer = indigo_output_create(ouput);
+	pthread_mutex_init(&client_context->output_mutex, NULL);
 	client->client_context = client_context;
 	client->is_remote = input == ouput;
 	return client;
@@ -311,6 +342,8 @@ indigo_client *indigo_xml_device_adapter(int input, int ouput) {
 void indigo_release_xml_device_adapter(indigo_client *client) {
 	assert(client != NULL);
 	assert(client->client_context != NULL);
+	pthread_mutex_destroy(&((indigo_adapter_context *)client->client_context)->output_mutex);
+	indigo_output_release(((indigo_adapter_context *)client->client_context)->output_buffer);
 	free(client->client_context);
 	free(client);
 }
@@ -43,6 +43,7 @@ indigo_result indigo_guider_attach(indigo_device *device, unsigned version) {
 		device->device_context = malloc(sizeof(indigo_guider_context));
 		assert(device->device_context);
 		memset(device->device_context, 0, sizeof(indigo_guider_context));
+		pthread_mutex_init(&GUIDER_CONTEXT->guider_pulse_mutex, NULL);
 	}
 	if (GUIDER_CONTEXT != NULL) {
 		if (indigo_device_attach(device, version, INDIGO_INTERFACE_GUIDER) == INDIGO_OK) {
@@ -66,6 +67,22 @@ indigo_result indigo_guider_attach(indigo_device *device, unsigned version) {
 			GUIDER_RATE_PROPERTY->count = 1;
 			indigo_init_number_item(GUIDER_RATE_ITEM, GUIDER_RATE_ITEM_NAME, "Guiding rate (% of sidereal)", 10, 90, 0, 50);
 			indigo_init_number_item(GUIDER_DEC_RATE_ITEM, GUIDER_DEC_RATE_ITEM_NAME, "DEC Guiding rate (% of sidereal)", 10, 90, 0, 50);
+			// -------------------------------------------------------------------------------- GUIDER_PULSE_STATISTICS
+			GUIDER_PULSE_STATISTICS_PROPERTY = indigo_init_number_property(NULL, device->name, GUIDER_PULSE_STATISTICS_PROPERTY_NAME, GUIDER_MAIN_GROUP, "Pulse statistics", INDIGO_OK_STATE, INDIGO_RO_PERM, 5 + GUIDER_PULSE_HISTOGRAM_SIZE);
+			if (GUIDER_PULSE_STATISTICS_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			GUIDER_PULSE_STATISTICS_PROPERTY->hidden = true;
+			indigo_init_number_item(GUIDER_PULSE_COUNT_ITEM, GUIDER_PULSE_COUNT_ITEM_NAME, "Pulses", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_REQUESTED_ITEM, GUIDER_PULSE_REQUESTED_ITEM_NAME, "Last requested duration (ms)", 0, 10000, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_ACTUAL_ITEM, GUIDER_PULSE_ACTUAL_ITEM_NAME, "Last actual duration (ms)", 0, 10000, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_MEAN_ERROR_ITEM, GUIDER_PULSE_MEAN_ERROR_ITEM_NAME, "Mean error (ms)", 0, 10000, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_MAX_ERROR_ITEM, GUIDER_PULSE_MAX_ERROR_ITEM_NAME, "Max error (ms)", 0, 10000, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 0, GUIDER_PULSE_ERROR_0_1MS_ITEM_NAME, "Error < 0.1ms", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 1, GUIDER_PULSE_ERROR_0_5MS_ITEM_NAME, "Error < 0.5ms", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 2, GUIDER_PULSE_ERROR_1MS_ITEM_NAME, "Error < 1ms", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 3, GUIDER_PULSE_ERROR_5MS_ITEM_NAME, "Error < 5ms", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 4, GUIDER_PULSE_ERROR_10MS_ITEM_NAME, "Error < 10ms", 0, 1e9, 0, 0);
+			indigo_init_number_item(GUIDER_PULSE_HISTOGRAM_ITEM + 5, GUIDER_PULSE_ERROR_MORE_ITEM_NAME, "Error >= 10ms", 0, 1e9, 0, 0);
 			// --------------------------------------------------------------------------------
 			return INDIGO_OK;
 		}
@@ -83,6 +100,8 @@ indigo_result indigo_guider_enumerate_properties(indigo_device *device, indigo_c
 			indigo_define_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
 		if (indigo_property_match(GUIDER_RATE_PROPERTY, property))
 			indigo_define_property(device, GUIDER_RATE_PROPERTY, NULL);
+		if (indigo_property_match(GUIDER_PULSE_STATISTICS_PROPERTY, property))
+			indigo_define_property(device, GUIDER_PULSE_STATISTICS_PROPERTY, NULL);
 	}
 	return indigo_device_enumerate_properties(device, client, property);
 }
@@ -97,10 +116,17 @@ indigo_result indigo_guider_change_property(indigo_device *device, indigo_client
 			indigo_define_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
 			indigo_define_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
 			indigo_define_property(device, GUIDER_RATE_PROPERTY, NULL);
+			pthread_mutex_lock(&GUIDER_CONTEXT->guider_pulse_mutex);
+			for (int i = 0; i < GUIDER_PULSE_STATISTICS_PROPERTY->count; i++)
+				GUIDER_PULSE_STATISTICS_PROPERTY->items[i].number.value = GUIDER_CONTEXT->guider_pulse_values[i] = 0;
+			GUIDER_CONTEXT->guider_pulse_error_sum = 0;
+			pthread_mutex_unlock(&GUIDER_CONTEXT->guider_pulse_mutex);
+			indigo_define_property(device, GUIDER_PULSE_STATISTICS_PROPERTY, NULL);
 		} else {
 			indigo_delete_property(device, GUIDER_GUIDE_DEC_PROPERTY, NULL);
 			indigo_delete_property(device, GUIDER_GUIDE_RA_PROPERTY, NULL);
 			indigo_delete_property(device, GUIDER_RATE_PROPERTY, NULL);
+			indigo_delete_property(device, GUIDER_PULSE_STATISTICS_PROPERTY, NULL);
 		}
 		// --------------------------------------------------------------------------------
 	}
@@ -112,6 +138,58 @@ indigo_result indigo_guider_detach(indigo_device *device) {
 	indigo_release_property(GUIDER_GUIDE_DEC_PROPERTY);
 	indigo_release_property(GUIDER_GUIDE_RA_PROPERTY);
 	indigo_release_property(GUIDER_RATE_PROPERTY);
+	indigo_release_property(GUIDER_PULSE_STATISTICS_PROPERTY);
+	pthread_mutex_destroy(&GUIDER_CONTEXT->guider_pulse_mutex);
 	return indigo_device_detach(device);
 }
 
+#define PULSE_VALUE(item) (GUIDER_CONTEXT->guider_pulse_values[(item) - GUIDER_PULSE_STATISTICS_PROPERTY->items])
+
+static void guider_pulse_publish(indigo_device *device) {
+	if (GUIDER_CONTEXT == NULL || GUIDER_PULSE_STATISTICS_PROPERTY == NULL)
+		return;
+	pthread_mutex_lock(&GUIDER_CONTEXT->guider_pulse_mutex);
+	for (int i = 0; i < GUIDER_PULSE_STATISTICS_PROPERTY->count; i++)
+		GUIDER_PULSE_STATISTICS_PROPERTY->items[i].number.value = GUIDER_CONTEXT->guider_pulse_values[i];
+	GUIDER_CONTEXT->guider_pulse_publish_pending = false;
+	pthread_mutex_unlock(&GUIDER_CONTEXT->guider_pulse_mutex);
+	if (IS_CONNECTED)
+		indigo_update_property(device, GUIDER_PULSE_STATISTICS_PROPERTY, NULL);
+}
+
+static void guider_pulse_measured(indigo_device *device, double requested, double actual) {
+	// called on the pulse timer thread, measurement is only recorded here and published by a regular timer
+	static const double limits[GUIDER_PULSE_HISTOGRAM_SIZE - 1] = { 0.1, 0.5, 1, 5, 10 };
+	if (GUIDER_CONTEXT == NULL || GUIDER_PULSE_STATISTICS_PROPERTY == NULL)
+		return;
+	double error = fabs(actual - requested) * 1000;
+	int bin = 0;
+	while (bin < GUIDER_PULSE_HISTOGRAM_SIZE - 1 && error >= limits[bin])
+		bin++;
+	pthread_mutex_lock(&GUIDER_CONTEXT->guider_pulse_mutex);
+	PULSE_VALUE(GUIDER_PULSE_HISTOGRAM_ITEM + bin)++;
+	double count = ++PULSE_VALUE(GUIDER_PULSE_COUNT_ITEM);
+	PULSE_VALUE(GUIDER_PULSE_REQUESTED_ITEM) = requested * 1000;
+	PULSE_VALUE(GUIDER_PULSE_ACTUAL_ITEM) = actual * 1000;
+	GUIDER_CONTEXT->guider_pulse_error_sum += error;
+	PULSE_VALUE(GUIDER_PULSE_MEAN_ERROR_ITEM) = GUIDER_CONTEXT->guider_pulse_error_sum / count;
+	if (error > PULSE_VALUE(GUIDER_PULSE_MAX_ERROR_ITEM))
+		PULSE_VALUE(GUIDER_PULSE_MAX_ERROR_ITEM) = error;
+	bool schedule = !GUIDER_CONTEXT->guider_pulse_publish_pending;
+	GUIDER_CONTEXT->guider_pulse_publish_pending = true;
+	pthread_mutex_unlock(&GUIDER_CONTEXT->guider_pulse_mutex);
+	if (schedule)
+		indigo_set_timer(device, 0, guider_pulse_publish);
+}
+
+indigo_timer *indigo_guider_set_pulse_timer(indigo_device *device, double duration, indigo_timer_callback callback) {
+	assert(device != NULL);
+	assert(DEVICE_CONTEXT != NULL);
+	if (GUIDER_PULSE_STATISTICS_PROPERTY->hidden) {
+		GUIDER_PULSE_STATISTICS_PROPERTY->hidden = false;
+		if (IS_CONNECTED)
+			indigo_define_property(device, GUIDER_PULSE_STATISTICS_PROPERTY, NULL);
+	}
+	return indigo_set_pulse_timer(device, duration / 1000.0, callback, guider_pulse_measured);
+}
+
@@ -12,6 +12,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_ccd_driver.h>
@@ -21,85 +24,298 @@
 #define IM (1)
 #define PI_2 (6.2831853071795864769252867665590057683943L)
 
-static void _fft(const int n, const int offset, const int delta, const double (*x)[2], double (*X)[2], double (*_X)[2]);
-
-static void fft(const int n, const double (*x)[2], double (*X)[2]) {
-	double (*_X)[2] = malloc(2 * n * sizeof(double));
-	_fft(n, 0, 1, x, X, _X);
-	free(_X);
-}
-
-static void _fft(const int n, const int offset, const int delta, const double (*x)[2], double (*X)[2], double (*_X)[2]) {
-	int n2 = n / 2;
-	int k;
-	double ccos, csin;
-	int k00, k01, k10, k11;
-	double tmp0, tmp1;
-	if (n != 2) {
-		_fft(n2, offset, 2 * delta, x, _X, X);
-		_fft(n2, offset + delta, 2 * delta, x, _X, X);
-		for (k = 0; k < n2; k++) {
-			k00 = offset + k * delta;
-			k01 = k00 + n2 * delta;
-			k10 = offset + 2 * k * delta;
-			k11 = k10 + delta;
-			ccos = cos(PI_2 * k / (double)n);
-			csin = sin(PI_2 * k / (double)n);
-			tmp0 = ccos * _X[k11][RE] + csin * _X[k11][IM];
-			tmp1 = ccos * _X[k11][IM] - csin * _X[k11][RE];
-			X[k01][RE] = _X[k10][RE] - tmp0;
-			X[k01][IM] = _X[k10][IM] - tmp1;
-			X[k00][RE] = _X[k10][RE] + tmp0;
-			X[k00][IM] = _X[k10][IM] + tmp1;
+#define FFT_MAX_PASSES	32
+
+/* Plan for real FFT of even length n computed as complex FFT of length m = n / 2 by self-sorting (Stockham) passes of radix 4, 2, 3 and 5 */
+
+typedef struct fft_plan {
+	int n;
+	int m;
+	int passes;
+	int radix[FFT_MAX_PASSES];
+	double (*twiddles[FFT_MAX_PASSES])[2];	// (radix - 1) twiddles for each butterfly of the pass
+	double (*split)[2];											// exp(-2πik/n) for k = 0 ... m / 2 used to split/merge the real spectrum
+	struct fft_plan *next;
+} fft_plan;
+
+typedef struct {
+	int size;
+	double buffer[][2];
+} digest_scratch;
+
+static fft_plan *fft_plans = NULL;
+static pthread_mutex_t fft_plans_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t digest_scratch_key;
+static pthread_once_t digest_scratch_once = PTHREAD_ONCE_INIT;
+
+static int fft_size(const int n) {
+	for (int size = n + (n & 1);; size += 2) {
+		int rest = size / 2;
+		while (rest % 2 == 0)
+			rest /= 2;
+		while (rest % 3 == 0)
+			rest /= 3;
+		while (rest % 5 == 0)
+			rest /= 5;
+		if (rest == 1)
+			return size;
+	}
+}
+
+static fft_plan *fft_get_plan(const int n) {
+	pthread_mutex_lock(&fft_plans_mutex);
+	fft_plan *plan = fft_plans;
+	while (plan != NULL && plan->n != n)
+		plan = plan->next;
+	if (plan == NULL) {
+		plan = calloc(1, sizeof(fft_plan));
+		plan->n = n;
+		plan->m = n / 2;
+		int rest = plan->m;
+		static const int radixes[] = { 4, 2, 3, 5 };
+		for (int i = 0; i < 4; i++) {
+			while (rest % radixes[i] == 0) {
+				plan->radix[plan->passes++] = radixes[i];
+				rest /= radixes[i];
+			}
 		}
-	} else {
-		k00 = offset;
-		k01 = k00 + delta;
-		X[k01][RE] = x[k00][RE] - x[k01][RE];
-		X[k01][IM] = x[k00][IM] - x[k01][IM];
-		X[k00][RE] = x[k00][RE] + x[k01][RE];
-		X[k00][IM] = x[k00][IM] + x[k01][IM];
+		int length = plan->m;
+		for (int i = 0; i < plan->passes; i++) {
+			int radix = plan->radix[i], count = length / radix;
+			double (*twiddles)[2] = plan->twiddles[i] = malloc((count * (radix - 1) + 1) * sizeof(*twiddles));
+			for (int p = 0; p < count; p++) {
+				for (int k = 1; k < radix; k++) {
+					double angle = PI_2 * p * k / length;
+					twiddles[p * (radix - 1) + k - 1][RE] = cos(angle);
+					twiddles[p * (radix - 1) + k - 1][IM] = -sin(angle);
+				}
+			}
+			length = count;
+		}
+		plan->split = malloc((plan->m / 2 + 1) * sizeof(*plan->split));
+		for (int k = 0; k <= plan->m / 2; k++) {
+			double angle = PI_2 * k / n;
+			plan->split[k][RE] = cos(angle);
+			plan->split[k][IM] = -sin(angle);
+		}
+		plan->next = fft_plans;
+		fft_plans = plan;
 	}
+	pthread_mutex_unlock(&fft_plans_mutex);
+	return plan;
 }
 
-static void ifft(const int n, const double (*X)[2], double (*x)[2]) {
-	int n2 = n / 2;
-	int i;
-	double tmp0, tmp1;
-	fft(n, X, x);
-	x[0][RE] = x[0][RE] / n;
-	x[0][IM] = x[0][IM] / n;
-	x[n2][RE] = x[n2][RE] / n;
-	x[n2][IM] = x[n2][IM] / n;
-	for (i = 1; i < n2; i++) {
-		tmp0 = x[i][RE] / n;
-		tmp1 = x[i][IM] / n;
-		x[i][RE] = x[n-i][RE] / n;
-		x[i][IM] = x[n-i][IM] / n;
-		x[n-i][RE] = tmp0;
-		x[n-i][IM] = tmp1;
-	}
-}
-
-static void corellate_fft(const int n, const double (*X1)[2], const double (*X2)[2], double (*c)[2]) {
-	int i;
-	double (*C)[2] = malloc(2 * n * sizeof(double));
-	/* pointwise multiply X1 conjugate with X2 here, store in X1 */
-	for (i = 0; i < n; i++) {
+static void digest_scratch_init(void) {
+	pthread_key_create(&digest_scratch_key, free);
+}
+
+/* Per-thread scratch buffer, reused by subsequent calls and released when the thread exits */
+
+static double (*digest_get_scratch(const int size))[2] {
+	pthread_once(&digest_scratch_once, digest_scratch_init);
+	digest_scratch *scratch = pthread_getspecific(digest_scratch_key);
+	if (scratch == NULL || scratch->size < size) {
+		free(scratch);
+		scratch = malloc(sizeof(digest_scratch) + size * sizeof(scratch->buffer[0]));
+		scratch->size = size;
+		pthread_setspecific(digest_scratch_key, scratch);
+	}
+	return scratch->buffer;
+}
+
+#define TWIDDLE(b, w) { double tmp = b[RE] * w[RE] - b[IM] * w[IM]; b[IM] = b[RE] * w[IM] + b[IM] * w[RE]; b[RE] = tmp; }
+
+static void fft_pass(const int radix, const int length, const int stride, const double (*twiddles)[2], const double (*x)[2], double (*y)[2]) {
+	const int count = length / radix;
+	switch (radix) {
+		case 2:
+			for (int p = 0; p < count; p++) {
+				const double *w1 = twiddles[p];
+				for (int q = 0; q < stride; q++) {
+					const double *a0 = x[q + stride * p], *a1 = x[q + stride * (p + count)];
+					double *b0 = y[q + stride * 2 * p], *b1 = y[q + stride * (2 * p + 1)];
+					b0[RE] = a0[RE] + a1[RE];
+					b0[IM] = a0[IM] + a1[IM];
+					b1[RE] = a0[RE] - a1[RE];
+					b1[IM] = a0[IM] - a1[IM];
+					if (p)
+						TWIDDLE(b1, w1);
+				}
+			}
+			break;
+		case 3: {
+			const double s = 0.86602540378443864676;
+			for (int p = 0; p < count; p++) {
+				const double *w1 = twiddles[2 * p], *w2 = twiddles[2 * p + 1];
+				for (int q = 0; q < stride; q++) {
+					const double *a0 = x[q + stride * p], *a1 = x[q + stride * (p + count)], *a2 = x[q + stride * (p + 2 * count)];
+					double *b0 = y[q + stride * 3 * p], *b1 = y[q + stride * (3 * p + 1)], *b2 = y[q + stride * (3 * p + 2)];
+					double t1_re = a1[RE] + a2[RE], t1_im = a1[IM] + a2[IM];
+					double t2_re = a0[RE] - 0.5 * t1_re, t2_im = a0[IM] - 0.5 * t1_im;
+					double t3_re = s * (a1[RE] - a2[RE]), t3_im = s * (a1[IM] - a2[IM]);
+					b0[RE] = a0[RE] + t1_re;
+					b0[IM] = a0[IM] + t1_im;
+					b1[RE] = t2_re + t3_im;
+					b1[IM] = t2_im - t3_re;
+					b2[RE] = t2_re - t3_im;
+					b2[IM] = t2_im + t3_re;
+					if (p) {
+						TWIDDLE(b1, w1);
+						TWIDDLE(b2, w2);
+					}
+				}
+			}
+			break;
+		}
+		case 4:
+			for (int p = 0; p < count; p++) {
+				const double *w1 = twiddles[3 * p], *w2 = twiddles[3 * p + 1], *w3 = twiddles[3 * p + 2];
+				for (int q = 0; q < stride; q++) {
+					const double *a0 = x[q + stride * p], *a1 = x[q + stride * (p + count)], *a2 = x[q + stride * (p + 2 * count)], *a3 = x[q + stride * (p + 3 * count)];
+					double *b0 = y[q + stride * 4 * p], *b1 = y[q + stride * (4 * p + 1)], *b2 = y[q + stride * (4 * p + 2)], *b3 = y[q + stride * (4 * p + 3)];
+					double t0_re = a0[RE] + a2[RE], t0_im = a0[IM] + a2[IM];
+					double t1_re = a0[RE] - a2[RE], t1_im = a0[IM] - a2[IM];
+					double t2_re = a1[RE] + a3[RE], t2_im = a1[IM] + a3[IM];
+					double t3_re = a1[RE] - a3[RE], t3_im = a1[IM] - a3[IM];
+					b0[RE] = t0_re + t2_re;
+					b0[IM] = t0_im + t2_im;
+					b1[RE] = t1_re + t3_im;
+					b1[IM] = t1_im - t3_re;
+					b2[RE] = t0_re - t2_re;
+					b2[IM] = t0_im - t2_im;
+					b3[RE] = t1_re - t3_im;
+					b3[IM] = t1_im + t3_re;
+					if (p) {
+						TWIDDLE(b1, w1);
+						TWIDDLE(b2, w2);
+						TWIDDLE(b3, w3);
+					}
+				}
+			}
+			break;
+		case 5: {
+			const double c1 = 0.30901699437494742410, c2 = -0.80901699437494742410;
+			const double s1 = 0.95105651629515357212, s2 = 0.58778525229247312917;
+			for (int p = 0; p < count; p++) {
+				const double *w1 = twiddles[4 * p], *w2 = twiddles[4 * p + 1], *w3 = twiddles[4 * p + 2], *w4 = twiddles[4 * p + 3];
+				for (int q = 0; q < stride; q++) {
+					const double *a0 = x[q + stride * p], *a1 = x[q + stride * (p + count)], *a2 = x[q + stride * (p + 2 * count)], *a3 = x[q + stride * (p + 3 * count)], *a4 = x[q + stride * (p + 4 * count)];
+					double *b0 = y[q + stride * 5 * p], *b1 = y[q + stride * (5 * p + 1)], *b2 = y[q + stride * (5 * p + 2)], *b3 = y[q + stride * (5 * p + 3)], *b4 = y[q + stride * (5 * p + 4)];
+					double t1_re = a1[RE] + a4[RE], t1_im = a1[IM] + a4[IM];
+					double t2_re = a2[RE] + a3[RE], t2_im = a2[IM] + a3[IM];
+					double t3_re = a1[RE] - a4[RE], t3_im = a1[IM] - a4[IM];
+					double t4_re = a2[RE] - a3[RE], t4_im = a2[IM] - a3[IM];
+					double u1_re = a0[RE] + c1 * t1_re + c2 * t2_re, u1_im = a0[IM] + c1 * t1_im + c2 * t2_im;
+					double u2_re = a0[RE] + c2 * t1_re + c1 * t2_re, u2_im = a0[IM] + c2 * t1_im + c1 * t2_im;
+					double v1_re = s1 * t3_re + s2 * t4_re, v1_im = s1 * t3_im + s2 * t4_im;
+					double v2_re = s2 * t3_re - s1 * t4_re, v2_im = s2 * t3_im - s1 * t4_im;
+					b0[RE] = a0[RE] + t1_re + t2_re;
+					b0[IM] = a0[IM] + t1_im + t2_im;
+					b1[RE] = u1_re + v1_im;
+					b1[IM] = u1_im - v1_re;
+					b4[RE] = u1_re - v1_im;
+					b4[IM] = u1_im + v1_re;
+					b2[RE] = u2_re + v2_im;
+					b2[IM] = u2_im - v2_re;
+					b3[RE] = u2_re - v2_im;
+					b3[IM] = u2_im + v2_re;
+					if (p) {
+						TWIDDLE(b1, w1);
+						TWIDDLE(b2, w2);
+						TWIDDLE(b3, w3);
+						TWIDDLE(b4, w4);
+					}
+				}
+			}
+			break;
+		}
+	}
+}
+
+/* Forward complex FFT of length plan->m, result is stored in x, work is scratch of the same size */
+
+static void fft_complex(const fft_plan *plan, double (*x)[2], double (*work)[2]) {
+	double (*in)[2] = x, (*out)[2] = work;
+	int length = plan->m, stride = 1;
+	for (int i = 0; i < plan->passes; i++) {
+		fft_pass(plan->radix[i], length, stride, (const double (*)[2])plan->twiddles[i], (const double (*)[2])in, out);
+		length /= plan->radix[i];
+		stride *= plan->radix[i];
+		double (*tmp)[2] = in;
+		in = out;
+		out = tmp;
+	}
+	if (in != x)
+		memcpy(x, in, plan->m * sizeof(*x));
+}
+
+/* Forward FFT of real sequence x of length plan->n, X receives plan->m + 1 complex values of the half spectrum, work is scratch of plan->m complex values */
+
+static void fft_real(const fft_plan *plan, const double *x, double (*X)[2], double (*work)[2]) {
+	const int m = plan->m;
+	memcpy(X, x, plan->n * sizeof(double));
+	fft_complex(plan, X, work);
+	double z_re = X[0][RE], z_im = X[0][IM];
+	X[0][RE] = z_re + z_im;
+	X[0][IM] = 0;
+	X[m][RE] = z_re - z_im;
+	X[m][IM] = 0;
+	for (int k = 1; k <= m / 2; k++) {
+		const double *w = plan->split[k];
+		double *zk = X[k], *zmk = X[m - k];
+		double e_re = (zk[RE] + zmk[RE]) / 2, e_im = (zk[IM] - zmk[IM]) / 2;
+		double o_re = (zk[IM] + zmk[IM]) / 2, o_im = (zmk[RE] - zk[RE]) / 2;
+		double t_re = w[RE] * o_re - w[IM] * o_im, t_im = w[RE] * o_im + w[IM] * o_re;
+		zk[RE] = e_re + t_re;
+		zk[IM] = e_im + t_im;
+		zmk[RE] = e_re - t_re;
+		zmk[IM] = t_im - e_im;
+	}
+}
+
+/* Inverse FFT of half spectrum X (plan->m + 1 complex values, overwritten) to real sequence x of length plan->n, x may share memory with work */
+
+static void ifft_real(const fft_plan *plan, double (*X)[2], double *x, double (*work)[2]) {
+	const int m = plan->m;
+	double x0 = X[0][RE], xm = X[m][RE];
+	X[0][RE] = (x0 + xm) / 2;
+	X[0][IM] = -(x0 - xm) / 2;
+	for (int k = 1; k <= m / 2; k++) {
+		const double *w = plan->split[k];
+		double *xk = X[k], *xmk = X[m - k];
+		double e_re = (xk[RE] + xmk[RE]) / 2, e_im = (xk[IM] - xmk[IM]) / 2;
+		double d_re = (xk[RE] - xmk[RE]) / 2, d_im = (xk[IM] + xmk[IM]) / 2;
+		double o_re = d_re * w[RE] + d_im * w[IM], o_im = d_im * w[RE] - d_re * w[IM];
+		/* store conjugated values, inverse transform is computed as conjugated forward transform */
+		xk[RE] = e_re - o_im;
+		xk[IM] = -(e_im + o_re);
+		xmk[RE] = e_re + o_im;
+		xmk[IM] = e_im - o_re;
+	}
+	fft_complex(plan, X, work);
+	for (int k = 0; k < m; k++) {
+		x[2 * k] = X[k][RE] / m;
+		x[2 * k + 1] = -X[k][IM] / m;
+	}
+}
+
+static void corellate_fft(const fft_plan *plan, const double (*X1)[2], const double (*X2)[2], double *c, double (*work)[2]) {
+	double (*C)[2] = work + plan->m;
+	/* pointwise multiply X1 with X2 conjugate */
+	for (int i = 0; i <= plan->m; i++) {
 		C[i][RE] = X1[i][RE] * X2[i][RE] + X1[i][IM] * X2[i][IM];
 		C[i][IM] = X1[i][IM] * X2[i][RE] - X1[i][RE] * X2[i][IM];
 	}
-	ifft(n, C, c);
-	free(C);
+	ifft_real(plan, C, c, work);
 }
 
-static double find_distance(const int n, const double (*c)[2]) {
+static double find_distance(const int n, const double *c) {
 	int i;
 	const int n2 = n / 2;
 	int max=0;
 	int prev, next;
 	for (i = 0; i < n; i++) {
-		max = (c[i][0] > c[max][0]) ? i : max;
+		max = (c[i] > c[max]) ? i : max;
 	}
 	/* find previous and next positions to calculate quadratic interpolation */
 	if ((max == 0) || (max == n2)) {
@@ -113,8 +329,8 @@ static double find_distance(const int n, const double (*c)[2]) {
 		next = max + 1;
 	}
 	/* find subpixel offset of the maximum position using quadratic interpolation */
-	double max_subp = (c[next][RE] - c[prev][RE]) / (2 * (2 * c[max][RE] - c[next][RE] - c[prev][RE]));
-//	INDIGO_DEBUG(indigo_debug("max_subp = %5.2f max: %d -> %5.2f %5.2f %5.2f\n", max_subp, max, c[prev][0], c[max][0], c[next][0]));
+	double max_subp = (c[next] - c[prev]) / (2 * (2 * c[max] - c[next] - c[prev]));
+//	INDIGO_DEBUG(indigo_debug("max_subp = %5.2f max: %d -> %5.2f %5.2f %5.2f\n", max_subp, max, c[prev], c[max], c[next]));
 	if (max == n2) {
 		return max_subp;
 	} else if (max > n2) {
@@ -126,13 +342,6 @@ static double find_distance(const int n, const double (*c)[2]) {
 	}
 }
 
-static int next_power_2(const int n) {
-	int k = 1;
-	while (k < n)
-		k <<= 1;
-	return k;
-}
-
 indigo_result indigo_selection_psf(indigo_raw_type raw_type, const void *data, double x, double y, const int radius, const int width, const int height, double *fwhm, double *hfd, double *peak) {
 	static int d1[][2] = { { 0, 0 }, { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 }, { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 }, { -2, 0 }, { 0, -2 }, { 0, 2 }, { 2, 0 }, { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 }, { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 }, { -2, -2 }, { -2, 2 }, { 2, -2 }, { 2, 2 }, { -3, 0 }, { 0, -3 }, { 0, 3 }, { 3, 0 }, { -3, -1 }, { -3, 1 }, { -1, -3 }, { -1, 3 }, { 1, -3 }, { 1, 3 }, { 3, -1 }, { 3, 1 }, { -3, -2 }, { -3, 2 }, { -2, -3 }, { -2, 3 }, { 2, -3 }, { 2, 3 }, { 3, -2 }, { 3, 2 }, { -4, 0 }, { 0, -4 }, { 0, 4 }, { 4, 0 }, { -4, -1 }, { -4, 1 }, { -1, -4 }, { -1, 4 }, { 1, -4 }, { 1, 4 }, { 4, -1 }, { 4, 1 }, { -3, -3 }, { -3, 3 }, { 3, -3 }, { 3, 3 }, { -4, -2 }, { -4, 2 }, { -2, -4 }, { -2, 4 }, { 2, -4 }, { 2, 4 }, { 4, -2 }, { 4, 2 }, { -5, 0 }, { -4, -3 }, { -4, 3 }, { -3, -4 }, { -3, 4 }, { 0, -5 }, { 0, 5 }, { 3, -4 }, { 3, 4 }, { 4, -3 }, { 4, 3 }, { 5, 0 }, { -5, -1 }, { -5, 1 }, { -1, -5 }, { -1, 5 }, { 1, -5 }, { 1, 5 }, { 5, -1 }, { 5, 1 }, { -5, -2 }, { -5, 2 }, { -2, -5 }, { -2, 5 }, { 2, -5 }, { 2, 5 }, { 5, -2 }, { 5, 2 }, { -4, -4 }, { -4, 4 }, { 4, -4 }, { 4, 4 }, { -5, -3 }, { -5, 3 }, { -3, -5 }, { -3, 5 }, { 3, -5 }, { 3, 5 }, { 5, -3 }, { 5, 3 }, { -6, 0 }, { 0, -6 }, { 0, 6 }, { 6, 0 }, { -6, -1 }, { -6, 1 }, { -1, -6 }, { -1, 6 }, { 1, -6 }, { 1, 6 }, { 6, -1 }, { 6, 1 }, { -6, -2 }, { -6, 2 }, { -2, -6 }, { -2, 6 }, { 2, -6 }, { 2, 6 }, { 6, -2 }, { 6, 2 }, { -5, -4 }, { -5, 4 }, { -4, -5 }, { -4, 5 }, { 4, -5 }, { 4, 5 }, { 5, -4 }, { 5, 4 }, { -6, -3 }, { -6, 3 }, { -3, -6 }, { -3, 6 }, { 3, -6 }, { 3, 6 }, { 6, -3 }, { 6, 3 }, { -7, 0 }, { 0, -7 }, { 0, 7 }, { 7, 0 }, { -7, -1 }, { -7, 1 }, { -5, -5 }, { -5, 5 }, { -1, -7 }, { -1, 7 }, { 1, -7 }, { 1, 7 }, { 5, -5 }, { 5, 5 }, { 7, -1 }, { 7, 1 }, { -6, -4 }, { -6, 4 }, { -4, -6 }, { -4, 6 }, { 4, -6 }, { 4, 6 }, { 6, -4 }, { 6, 4 }, { -7, -2 }, { -7, 2 }, { -2, -7 }, { -2, 7 }, { 2, -7 }, { 2, 7 }, { 7, -2 }, { 7, 2 }, { -7, -3 }, { -7, 3 }, { -3, -7 }, { -3, 7 }, { 3, -7 }, { 3, 7 }, { 7, -3 }, { 7, 3 }, { -6, -5 }, { -6, 5 }, { -5, -6 }, { -5, 6 }, { 5, -6 }, { 5, 6 }, { 6, -5 }, { 6, 5 }, { -8, 0 }, { 0, -8 }, { 0, 8 }, { 8, 0 }, { -8, -1 }, { -8, 1 }, { -7, -4 }, { -7, 4 }, { -4, -7 }, { -4, 7 }, { -1, -8 }, { -1, 8 }, { 1, -8 }, { 1, 8 }, { 4, -7 }, { 4, 7 }, { 7, -4 }, { 7, 4 }, { 8, -1 }, { 8, 1 }, { -8, -2 }, { -8, 2 }, { -2, -8 }, { -2, 8 }, { 2, -8 }, { 2, 8 }, { 8, -2 }, { 8, 2 }, { -6, -6 }, { -6, 6 }, { 6, -6 }, { 6, 6 }, { -8, -3 }, { -8, 3 }, { -3, -8 }, { -3, 8 }, { 3, -8 }, { 3, 8 }, { 8, -3 }, { 8, 3 }, { -7, -5 }, { -7, 5 }, { -5, -7 }, { -5, 7 }, { 5, -7 }, { 5, 7 }, { 7, -5 }, { 7, 5 }, { -8, -4 }, { -8, 4 }, { -4, -8 }, { -4, 8 }, { 4, -8 }, { 4, 8 }, { 8, -4 }, { 8, 4 }, { -9, 0 }, { 0, -9 }, { 0, 9 }, { 9, 0 }, { -9, -1 }, { -9, 1 }, { -1, -9 }, { -1, 9 }, { 1, -9 }, { 1, 9 }, { 9, -1 }, { 9, 1 }, { -9, -2 }, { -9, 2 }, { -7, -6 }, { -7, 6 }, { -6, -7 }, { -6, 7 }, { -2, -9 }, { -2, 9 }, { 2, -9 }, { 2, 9 }, { 6, -7 }, { 6, 7 }, { 7, -6 }, { 7, 6 }, { 9, -2 }, { 9, 2 }, { -8, -5 }, { -8, 5 }, { -5, -8 }, { -5, 8 }, { 5, -8 }, { 5, 8 }, { 8, -5 }, { 8, 5 }, { -9, -3 }, { -9, 3 }, { -3, -9 }, { -3, 9 }, { 3, -9 }, { 3, 9 }, { 9, -3 }, { 9, 3 }, { -9, -4 }, { -9, 4 }, { -4, -9 }, { -4, 9 }, { 4, -9 }, { 4, 9 }, { 9, -4 }, { 9, 4 }, { -7, -7 }, { -7, 7 }, { 7, -7 }, { 7, 7 }, { -10, 0 }, { -8, -6 }, { -8, 6 }, { -6, -8 }, { -6, 8 }, { 0, -10 }, { 0, 10 }, { 6, -8 }, { 6, 8 }, { 8, -6 }, { 8, 6 }, { 10, 0 }, { -10, -1 }, { -10, 1 }, { -1, -10 }, { -1, 10 }, { 1, -10 }, { 1, 10 }, { 10, -1 }, { 10, 1 }, { -10, -2 }, { -10, 2 }, { -2, -10 }, { -2, 10 }, { 2, -10 }, { 2, 10 }, { 10, -2 }, { 10, 2 }, { -9, -5 }, { -9, 5 }, { -5, -9 }, { -5, 9 }, { 5, -9 }, { 5, 9 }, { 9, -5 }, { 9, 5 }, { -10, -3 }, { -10, 3 }, { -3, -10 }, { -3, 10 }, { 3, -10 }, { 3, 10 }, { 10, -3 }, { 10, 3 }, { -8, -7 }, { -8, 7 }, { -7, -8 }, { -7, 8 }, { 7, -8 }, { 7, 8 }, { 8, -7 }, { 8, 7 }, { -10, -4 }, { -10, 4 }, { -4, -10 }, { -4, 10 }, { 4, -10 }, { 4, 10 }, { 10, -4 }, { 10, 4 }, { -9, -6 }, { -9, 6 }, { -6, -9 }, { -6, 9 }, { 6, -9 }, { 6, 9 }, { 9, -6 }, { 9, 6 }, { -10, -5 }, { -10, 5 }, { -5, -10 }, { -5, 10 }, { 5, -10 }, { 5, 10 }, { 10, -5 }, { 10, 5 }, { -8, -8 }, { -8, 8 }, { 8, -8 }, { 8, 8 }, { -9, -7 }, { -9, 7 }, { -7, -9 }, { -7, 9 }, { 7, -9 }, { 7, 9 }, { 9, -7 }, { 9, 7 }, { -10, -6 }, { -10, 6 }, { -6, -10 }, { -6, 10 }, { 6, -10 }, { 6, 10 }, { 10, -6 }, { 10, 6 }, { -9, -8 }, { -9, 8 }, { -8, -9 }, { -8, 9 }, { 8, -9 }, { 8, 9 }, { 9, -8 }, { 9, 8 }, { -10, -7 }, { -10, 7 }, { -7, -10 }, { -7, 10 }, { 7, -10 }, { 7, 10 }, { 10, -7 }, { 10, 7 }, { -9, -9 }, { -9, 9 }, { 9, -9 }, { 9, 9 }, { -10, -8 }, { -10, 8 }, { -8, -10 }, { -8, 10 }, { 8, -10 }, { 8, 10 }, { 10, -8 }, { 10, 8 }, { -10, -9 }, { -10, 9 }, { -9, -10 }, { -9, 10 }, { 9, -10 }, { 9, 10 }, { 10, -9 }, { 10, 9 }, { -10, -10 }, { -10, 10 }, { 10, -10 }, { 10, 10 } };
 	static int d2[][2] = { { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 } };
@@ -344,43 +553,165 @@ indigo_result indigo_selection_frame_digest(indigo_raw_type raw_type, const void
 	return INDIGO_OK;
 }
 
+#define DIGEST_MAX_THREADS				8
+#define DIGEST_MIN_BAND_PIXELS		(512 * 1024)
+#define DIGEST_CHUNK_PIXELS				16384	// pixels accumulated in 32 bit sums before they are added to doubles (RGB48 pixel value < 2^18)
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DIGEST_X86
+#endif
+
+/* Row and column sums of a frame band, column sums of up to DIGEST_CHUNK_PIXELS rows are accumulated in 32 bit integers,
+ * loops are written to be vectorized by the compiler.
+ */
+
+#define PROJECTION_KERNEL(name, type, components, attributes) \
+attributes static void name(const void *data, const int width, const int first_row, const int last_row, uint32_t *col, double *row) { \
+	for (int y = first_row; y < last_row; y++) { \
+		const type *line = (const type *)data + (size_t)y * width * components; \
+		uint64_t sum = 0; \
+		for (int first = 0; first < width; first += DIGEST_CHUNK_PIXELS) { \
+			int last = (first + DIGEST_CHUNK_PIXELS < width) ? first + DIGEST_CHUNK_PIXELS : width; \
+			uint32_t partial = 0; \
+			for (int x = first; x < last; x++) { \
+				uint32_t value = components == 1 ? line[x] : (uint32_t)line[3 * x] + line[3 * x + 1] + line[3 * x + 2]; \
+				col[x] += value; \
+				partial += value; \
+			} \
+			sum += partial; \
+		} \
+		row[y] = sum; \
+	} \
+}
+
+PROJECTION_KERNEL(project_mono8, uint8_t, 1, )
+PROJECTION_KERNEL(project_mono16, uint16_t, 1, )
+PROJECTION_KERNEL(project_rgb24, uint8_t, 3, )
+PROJECTION_KERNEL(project_rgb48, uint16_t, 3, )
+
+#ifdef DIGEST_X86
+PROJECTION_KERNEL(project_mono8_avx2, uint8_t, 1, __attribute__((target("avx2"))))
+PROJECTION_KERNEL(project_mono16_avx2, uint16_t, 1, __attribute__((target("avx2"))))
+
+static bool projection_avx2() {
+	static int supported = -1;
+	if (supported == -1) {
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return supported == 1;
+}
+#endif
+
+typedef void (*projection_kernel)(const void *data, const int width, const int first_row, const int last_row, uint32_t *col, double *row);
+
+typedef struct {
+	projection_kernel kernel;
+	const void *data;
+	int width;
+	int first_row, last_row;
+	double *col;
+	double *row;
+} projection_band;
+
+static projection_kernel projection_kernel_for(indigo_raw_type raw_type) {
+	switch (raw_type) {
+		case INDIGO_RAW_MONO8:
+#ifdef DIGEST_X86
+			if (projection_avx2())
+				return project_mono8_avx2;
+#endif
+			return project_mono8;
+		case INDIGO_RAW_MONO16:
+#ifdef DIGEST_X86
+			if (projection_avx2())
+				return project_mono16_avx2;
+#endif
+			return project_mono16;
+		case INDIGO_RAW_RGB24:
+			return project_rgb24;
+		case INDIGO_RAW_RGB48:
+			return project_rgb48;
+	}
+	return NULL;
+}
+
+static void *projection_band_worker(void *arg) {
+	projection_band *band = arg;
+	uint32_t *col = calloc(band->width, sizeof(uint32_t));
+	memset(band->col, 0, band->width * sizeof(double));
+	for (int first = band->first_row; first < band->last_row; first += DIGEST_CHUNK_PIXELS) {
+		int last = (first + DIGEST_CHUNK_PIXELS < band->last_row) ? first + DIGEST_CHUNK_PIXELS : band->last_row;
+		band->kernel(band->data, band->width, first, last, col, band->row);
+		for (int x = 0; x < band->width; x++) {
+			band->col[x] += col[x];
+			col[x] = 0;
+		}
+	}
+	free(col);
+	return NULL;
+}
+
+static int projection_threads(long pixels) {
+	long threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > pixels / DIGEST_MIN_BAND_PIXELS)
+		threads = pixels / DIGEST_MIN_BAND_PIXELS;
+	if (threads > DIGEST_MAX_THREADS)
+		threads = DIGEST_MAX_THREADS;
+	return threads < 1 ? 1 : (int)threads;
+}
+
+/* Column sums (col, width values) and row sums (row, height values) of the frame computed in one pass, large frames are split to bands processed in parallel */
+
+static bool project_frame(indigo_raw_type raw_type, const void *data, const int width, const int height, double *col, double *row) {
+	projection_kernel kernel = projection_kernel_for(raw_type);
+	if (kernel == NULL)
+		return false;
+	int count = projection_threads((long)width * height);
+	projection_band bands[DIGEST_MAX_THREADS];
+	double *partials = count > 1 ? malloc((size_t)(count - 1) * width * sizeof(double)) : NULL;
+	for (int i = 0; i < count; i++) {
+		bands[i].kernel = kernel;
+		bands[i].data = data;
+		bands[i].width = width;
+		bands[i].first_row = (int)((long)height * i / count);
+		bands[i].last_row = (int)((long)height * (i + 1) / count);
+		bands[i].col = i == 0 ? col : partials + (size_t)(i - 1) * width;
+		bands[i].row = row;
+	}
+	pthread_t threads[DIGEST_MAX_THREADS];
+	bool started[DIGEST_MAX_THREADS] = { false };
+	for (int i = 1; i < count; i++)
+		started[i] = pthread_create(&threads[i], NULL, projection_band_worker, bands + i) == 0;
+	projection_band_worker(bands);
+	for (int i = 1; i < count; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			projection_band_worker(bands + i);
+		for (int x = 0; x < width; x++)
+			col[x] += bands[i].col[x];
+	}
+	if (partials)
+		free(partials);
+	return true;
+}
+
 indigo_result indigo_centroid_frame_digest(indigo_raw_type raw_type, const void *data, const int width, const int height, indigo_frame_digest *c) {
 	if ((width < 3) || (height < 3))
 		return INDIGO_FAILED;
 	if ((data == NULL) || (c == NULL))
 		return INDIGO_FAILED;
+	double *col = (double *)digest_get_scratch((width + height + 1) / 2);
+	double *row = col + width;
+	if (!project_frame(raw_type, data, width, height, col, row))
+		return INDIGO_FAILED;
 	double m10 = 0, m01 = 0, m00 = 0;
-	int ci = 0, li = 0, max = width * height;
-	for (int i = 0; i < max; i++) {
-		double value;
-		switch (raw_type) {
-			case INDIGO_RAW_MONO8: {
-				value = ((uint8_t *)data)[i];
-				break;
-			}
-			case INDIGO_RAW_MONO16: {
-				value = ((uint16_t *)data)[i];
-				break;
-			}
-			case INDIGO_RAW_RGB24: {
-				value = ((uint8_t *)data)[i] + ((uint8_t *)data)[i + 1] + ((uint8_t *)data)[i + 2];
-				i += 2;
-				break;
-			}
-			case INDIGO_RAW_RGB48: {
-				value = ((uint16_t *)data)[i] + ((uint16_t *)data)[i + 1] + ((uint16_t *)data)[i + 2];
-				i += 2;
-				break;
-			}
-		}
-		m10 += ci * value;
-		m01 += li * value;
-		m00 += value;
-		ci++;
-		if (ci == width) {
-			ci = 0;
-			li++;
-		}
+	for (int x = 0; x < width; x++)
+		m10 += x * col[x];
+	for (int y = 0; y < height; y++) {
+		m01 += y * row[y];
+		m00 += row[y];
 	}
 	c->width = width;
 	c->height = height;
@@ -393,34 +724,34 @@ indigo_result indigo_centroid_frame_digest(indigo_raw_type raw_type, const void
 
 #define BG_RADIUS	5
 
-static double calibrate_re(double (*vector)[2], int size) {
+static double calibrate_re(double *vector, int size) {
 	int first = BG_RADIUS + 1, last = size - BG_RADIUS - 1;
 	double avg = 0;
 	double mins[size];
 	for (int i = first; i <= last; i++) {
-		double min = vector[i - BG_RADIUS][RE];
+		double min = vector[i - BG_RADIUS];
 		for (int j = -BG_RADIUS + 1; j <= BG_RADIUS; j++) {
-			double value = vector[i + j][RE];
+			double value = vector[i + j];
 			if (value < min)
 				min = value;
 		}
 		mins[i] = min;
 	}
 	for (int i = 0; i < first; i++)
-		vector[i][RE] = 0;
+		vector[i] = 0;
 	for (int i = last + 1; i < size; i++)
-		vector[i][RE] = 0;
+		vector[i] = 0;
 	avg = 0;
 	int count = last - first + 1;
 	for (int i = first; i <= last; i++) {
-		double value = vector[i][RE] - mins[i];
-		vector[i][RE] = value;
+		double value = vector[i] - mins[i];
+		vector[i] = value;
 		avg += value;
 	}
 	avg /= count;
 	double stddev = 0;
 	for (int i = first; i <= last; i++) {
-		double value = vector[i][RE] - avg;
+		double value = vector[i] - avg;
 		stddev += value * value;
 	}
 	stddev /= count;
@@ -428,7 +759,7 @@ static double calibrate_re(double (*vector)[2], int size) {
 	double signal_ms = 0, noise_ms = 0;
 	int signal_count = 0, noise_count = 0;
 	for (int i = first; i <= last; i++) {
-		double value = vector[i][RE];
+		double value = vector[i];
 		if (value > threshold) {
 			signal_ms += value * value;
 			signal_count++;
@@ -448,57 +779,399 @@ indigo_result indigo_donuts_frame_digest(indigo_raw_type raw_type, const void *d
 		return INDIGO_FAILED;
 	if ((data == NULL) || (c == NULL))
 		return INDIGO_FAILED;
-	c->width = next_power_2(width);
-	c->height = next_power_2(height);
-	double (*col_x)[2] = calloc(2 * c->width * sizeof(double), 1);
-	double (*col_y)[2] = calloc(2 * c->height * sizeof(double), 1);
-	c->fft_x = malloc(2 * c->width * sizeof(double));
-	c->fft_y = malloc(2 * c->height * sizeof(double));
-	int ci = 0, li = 0, max = width * height;
-	for (int i = 0; i < max; i++) {
-		double value;
-		switch (raw_type) {
-			case INDIGO_RAW_MONO8: {
-				value = ((uint8_t *)data)[i];
-				break;
-			}
-			case INDIGO_RAW_MONO16: {
-				value = ((uint16_t *)data)[i];
-				break;
-			}
-			case INDIGO_RAW_RGB24: {
-				value = ((uint8_t *)data)[i] + ((uint8_t *)data)[i + 1] + ((uint8_t *)data)[i + 2];
-				break;
-			}
-			case INDIGO_RAW_RGB48: {
-				value = ((uint16_t *)data)[i] + ((uint16_t *)data)[i + 1] + ((uint16_t *)data)[i + 2];
-				break;
-			}
-		}
-		col_x[ci][RE] += value;
-		col_y[li][RE] += value;
-		ci++;
-		if (ci == width) {
-			ci = 0;
-			li++;
-		}
-	}
+	c->width = fft_size(width);
+	c->height = fft_size(height);
+	fft_plan *plan_x = fft_get_plan(c->width);
+	fft_plan *plan_y = fft_get_plan(c->height);
+	int max_m = (plan_x->m > plan_y->m) ? plan_x->m : plan_y->m;
+	double *col_x = (double *)digest_get_scratch((c->width + c->height) / 2 + max_m);
+	double *col_y = col_x + c->width;
+	double (*work)[2] = (double (*)[2])(col_y + c->height);
+	memset(col_x, 0, (c->width + c->height) * sizeof(double));
+	if (!project_frame(raw_type, data, width, height, col_x, col_y))
+		return INDIGO_FAILED;
+	c->fft_x = malloc((plan_x->m + 1) * sizeof(*c->fft_x));
+	c->fft_y = malloc((plan_y->m + 1) * sizeof(*c->fft_y));
 	c->snr = (calibrate_re(col_x, width) + calibrate_re(col_y, height)) / 2;
 //	printf("col_x:");
 //	for (i=0; i < c->width; i++) {
-//		printf(" %5.2f\n",col_x[i][RE]);
+//		printf(" %5.2f\n",col_x[i]);
 //	}
 //	printf("\n");
 //	printf("col_y:");
 //	for (i=0; i < fdigest->height; i++) {
-//		printf(" %5.2f",col_y[i][RE]);
+//		printf(" %5.2f",col_y[i]);
 //	}
 //	printf("\n");
-	fft(c->width, col_x, c->fft_x);
-	fft(c->height, col_y, c->fft_y);
+	fft_real(plan_x, col_x, c->fft_x, work);
+	fft_real(plan_y, col_y, c->fft_y, work);
 	c->algorithm = donuts;
-	free(col_x);
-	free(col_y);
+	return INDIGO_OK;
+}
+
+#define STAR_TILES						16		// max background tiles per axis
+#define STAR_MIN_TILE_SIZE		128
+#define STAR_TILE_SAMPLES			15		// background samples per tile axis
+#define STAR_DETECTION_SIGMA	5.0		// detection threshold above local background (in noise sigmas)
+#define STAR_MIN_AREA					3			// smaller components are hot pixels or noise
+#define STAR_MAX_AREA					2500	// larger components are extended objects or saturated blobs
+#define STAR_BORDER						8
+#define STAR_MAX_ELLIPTICITY	0.3		// (a^2 - b^2) / (a^2 + b^2) of second moments
+#define STAR_MATCH_TOLERANCE	2.0		// max deviation of matched star from consensus offset (px)
+
+static inline double frame_pixel(indigo_raw_type raw_type, const void *data, const int index) {
+	switch (raw_type) {
+		case INDIGO_RAW_MONO8:
+			return ((uint8_t *)data)[index];
+		case INDIGO_RAW_MONO16:
+			return ((uint16_t *)data)[index];
+		case INDIGO_RAW_RGB24:
+			return ((uint8_t *)data)[3 * index] + ((uint8_t *)data)[3 * index + 1] + ((uint8_t *)data)[3 * index + 2];
+		case INDIGO_RAW_RGB48:
+			return ((uint16_t *)data)[3 * index] + ((uint16_t *)data)[3 * index + 1] + ((uint16_t *)data)[3 * index + 2];
+	}
+	return 0;
+}
+
+static double select_kth(double *values, int count, int k) {
+	int left = 0, right = count - 1;
+	while (left < right) {
+		double pivot = values[(left + right) / 2];
+		int i = left, j = right;
+		while (i <= j) {
+			while (values[i] < pivot)
+				i++;
+			while (values[j] > pivot)
+				j--;
+			if (i <= j) {
+				double tmp = values[i];
+				values[i++] = values[j];
+				values[j--] = tmp;
+			}
+		}
+		if (k <= j)
+			right = j;
+		else if (k >= i)
+			left = i;
+		else
+			break;
+	}
+	return values[k];
+}
+
+typedef struct {
+	int tile_width, tile_height;
+	int tiles_x, tiles_y;
+	double background[STAR_TILES][STAR_TILES];
+	double threshold[STAR_TILES][STAR_TILES];
+	double sigma;
+} star_background;
+
+/* Local background (median) and noise (median absolute deviation) estimated from a fixed number of samples per tile */
+
+static void estimate_background(indigo_raw_type raw_type, const void *data, const int width, const int height, star_background *bg) {
+	bg->tiles_x = width / STAR_MIN_TILE_SIZE < 1 ? 1 : width / STAR_MIN_TILE_SIZE;
+	bg->tiles_y = height / STAR_MIN_TILE_SIZE < 1 ? 1 : height / STAR_MIN_TILE_SIZE;
+	if (bg->tiles_x > STAR_TILES)
+		bg->tiles_x = STAR_TILES;
+	if (bg->tiles_y > STAR_TILES)
+		bg->tiles_y = STAR_TILES;
+	bg->tile_width = (width + bg->tiles_x - 1) / bg->tiles_x;
+	bg->tile_height = (height + bg->tiles_y - 1) / bg->tiles_y;
+	double sigmas[STAR_TILES * STAR_TILES];
+	double samples[STAR_TILE_SAMPLES * STAR_TILE_SAMPLES];
+	for (int ty = 0; ty < bg->tiles_y; ty++) {
+		int y0 = ty * bg->tile_height, y1 = y0 + bg->tile_height < height ? y0 + bg->tile_height : height;
+		for (int tx = 0; tx < bg->tiles_x; tx++) {
+			int x0 = tx * bg->tile_width, x1 = x0 + bg->tile_width < width ? x0 + bg->tile_width : width;
+			int count = 0;
+			for (int j = 0; j < STAR_TILE_SAMPLES; j++) {
+				int y = y0 + (int)((j + 0.5) * (y1 - y0) / STAR_TILE_SAMPLES);
+				for (int i = 0; i < STAR_TILE_SAMPLES; i++) {
+					int x = x0 + (int)((i + 0.5) * (x1 - x0) / STAR_TILE_SAMPLES);
+					samples[count++] = frame_pixel(raw_type, data, y * width + x);
+				}
+			}
+			double median = select_kth(samples, count, count / 2);
+			for (int i = 0; i < count; i++)
+				samples[i] = fabs(samples[i] - median);
+			bg->background[ty][tx] = median;
+			sigmas[ty * bg->tiles_x + tx] = 1.4826 * select_kth(samples, count, count / 2);
+		}
+	}
+	/* tiles with stars or gradients overestimate noise, median of tile estimates is used for the whole frame */
+	bg->sigma = select_kth(sigmas, bg->tiles_x * bg->tiles_y, bg->tiles_x * bg->tiles_y / 2);
+	if (bg->sigma < 0.5)
+		bg->sigma = 0.5;
+	for (int ty = 0; ty < bg->tiles_y; ty++)
+		for (int tx = 0; tx < bg->tiles_x; tx++)
+			bg->threshold[ty][tx] = bg->background[ty][tx] + STAR_DETECTION_SIGMA * bg->sigma;
+}
+
+static inline double local_background(const star_background *bg, const int x, const int y) {
+	return bg->background[y / bg->tile_height][x / bg->tile_width];
+}
+
+typedef struct {
+	uint8_t *visited;
+	int *stack;
+	int stack_size;
+} star_scan;
+
+#define VISITED(scan, index)	((scan)->visited[(index) >> 3] & (1 << ((index) & 7)))
+#define SET_VISITED(scan, index)	((scan)->visited[(index) >> 3] |= (1 << ((index) & 7)))
+
+/* Flood fill of 8-connected component above threshold, returns false if component can't be a guide star */
+
+static bool measure_component(indigo_raw_type raw_type, const void *data, const int width, const int height, const star_background *bg, double saturation, star_scan *scan, int start, double *cx, double *cy) {
+	int top = 0, area = 0;
+	bool valid = true;
+	double m00 = 0, m10 = 0, m01 = 0;
+	SET_VISITED(scan, start);
+	scan->stack[top++] = start;
+	while (top > 0) {
+		int index = scan->stack[--top];
+		int x = index % width, y = index / width;
+		double value = frame_pixel(raw_type, data, index);
+		if (value >= saturation || x < STAR_BORDER || y < STAR_BORDER || x >= width - STAR_BORDER || y >= height - STAR_BORDER)
+			valid = false;
+		value -= local_background(bg, x, y);
+		m00 += value;
+		m10 += x * value;
+		m01 += y * value;
+		area++;
+		for (int dy = -1; dy <= 1; dy++) {
+			int yy = y + dy;
+			if (yy < 0 || yy >= height)
+				continue;
+			for (int dx = -1; dx <= 1; dx++) {
+				int xx = x + dx;
+				if (xx < 0 || xx >= width)
+					continue;
+				int neighbour = yy * width + xx;
+				if (VISITED(scan, neighbour) || frame_pixel(raw_type, data, neighbour) <= bg->threshold[yy / bg->tile_height][xx / bg->tile_width])
+					continue;
+				SET_VISITED(scan, neighbour);
+				if (top == scan->stack_size) {
+					scan->stack_size *= 2;
+					scan->stack = realloc(scan->stack, scan->stack_size * sizeof(int));
+				}
+				scan->stack[top++] = neighbour;
+			}
+		}
+	}
+	if (!valid || area < STAR_MIN_AREA || area > STAR_MAX_AREA || m00 <= 0)
+		return false;
+	*cx = m10 / m00;
+	*cy = m01 / m00;
+	return true;
+}
+
+/* Centroid, flux and S/N measured in a window around the component, S/N assumes gain 1e/ADU, elongated (blended) stars are rejected */
+
+static bool measure_star(indigo_raw_type raw_type, const void *data, const int width, const int height, const star_background *bg, double cx, double cy, int radius, indigo_star_detection *star) {
+	int x0 = (int)round(cx) - radius, x1 = (int)round(cx) + radius;
+	int y0 = (int)round(cy) - radius, y1 = (int)round(cy) + radius;
+	if (x0 < 0 || y0 < 0 || x1 >= width || y1 >= height)
+		return false;
+	double background = local_background(bg, (int)cx, (int)cy);
+	double noise = 2 * bg->sigma;
+	double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m02 = 0, m11 = 0;
+	int count = 0;
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			double value = frame_pixel(raw_type, data, y * width + x) - background;
+			if (value > noise) {
+				m00 += value;
+				m10 += x * value;
+				m01 += y * value;
+				m20 += x * x * value;
+				m02 += y * y * value;
+				m11 += x * y * value;
+			}
+			count++;
+		}
+	}
+	if (m00 <= 0)
+		return false;
+	star->x = m10 / m00;
+	star->y = m01 / m00;
+	double xx = m20 / m00 - star->x * star->x, yy = m02 / m00 - star->y * star->y, xy = m11 / m00 - star->x * star->y;
+	if (sqrt((xx - yy) * (xx - yy) + 4 * xy * xy) > STAR_MAX_ELLIPTICITY * (xx + yy))
+		return false;
+	star->flux = m00;
+	star->snr = m00 / sqrt(m00 + count * bg->sigma * bg->sigma);
+	return true;
+}
+
+#define FIND_STARS_SCAN(type, components) { \
+	for (int y = STAR_BORDER; y < height - STAR_BORDER; y++) { \
+		const type *line = (const type *)data + (size_t)y * width * components; \
+		const double *thresholds = bg.threshold[y / bg.tile_height]; \
+		for (int first = STAR_BORDER; first < width - STAR_BORDER;) { \
+			int tile = first / bg.tile_width; \
+			int last = (tile + 1) * bg.tile_width < width - STAR_BORDER ? (tile + 1) * bg.tile_width : width - STAR_BORDER; \
+			uint32_t threshold = (uint32_t)thresholds[tile]; \
+			for (int x = first; x < last; x++) { \
+				uint32_t value = components == 1 ? line[x] : (uint32_t)line[3 * x] + line[3 * x + 1] + line[3 * x + 2]; \
+				if (value <= threshold) \
+					continue; \
+				int index = y * width + x; \
+				if (VISITED(&scan, index)) \
+					continue; \
+				double cx, cy; \
+				if (measure_component(raw_type, data, width, height, &bg, saturation, &scan, index, &cx, &cy)) \
+					add_star(raw_type, data, width, height, &bg, cx, cy, max_stars, star_list, &found); \
+			} \
+			first = last; \
+		} \
+	} \
+}
+
+static void add_star(indigo_raw_type raw_type, const void *data, const int width, const int height, const star_background *bg, double cx, double cy, const int max_stars, indigo_star_detection star_list[], int *found) {
+	indigo_star_detection star;
+	if (!measure_star(raw_type, data, width, height, bg, cx, cy, STAR_BORDER - 1, &star))
+		return;
+	/* keep list sorted by flux, the faintest star is dropped if the list is full */
+	int i = *found;
+	if (i == max_stars) {
+		if (star_list[i - 1].flux >= star.flux)
+			return;
+		i--;
+	} else {
+		(*found)++;
+	}
+	while (i > 0 && star_list[i - 1].flux < star.flux) {
+		star_list[i] = star_list[i - 1];
+		i--;
+	}
+	star_list[i] = star;
+}
+
+indigo_result indigo_find_stars(indigo_raw_type raw_type, const void *data, const int width, const int height, const int max_stars, indigo_star_detection star_list[], int *stars_found) {
+	if ((width <= 2 * STAR_BORDER) || (height <= 2 * STAR_BORDER) || max_stars < 1)
+		return INDIGO_FAILED;
+	if ((data == NULL) || (star_list == NULL) || (stars_found == NULL))
+		return INDIGO_FAILED;
+	double saturation;
+	switch (raw_type) {
+		case INDIGO_RAW_MONO8:
+			saturation = 0.95 * 0xFF;
+			break;
+		case INDIGO_RAW_MONO16:
+			saturation = 0.95 * 0xFFFF;
+			break;
+		case INDIGO_RAW_RGB24:
+			saturation = 0.95 * 3 * 0xFF;
+			break;
+		case INDIGO_RAW_RGB48:
+			saturation = 0.95 * 3 * 0xFFFF;
+			break;
+		default:
+			return INDIGO_FAILED;
+	}
+	star_background bg;
+	estimate_background(raw_type, data, width, height, &bg);
+	star_scan scan;
+	scan.visited = calloc(((size_t)width * height + 7) / 8, 1);
+	scan.stack_size = 256;
+	scan.stack = malloc(scan.stack_size * sizeof(int));
+	int found = 0;
+	switch (raw_type) {
+		case INDIGO_RAW_MONO8:
+			FIND_STARS_SCAN(uint8_t, 1);
+			break;
+		case INDIGO_RAW_MONO16:
+			FIND_STARS_SCAN(uint16_t, 1);
+			break;
+		case INDIGO_RAW_RGB24:
+			FIND_STARS_SCAN(uint8_t, 3);
+			break;
+		case INDIGO_RAW_RGB48:
+			FIND_STARS_SCAN(uint16_t, 3);
+			break;
+	}
+	free(scan.visited);
+	free(scan.stack);
+	*stars_found = found;
+	//INDIGO_DEBUG(indigo_debug("indigo_find_stars: %d stars, background sigma = %g", found, bg.sigma));
+	return INDIGO_OK;
+}
+
+indigo_result indigo_multistar_frame_digest(indigo_raw_type raw_type, const void *data, const int width, const int height, const int max_stars, indigo_frame_digest *c) {
+	if (c == NULL)
+		return INDIGO_FAILED;
+	int count = max_stars < INDIGO_MAX_GUIDE_STARS ? max_stars : INDIGO_MAX_GUIDE_STARS;
+	indigo_star_detection stars[INDIGO_MAX_GUIDE_STARS];
+	int found = 0;
+	if (indigo_find_stars(raw_type, data, width, height, count, stars, &found) != INDIGO_OK || found == 0)
+		return INDIGO_FAILED;
+	c->width = width;
+	c->height = height;
+	c->stars = malloc(found * sizeof(indigo_star_detection));
+	memcpy(c->stars, stars, found * sizeof(indigo_star_detection));
+	c->star_count = found;
+	double snr2 = 0;
+	for (int i = 0; i < found; i++)
+		snr2 += stars[i].snr * stars[i].snr;
+	c->snr = sqrt(snr2);
+	c->algorithm = multistar;
+	return INDIGO_OK;
+}
+
+/* Offset supported by the most reference stars is found by voting over all star pairs, drift is then averaged over matching stars with inverse variance (S/N squared) weights */
+
+static indigo_result multistar_drift(const indigo_frame_digest *ref, const indigo_frame_digest *new, double *drift_x, double *drift_y) {
+	const double tolerance2 = STAR_MATCH_TOLERANCE * STAR_MATCH_TOLERANCE;
+	int best_votes = 0;
+	double best_dx = 0, best_dy = 0;
+	for (int i = 0; i < ref->star_count; i++) {
+		for (int j = 0; j < new->star_count; j++) {
+			double dx = new->stars[j].x - ref->stars[i].x;
+			double dy = new->stars[j].y - ref->stars[i].y;
+			int votes = 0;
+			for (int k = 0; k < ref->star_count; k++) {
+				double x = ref->stars[k].x + dx, y = ref->stars[k].y + dy;
+				for (int l = 0; l < new->star_count; l++) {
+					double ex = new->stars[l].x - x, ey = new->stars[l].y - y;
+					if (ex * ex + ey * ey < tolerance2) {
+						votes++;
+						break;
+					}
+				}
+			}
+			if (votes > best_votes) {
+				best_votes = votes;
+				best_dx = dx;
+				best_dy = dy;
+			}
+		}
+	}
+	if (best_votes == 0)
+		return INDIGO_FAILED;
+	double sum_w = 0, sum_x = 0, sum_y = 0;
+	for (int k = 0; k < ref->star_count; k++) {
+		const indigo_star_detection *r = ref->stars + k;
+		double x = r->x + best_dx, y = r->y + best_dy;
+		const indigo_star_detection *match = NULL;
+		double match_d2 = tolerance2;
+		for (int l = 0; l < new->star_count; l++) {
+			double ex = new->stars[l].x - x, ey = new->stars[l].y - y;
+			double d2 = ex * ex + ey * ey;
+			if (d2 < match_d2) {
+				match_d2 = d2;
+				match = new->stars + l;
+			}
+		}
+		if (match == NULL)
+			continue;
+		double w = 1 / (1 / (r->snr * r->snr) + 1 / (match->snr * match->snr));
+		sum_w += w;
+		sum_x += w * (match->x - r->x);
+		sum_y += w * (match->y - r->y);
+	}
+	*drift_x = sum_x / sum_w;
+	*drift_y = -sum_y / sum_w;
 	return INDIGO_OK;
 }
 
@@ -512,17 +1185,21 @@ indigo_result indigo_calculate_drift(const indigo_frame_digest *ref, const indig
 		*drift_y = ref->centroid_y - new->centroid_y;
 		return INDIGO_OK;
 	}
+	if (ref->algorithm == multistar && new->algorithm == multistar) {
+		return multistar_drift(ref, new, drift_x, drift_y);
+	}
 	if (ref->algorithm == donuts) {
-		double (*c_buf)[2];
-		int max_dim = (ref->width > ref->height) ? ref->width : ref->height;
-		c_buf = malloc(2 * max_dim * sizeof(double));
+		fft_plan *plan_x = fft_get_plan(ref->width);
+		fft_plan *plan_y = fft_get_plan(ref->height);
+		int max_m = (plan_x->m > plan_y->m) ? plan_x->m : plan_y->m;
+		double (*work)[2] = digest_get_scratch(2 * max_m + 1);
+		double *c_buf = (double *)work;
 		/* find X correction */
-		corellate_fft(ref->width, ref->fft_x, new->fft_x, c_buf);
+		corellate_fft(plan_x, (const double (*)[2])ref->fft_x, (const double (*)[2])new->fft_x, c_buf, work);
 		*drift_x = -find_distance(ref->width, c_buf);
 		/* find Y correction */
-		corellate_fft(ref->height, ref->fft_y, new->fft_y, c_buf);
+		corellate_fft(plan_y, (const double (*)[2])ref->fft_y, (const double (*)[2])new->fft_y, c_buf, work);
 		*drift_y = find_distance(ref->height, c_buf);
-		free(c_buf);
 		return INDIGO_OK;
 	}
 	return INDIGO_FAILED;
@@ -535,6 +1212,9 @@ indigo_result indigo_delete_frame_digest(indigo_frame_digest *fdigest) {
 				free(fdigest->fft_x);
 			if (fdigest->fft_y)
 				free(fdigest->fft_y);
+		} else if (fdigest->algorithm == multistar) {
+			if (fdigest->stars)
+				free(fdigest->stars);
 		}
 		fdigest->width = 0;
 		fdigest->height = 0;
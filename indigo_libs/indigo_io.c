@@ -31,14 +31,17 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <assert.h>
 #include <sys/types.h>
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
 #include <unistd.h>
+#include <poll.h>
 #include <termios.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #endif
 
 #if defined(INDIGO_WINDOWS)
@@ -300,7 +303,136 @@ int indigo_open_udp(const char *host, int port) {
 	return sock;
 }
 
+#define READ_BUFFER_SIZE	4096
+#define MAX_BUFFERED_HANDLES	1024
+
+typedef struct {
+	long timeout;
+	int pointer;
+	int length;
+	char data[READ_BUFFER_SIZE];
+} read_buffer;
+
+static read_buffer *read_buffers[MAX_BUFFERED_HANDLES];
+static pthread_mutex_t read_buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline read_buffer *get_read_buffer(int handle) {
+	return handle >= 0 && handle < MAX_BUFFERED_HANDLES ? read_buffers[handle] : NULL;
+}
+
+static long read_with_timeout(int handle, char *buffer, long length, long timeout) {
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+	if (timeout > 0) {
+		struct pollfd fds = { handle, POLLIN, 0 };
+		int result = poll(&fds, 1, (int)((timeout + 999) / 1000));
+		if (result == 0)
+			errno = ETIMEDOUT;
+		if (result <= 0)
+			return -1;
+	}
+#endif
+	while (true) {
+#if defined(INDIGO_WINDOWS)
+		long bytes_read = recv(handle, buffer, length, 0);
+		if (bytes_read == -1 && WSAGetLastError() == WSAETIMEDOUT) {
+			Sleep(500);
+			continue;
+		}
+#else
+		long bytes_read = read(handle, buffer, length);
+#endif
+		return bytes_read;
+	}
+}
+
+static long fill_read_buffer(int handle, read_buffer *buffer) {
+	long bytes_read = read_with_timeout(handle, buffer->data, READ_BUFFER_SIZE, buffer->timeout);
+	buffer->pointer = 0;
+	buffer->length = bytes_read > 0 ? (int)bytes_read : 0;
+	return bytes_read;
+}
+
+bool indigo_enable_read_buffer(int handle, long timeout) {
+	if (handle < 0 || handle >= MAX_BUFFERED_HANDLES)
+		return false;
+	pthread_mutex_lock(&read_buffers_mutex);
+	read_buffer *buffer = read_buffers[handle];
+	if (buffer == NULL) {
+		buffer = read_buffers[handle] = malloc(sizeof(read_buffer));
+		assert(buffer != NULL);
+		buffer->pointer = buffer->length = 0;
+	}
+	buffer->timeout = timeout;
+	pthread_mutex_unlock(&read_buffers_mutex);
+	return true;
+}
+
+void indigo_disable_read_buffer(int handle) {
+	if (handle < 0 || handle >= MAX_BUFFERED_HANDLES)
+		return;
+	pthread_mutex_lock(&read_buffers_mutex);
+	read_buffer *buffer = read_buffers[handle];
+	read_buffers[handle] = NULL;
+	pthread_mutex_unlock(&read_buffers_mutex);
+	if (buffer)
+		free(buffer);
+}
+
+void indigo_discard_read_buffer(int handle) {
+	read_buffer *buffer = get_read_buffer(handle);
+	if (buffer)
+		buffer->pointer = buffer->length = 0;
+}
+
+int indigo_peek(int handle, char *c) {
+	read_buffer *buffer = get_read_buffer(handle);
+	if (buffer == NULL) {
+		// no read-ahead buffer (e.g. handle above MAX_BUFFERED_HANDLES), socket can still be peeked unbuffered
+		while (true) {
+			long bytes_read = recv(handle, c, 1, MSG_PEEK);
+			if (bytes_read < 0 && errno == EINTR)
+				continue;
+			return (int)bytes_read;
+		}
+	}
+	if (buffer->pointer == buffer->length) {
+		long bytes_read = fill_read_buffer(handle, buffer);
+		if (bytes_read <= 0)
+			return (int)bytes_read;
+	}
+	*c = buffer->data[buffer->pointer];
+	return 1;
+}
+
 int indigo_read(int handle, char *buffer, long length) {
+	read_buffer *ahead = get_read_buffer(handle);
+	if (ahead) {
+		long total_bytes = 0;
+		while (total_bytes < length) {
+			long remains = length - total_bytes;
+			if (ahead->pointer == ahead->length) {
+				long bytes_read;
+				if (remains >= READ_BUFFER_SIZE) {
+					// large reads go directly to the caller's buffer
+					bytes_read = read_with_timeout(handle, buffer + total_bytes, remains, ahead->timeout);
+					if (bytes_read <= 0)
+						return (int)bytes_read;
+					total_bytes += bytes_read;
+					continue;
+				}
+				bytes_read = fill_read_buffer(handle, ahead);
+				if (bytes_read <= 0)
+					return (int)bytes_read;
+			}
+			long count = ahead->length - ahead->pointer;
+			if (count > remains)
+				count = remains;
+			memcpy(buffer + total_bytes, ahead->data + ahead->pointer, count);
+			ahead->pointer += count;
+			total_bytes += count;
+		}
+		return (int)total_bytes;
+	}
 	long remains = length;
 	long total_bytes = 0;
 	while (true) {
@@ -325,19 +457,29 @@ int indigo_read(int handle, char *buffer, long length) {
 	}
 }
 
-#if defined(INDIGO_WINDOWS)
 int indigo_recv(int handle, char *buffer, long length) {
-	while (true) {
-		long bytes_read = recv(handle, buffer, length, 0);
-		if (bytes_read == -1 && WSAGetLastError() == WSAETIMEDOUT) {
-			Sleep(500);
-			continue;
+	read_buffer *ahead = get_read_buffer(handle);
+	if (ahead) {
+		if (ahead->pointer == ahead->length) {
+			if (length >= READ_BUFFER_SIZE)
+				return (int)read_with_timeout(handle, buffer, length, ahead->timeout);
+			long bytes_read = fill_read_buffer(handle, ahead);
+			if (bytes_read <= 0)
+				return (int)bytes_read;
 		}
-		return (int)bytes_read;
+		long count = ahead->length - ahead->pointer;
+		if (count > length)
+			count = length;
+		memcpy(buffer, ahead->data + ahead->pointer, count);
+		ahead->pointer += count;
+		return (int)count;
 	}
+	return (int)read_with_timeout(handle, buffer, length, 0);
 }
 
+#if defined(INDIGO_WINDOWS)
 int indigo_close(int handle) {
+	indigo_disable_read_buffer(handle);
 	return closesocket(handle);
 }
 #endif
@@ -345,6 +487,34 @@ int indigo_close(int handle) {
 int indigo_read_line(int handle, char *buffer, int length) {
 	char c = '\0';
 	long total_bytes = 0;
+	read_buffer *ahead = get_read_buffer(handle);
+	if (ahead) {
+		while (total_bytes < length) {
+			if (ahead->pointer == ahead->length && fill_read_buffer(handle, ahead) <= 0) {
+				if (errno != ETIMEDOUT)
+					errno = ECONNRESET;
+				INDIGO_TRACE_PROTOCOL(indigo_trace("%d → ERROR", handle));
+				return -1;
+			}
+			char *data = ahead->data + ahead->pointer;
+			char *end = ahead->data + ahead->length;
+			while (data < end && total_bytes < length) {
+				c = *data++;
+				if (c == '\r')
+					;
+				else if (c != '\n')
+					buffer[total_bytes++] = c;
+				else
+					break;
+			}
+			ahead->pointer = (int)(data - ahead->data);
+			if (c == '\n')
+				break;
+		}
+		buffer[total_bytes] = '\0';
+		INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", handle, buffer));
+		return (int)total_bytes;
+	}
 	while (total_bytes < length) {
 #if defined(INDIGO_WINDOWS)
 		long bytes_read = recv(handle, &c, 1, 0);
@@ -401,6 +571,126 @@ bool indigo_printf(int handle, const char *format, ...) {
 	return indigo_write(handle, buffer, length);
 }
 
+#define OUTPUT_BUFFER_SIZE		4096
+#define OUTPUT_BUFFER_LIMIT		65536
+#define OUTPUT_DIRECT_SIZE		16384
+
+struct indigo_output_buffer {
+	int handle;
+	char *data;
+	long length;
+	long size;
+};
+
+indigo_output_buffer *indigo_output_create(int handle) {
+	indigo_output_buffer *buffer = malloc(sizeof(indigo_output_buffer));
+	assert(buffer != NULL);
+	buffer->handle = handle;
+	buffer->data = malloc(OUTPUT_BUFFER_SIZE);
+	assert(buffer->data != NULL);
+	buffer->length = 0;
+	buffer->size = OUTPUT_BUFFER_SIZE;
+	return buffer;
+}
+
+static bool output_send(indigo_output_buffer *buffer, const char *data, long length) {
+	bool result = true;
+#if defined(INDIGO_WINDOWS)
+	if (buffer->length)
+		result = indigo_write(buffer->handle, buffer->data, buffer->length);
+	if (result && length)
+		result = indigo_write(buffer->handle, data, length);
+#else
+	struct iovec parts[2] = { { buffer->data, buffer->length }, { (void *)data, length } };
+	struct iovec *part = parts;
+	int count = length ? 2 : 1;
+	if (buffer->length == 0) {
+		part++;
+		count--;
+	}
+	while (count > 0) {
+		long bytes_written = writev(buffer->handle, part, count);
+		if (bytes_written < 0) {
+			if (errno == EINTR)
+				continue;
+			result = false;
+			break;
+		}
+		while (count > 0 && bytes_written >= (long)part->iov_len) {
+			bytes_written -= part->iov_len;
+			part++;
+			count--;
+		}
+		if (count > 0) {
+			part->iov_base = (char *)part->iov_base + bytes_written;
+			part->iov_len -= bytes_written;
+		}
+	}
+#endif
+	buffer->length = 0;
+	return result;
+}
+
+static bool output_reserve(indigo_output_buffer *buffer, long length) {
+	if (buffer->length + length <= buffer->size)
+		return true;
+	long size = buffer->size;
+	while (size < buffer->length + length)
+		size *= 2;
+	char *data = realloc(buffer->data, size);
+	if (data == NULL)
+		return false;
+	buffer->data = data;
+	buffer->size = size;
+	return true;
+}
+
+bool indigo_output_write(indigo_output_buffer *buffer, const char *data, long length) {
+	if (length >= OUTPUT_DIRECT_SIZE)
+		return output_send(buffer, data, length);
+	if (buffer->length + length > OUTPUT_BUFFER_LIMIT && !output_send(buffer, NULL, 0))
+		return false;
+	if (!output_reserve(buffer, length))
+		return false;
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+	return true;
+}
+
+bool indigo_output_printf(indigo_output_buffer *buffer, const char *format, ...) {
+	if (buffer->length > OUTPUT_BUFFER_LIMIT && !output_send(buffer, NULL, 0))
+		return false;
+	va_list args;
+	va_start(args, format);
+	long length = vsnprintf(buffer->data + buffer->length, buffer->size - buffer->length, format, args);
+	va_end(args);
+	if (length < 0)
+		return false;
+	if (buffer->length + length >= buffer->size) {
+		if (!output_reserve(buffer, length + 1))
+			return false;
+		va_start(args, format);
+		vsnprintf(buffer->data + buffer->length, buffer->size - buffer->length, format, args);
+		va_end(args);
+	}
+	INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %s", buffer->handle, buffer->data + buffer->length));
+	buffer->length += length;
+	return true;
+}
+
+bool indigo_output_flush(indigo_output_buffer *buffer) {
+	if (buffer->length == 0)
+		return true;
+	return output_send(buffer, NULL, 0);
+}
+
+void indigo_output_release(indigo_output_buffer *buffer) {
+	if (buffer) {
+		free(buffer->data);
+		free(buffer);
+	}
+}
+
 int indigo_scanf(int handle, const char *format, ...) {
 	char buffer[1024];
 	if (indigo_read_line(handle, buffer, sizeof(buffer)) <= 0)
@@ -119,6 +119,8 @@ static void *get_properties_handler(parser_state state, char *name, char *value,
 	INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: %s %s '%s' '%s'", __FUNCTION__, parser_state_name[state], name != NULL ? name : "", value != NULL ? value : ""));
 	if (state == NUMBER_VALUE && !strcmp(name, "version")) {
 		client->version = (int)atol(value);
+	} else if (state == LOGICAL_VALUE && !strcmp(name, "partial")) {
+		((indigo_adapter_context *)client->client_context)->partial_updates = !strcmp(value, "true");
 	} else if (state == END_STRUCT) {
 		indigo_enumerate_properties(client, property);
 		return top_level_handler;
@@ -126,6 +128,23 @@ static void *get_properties_handler(parser_state state, char *name, char *value,
 	return get_properties_handler;
 }
 
+static void *update_interval_handler(parser_state state, char *name, char *value, indigo_property *property, indigo_device *device, indigo_client *client, char *message) {
+	INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: %s %s '%s' '%s'", __FUNCTION__, parser_state_name[state], name != NULL ? name : "", value != NULL ? value : ""));
+	if (state == TEXT_VALUE) {
+		if (!strcmp(name, "device")) {
+			strncpy(property->device, value, INDIGO_NAME_SIZE);
+		} else if (!strcmp(name, "name")) {
+			strncpy(property->name, value, INDIGO_NAME_SIZE);
+		}
+	} else if (state == NUMBER_VALUE && !strcmp(name, "interval")) {
+		property->items[0].number.value = indigo_atod(value);
+	} else if (state == END_STRUCT) {
+		indigo_set_update_interval(client, property->device, property->name, property->items[0].number.value);
+		return top_level_handler;
+	}
+	return update_interval_handler;
+}
+
 static void *one_text_handler(parser_state state, char *name, char *value, indigo_property *property, indigo_device *device, indigo_client *client, char *message) {
 	INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: %s %s '%s' '%s'", __FUNCTION__, parser_state_name[state], name != NULL ? name : "", value != NULL ? value : ""));
 	if (state == END_ARRAY)
@@ -235,6 +254,8 @@ static void *top_level_handler(parser_state state, char *name, char *value, indi
 		if (name != NULL) {
 			if (!strcmp(name, "getProperties"))
 				return get_properties_handler;
+			if (!strcmp(name, "updateInterval"))
+				return update_interval_handler;
 			if (!strcmp(name, "newTextVector")) {
 				property->type = INDIGO_TEXT_VECTOR;
 				property->version = client->version;
@@ -255,164 +276,167 @@ static void *top_level_handler(parser_state state, char *name, char *value, indi
 	return top_level_handler;
 }
 
-void indigo_json_parse(indigo_device *device, indigo_client *client) {
-	indigo_adapter_context *context = (indigo_adapter_context*)client->client_context;
-	int handle = context->input;
-	char buffer[JSON_BUFFER_SIZE];
-	char *pointer = buffer;
-	char *buffer_end = NULL;
+struct indigo_json_parser {
+	indigo_device *device;
+	indigo_client *client;
+	parser_handler handler;
+	parser_state state;
+	int depth;
+	char q;
+	char *name_pointer;
+	char *value_pointer;
+	indigo_property *property;
 	char property_buffer[PROPERTY_SIZE];
 	char message[INDIGO_VALUE_SIZE];
 	char name_buffer[INDIGO_NAME_SIZE];
-	char *name_pointer = name_buffer;
 	char value_buffer[INDIGO_VALUE_SIZE];
-	char *value_pointer = value_buffer;
-	*pointer = 0;
-	char c = 0;
-	char q = '"';
-	int depth = 0;
-	parser_handler handler = top_level_handler;
-	parser_state state = IDLE;
-	indigo_property *property = (indigo_property *)property_buffer;
-	memset(property_buffer, 0, PROPERTY_SIZE);
+};
 
-	while (true) {
-		assert(pointer - buffer <= JSON_BUFFER_SIZE);
-		assert(name_pointer - name_buffer <= INDIGO_NAME_SIZE);
-		if (state == ERROR) {
+indigo_json_parser *indigo_json_parser_create(indigo_device *device, indigo_client *client) {
+	indigo_json_parser *parser = malloc(sizeof(indigo_json_parser));
+	assert(parser != NULL);
+	memset(parser, 0, sizeof(indigo_json_parser));
+	parser->device = device;
+	parser->client = client;
+	parser->handler = top_level_handler;
+	parser->state = IDLE;
+	parser->q = '"';
+	parser->name_pointer = parser->name_buffer;
+	parser->value_pointer = parser->value_buffer;
+	parser->property = (indigo_property *)parser->property_buffer;
+	return parser;
+}
+
+bool indigo_json_parser_feed(indigo_json_parser *parser, char *data, long length) {
+	char *pointer = data;
+	char *buffer_end = data + length;
+	char c;
+	while (pointer < buffer_end && (c = *pointer++) != 0) {
+		assert(parser->name_pointer - parser->name_buffer <= INDIGO_NAME_SIZE);
+		if (parser->state == ERROR) {
 			indigo_error("JSON Parser: syntax error");
-			goto exit_loop;
-		}
-		while ((c = *pointer++) == 0) {
-			ssize_t count = (int)context->web_socket ? ws_read(handle, buffer, JSON_BUFFER_SIZE) : indigo_read_line(handle, buffer, JSON_BUFFER_SIZE);
-			if (count <= 0) {
-				goto exit_loop;
-			}
-			pointer = buffer;
-			buffer_end = buffer + count;
-			buffer[count] = 0;
-			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", handle, buffer));
+			return false;
 		}
-		switch (state) {
+		switch (parser->state) {
 			case ERROR:
-				goto exit_loop;
+				return false;
 			case IDLE:
 				if (isspace(c)) {
 				} else if (c == '{') {
-					name_pointer = name_buffer;
-					*name_pointer = 0;
-					value_pointer = value_buffer;
-					*value_pointer = 0;
-					state = BEGIN_STRUCT;
+					parser->name_pointer = parser->name_buffer;
+					*parser->name_pointer = 0;
+					parser->value_pointer = parser->value_buffer;
+					*parser->value_pointer = 0;
+					parser->state = BEGIN_STRUCT;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' IDLE -> BEGIN_STRUCT", c));
-					depth++;
-					handler = handler(BEGIN_STRUCT, NULL, NULL, property, device, client, message);
+					parser->depth++;
+					parser->handler = parser->handler(BEGIN_STRUCT, NULL, NULL, parser->property, parser->device, parser->client, parser->message);
 				}
 				break;
 			case BEGIN_STRUCT:
 				if (isspace(c)) {
 				} else if (c == '"' || c == '\'') {
-					q = c;
-					state = NAME;
-					name_pointer = name_buffer;
+					parser->q = c;
+					parser->state = NAME;
+					parser->name_pointer = parser->name_buffer;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' BEGIN_STRUCT -> NAME", c));
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' BEGIN_STRUCT -> ERROR", c));
 				}
 				break;
 			case BEGIN_ARRAY:
 				if (isspace(c)) {
 				} else if (c == '{') {
-					state = BEGIN_STRUCT;
+					parser->state = BEGIN_STRUCT;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' BEGIN_ARRAY -> BEGIN_STRUCT", c));
-					depth++;
-					handler = handler(BEGIN_STRUCT, NULL, NULL, property, device, client, message);
+					parser->depth++;
+					parser->handler = parser->handler(BEGIN_STRUCT, NULL, NULL, parser->property, parser->device, parser->client, parser->message);
 				}
 				break;
 			case NAME:
-				if (c == q) {
-					state = NAME1;
-					*name_pointer = 0;
+				if (c == parser->q) {
+					parser->state = NAME1;
+					*parser->name_pointer = 0;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME -> NAME1", c));
-				} else if (name_pointer - name_buffer <INDIGO_NAME_SIZE) {
-					*name_pointer++ = c;
+				} else if (parser->name_pointer - parser->name_buffer <INDIGO_NAME_SIZE) {
+					*parser->name_pointer++ = c;
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME -> ERROR", c));
 				}
 				break;
 			case NAME1:
 				if (isspace(c)) {
 				} else if (c == ':') {
-					state = NAME2;
+					parser->state = NAME2;
 				}
 				break;
 			case NAME2:
 				if (isspace(c)) {
 				} else if (c == '{') {
-					state = BEGIN_STRUCT;
+					parser->state = BEGIN_STRUCT;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> BEGIN_STRUCT", c));
-					handler = handler(BEGIN_STRUCT, name_buffer, NULL, property, device, client, message);
-					depth++;
+					parser->handler = parser->handler(BEGIN_STRUCT, parser->name_buffer, NULL, parser->property, parser->device, parser->client, parser->message);
+					parser->depth++;
 				} else if (c == '[') {
-					state = BEGIN_ARRAY;
+					parser->state = BEGIN_ARRAY;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> BEGIN_ARRAY", c));
-					handler = handler(BEGIN_ARRAY, name_buffer, NULL, property, device, client, message);
+					parser->handler = parser->handler(BEGIN_ARRAY, parser->name_buffer, NULL, parser->property, parser->device, parser->client, parser->message);
 				} else if (c == '"' || c == '\'') {
-					q = c;
-					state = TEXT_VALUE;
-					value_pointer = value_buffer;
+					parser->q = c;
+					parser->state = TEXT_VALUE;
+					parser->value_pointer = parser->value_buffer;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> TEXT_VALUE", c));
 				} else if (isdigit(c) || c == '-') {
-					state = NUMBER_VALUE;
-					value_pointer = value_buffer;
-					*value_pointer++ = c;
+					parser->state = NUMBER_VALUE;
+					parser->value_pointer = parser->value_buffer;
+					*parser->value_pointer++ = c;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> NUMBER_VALUE", c));
 				} else if (isalpha(c)) {
-					state = LOGICAL_VALUE;
-					value_pointer = value_buffer;
-					*value_pointer++ = c;
+					parser->state = LOGICAL_VALUE;
+					parser->value_pointer = parser->value_buffer;
+					*parser->value_pointer++ = c;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> LOGICAL_VALUE", c));
 				}
 				break;
 			case TEXT_VALUE:
-				if (c == q) {
-					state = VALUE1;
+				if (c == parser->q) {
+					parser->state = VALUE1;
 					pointer--;
-					*value_pointer = 0;
-					handler = handler(TEXT_VALUE, name_buffer, value_buffer, property, device, client, message);
+					*parser->value_pointer = 0;
+					parser->handler = parser->handler(TEXT_VALUE, parser->name_buffer, parser->value_buffer, parser->property, parser->device, parser->client, parser->message);
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' TEXT_VALUE -> VALUE1", c));
-				} else if (value_pointer - value_buffer <INDIGO_VALUE_SIZE) {
-					*value_pointer++ = c;
+				} else if (parser->value_pointer - parser->value_buffer <INDIGO_VALUE_SIZE) {
+					*parser->value_pointer++ = c;
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' TEXT_VALUE -> ERROR", c));
 				}
 				break;
 			case NUMBER_VALUE:
-				if ((isdigit(c) || c == '.') && value_pointer - value_buffer <INDIGO_VALUE_SIZE) {
-					*value_pointer++ = c;
+				if ((isdigit(c) || c == '.') && parser->value_pointer - parser->value_buffer <INDIGO_VALUE_SIZE) {
+					*parser->value_pointer++ = c;
 				} else {
-					state = VALUE1;
+					parser->state = VALUE1;
 					pointer--;
-					*value_pointer = 0;
-					handler = handler(NUMBER_VALUE, name_buffer, value_buffer, property, device, client, message);
+					*parser->value_pointer = 0;
+					parser->handler = parser->handler(NUMBER_VALUE, parser->name_buffer, parser->value_buffer, parser->property, parser->device, parser->client, parser->message);
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NUMBER_VALUE -> VALUE1", c));
 				}
 				break;
 			case LOGICAL_VALUE:
-				if ((isalpha(c)) && value_pointer - value_buffer <INDIGO_VALUE_SIZE) {
-					*value_pointer++ = c;
+				if ((isalpha(c)) && parser->value_pointer - parser->value_buffer <INDIGO_VALUE_SIZE) {
+					*parser->value_pointer++ = c;
 				} else {
-					*value_pointer = 0;
-					if (!strcmp(value_buffer, "true") || !strcmp(value_buffer, "false")) {
-						handler = handler(LOGICAL_VALUE, name_buffer, value_buffer, property, device, client, message);
-						state = VALUE1;
+					*parser->value_pointer = 0;
+					if (!strcmp(parser->value_buffer, "true") || !strcmp(parser->value_buffer, "false")) {
+						parser->handler = parser->handler(LOGICAL_VALUE, parser->name_buffer, parser->value_buffer, parser->property, parser->device, parser->client, parser->message);
+						parser->state = VALUE1;
 						pointer--;
 						INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' LOGICAL_VALUE -> VALUE1", c));
 					} else {
-						state = ERROR;
+						parser->state = ERROR;
 						INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' LOGICAL_VALUE -> ERROR", c));
 					}
 				}
@@ -420,20 +444,20 @@ void indigo_json_parse(indigo_device *device, indigo_client *client) {
 			case VALUE1:
 				if (isspace(c)) {
 				} else if (c == ',') {
-					state = VALUE2;
+					parser->state = VALUE2;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' VALUE1 -> VALUE2", c));
 				} else if (c == '}') {
-					handler = handler(END_STRUCT, NULL, NULL, property, device, client, message);
-					depth--;
-					if (depth == 0) {
-						state = IDLE;
+					parser->handler = parser->handler(END_STRUCT, NULL, NULL, parser->property, parser->device, parser->client, parser->message);
+					parser->depth--;
+					if (parser->depth == 0) {
+						parser->state = IDLE;
 						INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' VALUE2 -> IDLE", c));
 					}
 				} else if (c == ']') {
-					handler = handler(END_ARRAY, NULL, NULL, property, device, client, message);
-					depth--;
-					if (depth == 0) {
-						state = IDLE;
+					parser->handler = parser->handler(END_ARRAY, NULL, NULL, parser->property, parser->device, parser->client, parser->message);
+					parser->depth--;
+					if (parser->depth == 0) {
+						parser->state = IDLE;
 						INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' VALUE2 -> IDLE", c));
 					}
 				}
@@ -441,17 +465,17 @@ void indigo_json_parse(indigo_device *device, indigo_client *client) {
 			case VALUE2:
 				if (isspace(c)) {
 				} else if (c == '"' || c == '\'') {
-					q = c;
-					state = NAME;
-					name_pointer = name_buffer;
+					parser->q = c;
+					parser->state = NAME;
+					parser->name_pointer = parser->name_buffer;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' VALUE2 -> NAME", c));
 				} else if (c == '{') {
-					state = BEGIN_STRUCT;
+					parser->state = BEGIN_STRUCT;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' NAME2 -> BEGIN_STRUCT", c));
-					handler = handler(BEGIN_STRUCT, NULL, NULL, property, device, client, message);
-					depth++;
+					parser->handler = parser->handler(BEGIN_STRUCT, NULL, NULL, parser->property, parser->device, parser->client, parser->message);
+					parser->depth++;
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("JSON Parser: '%c' VALUE2 -> ERROR", c));
 				}
 				break;
@@ -460,7 +484,35 @@ void indigo_json_parse(indigo_device *device, indigo_client *client) {
 				break;
 		}
 	}
-exit_loop:
+	if (parser->state == ERROR) {
+		indigo_error("JSON Parser: syntax error");
+		return false;
+	}
+	return true;
+}
+
+void indigo_json_parser_release(indigo_json_parser *parser) {
+	free(parser);
+}
+
+void indigo_json_parse(indigo_device *device, indigo_client *client) {
+	indigo_adapter_context *context = (indigo_adapter_context*)client->client_context;
+	int handle = context->input;
+	char *buffer = malloc(JSON_BUFFER_SIZE + 1);
+	assert(buffer != NULL);
+	indigo_json_parser *parser = indigo_json_parser_create(device, client);
+	while (true) {
+		ssize_t count = (int)context->web_socket ? ws_read(handle, buffer, JSON_BUFFER_SIZE) : indigo_read_line(handle, buffer, JSON_BUFFER_SIZE);
+		if (count <= 0)
+			break;
+		buffer[count] = 0;
+		INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", handle, buffer));
+		if (!indigo_json_parser_feed(parser, buffer, count))
+			break;
+	}
+	indigo_json_parser_release(parser);
+	free(buffer);
+	indigo_disable_read_buffer(handle);
 	close(handle);
 	indigo_log("JSON Parser: parser finished");
 }
@@ -24,6 +24,8 @@
  */
 
 //#include <time.h>
+#include <pthread.h>
+#include <float.h>
 #include <novas.h>
 #include <eph_manager.h>
 
@@ -34,12 +36,37 @@
 double DELTA_T = 34+32.184+0.477677;
 double DELTA_UTC_UT1 = -0.477677/86400.0;
 
+// NOVAS keeps state in static variables (nutation cache, open ephemeris file), so calls have to be serialized
+
+static pthread_mutex_t novas_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static object earth_object, sun_object;
+
+// NOVAS declares names as char[SIZE_OF_OBJ_NAME] and char[SIZE_OF_CAT_NAME] and reads whole arrays, so literals are copied to buffers of that size first
+
+static void make_star(const char *name, const char *catalog, long number, double ra, double dec, double promora, double promodec, double parallax, double rv, cat_entry *star) {
+	char star_name[SIZE_OF_OBJ_NAME] = { 0 }, catalog_name[SIZE_OF_CAT_NAME] = { 0 };
+	snprintf(star_name, SIZE_OF_OBJ_NAME, "%s", name);
+	snprintf(catalog_name, SIZE_OF_CAT_NAME, "%s", catalog);
+	make_cat_entry(star_name, catalog_name, number, ra, dec, promora, promodec, parallax, rv, star);
+}
+
+static void make_body(short number, const char *name, object *body) {
+	char body_name[SIZE_OF_OBJ_NAME] = { 0 };
+	cat_entry dummy_star;
+	snprintf(body_name, SIZE_OF_OBJ_NAME, "%s", name);
+	make_star("DUMMY", "   ", 0, 0, 0, 0, 0, 0, 0, &dummy_star);
+	make_object(0, number, body_name, &dummy_star, body);
+}
+
 static void init() {
 	static int do_init = 1;
 	if (do_init) {
 		double jd_begin, jd_end;
 		short de_number;
 		ephem_open("JPLEPH.421", &jd_begin, &jd_end, &de_number);
+		make_body(3, "Earth", &earth_object);
+		make_body(10, "Sun", &sun_object);
 		do_init = 0;
 	}
 }
@@ -52,7 +79,9 @@ double indigo_lst(time_t *utc, double longitude) {
 		ut1 = UT2JD(time(NULL));
 
 	double gst;
+	pthread_mutex_lock(&novas_mutex);
 	int error = sidereal_time(ut1, 0.0, DELTA_T, 0, 0, 0, &gst);
+	pthread_mutex_unlock(&novas_mutex);
 	if (error != 0) {
 		indigo_error("sidereal_time() -> %d", error);
 		return 0;
@@ -68,7 +97,9 @@ void indigo_eq2hor(time_t *utc, double latitude, double longitude, double elevat
 		ut1 = UT2JD(time(NULL));
 
 	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
+	pthread_mutex_lock(&novas_mutex);
 	equ2hor(ut1, DELTA_T, 1, 0.0, 0.0, &position, ra, dec, 0, alt, az, &ra, &dec);
+	pthread_mutex_unlock(&novas_mutex);
 	*alt = 90 - *alt;
 }
 
@@ -76,36 +107,171 @@ void indigo_app_star(double promora, double promodec, double parallax, double rv
 	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
 	double tt_now = ut1_now + DELTA_T / 86400.0;
 	cat_entry star;
+	pthread_mutex_lock(&novas_mutex);
 	init();
-	make_cat_entry("HIP 1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
+	make_star("HIP 1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
 	int error = app_star(tt_now, &star, 1, ra, dec);
+	pthread_mutex_unlock(&novas_mutex);
 	if (error != 0) {
 		indigo_error("app_star() -> %d", error);
 	}
 }
 
+#define APP_STAR_CHUNK	256
+
+// low precision geocentric position of Sun in mean equator and equinox of date (Astronomical Almanac, 0.01 deg)
+
+static void sun_position(double jd, double *pos) {
+	double n = jd - T0;
+	double l = (280.460 + 0.9856474 * n) * DEG2RAD;
+	double g = (357.528 + 0.9856003 * n) * DEG2RAD;
+	double lambda = l + (1.915 * sin(g) + 0.020 * sin(2 * g)) * DEG2RAD;
+	double r = 1.00014 - 0.01671 * cos(g) - 0.00014 * cos(2 * g);
+	double epsilon = (23.439 - 0.0000004 * n) * DEG2RAD;
+	pos[0] = r * cos(lambda);
+	pos[1] = r * cos(epsilon) * sin(lambda);
+	pos[2] = r * sin(epsilon) * sin(lambda);
+}
+
+void indigo_app_star_epoch_init(time_t *utc, indigo_app_star_epoch *epoch) {
+	double ut1 = utc ? UT2JD(*utc) : UT2JD(time(NULL));
+	double jd_tt = ut1 + DELTA_T / 86400.0, x, secdif;
+	tdb2tt(jd_tt, &x, &secdif);
+	epoch->jd_tdb = jd_tt + secdif / 86400.0;
+	double jd[2] = { epoch->jd_tdb, 0 }, vel[3];
+	double bias_precession[3][3];
+	pthread_mutex_lock(&novas_mutex);
+	init();
+	// matrices are linear, so they are obtained by transforming basis vectors
+	for (int i = 0; i < 3; i++) {
+		double basis[3] = { i == 0, i == 1, i == 2 }, pos1[3], pos2[3], pos3[3];
+		frame_tie(basis, 1, pos1);
+		precession(T0, pos1, epoch->jd_tdb, pos2);
+		nutation(epoch->jd_tdb, 0, 1, pos2, pos3);
+		for (int j = 0; j < 3; j++) {
+			bias_precession[j][i] = pos2[j];
+			epoch->matrix[j][i] = pos3[j];
+		}
+	}
+	epoch->ephemeris = ephemeris(jd, &earth_object, 0, 1, epoch->earth_pos, epoch->earth_vel) == 0 && ephemeris(jd, &sun_object, 0, 1, epoch->sun_pos, vel) == 0;
+	pthread_mutex_unlock(&novas_mutex);
+	if (epoch->ephemeris) {
+		// sanity check of ephemeris data, Earth-Sun distance is 0.983 - 1.017 AU
+		double distance = sqrt(pow(epoch->earth_pos[0] - epoch->sun_pos[0], 2) + pow(epoch->earth_pos[1] - epoch->sun_pos[1], 2) + pow(epoch->earth_pos[2] - epoch->sun_pos[2], 2));
+		epoch->ephemeris = distance > 0.95 && distance < 1.05;
+	}
+	if (!epoch->ephemeris) {
+		INDIGO_DEBUG(indigo_debug("JPL ephemeris not available, using low precision Earth position"));
+		// heliocentric Earth is used as barycentric (difference up to 0.01 AU doesn't matter for stars), rotated from mean equator of date to ICRS
+		double pos[3][3];
+		sun_position(epoch->jd_tdb, pos[0]);
+		sun_position(epoch->jd_tdb - 0.5, pos[1]);
+		sun_position(epoch->jd_tdb + 0.5, pos[2]);
+		for (int i = 0; i < 3; i++) {
+			epoch->earth_pos[i] = -(bias_precession[0][i] * pos[0][0] + bias_precession[1][i] * pos[0][1] + bias_precession[2][i] * pos[0][2]);
+			epoch->earth_vel[i] = -(bias_precession[0][i] * (pos[2][0] - pos[1][0]) + bias_precession[1][i] * (pos[2][1] - pos[1][1]) + bias_precession[2][i] * (pos[2][2] - pos[1][2]));
+			epoch->sun_pos[i] = 0;
+		}
+	}
+}
+
+// the same steps as NOVAS place() does for star with reduced accuracy (space motion, parallax, deflection by Sun, aberration, frame tie, precession and nutation),
+// but epoch dependent terms are computed only once and stars are processed in chunks with branch-free loops over arrays, so the compiler can vectorize them
+
+void indigo_app_star_batch(const indigo_app_star_epoch *epoch, const indigo_catalog_entry *entries, int count, double *ra, double *dec) {
+	const double pob[3] = { epoch->earth_pos[0], epoch->earth_pos[1], epoch->earth_pos[2] }, vob[3] = { epoch->earth_vel[0], epoch->earth_vel[1], epoch->earth_vel[2] };
+	const double pe[3] = { pob[0] - epoch->sun_pos[0], pob[1] - epoch->sun_pos[1], pob[2] - epoch->sun_pos[2] };
+	const double emag = sqrt(pe[0] * pe[0] + pe[1] * pe[1] + pe[2] * pe[2]);
+	const double ehat[3] = { pe[0] / emag, pe[1] / emag, pe[2] / emag };
+	const double fac1 = 2.0 * GS / (C * C * emag * AU * RMASS[10]);
+	const double c_auday = C_AUDAY, delta_jd = epoch->jd_tdb - T0;
+	const double vemag = sqrt(vob[0] * vob[0] + vob[1] * vob[1] + vob[2] * vob[2]);
+	const double beta = vemag / c_auday;
+	const double gammai = sqrt(1.0 - beta * beta);
+	const double m[3][3] = { { epoch->matrix[0][0], epoch->matrix[0][1], epoch->matrix[0][2] }, { epoch->matrix[1][0], epoch->matrix[1][1], epoch->matrix[1][2] }, { epoch->matrix[2][0], epoch->matrix[2][1], epoch->matrix[2][2] } };
+	double x[APP_STAR_CHUNK], y[APP_STAR_CHUNK], z[APP_STAR_CHUNK], vx[APP_STAR_CHUNK], vy[APP_STAR_CHUNK], vz[APP_STAR_CHUNK];
+	for (int base = 0; base < count; base += APP_STAR_CHUNK) {
+		int n = count - base < APP_STAR_CHUNK ? count - base : APP_STAR_CHUNK;
+		const indigo_catalog_entry *entry = entries + base;
+		// catalog position and space motion (NOVAS starvectors())
+		for (int i = 0; i < n; i++) {
+			double paralx = entry[i].px > 0 ? entry[i].px : 1.0e-6;
+			double dist = 1.0 / sin(paralx * 1.0e-3 * ASEC2RAD);
+			double r = entry[i].ra * 15.0 * DEG2RAD, d = entry[i].dec * DEG2RAD;
+			double cra = cos(r), sra = sin(r), cdc = cos(d), sdc = sin(d);
+			double k = 1.0 / (1.0 - entry[i].rv / C * 1000.0);
+			double pmr = entry[i].promora / (paralx * 365.25) * k, pmd = entry[i].promodec / (paralx * 365.25) * k, rvl = entry[i].rv * 86400.0 / AU_KM * k;
+			x[i] = dist * cdc * cra;
+			y[i] = dist * cdc * sra;
+			z[i] = dist * sdc;
+			vx[i] = -pmr * sra - pmd * sdc * cra + rvl * cdc * cra;
+			vy[i] = pmr * cra - pmd * sdc * sra + rvl * cdc * sra;
+			vz[i] = pmd * cdc + rvl * sdc;
+		}
+		for (int i = 0; i < n; i++) {
+			// proper motion to epoch and light time (proper_motion(), bary2obs())
+			double dt = (pob[0] * x[i] + pob[1] * y[i] + pob[2] * z[i]) / sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) / c_auday + delta_jd;
+			double px = x[i] + vx[i] * dt - pob[0], py = y[i] + vy[i] * dt - pob[1], pz = z[i] + vz[i] * dt - pob[2];
+			double pmag = sqrt(px * px + py * py + pz * pz);
+			double lighttime = pmag / c_auday;
+			// deflection by Sun (grav_vec())
+			double qx = pe[0] + px, qy = pe[1] + py, qz = pe[2] + pz;
+			double qmag = sqrt(qx * qx + qy * qy + qz * qz);
+			px /= pmag; py /= pmag; pz /= pmag;
+			qx /= qmag; qy /= qmag; qz /= qmag;
+			double pdotq = px * qx + py * qy + pz * qz;
+			double edotp = ehat[0] * px + ehat[1] * py + ehat[2] * pz;
+			double qdote = qx * ehat[0] + qy * ehat[1] + qz * ehat[2];
+			// no deflection if Sun is on the line of sight, DBL_MIN keeps 0 / 0 away without branch
+			double f = (fabs(edotp) > 0.99999999999 ? 0 : fac1) / (1.0 + qdote + DBL_MIN);
+			px = (px + f * (pdotq * ehat[0] - edotp * qx)) * pmag;
+			py = (py + f * (pdotq * ehat[1] - edotp * qy)) * pmag;
+			pz = (pz + f * (pdotq * ehat[2] - edotp * qz)) * pmag;
+			// aberration (aberration())
+			double p = beta * (px * vob[0] + py * vob[1] + pz * vob[2]) / (pmag * vemag);
+			double q = (1.0 + p / (1.0 + gammai)) * lighttime;
+			double r = 1.0 + p;
+			px = (gammai * px + q * vob[0]) / r;
+			py = (gammai * py + q * vob[1]) / r;
+			pz = (gammai * pz + q * vob[2]) / r;
+			// frame tie, precession and nutation
+			x[i] = m[0][0] * px + m[0][1] * py + m[0][2] * pz;
+			y[i] = m[1][0] * px + m[1][1] * py + m[1][2] * pz;
+			z[i] = m[2][0] * px + m[2][1] * py + m[2][2] * pz;
+		}
+		for (int i = 0; i < n; i++) {
+			double h = atan2(y[i], x[i]) * RAD2DEG / 15.0;
+			ra[base + i] = h < 0 ? h + 24.0 : h;
+			dec[base + i] = atan2(z[i], sqrt(x[i] * x[i] + y[i] * y[i])) * RAD2DEG;
+		}
+	}
+}
+
 void indigo_topo_star(double latitude, double longitude, double elevation, double promora, double promodec, double parallax, double rv, double *ra, double *dec) {
 	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
 	double tt_now = ut1_now + DELTA_T / 86400.0;
 	cat_entry star;
-	init();
-	make_cat_entry("HIP1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
 	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
+	pthread_mutex_lock(&novas_mutex);
+	init();
+	make_star("HIP1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
 	int error = topo_star(tt_now, DELTA_T, &star, &position, 1, ra, dec);
+	pthread_mutex_unlock(&novas_mutex);
 	if (error != 0) {
 		indigo_error("topo_star() -> %d", error);
 	}
 }
 
 void indigo_topo_planet(double latitude, double longitude, double elevation, int id, double *ra, double *dec) {
-	cat_entry DUMMY_STAR;
 	object solarSystem;
 	double distance;
 	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
 	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
+	pthread_mutex_lock(&novas_mutex);
 	init();
-	make_object(0, id, "Dummy", &DUMMY_STAR, &solarSystem);
+	make_body(id, "Dummy", &solarSystem);
 	int error = topo_planet(ut1_now, &solarSystem, DELTA_T, &position, 1, ra, dec, &distance);
+	pthread_mutex_unlock(&novas_mutex);
 	if (error != 0) {
 		indigo_error("topo_planet() -> %d", error);
 	}
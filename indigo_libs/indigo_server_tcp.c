@@ -43,13 +43,23 @@
 
 #ifdef INDIGO_LINUX
 #include <netinet/tcp.h>
+#include <sys/sendfile.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#ifdef INDIGO_MACOS
+#include <sys/uio.h>
 #endif
 
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_server_tcp.h>
 #include <indigo/indigo_driver_xml.h>
 #include <indigo/indigo_driver_json.h>
+#include <indigo/indigo_driver_binary.h>
 #include <indigo/indigo_client_xml.h>
+#include <indigo/indigo_xml.h>
+#include <indigo/indigo_json.h>
+#include <indigo/indigo_binary.h>
 #include <indigo/indigo_base64.h>
 #include <indigo/indigo_io.h>
 
@@ -69,6 +79,7 @@ static indigo_server_tcp_callback server_callback;
 
 int indigo_server_tcp_port = 7624;
 bool indigo_is_ephemeral_port = false;
+bool indigo_server_tcp_reactor = false;
 
 static struct resource {
 	const char *path;
@@ -80,18 +91,253 @@ static struct resource {
 } *resources = NULL;
 
 #define BUFFER_SIZE	1024
+#define CLIENT_QUEUE_SIZE	256
+#define FILE_BUFFER_SIZE	(128 * 1024)
+
+static int parse_range(const char *range, long size, long *start, long *end) {
+	*start = 0;
+	*end = size - 1;
+	if (*range == 0 || strchr(range, ','))
+		return 200; // no or multipart range, full content is sent
+	long first, last;
+	char dash;
+	if (sscanf(range, "bytes=-%ld", &last) == 1) {
+		if (last <= 0 || size == 0)
+			return 416;
+		*start = last < size ? size - last : 0;
+		return 206;
+	}
+	int count = sscanf(range, "bytes=%ld%c%ld", &first, &dash, &last);
+	if (count < 2 || dash != '-' || first < 0)
+		return 200;
+	if (count == 3 && last < first)
+		return 200;
+	if (first >= size)
+		return 416;
+	*start = first;
+	if (count == 3 && last < size)
+		*end = last;
+	return 206;
+}
+
+static void send_range_headers(int socket, int status, long start, long end, long size) {
+	indigo_printf(socket, "Accept-Ranges: bytes\r\n");
+	if (status == 206)
+		indigo_printf(socket, "Content-Range: bytes %ld-%ld/%ld\r\n", start, end, size);
+	indigo_printf(socket, "Content-Length: %ld\r\n", end - start + 1);
+}
+
+static void send_range_not_satisfiable(int socket, long size) {
+	indigo_printf(socket, "HTTP/1.1 416 Range Not Satisfiable\r\n");
+	indigo_printf(socket, "Content-Range: bytes */%ld\r\n", size);
+	indigo_printf(socket, "Content-Length: 0\r\n");
+	indigo_printf(socket, "\r\n");
+}
+
+static bool send_file(int socket, int handle, long offset, long length) {
+#if defined(INDIGO_LINUX)
+	off_t position = offset;
+	while (length > 0) {
+		ssize_t count = sendfile(socket, handle, &position, length);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return false;
+		length -= count;
+	}
+	return true;
+#elif defined(INDIGO_MACOS)
+	while (length > 0) {
+		off_t count = length;
+		int result = sendfile(handle, socket, offset, &count, NULL, 0);
+		offset += count;
+		length -= count;
+		if (result < 0 && errno != EINTR && errno != EAGAIN)
+			return false;
+		if (result == 0 && count == 0)
+			return false;
+	}
+	return true;
+#else
+	if (lseek(handle, offset, SEEK_SET) < 0)
+		return false;
+	char *buffer = malloc(FILE_BUFFER_SIZE);
+	bool result = buffer != NULL;
+	while (result && length > 0) {
+		long count = read(handle, buffer, length < FILE_BUFFER_SIZE ? length : FILE_BUFFER_SIZE);
+		if (count <= 0 || !indigo_write(socket, buffer, count))
+			result = false;
+		length -= count;
+	}
+	free(buffer);
+	return result;
+#endif
+}
+
+typedef struct {
+	char line[BUFFER_SIZE];
+	char websocket_key[256];
+	char range[256];
+	bool keep_alive;
+	bool upgrade;
+} http_request;
+
+static void parse_http_header(http_request *request, char *header) {
+	if (!strncasecmp(header, "Sec-WebSocket-Key: ", 19))
+		strncpy(request->websocket_key, header + 19, sizeof(request->websocket_key) - 1);
+	if (!strncasecmp(header, "Range: ", 7))
+		strncpy(request->range, header + 7, sizeof(request->range) - 1);
+	if (!strcasecmp(header, "Connection: keep-alive"))
+		request->keep_alive = true;
+}
+
+static bool handle_http_request(int socket, http_request *request) {
+	if (strncmp(request->line, "GET /", 5))
+		return false;
+	char *path = request->line + 4;
+	char *space = strchr(path, ' ');
+	if (space)
+		*space = 0;
+	char *param = strchr(path, '?');
+	if (param)
+		*param = 0;
+	if (!strcmp(path, "/")) {
+		if (*request->websocket_key) {
+			unsigned char shaHash[SHA1_SIZE];
+			memset(shaHash, 0, sizeof(shaHash));
+			strcat(request->websocket_key, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+			sha1(shaHash, request->websocket_key, strlen(request->websocket_key));
+			indigo_printf(socket, "HTTP/1.1 101 Switching Protocols\r\n");
+			indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+			indigo_printf(socket, "Upgrade: websocket\r\n");
+			indigo_printf(socket, "Connection: upgrade\r\n");
+			base64_encode((unsigned char *)request->websocket_key, shaHash, 20);
+			indigo_printf(socket, "Sec-WebSocket-Accept: %s\r\n", request->websocket_key);
+			indigo_printf(socket, "\r\n");
+			INDIGO_LOG(indigo_log("Protocol switched to JSON-over-WebSockets"));
+			request->upgrade = true;
+		} else {
+			indigo_printf(socket, "HTTP/1.1 301 OK\r\n");
+			indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+			indigo_printf(socket, "Location: /mng.html\r\n");
+			indigo_printf(socket, "Content-type: text/html\r\n");
+			indigo_printf(socket, "\r\n");
+			indigo_printf(socket, "<a href='/mng.html'>INDIGO Server Manager</a>");
+		}
+		request->keep_alive = false;
+	} else if (!strncmp(path, "/blob/", 6)) {
+		indigo_item *item;
+		indigo_blob_entry *entry;
+		if (sscanf(path, "/blob/%p.", &item) && (entry = indigo_validate_blob(item))) {
+			// snapshot is immutable and reference counted, it is written directly from the cache without locking
+			long start, end;
+			int status = parse_range(request->range, entry->size, &start, &end);
+			if (status == 416) {
+				send_range_not_satisfiable(socket, entry->size);
+				INDIGO_LOG(indigo_log("%s -> Range not satisfiable (%s)", request->line, request->range));
+			} else {
+				indigo_printf(socket, status == 206 ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n");
+				indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+				if (!strcmp(entry->format, ".jpeg")) {
+					indigo_printf(socket, "Content-Type: image/jpeg\r\n");
+				} else {
+					indigo_printf(socket, "Content-Type: application/octet-stream\r\n");
+					indigo_printf(socket, "Content-Disposition: attachment; filename=\"%p%s\"\r\n", item, entry->format);
+				}
+				if (request->keep_alive)
+					indigo_printf(socket, "Connection: keep-alive\r\n");
+				send_range_headers(socket, status, start, end, entry->size);
+				indigo_printf(socket, "\r\n");
+				if (indigo_write(socket, (char *)entry->content + start, end - start + 1)) {
+					INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request->line, end - start + 1));
+				} else {
+					INDIGO_LOG(indigo_log("%s -> Failed (%s)", request->line, strerror(errno)));
+					request->keep_alive = false;
+				}
+			}
+			indigo_release_blob_entry(entry);
+		} else {
+			indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
+			indigo_printf(socket, "Content-Type: text/plain\r\n");
+			indigo_printf(socket, "\r\n");
+			indigo_printf(socket, "BLOB not found!\r\n");
+			INDIGO_LOG(indigo_log("%s -> Failed", request->line));
+			request->keep_alive = false;
+		}
+	} else {
+		struct resource *resource = resources;
+		do {
+			if (!strcmp(resource->path, path))
+				break;
+		} while ((resource = resource->next) != NULL);
+		if (resource == NULL) {
+			indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
+			indigo_printf(socket, "Content-Type: text/plain\r\n");
+			indigo_printf(socket, "\r\n");
+			indigo_printf(socket, "%s not found!\r\n", path);
+			INDIGO_LOG(indigo_log("%s -> Failed", request->line));
+			request->keep_alive = false;
+		} else if (resource->data) {
+			indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
+			indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+			indigo_printf(socket, "Content-Type: %s\r\n", resource->content_type);
+			indigo_printf(socket, "Content-Length: %d\r\n", resource->length);
+			indigo_printf(socket, "Content-Encoding: gzip\r\n");
+			indigo_printf(socket, "\r\n");
+			indigo_write(socket, (const char *)resource->data, resource->length);
+			INDIGO_LOG(indigo_log("%s -> OK (%d bytes)", request->line, resource->length));
+		} else if (resource->file_name) {
+			char file_name[256];
+			struct stat file_stat;
+			int handle;
+			sprintf(file_name, "%s/%s", getenv("HOME"), resource->file_name);
+			if (stat(file_name, &file_stat) < 0 || (handle = open(file_name, O_RDONLY)) < 0) {
+				indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
+				indigo_printf(socket, "Content-Type: text/plain\r\n");
+				indigo_printf(socket, "\r\n");
+				indigo_printf(socket, "%s not found (%s)\r\n", file_name, strerror(errno));
+				INDIGO_LOG(indigo_log("%s -> Failed to stat/open file (%s, %s)", request->line, file_name, strerror(errno)));
+				request->keep_alive = false;
+			} else {
+				long start, end;
+				int status = parse_range(request->range, file_stat.st_size, &start, &end);
+				if (status == 416) {
+					send_range_not_satisfiable(socket, file_stat.st_size);
+					INDIGO_LOG(indigo_log("%s -> Range not satisfiable (%s)", request->line, request->range));
+				} else {
+					indigo_printf(socket, status == 206 ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n");
+					indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+					indigo_printf(socket, "Content-Type: %s\r\n", resource->content_type);
+					send_range_headers(socket, status, start, end, file_stat.st_size);
+					indigo_printf(socket, "\r\n");
+					if (send_file(socket, handle, start, end - start + 1)) {
+						INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request->line, end - start + 1));
+					} else {
+						INDIGO_LOG(indigo_log("%s -> Failed (%s)", request->line, strerror(errno)));
+						request->keep_alive = false;
+					}
+				}
+				close(handle);
+			}
+		}
+	}
+	return request->keep_alive;
+}
 
 static void start_worker_thread(int *client_socket) {
 	int socket = *client_socket;
 	INDIGO_LOG(indigo_log("Worker thread started socket = %d", socket));
 	server_callback(++client_count);
-	int res = 0;
 	char c;
-	if (recv(socket, &c, 1, MSG_PEEK) == 1) {
+	if (!indigo_enable_read_buffer(socket, 0))
+		INDIGO_DEBUG(indigo_debug("No read buffer for socket = %d, reading unbuffered", socket));
+	if (indigo_peek(socket, &c) == 1) {
 		if (c == '<') {
 			INDIGO_LOG(indigo_log("Protocol switched to XML"));
 			indigo_client *protocol_adapter = indigo_xml_device_adapter(socket, socket);
 			assert(protocol_adapter != NULL);
+			snprintf(protocol_adapter->name, INDIGO_NAME_SIZE, "XML client #%d", socket);
+			indigo_enable_client_queue(protocol_adapter, CLIENT_QUEUE_SIZE, INDIGO_QUEUE_DROP_OLDEST);
 			indigo_attach_client(protocol_adapter);
 			indigo_xml_parse(NULL, protocol_adapter);
 			indigo_detach_client(protocol_adapter);
@@ -100,162 +346,56 @@ static void start_worker_thread(int *client_socket) {
 			INDIGO_LOG(indigo_log("Protocol switched to JSON"));
 			indigo_client *protocol_adapter = indigo_json_device_adapter(socket, socket, false);
 			assert(protocol_adapter != NULL);
+			snprintf(protocol_adapter->name, INDIGO_NAME_SIZE, "JSON client #%d", socket);
+			indigo_enable_client_queue(protocol_adapter, CLIENT_QUEUE_SIZE, INDIGO_QUEUE_DROP_OLDEST);
 			indigo_attach_client(protocol_adapter);
 			indigo_json_parse(NULL, protocol_adapter);
 			indigo_detach_client(protocol_adapter);
 			indigo_release_json_device_adapter(protocol_adapter);
+		} else if ((unsigned char)c == INDIGO_BINARY_MAGIC) {
+			INDIGO_LOG(indigo_log("Protocol switched to binary"));
+			indigo_client *protocol_adapter = indigo_binary_device_adapter(socket, socket);
+			assert(protocol_adapter != NULL);
+			snprintf(protocol_adapter->name, INDIGO_NAME_SIZE, "Binary client #%d", socket);
+			indigo_enable_client_queue(protocol_adapter, CLIENT_QUEUE_SIZE, INDIGO_QUEUE_DROP_OLDEST);
+			indigo_attach_client(protocol_adapter);
+			indigo_binary_parse(NULL, protocol_adapter);
+			indigo_detach_client(protocol_adapter);
+			indigo_release_binary_device_adapter(protocol_adapter);
 		} else if (c == 'G') {
-			char request[BUFFER_SIZE];
+			http_request request;
 			char header[BUFFER_SIZE];
-			while ((res = indigo_read_line(socket, request, BUFFER_SIZE)) >= 0) {
-				bool keep_alive = false;
-				if (!strncmp(request, "GET /", 5)) {
-					char *path = request + 4;
-					char *space = strchr(path, ' ');
-					if (space)
-						*space = 0;
-					char *param = strchr(path, '?');
-					if (param)
-						*param = 0;
-					char websocket_key[256] = "";
-					while (indigo_read_line(socket, header, BUFFER_SIZE) > 0) {
-						if (!strncasecmp(header, "Sec-WebSocket-Key: ", 19))
-							strncpy(websocket_key, header + 19, sizeof(websocket_key));
-						if (!strcasecmp(header, "Connection: keep-alive"))
-							keep_alive = true;
-					}
-					if (!strcmp(path, "/")) {
-						if (*websocket_key) {
-							unsigned char shaHash[SHA1_SIZE];
-							memset(shaHash, 0, sizeof(shaHash));
-							strcat(websocket_key, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
-							sha1(shaHash, websocket_key, strlen(websocket_key));
-							indigo_printf(socket, "HTTP/1.1 101 Switching Protocols\r\n");
-							indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
-							indigo_printf(socket, "Upgrade: websocket\r\n");
-							indigo_printf(socket, "Connection: upgrade\r\n");
-							base64_encode((unsigned char *)websocket_key, shaHash, 20);
-							indigo_printf(socket, "Sec-WebSocket-Accept: %s\r\n", websocket_key);
-							indigo_printf(socket, "\r\n");
-							INDIGO_LOG(indigo_log("Protocol switched to JSON-over-WebSockets"));
-							indigo_client *protocol_adapter = indigo_json_device_adapter(socket, socket, true);
-							assert(protocol_adapter != NULL);
-							indigo_attach_client(protocol_adapter);
-							indigo_json_parse(NULL, protocol_adapter);
-							indigo_detach_client(protocol_adapter);
-						} else {
-							indigo_printf(socket, "HTTP/1.1 301 OK\r\n");
-							indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
-							indigo_printf(socket, "Location: /mng.html\r\n");
-							indigo_printf(socket, "Content-type: text/html\r\n");
-							indigo_printf(socket, "\r\n");
-							indigo_printf(socket, "<a href='/mng.html'>INDIGO Server Manager</a>");
-						}
-						keep_alive = false;
-					} else if (!strncmp(path, "/blob/", 6)) {
-						indigo_item *item;
-						indigo_blob_entry *entry;
-						if (sscanf(path, "/blob/%p.", &item) && (entry = indigo_validate_blob(item))) {
-							indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
-							indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
-							if (!strcmp(entry->format, ".jpeg")) {
-								indigo_printf(socket, "Content-Type: image/jpeg\r\n");
-							} else {
-								indigo_printf(socket, "Content-Type: application/octet-stream\r\n");
-								indigo_printf(socket, "Content-Disposition: attachment; filename=\"%p%s\"\r\n", item, entry->format);
-							}
-							if (keep_alive)
-								indigo_printf(socket, "Connection: keep-alive\r\n");
-							indigo_printf(socket, "Content-Length: %ld\r\n", entry->size);
-							indigo_printf(socket, "\r\n");
-							pthread_mutex_lock(&entry->mutext);
-							if (indigo_write(socket, entry->content, entry->size)) {
-								INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request, entry->size));
-							} else {
-								INDIGO_LOG(indigo_log("%s -> Failed (%s)", request, strerror(errno)));
-								keep_alive = false;
-							}
-							pthread_mutex_unlock(&entry->mutext);
-						} else {
-							indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
-							indigo_printf(socket, "Content-Type: text/plain\r\n");
-							indigo_printf(socket, "\r\n");
-							indigo_printf(socket, "BLOB not found!\r\n");
-							shutdown(socket,SHUT_RDWR);
-							indigo_usleep(ONE_SECOND_DELAY);
-							close(socket);
-							INDIGO_LOG(indigo_log("%s -> Failed", request));
-							keep_alive = false;
-						}
-					} else {
-						struct resource *resource = resources;
-						do {
-							if (!strcmp(resource->path, path))
-								break;
-						} while ((resource = resource->next) != NULL);
-						if (resource == NULL) {
-							indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
-							indigo_printf(socket, "Content-Type: text/plain\r\n");
-							indigo_printf(socket, "\r\n");
-							indigo_printf(socket, "%s not found!\r\n", path);
-							INDIGO_LOG(indigo_log("%s -> Failed", request));
-							keep_alive = false;
-						} else if (resource->data) {
-							indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
-							indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
-							indigo_printf(socket, "Content-Type: %s\r\n", resource->content_type);
-							indigo_printf(socket, "Content-Length: %d\r\n", resource->length);
-							indigo_printf(socket, "Content-Encoding: gzip\r\n");
-							indigo_printf(socket, "\r\n");
-							indigo_write(socket, (const char *)resource->data, resource->length);
-							INDIGO_LOG(indigo_log("%s -> OK (%d bytes)", request, resource->length));
-						} else if (resource->file_name) {
-							char file_name[256];
-							struct stat file_stat;
-							int handle;
-							sprintf(file_name, "%s/%s", getenv("HOME"), resource->file_name);
-							if (stat(file_name, &file_stat) < 0 || (handle = open(file_name, O_RDONLY)) < 0) {
-								indigo_printf(socket, "HTTP/1.1 404 Not found\r\n");
-								indigo_printf(socket, "Content-Type: text/plain\r\n");
-								indigo_printf(socket, "\r\n");
-								indigo_printf(socket, "%s not found (%s)\r\n", file_name, strerror(errno));
-								INDIGO_LOG(indigo_log("%s -> Failed to stat/open file (%s, %s)", request, file_name, strerror(errno)));
-								keep_alive = false;
-							} else {
-								indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
-								indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
-								indigo_printf(socket, "Content-Type: %s\r\n", resource->content_type);
-								indigo_printf(socket, "Content-Length: %d\r\n", file_stat.st_size);
-								indigo_printf(socket, "\r\n");
-								long remaining = file_stat.st_size;
-								char buffer[128 * 1024];
-								while (remaining > 0) {
-									long count = read(handle, buffer, remaining < sizeof(buffer) ? remaining : sizeof(buffer));
-									if (count < 0) {
-										INDIGO_LOG(indigo_log("%s -> Failed to read file (%s)", request, strerror(errno)));
-										break;
-									}
-									if (indigo_write(socket, buffer, count)) {
-										INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request, count));
-									} else {
-										INDIGO_LOG(indigo_log("%s -> Failed (%s)", request, strerror(errno)));
-										keep_alive = false;
-										break;
-									}
-									remaining -= count;
-								}
-								close(handle);
-							}
-						}
-					}
+			request.upgrade = false;
+			while (indigo_read_line(socket, request.line, BUFFER_SIZE) >= 0) {
+				*request.websocket_key = *request.range = 0;
+				request.keep_alive = request.upgrade = false;
+				if (!strncmp(request.line, "GET /", 5)) {
+					while (indigo_read_line(socket, header, BUFFER_SIZE) > 0)
+						parse_http_header(&request, header);
 				}
-				if (!keep_alive) {
+				bool keep_alive = handle_http_request(socket, &request);
+				if (request.upgrade) {
+					indigo_client *protocol_adapter = indigo_json_device_adapter(socket, socket, true);
+					assert(protocol_adapter != NULL);
+					snprintf(protocol_adapter->name, INDIGO_NAME_SIZE, "WebSocket client #%d", socket);
+					indigo_enable_client_queue(protocol_adapter, CLIENT_QUEUE_SIZE, INDIGO_QUEUE_DROP_OLDEST);
+					indigo_attach_client(protocol_adapter);
+					indigo_json_parse(NULL, protocol_adapter);
+					indigo_detach_client(protocol_adapter);
+					indigo_release_json_device_adapter(protocol_adapter);
 					break;
 				}
+				if (!keep_alive)
+					break;
 			}
+			if (!request.upgrade)
+				indigo_disable_read_buffer(socket);
 		} else {
 			INDIGO_LOG(indigo_log("Unrecognised protocol"));
+			indigo_disable_read_buffer(socket);
 		}
+	} else {
+		indigo_disable_read_buffer(socket);
 	}
 	shutdown(socket, SHUT_RDWR);
 	//indigo_usleep(ONE_SECOND_DELAY); // ???
@@ -265,9 +405,403 @@ static void start_worker_thread(int *client_socket) {
 	INDIGO_LOG(indigo_log("Worker thread finished"));
 }
 
+#ifdef INDIGO_LINUX
+
+#define REACTOR_BUFFER_SIZE	(64 * 1024)
+#define REACTOR_HEAD_SIZE	(8 * BUFFER_SIZE)
+#define REACTOR_MAX_WORKERS	8
+#define REACTOR_READS_PER_EVENT	16
+
+typedef enum {
+	PROTOCOL_DETECT,
+	PROTOCOL_XML,
+	PROTOCOL_JSON,
+	PROTOCOL_BINARY,
+	PROTOCOL_HTTP,
+	PROTOCOL_WEB_SOCKET
+} connection_protocol;
+
+typedef struct connection {
+	int socket;
+	connection_protocol protocol;
+	indigo_client *protocol_adapter;
+	indigo_xml_parser *xml_parser;
+	indigo_json_parser *json_parser;
+	indigo_binary_parser *binary_parser;
+	char head[REACTOR_HEAD_SIZE + 1];
+	long head_length;
+	uint8_t frame_header[14];
+	int frame_header_length;
+	int frame_header_size;
+	uint64_t payload_remaining;
+	uint64_t payload_offset;
+	bool in_payload;
+	http_request *response;
+	struct connection *prev, *next;
+} connection;
+
+static int epoll_handle = -1;
+static int wakeup_handle = -1;
+static connection *connections = NULL;
+static pthread_mutex_t connections_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t responses_cond = PTHREAD_COND_INITIALIZER;
+static int response_count = 0;
+
+static bool watch_connection(int socket, void *data, int op) {
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = data;
+	return epoll_ctl(epoll_handle, op, socket, &event) == 0;
+}
+
+static void close_connection(connection *connection) {
+	epoll_ctl(epoll_handle, EPOLL_CTL_DEL, connection->socket, NULL);
+	if (connection->xml_parser)
+		indigo_xml_parser_release(connection->xml_parser);
+	if (connection->json_parser)
+		indigo_json_parser_release(connection->json_parser);
+	if (connection->binary_parser)
+		indigo_binary_parser_release(connection->binary_parser);
+	if (connection->protocol_adapter) {
+		indigo_detach_client(connection->protocol_adapter);
+		if (connection->protocol == PROTOCOL_XML)
+			indigo_release_xml_device_adapter(connection->protocol_adapter);
+		else if (connection->protocol == PROTOCOL_BINARY)
+			indigo_release_binary_device_adapter(connection->protocol_adapter);
+		else
+			indigo_release_json_device_adapter(connection->protocol_adapter);
+	}
+	pthread_mutex_lock(&connections_mutex);
+	if (connection->prev)
+		connection->prev->next = connection->next;
+	else
+		connections = connection->next;
+	if (connection->next)
+		connection->next->prev = connection->prev;
+	int count = --client_count;
+	pthread_mutex_unlock(&connections_mutex);
+	shutdown(connection->socket, SHUT_RDWR);
+	close(connection->socket);
+	server_callback(count);
+	INDIGO_LOG(indigo_log("Connection closed socket = %d", connection->socket));
+	free(connection);
+}
+
+static void attach_protocol_adapter(connection *connection, indigo_client *protocol_adapter, const char *name) {
+	assert(protocol_adapter != NULL);
+	snprintf(protocol_adapter->name, INDIGO_NAME_SIZE, "%s #%d", name, connection->socket);
+	indigo_enable_client_queue(protocol_adapter, CLIENT_QUEUE_SIZE, INDIGO_QUEUE_DROP_OLDEST);
+	indigo_attach_client(protocol_adapter);
+	connection->protocol_adapter = protocol_adapter;
+}
+
+static bool process_web_socket(connection *connection, char *data, long length) {
+	while (length > 0) {
+		if (!connection->in_payload) {
+			connection->frame_header[connection->frame_header_length++] = (uint8_t)*data++;
+			length--;
+			if (connection->frame_header_length == 2) {
+				uint8_t size = connection->frame_header[1] & 0x7F;
+				connection->frame_header_size = 2 + (size == 0x7E ? 2 : size == 0x7F ? 8 : 0) + (connection->frame_header[1] & 0x80 ? 4 : 0);
+			}
+			if (connection->frame_header_length < 2 || connection->frame_header_length < connection->frame_header_size)
+				continue;
+			uint8_t opcode = connection->frame_header[0] & 0x0F;
+			INDIGO_TRACE_PARSER(indigo_trace("ws_read -> %2x", connection->frame_header[0]));
+			if (opcode == 0x8)
+				return false;
+			uint64_t payload_length = connection->frame_header[1] & 0x7F;
+			if (payload_length == 0x7E)
+				payload_length = ntohs(*((uint16_t *)(connection->frame_header + 2)));
+			else if (payload_length == 0x7F)
+				payload_length = ntohll(*((uint64_t *)(connection->frame_header + 2)));
+			connection->payload_remaining = payload_length;
+			connection->payload_offset = 0;
+			connection->frame_header_length = 0;
+			connection->in_payload = payload_length > 0;
+			continue;
+		}
+		long count = length < connection->payload_remaining ? length : (long)connection->payload_remaining;
+		if (connection->frame_header[1] & 0x80) {
+			uint8_t *masking_key = connection->frame_header + connection->frame_header_size - 4;
+			for (long i = 0; i < count; i++)
+				data[i] ^= masking_key[connection->payload_offset++ % 4];
+		}
+		uint8_t opcode = connection->frame_header[0] & 0x0F;
+		if (opcode <= 0x2) {
+			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %.*s", connection->socket, (int)count, data));
+			if (!indigo_json_parser_feed(connection->json_parser, data, count))
+				return false;
+		}
+		data += count;
+		length -= count;
+		connection->payload_remaining -= count;
+		connection->in_payload = connection->payload_remaining > 0;
+	}
+	return true;
+}
+
+static bool process_http(connection *connection, char *data, long length);
+
+static void *http_response_worker(void *arg) {
+	// connection is not watched by the event loop until the responses are written, so no other thread touches it
+	connection *connection = arg;
+	bool keep_open = true;
+	while (keep_open && connection->response) {
+		http_request *request = connection->response;
+		keep_open = handle_http_request(connection->socket, request);
+		free(request);
+		connection->response = NULL;
+		if (keep_open)
+			keep_open = process_http(connection, "", 0);
+	}
+	if (!keep_open || !watch_connection(connection->socket, connection, EPOLL_CTL_MOD))
+		close_connection(connection);
+	pthread_mutex_lock(&connections_mutex);
+	if (--response_count == 0)
+		pthread_cond_broadcast(&responses_cond);
+	pthread_mutex_unlock(&connections_mutex);
+	return NULL;
+}
+
+static bool start_http_response(connection *connection) {
+	// BLOB, file and resource responses can be large and the writes are blocking, they are written by a dedicated thread to keep event loop workers free
+	pthread_mutex_lock(&connections_mutex);
+	response_count++;
+	pthread_mutex_unlock(&connections_mutex);
+	pthread_t thread;
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	int result = pthread_create(&thread, &attr, http_response_worker, connection);
+	pthread_attr_destroy(&attr);
+	if (result == 0)
+		return true;
+	indigo_error("Can't create HTTP response thread (%s)", strerror(result));
+	free(connection->response);
+	connection->response = NULL;
+	pthread_mutex_lock(&connections_mutex);
+	response_count--;
+	pthread_mutex_unlock(&connections_mutex);
+	return false;
+}
+
+static bool process_http(connection *connection, char *data, long length) {
+	if (connection->head_length + length > REACTOR_HEAD_SIZE) {
+		INDIGO_LOG(indigo_log("HTTP request header too long"));
+		return false;
+	}
+	memcpy(connection->head + connection->head_length, data, length);
+	connection->head_length += length;
+	connection->head[connection->head_length] = 0;
+	while (true) {
+		char *end = strstr(connection->head, "\r\n\r\n");
+		if (end == NULL)
+			return true;
+		*end = 0;
+		http_request request;
+		memset(&request, 0, sizeof(request));
+		char *line = connection->head, *next;
+		for (bool first = true; line; line = next, first = false) {
+			if ((next = strstr(line, "\r\n")) != NULL) {
+				*next = 0;
+				next += 2;
+			}
+			if (first)
+				strncpy(request.line, line, BUFFER_SIZE - 1);
+			else
+				parse_http_header(&request, line);
+		}
+		long rest = connection->head_length - (end + 4 - connection->head);
+		memmove(connection->head, end + 4, rest + 1);
+		connection->head_length = rest;
+		if (*request.websocket_key == 0) {
+			// response is written outside of event loop, see start_http_response()
+			if ((connection->response = malloc(sizeof(http_request))) == NULL)
+				return false;
+			memcpy(connection->response, &request, sizeof(http_request));
+			return true;
+		}
+		bool keep_alive = handle_http_request(connection->socket, &request);
+		if (request.upgrade) {
+			connection->protocol = PROTOCOL_WEB_SOCKET;
+			attach_protocol_adapter(connection, indigo_json_device_adapter(connection->socket, connection->socket, true), "WebSocket client");
+			connection->json_parser = indigo_json_parser_create(NULL, connection->protocol_adapter);
+			connection->head_length = 0;
+			return process_web_socket(connection, connection->head, rest);
+		}
+		if (!keep_alive)
+			return false;
+	}
+}
+
+static bool process_input(connection *connection, char *data, long length) {
+	if (connection->protocol == PROTOCOL_DETECT) {
+		if (*data == '<') {
+			INDIGO_LOG(indigo_log("Protocol switched to XML"));
+			connection->protocol = PROTOCOL_XML;
+			attach_protocol_adapter(connection, indigo_xml_device_adapter(connection->socket, connection->socket), "XML client");
+			connection->xml_parser = indigo_xml_parser_create(NULL, connection->protocol_adapter);
+		} else if (*data == '{') {
+			INDIGO_LOG(indigo_log("Protocol switched to JSON"));
+			connection->protocol = PROTOCOL_JSON;
+			attach_protocol_adapter(connection, indigo_json_device_adapter(connection->socket, connection->socket, false), "JSON client");
+			connection->json_parser = indigo_json_parser_create(NULL, connection->protocol_adapter);
+		} else if ((unsigned char)*data == INDIGO_BINARY_MAGIC) {
+			INDIGO_LOG(indigo_log("Protocol switched to binary"));
+			connection->protocol = PROTOCOL_BINARY;
+			attach_protocol_adapter(connection, indigo_binary_device_adapter(connection->socket, connection->socket), "Binary client");
+			connection->binary_parser = indigo_binary_parser_create(NULL, connection->protocol_adapter);
+		} else if (*data == 'G') {
+			connection->protocol = PROTOCOL_HTTP;
+		} else {
+			INDIGO_LOG(indigo_log("Unrecognised protocol"));
+			return false;
+		}
+	}
+	switch (connection->protocol) {
+		case PROTOCOL_XML:
+			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", connection->socket, data));
+			return indigo_xml_parser_feed(connection->xml_parser, data, length);
+		case PROTOCOL_JSON:
+			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", connection->socket, data));
+			return indigo_json_parser_feed(connection->json_parser, data, length);
+		case PROTOCOL_BINARY:
+			return indigo_binary_parser_feed(connection->binary_parser, data, length);
+		case PROTOCOL_HTTP:
+			return process_http(connection, data, length);
+		case PROTOCOL_WEB_SOCKET:
+			return process_web_socket(connection, data, length);
+		default:
+			return false;
+	}
+}
+
+static void accept_connections() {
+	int client_socket;
+	while ((client_socket = accept(server_socket, NULL, NULL)) >= 0) {
+		connection *connection = malloc(sizeof(struct connection));
+		assert(connection != NULL);
+		memset(connection, 0, sizeof(struct connection));
+		connection->socket = client_socket;
+		pthread_mutex_lock(&connections_mutex);
+		connection->next = connections;
+		if (connections)
+			connections->prev = connection;
+		connections = connection;
+		int count = ++client_count;
+		pthread_mutex_unlock(&connections_mutex);
+		server_callback(count);
+		INDIGO_LOG(indigo_log("Connection accepted socket = %d", client_socket));
+		if (!watch_connection(client_socket, connection, EPOLL_CTL_ADD)) {
+			indigo_error("Can't watch connection (%s)", strerror(errno));
+			close_connection(connection);
+		}
+	}
+	if (errno != EAGAIN && errno != EWOULDBLOCK && !shutdown_initiated)
+		indigo_error("Can't accept connection (%s)", strerror(errno));
+	watch_connection(server_socket, &server_socket, EPOLL_CTL_MOD);
+}
+
+static void *reactor_worker(void *arg) {
+	char *buffer = malloc(REACTOR_BUFFER_SIZE + 1);
+	assert(buffer != NULL);
+	struct epoll_event event;
+	while (!shutdown_initiated) {
+		int count = epoll_wait(epoll_handle, &event, 1, -1);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0 || event.data.ptr == NULL)
+			break;
+		if (event.data.ptr == &server_socket) {
+			accept_connections();
+			continue;
+		}
+		// EPOLLONESHOT guarantees that only one worker at time processes given connection
+		connection *connection = event.data.ptr;
+		bool keep_open = true;
+		for (int i = 0; keep_open && connection->response == NULL && i < REACTOR_READS_PER_EVENT; i++) {
+			ssize_t length = recv(connection->socket, buffer, REACTOR_BUFFER_SIZE, MSG_DONTWAIT);
+			if (length > 0) {
+				buffer[length] = 0;
+				keep_open = process_input(connection, buffer, length);
+			} else if (length < 0 && errno == EINTR) {
+				continue;
+			} else if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			} else {
+				keep_open = false;
+			}
+		}
+		if (keep_open && connection->response != NULL) {
+			if (start_http_response(connection))
+				continue;
+			keep_open = false;
+		}
+		if (!keep_open || !watch_connection(connection->socket, connection, EPOLL_CTL_MOD))
+			close_connection(connection);
+	}
+	free(buffer);
+	return NULL;
+}
+
+static indigo_result start_reactor() {
+	if ((epoll_handle = epoll_create1(EPOLL_CLOEXEC)) < 0 || (wakeup_handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+		indigo_error("Can't create event loop (%s)", strerror(errno));
+		return INDIGO_CANT_START_SERVER;
+	}
+	fcntl(server_socket, F_SETFL, fcntl(server_socket, F_GETFL) | O_NONBLOCK);
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	epoll_ctl(epoll_handle, EPOLL_CTL_ADD, wakeup_handle, &event);
+	watch_connection(server_socket, &server_socket, EPOLL_CTL_ADD);
+	int worker_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_count < 2)
+		worker_count = 2;
+	else if (worker_count > REACTOR_MAX_WORKERS)
+		worker_count = REACTOR_MAX_WORKERS;
+	pthread_t workers[REACTOR_MAX_WORKERS];
+	for (int i = 0; i < worker_count; i++) {
+		if (pthread_create(&workers[i], NULL, reactor_worker, NULL) != 0) {
+			indigo_error("Can't create reactor worker (%s)", strerror(errno));
+			worker_count = i;
+			break;
+		}
+	}
+	INDIGO_LOG(indigo_log("Event loop started with %d workers", worker_count));
+	for (int i = 0; i < worker_count; i++)
+		pthread_join(workers[i], NULL);
+	pthread_mutex_lock(&connections_mutex);
+	for (connection *connection = connections; connection; connection = connection->next) {
+		if (connection->response)
+			shutdown(connection->socket, SHUT_RDWR);
+	}
+	while (response_count > 0)
+		pthread_cond_wait(&responses_cond, &connections_mutex);
+	pthread_mutex_unlock(&connections_mutex);
+	while (connections)
+		close_connection(connections);
+	close(epoll_handle);
+	close(wakeup_handle);
+	epoll_handle = wakeup_handle = -1;
+	return INDIGO_OK;
+}
+
+#endif
+
 void indigo_server_shutdown() {
 	if (!shutdown_initiated) {
 		shutdown_initiated = true;
+#ifdef INDIGO_LINUX
+		if (wakeup_handle >= 0) {
+			uint64_t value = 1;
+			if (write(wakeup_handle, &value, sizeof(value)) < 0)
+				indigo_error("Can't wake up event loop (%s)", strerror(errno));
+		}
+#endif
 		shutdown(server_socket, SHUT_RDWR);
 		close(server_socket);
 	}
@@ -373,6 +907,13 @@ indigo_result indigo_server_start(indigo_server_tcp_callback callback) {
 	INDIGO_LOG(indigo_log("Server started on %d", indigo_server_tcp_port));
 	server_callback(client_count);
 	signal(SIGPIPE, SIG_IGN);
+#ifdef INDIGO_LINUX
+	if (indigo_server_tcp_reactor) {
+		indigo_result result = start_reactor();
+		shutdown_initiated = false;
+		return result;
+	}
+#endif
 	while (1) {
 		client_socket = accept(server_socket, (struct sockaddr *)&client_name, &name_len);
 		if (client_socket == -1) {
@@ -27,7 +27,9 @@
 #include <time.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <sched.h>
 
 #include <indigo/indigo_timer.h>
 
@@ -50,160 +52,643 @@ void utc_time(struct timespec *ts) {
 #define utc_time(ts) clock_gettime(CLOCK_REALTIME, ts)
 #endif
 
+#ifdef INDIGO_LINUX
+#define timer_clock(ts) clock_gettime(CLOCK_MONOTONIC, ts)
+#else
+#define timer_clock(ts) utc_time(ts)
+#endif
 
 #define NANO	1000000000L
 
+// Hierarchical timer wheel with 1ms ticks, level 0 has 256 slots for the next 256ms, each next level has 64 slots
+// 64 times longer than slots of the previous level (2^32ms in total). Timers are moved to lower levels when the
+// previous level wraps around and to the due list when their tick comes, wheel thread waits for exact deadlines
+// of timers in the due list and passes them to the ready list served by the worker pool.
+
+#define TICK_NS					1000000L
+#define LEVELS					5
+#define LEVEL0_BITS			8
+#define LEVEL_BITS			6
+#define LEVEL0_SIZE			(1 << LEVEL0_BITS)
+#define LEVEL_SIZE			(1 << LEVEL_BITS)
+#define MAX_TICKS				((1ULL << (LEVEL0_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1)
+
+#define POOL_SIZE				4
+#define IDLE_TIMEOUT		10
+#define STARVATION_NS		(5 * TICK_NS)
+#define HANDOFF_NS			((uint64_t)(INDIGO_TIMER_HANDOFF * NANO))
+
+#define TIMER_FREE			0
+#define TIMER_PENDING		1
+#define TIMER_DUE				2
+#define TIMER_READY			3
+#define TIMER_RUNNING		4
+#define TIMER_PULSE			5
+
+#define PULSE_SPIN_NS		((uint64_t)(INDIGO_PULSE_SPIN * NANO))
+
+typedef struct timer_worker {
+	void *owner;
+	uint64_t handoff;
+	bool handed_off;
+	struct timer_worker *next;
+} timer_worker;
+
 int timer_count = 0;
-indigo_timer *free_timer;
+bool indigo_use_realtime_pulses = true;
+
+static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wheel_cond;
+static pthread_cond_t worker_cond;
+static bool wheel_started = false;
+static uint64_t wheel_base;
+static uint64_t wheel_tick;
+static uint64_t wheel_target;
+static int wheel_count;
+static indigo_timer *wheel[LEVELS][LEVEL0_SIZE];
+static indigo_timer *due_head = NULL;
+static indigo_timer **due_tail = &due_head;
+static indigo_timer *ready_head = NULL;
+static indigo_timer **ready_tail = &ready_head;
+static indigo_timer *free_head = NULL;
+static indigo_timer **free_tail = &free_head;
+static timer_worker *running = NULL;
+static int workers = 0;
+static int idle_workers = 0;
+static int wakeups = 0;
+static pthread_cond_t pulse_cond;
+static bool pulse_started = false;
+static indigo_timer *pulse_head = NULL;
+
+// nanoseconds since the wheel was started
+
+static uint64_t clock_ns() {
+	struct timespec ts;
+	timer_clock(&ts);
+	return (uint64_t)ts.tv_sec * NANO + ts.tv_nsec - wheel_base;
+}
+
+static void ns_to_timespec(uint64_t ns, struct timespec *ts) {
+	ns += wheel_base;
+	ts->tv_sec = ns / NANO;
+	ts->tv_nsec = ns % NANO;
+}
+
+static inline int level_shift(int level) {
+	return level == 0 ? 0 : LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+}
+
+static inline int level_mask(int level) {
+	return level == 0 ? LEVEL0_SIZE - 1 : LEVEL_SIZE - 1;
+}
+
+static void list_append(indigo_timer ***tail, indigo_timer *timer) {
+	timer->wheel_next = NULL;
+	timer->wheel_previous = *tail;
+	**tail = timer;
+	*tail = &timer->wheel_next;
+}
+
+static void list_remove(indigo_timer ***tail, indigo_timer *timer) {
+	*timer->wheel_previous = timer->wheel_next;
+	if (timer->wheel_next != NULL)
+		timer->wheel_next->wheel_previous = timer->wheel_previous;
+	else if (tail != NULL)
+		*tail = timer->wheel_previous;
+	timer->wheel_next = NULL;
+	timer->wheel_previous = NULL;
+}
+
+static void *worker_func(void *arg);
+
+static void start_worker() {
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, worker_func, NULL) == 0)
+		workers++;
+	else
+		indigo_error("Can't create timer worker thread (%s)", strerror(errno));
+}
+
+static void wake_wheel(uint64_t deadline) {
+	if (wheel_target == 0 || deadline < wheel_target)
+		pthread_cond_signal(&wheel_cond);
+}
+
+// make sure some worker thread will look at the ready list, if all of them are busy and the pool is full, wheel thread
+// adds another one when the callback is not taken in STARVATION_NS (call with timer_mutex locked)
+
+static void kick_worker() {
+	if (idle_workers > wakeups) {
+		wakeups++;
+		pthread_cond_signal(&worker_cond);
+	} else if (workers < POOL_SIZE) {
+		start_worker();
+	} else {
+		wake_wheel(clock_ns() + STARVATION_NS);
+	}
+}
+
+static void make_ready(indigo_timer *timer, uint64_t now) {
+	timer->state = TIMER_READY;
+	timer->deadline = now;
+	list_append(&ready_tail, timer);
+	kick_worker();
+}
 
-pthread_mutex_t free_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t cancel_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void wheel_insert(indigo_timer *timer) {
+	if (timer->expires <= wheel_tick) {
+		timer->state = TIMER_DUE;
+		list_append(&due_tail, timer);
+	} else {
+		uint64_t delta = timer->expires - wheel_tick;
+		int level = 0;
+		while (level < LEVELS - 1 && delta >= (1ULL << level_shift(level + 1)))
+			level++;
+		indigo_timer **slot = &wheel[level][(timer->expires >> level_shift(level)) & level_mask(level)];
+		timer->state = TIMER_PENDING;
+		timer->wheel_previous = slot;
+		if ((timer->wheel_next = *slot) != NULL)
+			(*slot)->wheel_previous = &timer->wheel_next;
+		*slot = timer;
+	}
+	wheel_count++;
+}
+
+static void wheel_remove(indigo_timer *timer) {
+	if (timer->state == TIMER_PULSE) {
+		list_remove(NULL, timer);
+	} else {
+		list_remove(timer->state == TIMER_DUE ? &due_tail : NULL, timer);
+		wheel_count--;
+	}
+}
+
+// first tick with non empty slot (timers expiring or to be moved to lower level), or 0 if there is no such slot
+
+static uint64_t wheel_next_event() {
+	uint64_t result = 0;
+	if (wheel_count == 0)
+		return 0;
+	for (int level = 0; level < LEVELS; level++) {
+		int shift = level_shift(level);
+		int mask = level_mask(level);
+		uint64_t base = wheel_tick >> shift;
+		for (uint64_t i = 1; i <= (uint64_t)mask + 1; i++) {
+			if (wheel[level][(base + i) & mask] != NULL) {
+				uint64_t tick = (base + i) << shift;
+				if (result == 0 || tick < result)
+					result = tick;
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+static void wheel_process_slot(indigo_timer **slot) {
+	indigo_timer *timer = *slot;
+	*slot = NULL;
+	while (timer != NULL) {
+		indigo_timer *next = timer->wheel_next;
+		wheel_count--;
+		wheel_insert(timer);
+		timer = next;
+	}
+}
 
-static void *timer_func(indigo_timer *timer) {
+// advance the wheel to the current tick, slots without timers are skipped (call with timer_mutex locked)
+
+static void wheel_advance(uint64_t now) {
+	uint64_t now_tick = now / TICK_NS;
+	while (wheel_tick < now_tick) {
+		uint64_t tick = wheel_next_event();
+		if (tick == 0 || tick > now_tick) {
+			wheel_tick = now_tick;
+			break;
+		}
+		wheel_tick = tick;
+		for (int level = LEVELS - 1; level > 0; level--) {
+			if ((tick & ((1ULL << level_shift(level)) - 1)) == 0)
+				wheel_process_slot(&wheel[level][(tick >> level_shift(level)) & level_mask(level)]);
+		}
+		wheel_process_slot(&wheel[0][tick & level_mask(0)]);
+	}
+}
+
+static bool owner_busy(void *owner, uint64_t now) {
+	for (timer_worker *worker = running; worker != NULL; worker = worker->next) {
+		if (worker->owner == owner && now < worker->handoff)
+			return true;
+	}
+	return false;
+}
+
+static bool owner_ready(void *owner) {
+	for (indigo_timer *timer = ready_head; timer != NULL; timer = timer->wheel_next) {
+		if (timer->owner == owner)
+			return true;
+	}
+	return false;
+}
+
+static void *wheel_func(void *arg) {
 	pthread_detach(pthread_self());
+	pthread_mutex_lock(&timer_mutex);
 	while (true) {
-		while (timer->scheduled) {
-			INDIGO_TRACE(indigo_trace("timer #%d (of %d) used for %gs", timer->timer_id, timer_count, timer->delay));
-			if (timer->delay > 0) {
-				struct timespec end;
-				utc_time(&end);
-				end.tv_sec += (int)timer->delay;
-				end.tv_nsec += NANO * (timer->delay - (int)timer->delay);
-				normalize_timespec(&end);
-				while (!timer->canceled) {
-					pthread_mutex_lock(&timer->mutex);
-					int rc = pthread_cond_timedwait(&timer->cond, &timer->mutex, &end);
-					pthread_mutex_unlock(&timer->mutex);
-					if (rc == ETIMEDOUT)
-						break;
-				}
+		uint64_t now = clock_ns();
+		uint64_t target = 0;
+		wheel_advance(now);
+		indigo_timer *timer = due_head;
+		while (timer != NULL) {
+			indigo_timer *next = timer->wheel_next;
+			if (timer->deadline <= now) {
+				wheel_remove(timer);
+				make_ready(timer, now);
+			} else if (target == 0 || timer->deadline < target) {
+				target = timer->deadline;
 			}
-
-			timer->scheduled = false;
-			if (!timer->canceled) {
-				timer->callback(timer->device);
+			timer = next;
+		}
+		uint64_t tick = wheel_next_event();
+		if (tick != 0 && (target == 0 || tick * TICK_NS < target))
+			target = tick * TICK_NS;
+		// callbacks running too long don't block other callbacks of the same device any more
+		for (timer_worker *worker = running; worker != NULL; worker = worker->next) {
+			if (worker->handed_off || worker->owner == NULL || !owner_ready(worker->owner))
+				continue;
+			if (now >= worker->handoff) {
+				worker->handed_off = true;
+				kick_worker();
+			} else if (target == 0 || worker->handoff < target) {
+				target = worker->handoff;
 			}
 		}
+		// all workers are blocked by long callbacks
+		if (idle_workers <= wakeups) {
+			for (timer = ready_head; timer != NULL; timer = timer->wheel_next) {
+				if (timer->owner == NULL || !owner_busy(timer->owner, now)) {
+					if (now >= timer->deadline + STARVATION_NS) {
+						start_worker();
+					} else if (target == 0 || timer->deadline + STARVATION_NS < target) {
+						target = timer->deadline + STARVATION_NS;
+					}
+					break;
+				}
+			}
+		}
+		wheel_target = target;
+		if (target == 0) {
+			pthread_cond_wait(&wheel_cond, &timer_mutex);
+		} else if (target > now) {
+			struct timespec end;
+			ns_to_timespec(target, &end);
+			pthread_cond_timedwait(&wheel_cond, &timer_mutex, &end);
+		}
+	}
+	return NULL;
+}
 
-		INDIGO_TRACE(indigo_trace("timer #%d done", timer->timer_id));
+static void start_wheel() {
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+#ifdef INDIGO_LINUX
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+	pthread_cond_init(&wheel_cond, &attr);
+	pthread_cond_init(&worker_cond, &attr);
+	pthread_condattr_destroy(&attr);
+	wheel_base = clock_ns();
+	wheel_tick = 0;
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, wheel_func, NULL) != 0)
+		indigo_error("Can't create timer wheel thread (%s)", strerror(errno));
+	wheel_started = true;
+}
 
-		pthread_mutex_lock(&cancel_timer_mutex);
+static void release_timer(indigo_timer *timer);
+static void arm_timer(indigo_timer *timer, double delay);
+
+// Pulse timers are kept in a short list sorted by deadline and served by a dedicated thread, which waits for the deadline
+// on a condition and busy-waits for the last PULSE_SPIN_NS to avoid wake up latency.
+
+static void *pulse_func(void *arg) {
+	pthread_detach(pthread_self());
+	if (indigo_use_realtime_pulses) {
+		struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + 1 };
+		int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (rc)
+			INDIGO_DEBUG(indigo_debug("Can't use SCHED_FIFO policy for pulse timers (%s)", strerror(rc)));
+	}
+	pthread_mutex_lock(&timer_mutex);
+	while (true) {
+		indigo_timer *timer = pulse_head;
+		if (timer == NULL) {
+			pthread_cond_wait(&pulse_cond, &timer_mutex);
+			continue;
+		}
+		uint64_t deadline = timer->deadline;
+		uint64_t now = clock_ns();
+		if (deadline > now + PULSE_SPIN_NS) {
+			struct timespec end;
+			ns_to_timespec(deadline - PULSE_SPIN_NS, &end);
+			pthread_cond_timedwait(&pulse_cond, &timer_mutex, &end);
+			continue;
+		}
+		pthread_mutex_unlock(&timer_mutex);
+		while ((now = clock_ns()) < deadline)
+			;
+		pthread_mutex_lock(&timer_mutex);
+		// pulse could be canceled or rescheduled while spinning
+		if (pulse_head != timer || timer->deadline != deadline)
+			continue;
+		list_remove(NULL, timer);
+		timer->state = TIMER_RUNNING;
 		indigo_device *device = timer->device;
-		if (device != NULL) {
-			if (DEVICE_CONTEXT->timers == timer) {
-				DEVICE_CONTEXT->timers = timer->next;
-			} else {
-				indigo_timer *previous = DEVICE_CONTEXT->timers;
-				while (previous->next != NULL) {
-					if (previous->next == timer) {
-						previous->next = timer->next;
-						break;
-					}
-					previous = previous->next;
+		indigo_pulse_callback measured = timer->measured;
+		double requested = timer->delay;
+		pthread_mutex_unlock(&timer_mutex);
+		timer->callback(device);
+		pthread_mutex_lock(&timer_mutex);
+		if (timer->scheduled && !timer->canceled)
+			arm_timer(timer, timer->delay);
+		else
+			release_timer(timer);
+		if (measured) {
+			pthread_mutex_unlock(&timer_mutex);
+			measured(device, requested, requested + (double)(now - deadline) / NANO);
+			pthread_mutex_lock(&timer_mutex);
+		}
+	}
+	return NULL;
+}
+
+static void arm_pulse(indigo_timer *timer, uint64_t now, double duration) {
+	if (!pulse_started) {
+		pthread_t thread;
+		pthread_condattr_t attr;
+		pthread_condattr_init(&attr);
+#ifdef INDIGO_LINUX
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+		pthread_cond_init(&pulse_cond, &attr);
+		pthread_condattr_destroy(&attr);
+		if (pthread_create(&thread, NULL, pulse_func, NULL) != 0)
+			indigo_error("Can't create pulse timer thread (%s)", strerror(errno));
+		pulse_started = true;
+	}
+	timer->deadline = now + (duration > 0 ? (uint64_t)(duration * NANO) : 0);
+	timer->state = TIMER_PULSE;
+	indigo_timer **previous = &pulse_head;
+	while (*previous != NULL && (*previous)->deadline <= timer->deadline)
+		previous = &(*previous)->wheel_next;
+	timer->wheel_previous = previous;
+	if ((timer->wheel_next = *previous) != NULL)
+		(*previous)->wheel_previous = &timer->wheel_next;
+	*previous = timer;
+	if (pulse_head == timer)
+		pthread_cond_signal(&pulse_cond);
+}
+
+// schedule timer to fire after delay (call with timer_mutex locked)
+
+static void arm_timer(indigo_timer *timer, double delay) {
+	if (!wheel_started)
+		start_wheel();
+	timer->canceled = false;
+	timer->scheduled = false;
+	timer->delay = delay;
+	uint64_t now = clock_ns();
+	if (timer->pulse) {
+		arm_pulse(timer, now, delay);
+		return;
+	}
+	wheel_advance(now);
+	if (delay <= 0) {
+		make_ready(timer, now);
+		return;
+	}
+	if (delay * 1000 >= MAX_TICKS)
+		timer->deadline = (wheel_tick + MAX_TICKS - 1) * TICK_NS;
+	else
+		timer->deadline = now + (uint64_t)(delay * NANO);
+	timer->expires = timer->deadline / TICK_NS;
+	wheel_insert(timer);
+	wake_wheel(timer->deadline);
+}
+
+// timer is not used any more, remove it from device and put it to the free list (call with timer_mutex locked)
+
+static void release_timer(indigo_timer *timer) {
+	indigo_device *device = timer->device;
+	if (device != NULL) {
+		if (DEVICE_CONTEXT->timers == timer) {
+			DEVICE_CONTEXT->timers = timer->next;
+		} else {
+			indigo_timer *previous = DEVICE_CONTEXT->timers;
+			while (previous != NULL && previous->next != NULL) {
+				if (previous->next == timer) {
+					previous->next = timer->next;
+					break;
 				}
+				previous = previous->next;
 			}
 		}
-		pthread_mutex_unlock(&cancel_timer_mutex);
-
-		pthread_mutex_lock(&free_timer_mutex);
-		timer->next = free_timer;
-		free_timer = timer;
-		timer->wake = false;
-		pthread_mutex_unlock(&free_timer_mutex);
+	}
+	INDIGO_TRACE(indigo_trace("timer #%d done", timer->timer_id));
+	timer->state = TIMER_FREE;
+	timer->device = NULL;
+	timer->next = NULL;
+	// free timers are reused in FIFO order to make stale timer pointers less harmful
+	list_append(&free_tail, timer);
+}
 
-		pthread_mutex_lock(&timer->mutex);
-		while (!timer->wake)
-			 pthread_cond_wait(&timer->cond, &timer->mutex);
-		pthread_mutex_unlock(&timer->mutex);
+static indigo_timer *take_ready(uint64_t now) {
+	for (indigo_timer *timer = ready_head; timer != NULL; timer = timer->wheel_next) {
+		if (timer->owner == NULL || !owner_busy(timer->owner, now)) {
+			list_remove(&ready_tail, timer);
+			return timer;
+		}
+		// wheel thread has to wake up at handoff time of the running callback
+		wake_wheel(now + HANDOFF_NS);
 	}
 	return NULL;
 }
 
-indigo_timer *indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback callback) {
-	indigo_timer *timer = NULL;
-	pthread_mutex_lock(&free_timer_mutex);
-	if (free_timer != NULL) {
-		timer = free_timer;
-		free_timer = free_timer->next;
-		timer->wake = true;
-		timer->canceled = false;
-		timer->scheduled = true;
-		timer->delay = delay;
-		if ((timer->device = device) != NULL) {
-			timer->next = DEVICE_CONTEXT->timers;
-			DEVICE_CONTEXT->timers = timer;
+static void *worker_func(void *arg) {
+	pthread_detach(pthread_self());
+	timer_worker worker = { 0 };
+	pthread_mutex_lock(&timer_mutex);
+	while (true) {
+		uint64_t now = clock_ns();
+		indigo_timer *timer = take_ready(now);
+		if (timer != NULL) {
+			timer->state = TIMER_RUNNING;
+			worker.owner = timer->owner;
+			worker.handoff = now + HANDOFF_NS;
+			worker.handed_off = false;
+			worker.next = running;
+			running = &worker;
+			indigo_device *device = timer->device;
+			INDIGO_TRACE(indigo_trace("timer #%d (of %d) used for %gs", timer->timer_id, timer_count, timer->delay));
+			pthread_mutex_unlock(&timer_mutex);
+			timer->callback(device);
+			pthread_mutex_lock(&timer_mutex);
+			for (timer_worker **previous = &running; *previous != NULL; previous = &(*previous)->next) {
+				if (*previous == &worker) {
+					*previous = worker.next;
+					break;
+				}
+			}
+			if (timer->scheduled && !timer->canceled)
+				arm_timer(timer, timer->delay);
+			else
+				release_timer(timer);
+			if (worker.owner != NULL && owner_ready(worker.owner))
+				kick_worker();
+			continue;
+		}
+		idle_workers++;
+		int rc = 0;
+		if (workers > POOL_SIZE) {
+			struct timespec end;
+			ns_to_timespec(now + IDLE_TIMEOUT * (uint64_t)NANO, &end);
+			while (wakeups == 0 && rc != ETIMEDOUT)
+				rc = pthread_cond_timedwait(&worker_cond, &timer_mutex, &end);
 		} else {
-			timer->next = NULL;
+			while (wakeups == 0)
+				pthread_cond_wait(&worker_cond, &timer_mutex);
 		}
-		timer->callback = callback;
-		pthread_mutex_lock(&timer->mutex);
-		pthread_cond_signal(&timer->cond);
-		pthread_mutex_unlock(&timer->mutex);
+		idle_workers--;
+		if (wakeups > 0)
+			wakeups--;
+		else if (rc == ETIMEDOUT && workers > POOL_SIZE)
+			break;
+	}
+	workers--;
+	pthread_mutex_unlock(&timer_mutex);
+	return NULL;
+}
+
+// get free timer and add it to the device (call with timer_mutex locked)
+
+static indigo_timer *new_timer(indigo_device *device, indigo_timer_callback callback) {
+	indigo_timer *timer = NULL;
+	if (free_head != NULL) {
+		timer = free_head;
+		list_remove(&free_tail, timer);
 	} else {
 		timer = malloc(sizeof(indigo_timer));
+		memset(timer, 0, sizeof(indigo_timer));
 		timer->timer_id = timer_count++;
-		pthread_mutex_init(&timer->mutex, NULL);
-		pthread_cond_init(&timer->cond, NULL);
-		timer->canceled = false;
-		timer->scheduled = true;
-		if ((timer->device = device) != NULL) {
-			timer->next = DEVICE_CONTEXT->timers;
-			DEVICE_CONTEXT->timers = timer;
-		} else {
-			timer->next = NULL;
-		}
-		timer->delay = delay;
-		timer->callback = callback;
-		pthread_create(&timer->thread, NULL, (void * (*)(void*))timer_func, timer);
 	}
-	pthread_mutex_unlock(&free_timer_mutex);
+	if ((timer->device = device) != NULL) {
+		timer->next = DEVICE_CONTEXT->timers;
+		DEVICE_CONTEXT->timers = timer;
+	} else {
+		timer->next = NULL;
+	}
+	timer->owner = device;
+	timer->callback = callback;
+	timer->pulse = false;
+	timer->measured = NULL;
+	return timer;
+}
+
+indigo_timer *indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback callback) {
+	pthread_mutex_lock(&timer_mutex);
+	indigo_timer *timer = new_timer(device, callback);
+	arm_timer(timer, delay);
+	pthread_mutex_unlock(&timer_mutex);
 	return timer;
 }
 
-// TODO: do we need device?
+indigo_timer *indigo_set_pulse_timer(indigo_device *device, double duration, indigo_timer_callback callback, indigo_pulse_callback measured) {
+	pthread_mutex_lock(&timer_mutex);
+	indigo_timer *timer = new_timer(device, callback);
+	timer->pulse = true;
+	timer->measured = measured;
+	arm_timer(timer, duration);
+	pthread_mutex_unlock(&timer_mutex);
+	return timer;
+}
 
 bool indigo_reschedule_timer(indigo_device *device, double delay, indigo_timer **timer) {
 	bool result = false;
-	pthread_mutex_lock(&cancel_timer_mutex);
+	pthread_mutex_lock(&timer_mutex);
 	if (*timer != NULL) {
-		(*timer)->delay = delay;
-		(*timer)->scheduled = true;
-		result = true;
+		indigo_timer *t = *timer;
+		switch (t->state) {
+			case TIMER_RUNNING:
+				// callback reschedules itself, timer is armed again when it returns
+				t->delay = delay;
+				t->scheduled = true;
+				result = true;
+				break;
+			case TIMER_PENDING:
+			case TIMER_DUE:
+			case TIMER_PULSE:
+				wheel_remove(t);
+				arm_timer(t, delay);
+				result = true;
+				break;
+			case TIMER_READY:
+				list_remove(&ready_tail, t);
+				arm_timer(t, delay);
+				result = true;
+				break;
+		}
 	}
-	pthread_mutex_unlock(&cancel_timer_mutex);
+	pthread_mutex_unlock(&timer_mutex);
 	return result;
 }
 
-// TODO: do we need device?
-
 bool indigo_cancel_timer(indigo_device *device, indigo_timer **timer) {
 	bool result = false;
-	pthread_mutex_lock(&cancel_timer_mutex);
+	pthread_mutex_lock(&timer_mutex);
 	if (*timer != NULL) {
-		(*timer)->canceled = true;
-		(*timer)->scheduled = false;
-		pthread_mutex_lock(&(*timer)->mutex);
-		pthread_cond_signal(&(*timer)->cond);
-		pthread_mutex_unlock(&(*timer)->mutex);
+		indigo_timer *t = *timer;
+		switch (t->state) {
+			case TIMER_RUNNING:
+				// callback is running, timer is released when it returns
+				t->canceled = true;
+				t->scheduled = false;
+				break;
+			case TIMER_PENDING:
+			case TIMER_DUE:
+			case TIMER_PULSE:
+				t->canceled = true;
+				wheel_remove(t);
+				release_timer(t);
+				break;
+			case TIMER_READY:
+				t->canceled = true;
+				list_remove(&ready_tail, t);
+				release_timer(t);
+				break;
+		}
 		*timer = NULL;
 		result = true;
 	}
-	pthread_mutex_unlock(&cancel_timer_mutex);
+	pthread_mutex_unlock(&timer_mutex);
 	return result;
 }
 
 void indigo_cancel_all_timers(indigo_device *device) {
-	pthread_mutex_lock(&cancel_timer_mutex);
+	pthread_mutex_lock(&timer_mutex);
 	indigo_timer *timer;
 	while ((timer = DEVICE_CONTEXT->timers) != NULL) {
 		DEVICE_CONTEXT->timers = timer->next;
 		timer->device = NULL;
 		timer->next = NULL;
 		timer->canceled = true;
-		timer->scheduled = true;
-		pthread_mutex_lock(&timer->mutex);
-		pthread_cond_signal(&timer->cond);
-		pthread_mutex_unlock(&timer->mutex);
+		timer->scheduled = false;
+		if (timer->state == TIMER_PENDING || timer->state == TIMER_DUE || timer->state == TIMER_PULSE) {
+			wheel_remove(timer);
+			release_timer(timer);
+		} else if (timer->state == TIMER_READY) {
+			list_remove(&ready_tail, timer);
+			release_timer(timer);
+		}
 	}
-	pthread_mutex_unlock(&cancel_timer_mutex);
+	pthread_mutex_unlock(&timer_mutex);
 }
@@ -125,15 +125,88 @@ static indigo_rule parse_rule(char *value) {
 	return INDIGO_ANY_OF_MANY_RULE;
 }
 
+typedef struct {
+	uint32_t hash;
+	indigo_property *property;
+} property_slot;
+
 typedef struct {
 	char property_buffer[PROPERTY_SIZE];
 	indigo_device *device;
 	indigo_client *client;
 	int count;
 	indigo_property **properties;
+	property_slot *slots;
+	int slot_count;
+	int slot_used;
 } parser_context;
 
 bool indigo_use_blob_urls = true;
+bool indigo_use_fast_xml_parser = true;
+
+static void reset_property(indigo_property *property) {
+	// items past count are never written, so only the used part of the buffer has to be cleared
+	memset(property, 0, sizeof(indigo_property) + property->count * sizeof(indigo_item));
+}
+
+static uint32_t property_hash(const char *device, const char *name) {
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < INDIGO_NAME_SIZE && device[i]; i++)
+		hash = (hash ^ (unsigned char)device[i]) * 16777619u;
+	hash *= 16777619u;
+	for (int i = 0; i < INDIGO_NAME_SIZE && name[i]; i++)
+		hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+	return hash;
+}
+
+static void insert_property_slot(parser_context *context, uint32_t hash, indigo_property *property) {
+	if (2 * (context->slot_used + 1) > context->slot_count) {
+		property_slot *old_slots = context->slots;
+		int old_count = context->slot_count;
+		context->slot_count = old_count ? 2 * old_count : 64;
+		context->slots = calloc(context->slot_count, sizeof(property_slot));
+		assert(context->slots != NULL);
+		context->slot_used = 0;
+		for (int i = 0; i < old_count; i++) {
+			if (old_slots[i].property != NULL)
+				insert_property_slot(context, old_slots[i].hash, old_slots[i].property);
+		}
+		free(old_slots);
+	}
+	uint32_t mask = context->slot_count - 1;
+	uint32_t i = hash & mask;
+	while (context->slots[i].property != NULL)
+		i = (i + 1) & mask;
+	context->slots[i].hash = hash;
+	context->slots[i].property = property;
+	context->slot_used++;
+}
+
+static indigo_property *find_property(parser_context *context, const char *device, const char *name) {
+	uint32_t hash = property_hash(device, name);
+	if (context->slots != NULL) {
+		uint32_t mask = context->slot_count - 1;
+		for (uint32_t i = hash & mask; context->slots[i].property != NULL; i = (i + 1) & mask) {
+			indigo_property *property = context->slots[i].property;
+			if (context->slots[i].hash == hash && !strncmp(property->device, device, INDIGO_NAME_SIZE) && !strncmp(property->name, name, INDIGO_NAME_SIZE))
+				return property;
+		}
+	}
+	for (int index = 0; index < context->count; index++) {
+		indigo_property *property = context->properties[index];
+		if (property != NULL && !strncmp(property->device, device, INDIGO_NAME_SIZE) && !strncmp(property->name, name, INDIGO_NAME_SIZE)) {
+			insert_property_slot(context, hash, property);
+			return property;
+		}
+	}
+	return NULL;
+}
+
+static void forget_property_slots(parser_context *context) {
+	if (context->slots != NULL)
+		memset(context->slots, 0, context->slot_count * sizeof(property_slot));
+	context->slot_used = 0;
+}
 
 typedef void *(* parser_handler)(parser_state state, parser_context *context, char *name, char *value, char *message);
 
@@ -197,7 +270,7 @@ static void *enable_blob_handler(parser_state state, parser_context *context, ch
 			indigo_enable_blob(client, property, INDIGO_ENABLE_BLOB_NEVER);
 		}
 	} else if (state == END_TAG) {
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return enable_blob_handler;
@@ -224,10 +297,16 @@ static void *get_properties_handler(parser_state state, parser_context *context,
 				version = INDIGO_VERSION_2_0;
 			if (version > client->version) {
 				assert(client->client_context != NULL);
-				int handle = ((indigo_adapter_context *)(client->client_context))->output;
-				indigo_printf(handle, "<switchProtocol version='%d.%d'/>\n", (version >> 8) & 0xFF, version & 0xFF);
+				indigo_adapter_context *client_context = (indigo_adapter_context *)client->client_context;
+				pthread_mutex_lock(&client_context->output_mutex);
+				indigo_output_printf(client_context->output_buffer, "<switchProtocol version='%d.%d'/>\n", (version >> 8) & 0xFF, version & 0xFF);
+				indigo_output_flush(client_context->output_buffer);
+				pthread_mutex_unlock(&client_context->output_mutex);
 				client->version = version;
 			}
+		} else if (!strcmp(name, "partial")) {
+			assert(client->client_context != NULL);
+			((indigo_adapter_context *)client->client_context)->partial_updates = !strcmp(value, "true");
 		} else if (!strncmp(name, "device",INDIGO_NAME_SIZE)) {
 			strncpy(property->device, value, INDIGO_NAME_SIZE);
 		} else if (!strncmp(name, "name",INDIGO_NAME_SIZE)) {
@@ -235,12 +314,34 @@ static void *get_properties_handler(parser_state state, parser_context *context,
 		}
 	} else if (state == END_TAG) {
 		indigo_enumerate_properties(client, property);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return get_properties_handler;
 }
 
+static void *update_interval_handler(parser_state state, parser_context *context, char *name, char *value, char *message) {
+	indigo_property *property = (indigo_property *)context->property_buffer;
+	indigo_client *client = context->client;
+	assert(client != NULL);
+	INDIGO_TRACE_PARSER(indigo_trace("XML Parser: update_interval_handler %s '%s' '%s'", parser_state_name[state], name != NULL ? name : "", value != NULL ? value : ""));
+	if (state == ATTRIBUTE_VALUE) {
+		if (!strcmp(name, "device")) {
+			strncpy(property->device, value, INDIGO_NAME_SIZE);
+		} else if (!strcmp(name, "name")) {
+			indigo_copy_property_name(client->version, property, value);
+		} else if (!strcmp(name, "interval")) {
+			property->count = 1;
+			property->items[0].number.value = indigo_atod(value);
+		}
+	} else if (state == END_TAG) {
+		indigo_set_update_interval(client, property->device, property->name, property->count ? property->items[0].number.value : 0);
+		reset_property(property);
+		return top_level_handler;
+	}
+	return update_interval_handler;
+}
+
 static void *new_one_text_vector_handler(parser_state state, parser_context *context, char *name, char *value, char *message) {
 	indigo_property *property = (indigo_property *)context->property_buffer;
 	indigo_client *client = context->client;
@@ -277,7 +378,7 @@ static void *new_text_vector_handler(parser_state state, parser_context *context
 		}
 	} else if (state == END_TAG) {
 		indigo_change_property(client, property);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return new_text_vector_handler;
@@ -319,7 +420,7 @@ static void *new_number_vector_handler(parser_state state, parser_context *conte
 		}
 	} else if (state == END_TAG) {
 		indigo_change_property(client, property);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return new_number_vector_handler;
@@ -362,7 +463,7 @@ static void *new_switch_vector_handler(parser_state state, parser_context *conte
 		return new_switch_vector_handler;
 	} else if (state == END_TAG) {
 		indigo_change_property(client, property);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return new_switch_vector_handler;
@@ -385,69 +486,70 @@ static void *switch_protocol_handler(parser_state state, parser_context *context
 }
 
 static void set_property(parser_context *context, indigo_property *other, char *message) {
-	for (int index = 0; index < context->count; index++) {
-		indigo_property *property = context->properties[index];
-		if (property != NULL && !strncmp(property->device, other->device, INDIGO_NAME_SIZE) && !strncmp(property->name, other->name, INDIGO_NAME_SIZE)) {
-			property->state = other->state;
-			if (property->type == INDIGO_SWITCH_VECTOR && property->rule != INDIGO_ANY_OF_MANY_RULE) {
-				for (int j = 0; j < property->count; j++) {
-					property->items[j].sw.value = false;
-				}
+	indigo_property *property = find_property(context, other->device, other->name);
+	if (property != NULL) {
+		property->state = other->state;
+		if (property->type == INDIGO_SWITCH_VECTOR && property->rule != INDIGO_ANY_OF_MANY_RULE) {
+			for (int j = 0; j < property->count; j++) {
+				property->items[j].sw.value = false;
 			}
-			for (int i = 0; i < other->count; i++) {
-				indigo_item *other_item = &other->items[i];
-				for (int j = 0; j < property->count; j++) {
-					indigo_item *property_item = &property->items[j];
-					if (!strcmp(property_item->name, other_item->name)) {
-						switch (property->type) {
-							case INDIGO_TEXT_VECTOR:
-								strncpy(property_item->text.value, other_item->text.value, INDIGO_VALUE_SIZE);
-								break;
-							case INDIGO_NUMBER_VECTOR:
-								property_item->number.value = other_item->number.value;
-								if (!isnan(other_item->number.min))
-									property_item->number.min = other_item->number.min;
-								if (!isnan(other_item->number.max))
-									property_item->number.max = other_item->number.max;
-								if (!isnan(other_item->number.step))
-									property_item->number.step = other_item->number.step;
-								if (property_item->number.value < property_item->number.min) {
-									//property_item->number.value = property_item->number.min;
-									if (strcmp(property->name, CCD_EXPOSURE_PROPERTY_NAME))
-										indigo_debug("%s.%s value out of range", property->name, property_item->name);
-								}
-								if (property_item->number.value > property_item->number.max) {
-									//property_item->number.value = property_item->number.max;
-									if (strcmp(property->name, CCD_EXPOSURE_PROPERTY_NAME))
-										indigo_debug("%s.%s value out of range", property->name, property_item->name);
-								}
-								property_item->number.target = other_item->number.target;
-								break;
-							case INDIGO_SWITCH_VECTOR:
-								property_item->sw.value = other_item->sw.value;
-								break;
-							case INDIGO_LIGHT_VECTOR:
-								property_item->light.value = other_item->light.value;
-								break;
-							case INDIGO_BLOB_VECTOR:
-								strncpy(property_item->blob.format, other_item->blob.format, INDIGO_NAME_SIZE);
-								strncpy(property_item->blob.url, other_item->blob.url, INDIGO_VALUE_SIZE);
-								property_item->blob.size = other_item->blob.size;
-								if (property_item->blob.value != NULL)
-									property_item->blob.value = realloc(property_item->blob.value, property_item->blob.size);
-								else
-									property_item->blob.value = malloc(property_item->blob.size);
-								memcpy(property_item->blob.value, other_item->blob.value, property_item->blob.size);
-								break;
-						}
-						break;
+		}
+		int next = 0;
+		for (int i = 0; i < other->count; i++) {
+			indigo_item *other_item = &other->items[i];
+			// items usually come in definition order, so start looking right after the previous match
+			for (int k = 0; k < property->count; k++) {
+				int j = next + k < property->count ? next + k : next + k - property->count;
+				indigo_item *property_item = &property->items[j];
+				if (!strcmp(property_item->name, other_item->name)) {
+					next = j + 1;
+					switch (property->type) {
+						case INDIGO_TEXT_VECTOR:
+							strncpy(property_item->text.value, other_item->text.value, INDIGO_VALUE_SIZE);
+							break;
+						case INDIGO_NUMBER_VECTOR:
+							property_item->number.value = other_item->number.value;
+							if (!isnan(other_item->number.min))
+								property_item->number.min = other_item->number.min;
+							if (!isnan(other_item->number.max))
+								property_item->number.max = other_item->number.max;
+							if (!isnan(other_item->number.step))
+								property_item->number.step = other_item->number.step;
+							if (property_item->number.value < property_item->number.min) {
+								//property_item->number.value = property_item->number.min;
+								if (strcmp(property->name, CCD_EXPOSURE_PROPERTY_NAME))
+									indigo_debug("%s.%s value out of range", property->name, property_item->name);
+							}
+							if (property_item->number.value > property_item->number.max) {
+								//property_item->number.value = property_item->number.max;
+								if (strcmp(property->name, CCD_EXPOSURE_PROPERTY_NAME))
+									indigo_debug("%s.%s value out of range", property->name, property_item->name);
+							}
+							property_item->number.target = other_item->number.target;
+							break;
+						case INDIGO_SWITCH_VECTOR:
+							property_item->sw.value = other_item->sw.value;
+							break;
+						case INDIGO_LIGHT_VECTOR:
+							property_item->light.value = other_item->light.value;
+							break;
+						case INDIGO_BLOB_VECTOR:
+							strncpy(property_item->blob.format, other_item->blob.format, INDIGO_NAME_SIZE);
+							strncpy(property_item->blob.url, other_item->blob.url, INDIGO_VALUE_SIZE);
+							property_item->blob.size = other_item->blob.size;
+							if (property_item->blob.value != NULL)
+								property_item->blob.value = realloc(property_item->blob.value, property_item->blob.size);
+							else
+								property_item->blob.value = malloc(property_item->blob.size);
+							memcpy(property_item->blob.value, other_item->blob.value, property_item->blob.size);
+							break;
 					}
+					break;
 				}
 			}
-			INDIGO_TRACE_PARSER(indigo_trace("XML Parser: set_property '%s' '%s' %d", property->device, property->name, index));
-			indigo_update_property(context->device, property, *message ? message : NULL);
-			break;
 		}
+		INDIGO_TRACE_PARSER(indigo_trace("XML Parser: set_property '%s' '%s'", property->device, property->name));
+		indigo_update_property(context->device, property, *message ? message : NULL);
 	}
 }
 
@@ -492,7 +594,7 @@ static void *set_text_vector_handler(parser_state state, parser_context *context
 		}
 	} else if (state == END_TAG) {
 		set_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return set_text_vector_handler;
@@ -553,7 +655,7 @@ static void *set_number_vector_handler(parser_state state, parser_context *conte
 		}
 	} else if (state == END_TAG) {
 		set_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return set_number_vector_handler;
@@ -600,7 +702,7 @@ static void *set_switch_vector_handler(parser_state state, parser_context *conte
 		}
 	} else if (state == END_TAG) {
 		set_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return set_switch_vector_handler;
@@ -647,7 +749,7 @@ static void *set_light_vector_handler(parser_state state, parser_context *contex
 		}
 	} else if (state == END_TAG) {
 		set_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return set_light_vector_handler;
@@ -705,7 +807,7 @@ static void *set_blob_vector_handler(parser_state state, parser_context *context
 		}
 	} else if (state == END_TAG) {
 		set_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return set_blob_vector_handler;
@@ -817,7 +919,7 @@ static void *def_text_vector_handler(parser_state state, parser_context *context
 		}
 	} else if (state == END_TAG) {
 		def_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return def_text_vector_handler;
@@ -886,7 +988,7 @@ static void *def_number_vector_handler(parser_state state, parser_context *conte
 		}
 	} else if (state == END_TAG) {
 		def_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return def_number_vector_handler;
@@ -947,7 +1049,7 @@ static void *def_switch_vector_handler(parser_state state, parser_context *conte
 		}
 	} else if (state == END_TAG) {
 		def_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return def_switch_vector_handler;
@@ -1004,7 +1106,7 @@ static void *def_light_vector_handler(parser_state state, parser_context *contex
 		}
 	} else if (state == END_TAG) {
 		def_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return def_light_vector_handler;
@@ -1065,7 +1167,7 @@ static void *def_blob_vector_handler(parser_state state, parser_context *context
 		}
 	} else if (state == END_TAG) {
 		def_property(context, property, message);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return def_blob_vector_handler;
@@ -1087,6 +1189,7 @@ static void *del_property_handler(parser_state state, parser_context *context, c
 			strncpy(message, value, INDIGO_VALUE_SIZE);
 		}
 	} else if (state == END_TAG) {
+		forget_property_slots(context);
 		if (*property->name) {
 			for (int i = 0; i < context->count; i++) {
 				indigo_property *tmp = context->properties[i];
@@ -1107,7 +1210,7 @@ static void *del_property_handler(parser_state state, parser_context *context, c
 				}
 			}
 		}
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return del_property_handler;
@@ -1128,7 +1231,7 @@ static void *message_handler(parser_state state, parser_context *context, char *
 		}
 	} else if (state == END_TAG) {
 		indigo_send_message(device, *message ? message : NULL);
-		memset(property, 0, PROPERTY_SIZE);
+		reset_property(property);
 		return top_level_handler;
 	}
 	return message_handler;
@@ -1144,6 +1247,8 @@ static void *top_level_handler(parser_state state, parser_context *context, char
 			return enable_blob_handler;
 		if (!strcmp(name, "getProperties") && client != NULL)
 			return get_properties_handler;
+		if (!strcmp(name, "updateInterval") && client != NULL)
+			return update_interval_handler;
 		if (!strcmp(name, "newTextVector")) {
 			property->type = INDIGO_TEXT_VECTOR;
 			return new_text_vector_handler;
@@ -1206,33 +1311,258 @@ static void *top_level_handler(parser_state state, parser_context *context, char
 	return top_level_handler;
 }
 
-void indigo_xml_parse(indigo_device *device, indigo_client *client) {
-	char *buffer = malloc(BUFFER_SIZE+3); /* BUFFER_SIZE % 4 == 0 and keep always +3 for base64 alignmet */
-	assert(buffer != NULL);
-	char *value_buffer = malloc(BUFFER_SIZE+1); /* +1 to accomodate \0" */
-	assert(value_buffer != NULL);
+#define MAX_TOKENS	2048
+
+typedef struct {
+	parser_state type; ///< BEGIN_TAG, ATTRIBUTE_VALUE, TEXT or END_TAG
+	char *name;
+	int name_length;
+	char *value;
+	long value_length;
+} xml_token;
+
+struct indigo_xml_parser {
+	parser_context *context;
+	parser_handler handler;
+	parser_state state;
+	int depth;
+	char q;
 	char name_buffer[INDIGO_NAME_SIZE];
-	unsigned char *blob_buffer = NULL;
-	char *pointer = buffer;
-	char *buffer_end = NULL;
-	char *name_pointer = name_buffer;
-	char *value_pointer = value_buffer;
-	unsigned char *blob_pointer = NULL;
-	long blob_size = 0;
+	char *name_pointer;
+	char *value_buffer;
+	char *value_pointer;
 	char message[INDIGO_VALUE_SIZE];
-	char q = '"';
-	int depth = 0;
-	char c = 0;
 	char entity_buffer[8];
-	char *entity_pointer = NULL;
-	bool is_escaped = false;
-	/* (void)parser_state_name; */
+	char *entity_pointer;
+	bool is_escaped;
+	indigo_property *property;
+	unsigned char *blob_buffer;
+	unsigned char *blob_pointer;
+	long blob_size;
+	long blob_remaining;
+	unsigned char blob_carry[4];
+	int blob_carry_count;
+	int handle;
+	xml_token tokens[MAX_TOKENS];
+};
+
+static char *decode_blob(indigo_xml_parser *parser, char *pointer, char *buffer_end) {
+	long available = buffer_end - pointer;
+	if (available > parser->blob_remaining)
+		available = parser->blob_remaining;
+	parser->blob_remaining -= available;
+	if (parser->blob_carry_count > 0) {
+		while (parser->blob_carry_count < 4 && available > 0) {
+			parser->blob_carry[parser->blob_carry_count++] = *pointer++;
+			available--;
+		}
+		if (parser->blob_carry_count < 4)
+			return pointer;
+		parser->blob_pointer += base64_decode_fast(parser->blob_pointer, parser->blob_carry, 4);
+		parser->blob_carry_count = 0;
+	}
+	long len = available & ~3L;
+	if (len > 0) {
+		parser->blob_pointer += base64_decode_fast(parser->blob_pointer, (unsigned char *)pointer, len);
+		pointer += len;
+		available -= len;
+	}
+	while (available-- > 0) // base64 quadruple split between chunks
+		parser->blob_carry[parser->blob_carry_count++] = *pointer++;
+	return pointer;
+}
+
+static bool valid_entities(char *pointer, char *end) {
+	while ((pointer = memchr(pointer, '&', end - pointer)) != NULL) {
+		char *semicolon = memchr(pointer, ';', end - pointer);
+		if (semicolon == NULL)
+			return false;
+		pointer++;
+		switch (semicolon - pointer) {
+			case 2:
+				if (strncmp(pointer, "lt", 2) && strncmp(pointer, "gt", 2))
+					return false;
+				break;
+			case 3:
+				if (strncmp(pointer, "amp", 3))
+					return false;
+				break;
+			case 4:
+				if (strncmp(pointer, "quot", 4) && strncmp(pointer, "apos", 4))
+					return false;
+				break;
+			default:
+				return false;
+		}
+		pointer = semicolon + 1;
+	}
+	return true;
+}
+
+static long copy_value(char *buffer, long size, char *value, long length) {
+	char *end = value + length;
+	char *out = buffer;
+	while (value < end && out - buffer < size) {
+		char c = *value++;
+		if (c == '&') {
+			switch (*value) {
+				case 'l':
+					c = '<';
+					value += 3;
+					break;
+				case 'g':
+					c = '>';
+					value += 3;
+					break;
+				case 'q':
+					c = '"';
+					value += 5;
+					break;
+				default:
+					if (value[1] == 'm') {
+						c = '&';
+						value += 4;
+					} else {
+						c = '\'';
+						value += 5;
+					}
+					break;
+			}
+		}
+		*out++ = c;
+	}
+	*out = 0;
+	return out - buffer;
+}
 
-	parser_handler handler = top_level_handler;
+/* Split one complete top level element starting at '<' into tokens, without calling any handler. Returns the number
+ of tokens and sets *next past the element, or returns 0 if the element is incomplete or uses anything the byte by
+ byte parser would treat in a special way (header, BLOB payload, unknown entities, sloppy syntax).
+ */
+static int scan_message(indigo_xml_parser *parser, char *pointer, char *end, char **next) {
+	xml_token *tokens = parser->tokens;
+	int count = 0;
+	int depth = 0;
+	while (true) {
+		if (++pointer >= end || count == MAX_TOKENS)
+			return 0;
+		if (*pointer == '/') {
+			while (++pointer < end && isalpha(*pointer))
+				;
+			if (pointer >= end || *pointer != '>' || depth == 0)
+				return 0;
+			pointer++;
+			tokens[count++].type = END_TAG;
+		} else {
+			char *name = pointer;
+			while (pointer < end && isalpha(*pointer))
+				pointer++;
+			if (pointer == name || pointer - name >= INDIGO_NAME_SIZE)
+				return 0;
+			if (depth == 0 && pointer - name == 13 && !strncmp(name, "setBLOBVector", 13))
+				return 0;
+			tokens[count++] = (xml_token){ BEGIN_TAG, name, (int)(pointer - name), NULL, 0 };
+			depth++;
+			while (true) {
+				while (pointer < end && isspace(*pointer))
+					pointer++;
+				if (pointer >= end)
+					return 0;
+				if (!isalpha(*pointer))
+					break;
+				name = pointer;
+				while (pointer < end && isalpha(*pointer))
+					pointer++;
+				if (pointer + 1 >= end || pointer - name >= INDIGO_NAME_SIZE || *pointer != '=' || (pointer[1] != '"' && pointer[1] != '\''))
+					return 0;
+				char *value = pointer + 2;
+				pointer = memchr(value, pointer[1], end - value);
+				if (pointer == NULL || count == MAX_TOKENS || !valid_entities(value, pointer))
+					return 0;
+				tokens[count++] = (xml_token){ ATTRIBUTE_VALUE, name, (int)(value - name - 2), value, pointer - value };
+				pointer++;
+			}
+			if (*pointer == '/') {
+				if (++pointer >= end || *pointer != '>' || count == MAX_TOKENS)
+					return 0;
+				pointer++;
+				tokens[count++].type = END_TAG;
+			} else if (*pointer == '>') {
+				char *value = ++pointer;
+				pointer = memchr(value, '<', end - value);
+				if (pointer == NULL || count == MAX_TOKENS || !valid_entities(value, pointer))
+					return 0;
+				tokens[count++] = (xml_token){ TEXT, NULL, 0, value, pointer - value };
+				continue;
+			} else {
+				return 0;
+			}
+		}
+		if (--depth == 0)
+			break;
+		char *value = pointer;
+		pointer = memchr(value, '<', end - value);
+		if (pointer == NULL || memchr(value, '&', pointer - value))
+			return 0;
+	}
+	*next = pointer;
+	return count;
+}
 
-	parser_state state = IDLE;
+/* Feed tokens of one element to the handler chain exactly as the byte by byte parser would.
+ */
+static void replay_message(indigo_xml_parser *parser, int count) {
+	for (xml_token *token = parser->tokens; token < parser->tokens + count; token++) {
+		switch (token->type) {
+			case BEGIN_TAG:
+				memcpy(parser->name_buffer, token->name, token->name_length);
+				parser->name_buffer[token->name_length] = 0;
+				parser->depth++;
+				parser->handler = parser->handler(BEGIN_TAG, parser->context, parser->name_buffer, NULL, parser->message);
+				break;
+			case ATTRIBUTE_VALUE:
+				memcpy(parser->name_buffer, token->name, token->name_length);
+				parser->name_buffer[token->name_length] = 0;
+				copy_value(parser->value_buffer, BUFFER_SIZE, token->value, token->value_length);
+				parser->handler = parser->handler(ATTRIBUTE_VALUE, parser->context, parser->name_buffer, parser->value_buffer, parser->message);
+				break;
+			case TEXT:
+				if (parser->depth == 2 || parser->handler == enable_blob_handler) {
+					char *value = parser->value_buffer;
+					char *last = value + copy_value(value, INDIGO_VALUE_SIZE, token->value, token->value_length) - 1;
+					while (last >= value && isspace(*last))
+						*last-- = 0;
+					while (*value && isspace(*value))
+						value++;
+					parser->handler = parser->handler(TEXT, parser->context, NULL, value, parser->message);
+				}
+				break;
+			case END_TAG:
+				parser->handler = parser->handler(END_TAG, parser->context, NULL, NULL, parser->message);
+				parser->depth--;
+				break;
+			default:
+				break;
+		}
+	}
+	parser->name_pointer = parser->name_buffer;
+	parser->value_pointer = parser->value_buffer;
+}
 
-	parser_context *context = malloc(sizeof(parser_context));
+indigo_xml_parser *indigo_xml_parser_create(indigo_device *device, indigo_client *client) {
+	indigo_xml_parser *parser = malloc(sizeof(indigo_xml_parser));
+	assert(parser != NULL);
+	memset(parser, 0, sizeof(indigo_xml_parser));
+	parser->value_buffer = malloc(BUFFER_SIZE+1); /* +1 to accomodate \0" */
+	assert(parser->value_buffer != NULL);
+	parser->name_pointer = parser->name_buffer;
+	parser->value_pointer = parser->value_buffer;
+	parser->q = '"';
+	parser->handler = top_level_handler;
+	parser->state = IDLE;
+	parser->blob_remaining = -1;
+	parser_context *context = parser->context = malloc(sizeof(parser_context));
+	assert(context != NULL);
 	context->client = client;
 	context->device = device;
 	if (device != NULL) {
@@ -1243,127 +1573,129 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 		context->count = 0;
 		context->properties = NULL;
 	}
-
-	indigo_property *property = (indigo_property *)&context->property_buffer;
+	context->slots = NULL;
+	context->slot_count = context->slot_used = 0;
+	parser->property = (indigo_property *)&context->property_buffer;
 	memset(context->property_buffer, 0, PROPERTY_SIZE);
-
-	int handle = 0;
 	if (device != NULL) {
-		handle = ((indigo_adapter_context *)device->device_context)->input;
+		parser->handle = ((indigo_adapter_context *)device->device_context)->input;
 		device->enumerate_properties(device, client, NULL);
 	} else {
-		handle = ((indigo_adapter_context *)client->client_context)->input;
+		parser->handle = ((indigo_adapter_context *)client->client_context)->input;
 	}
-	*pointer = 0;
-	while (true) {
-		assert(pointer - buffer <= BUFFER_SIZE);
-		assert(value_pointer - value_buffer <= BUFFER_SIZE);
-		assert(name_pointer - name_buffer <= INDIGO_NAME_SIZE);
-		if (state == ERROR) {
-			indigo_error("XML Parser: syntax error");
-			goto exit_loop;
-		}
-		while ((c = *pointer++) == 0) {
-#if defined(INDIGO_WINDOWS)
-			ssize_t count = indigo_recv(handle, (void *)buffer, (ssize_t)BUFFER_SIZE);
-#else
-			ssize_t count = (int)read(handle, (void *)buffer, (ssize_t)BUFFER_SIZE);
-#endif
-			if (count <= 0) {
-				goto exit_loop;
-			}
-			pointer = buffer;
-			buffer_end = buffer + count;
-			buffer[count] = 0;
-			INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", handle, buffer));
-		}
+	return parser;
+}
+
+bool indigo_xml_parser_feed(indigo_xml_parser *parser, char *data, long length) {
+	char *pointer = data;
+	char *buffer_end = data + length;
+	char c = 0;
+	char *scan_end = NULL;
+	while (pointer < buffer_end && (c = *pointer++) != 0) {
+		assert(parser->value_pointer - parser->value_buffer <= BUFFER_SIZE);
+		assert(parser->name_pointer - parser->name_buffer <= INDIGO_NAME_SIZE);
+		if (parser->state == ERROR)
+			break;
 		if (c == '&') {
-			entity_pointer = entity_buffer;
+			parser->entity_pointer = parser->entity_buffer;
 			continue;
 		}
-		if (entity_pointer != NULL) {
+		if (parser->entity_pointer != NULL) {
 			if (c == ';') {
-				*entity_pointer++ = 0;
-				if (!strcmp(entity_buffer, "amp"))
+				*parser->entity_pointer++ = 0;
+				if (!strcmp(parser->entity_buffer, "amp"))
 					c = '&';
-				else if (!strcmp(entity_buffer, "lt"))
+				else if (!strcmp(parser->entity_buffer, "lt"))
 					c = '<';
-				else if (!strcmp(entity_buffer, "gt"))
+				else if (!strcmp(parser->entity_buffer, "gt"))
 					c = '>';
-				else if (!strcmp(entity_buffer, "quot"))
+				else if (!strcmp(parser->entity_buffer, "quot"))
 					c = '"';
-				else if (!strcmp(entity_buffer, "apos"))
+				else if (!strcmp(parser->entity_buffer, "apos"))
 					c = '\'';
-				entity_pointer = NULL;
-				is_escaped = true;
-			} else if (isalpha(c) && entity_pointer - entity_buffer < sizeof(entity_buffer)) {
-				*entity_pointer++ = c;
+				parser->entity_pointer = NULL;
+				parser->is_escaped = true;
+			} else if (isalpha(c) && parser->entity_pointer - parser->entity_buffer < sizeof(parser->entity_buffer)) {
+				*parser->entity_pointer++ = c;
 				continue;
 			} else {
-				INDIGO_TRACE_PARSER(indigo_trace("XML Parser: invalid entity '&%s%c...'", entity_buffer, c));
+				INDIGO_TRACE_PARSER(indigo_trace("XML Parser: invalid entity '&%s%c...'", parser->entity_buffer, c));
 				continue;
 			}
 		} else {
-			is_escaped = false;
+			parser->is_escaped = false;
 		}
-		switch (state) {
+		switch (parser->state) {
 			case IDLE:
 				if (c == '<') {
-					state = BEGIN_TAG1;
+					if (indigo_use_fast_xml_parser && !parser->is_escaped && parser->depth == 0) {
+						// whole elements available in the buffer are tokenized with memchr and replayed to the handlers
+						char *next;
+						if (scan_end == NULL && (scan_end = memchr(data, 0, length)) == NULL)
+							scan_end = buffer_end;
+						int count = scan_message(parser, pointer - 1, scan_end, &next);
+						if (count > 0) {
+							INDIGO_TRACE_PARSER(indigo_trace("XML Parser: %d tokens scanned", count));
+							replay_message(parser, count);
+							pointer = next;
+							break;
+						}
+					}
+					parser->state = BEGIN_TAG1;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' IDLE -> BEGIN_TAG1", c));
 				}
 				break;
 			case BEGIN_TAG1:
 				if (c == '?') {
-					state = HEADER;
+					parser->state = HEADER;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG1 -> HEADER", c));
 				} else {
-					name_pointer = name_buffer;
+					parser->name_pointer = parser->name_buffer;
 					if (isalpha(c)) {
-						*name_pointer++ = c;
-						state = BEGIN_TAG;
+						*parser->name_pointer++ = c;
+						parser->state = BEGIN_TAG;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG1 -> BEGIN_TAG", c));
 					} else if (c == '/') {
-						state = END_TAG;
+						parser->state = END_TAG;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG1 -> END_TAG", c));
 					}
 				}
 				break;
 			case HEADER:
 				if (c == '?') {
-					state = HEADER1;
+					parser->state = HEADER1;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' HEADER -> HEADER1", c));
 				}
 				break;
 			case HEADER1:
 				if (c == '>') {
-					state = IDLE;
+					parser->state = IDLE;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' HEADER1 -> IDLE", c));
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' HEADER1 -> ERROR", c));
 				}
 				break;
 			case BEGIN_TAG:
-				if (name_pointer - name_buffer <INDIGO_NAME_SIZE && isalpha(c)) {
-					*name_pointer++ = c;
+				if (parser->name_pointer - parser->name_buffer <INDIGO_NAME_SIZE && isalpha(c)) {
+					*parser->name_pointer++ = c;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG", c));
 				} else {
-					*name_pointer = 0;
-					depth++;
-					handler = handler(BEGIN_TAG, context, name_buffer, NULL, message);
+					*parser->name_pointer = 0;
+					parser->depth++;
+					parser->handler = parser->handler(BEGIN_TAG, parser->context, parser->name_buffer, NULL, parser->message);
 					if (isspace(c)) {
-						state = ATTRIBUTE_NAME1;
+						parser->state = ATTRIBUTE_NAME1;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG -> ATTRIBUTE_NAME1", c));
 					} else if (c == '/') {
-						state = END_TAG1;
+						parser->state = END_TAG1;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG -> END_TAG1", c));
 					} else if (c == '>') {
-						state = TEXT;
-						value_pointer = value_buffer;
+						parser->state = TEXT;
+						parser->value_pointer = parser->value_buffer;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BEGIN_TAG -> TEXT", c));
 					} else {
-						state = ERROR;
+						parser->state = ERROR;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' error BEGIN_TAG", c));
 					}
 				}
@@ -1371,20 +1703,20 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 			case END_TAG1:
 				if (c == '>') {
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' END_TAG1 -> IDLE", c));
-					handler = handler(END_TAG, context, NULL, NULL, message);
-					depth--;
-					state = IDLE;
+					parser->handler = parser->handler(END_TAG, parser->context, NULL, NULL, parser->message);
+					parser->depth--;
+					parser->state = IDLE;
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' error END_TAG1", c));
 				}
 				break;
 			case END_TAG2:
 				if (c == '/') {
-					state = END_TAG;
+					parser->state = END_TAG;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' END_TAG2 -> END_TAG", c));
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' error END_TAG2", c));
 				}
 				break;
@@ -1392,128 +1724,96 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 				if (isalpha(c)) {
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' END_TAG", c));
 				} else if (c == '>') {
-					handler = handler(END_TAG, context, NULL, NULL, message);
-					depth--;
-					state = IDLE;
+					parser->handler = parser->handler(END_TAG, parser->context, NULL, NULL, parser->message);
+					parser->depth--;
+					parser->state = IDLE;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' END_TAG -> IDLE", c));
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' error END_TAG", c));
 				}
 				break;
 			case TEXT:
-				if (c == '<' && !is_escaped) {
-					if (depth == 2 || handler == enable_blob_handler) {
-						*value_pointer-- = 0;
-						while (value_pointer >= value_buffer && isspace(*value_pointer))
-							*value_pointer-- = 0;
-						value_pointer = value_buffer;
-						while (*value_pointer && isspace(*value_pointer))
-							value_pointer++;
-						handler = handler(TEXT, context, NULL, value_pointer, message);
+				if (c == '<' && !parser->is_escaped) {
+					if (parser->depth == 2 || parser->handler == enable_blob_handler) {
+						*parser->value_pointer-- = 0;
+						while (parser->value_pointer >= parser->value_buffer && isspace(*parser->value_pointer))
+							*parser->value_pointer-- = 0;
+						parser->value_pointer = parser->value_buffer;
+						while (*parser->value_pointer && isspace(*parser->value_pointer))
+							parser->value_pointer++;
+						parser->handler = parser->handler(TEXT, parser->context, NULL, parser->value_pointer, parser->message);
 					}
-					state = TEXT1;
-					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d TEXT -> TEXT1", c, depth));
+					parser->state = TEXT1;
+					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d TEXT -> TEXT1", c, parser->depth));
 					break;
 				} else {
-					if (depth == 2 || handler == enable_blob_handler) {
-						if (value_pointer - value_buffer < INDIGO_VALUE_SIZE) {
-							*value_pointer++ = c;
+					if (parser->depth == 2 || parser->handler == enable_blob_handler) {
+						if (parser->value_pointer - parser->value_buffer < INDIGO_VALUE_SIZE) {
+							*parser->value_pointer++ = c;
 						}
 					}
-					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d TEXT", c, depth));
+					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d TEXT", c, parser->depth));
 				}
 				break;
 			case TEXT1:
 				if (c=='/') {
-					state = END_TAG;
+					parser->state = END_TAG;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' TEXT -> END_TAG", c));
 				} else if (isalpha(c)) {
-					name_pointer = name_buffer;
-					*name_pointer++ = c;
-					state = BEGIN_TAG;
+					parser->name_pointer = parser->name_buffer;
+					*parser->name_pointer++ = c;
+					parser->state = BEGIN_TAG;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' TEXT -> BEGIN_TAG", c));
 				}
 				break;
 			case BLOB_END:
 				if (c == '<') {
-					state = TEXT1;
+					parser->state = TEXT1;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' BLOB_END -> TEXT1", c));
 				}
-				*name_pointer++ = c;
+				*parser->name_pointer++ = c;
 				break;
 			case BLOB:
-				if (device->version >= INDIGO_VERSION_2_0) {
-					ssize_t count;
+				if (parser->context->device->version >= INDIGO_VERSION_2_0) {
 					pointer--;
-					while (isspace(*pointer)) pointer++;
-					unsigned long blob_len = (blob_size + 2) / 3 * 4;
-					unsigned long len = (long)(buffer_end - pointer);
-					len = (len < blob_len) ? len : blob_len;
-					ssize_t bytes_needed = len % 4;
-					if(bytes_needed) bytes_needed = 4 - bytes_needed;
-					while (bytes_needed) {
-#if defined(INDIGO_WINDOWS)
-						count = indigo_recv(handle, (void *)buffer_end, bytes_needed);
-#else
-						count = (int)read(handle, (void *)buffer_end, bytes_needed);
-#endif
-						if (count <= 0)
-							goto exit_loop;
-						len += count;
-						bytes_needed -= count;
-						buffer_end += count;
+					if (parser->blob_remaining < 0) {
+						while (pointer < buffer_end && isspace(*pointer))
+							pointer++;
+						if (pointer == buffer_end)
+							break;
+						parser->blob_remaining = (parser->blob_size + 2) / 3 * 4;
 					}
-					blob_pointer += base64_decode_fast((unsigned char*)blob_pointer, (unsigned char*)pointer, len);
-					pointer += len;
-					blob_len -= len;
-					while(blob_len) {
-						len = ((BUFFER_SIZE) < blob_len) ? (BUFFER_SIZE) : blob_len;
-						ssize_t to_read = len;
-						char *ptr = buffer;
-						while(to_read) {
-#if defined(INDIGO_WINDOWS)
-							count = indigo_recv(handle, (void *)ptr, to_read);
-#else
-							count = (int)read(handle, (void *)ptr, to_read);
-#endif
-							if (count <= 0)
-								goto exit_loop;
-							ptr += count;
-							to_read -= count;
-						}
-						blob_pointer += base64_decode_fast((unsigned char*)blob_pointer, (unsigned char*)buffer, len);
-						blob_len -= len;
+					pointer = decode_blob(parser, pointer, buffer_end);
+					if (parser->blob_remaining == 0) {
+						parser->blob_remaining = -1;
+						parser->handler = parser->handler(BLOB, parser->context, NULL, (char *)parser->blob_buffer, parser->message);
+						parser->state = BLOB_END;
+						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB -> BLOB_END", c, parser->depth));
 					}
-
-					handler = handler(BLOB, context, NULL, (char *)blob_buffer, message);
-					pointer = buffer;
-					*pointer = 0;
-					state = BLOB_END;
-					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB -> BLOB_END", c, depth));
 					break;
 				} else {
 					if (c == '<') {
-						if (depth == 2) {
-							*value_pointer = 0;
-							blob_pointer += base64_decode_fast((unsigned char*)blob_pointer, (unsigned char*)value_buffer, (int)(value_pointer-value_buffer));
-							handler = handler(BLOB, context, NULL, (char *)blob_buffer, message);
+						if (parser->depth == 2) {
+							*parser->value_pointer = 0;
+							parser->blob_pointer += base64_decode_fast((unsigned char*)parser->blob_pointer, (unsigned char*)parser->value_buffer, (int)(parser->value_pointer-parser->value_buffer));
+							parser->handler = parser->handler(BLOB, parser->context, NULL, (char *)parser->blob_buffer, parser->message);
 						}
-						state = TEXT1;
-						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB -> TEXT1", c, depth));
+						parser->state = TEXT1;
+						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB -> TEXT1", c, parser->depth));
 						break;
 					} else if (c != '\n') {
-						if (depth == 2) {
-							if (value_pointer - value_buffer < BUFFER_SIZE) {
-								*value_pointer++ = c;
+						if (parser->depth == 2) {
+							if (parser->value_pointer - parser->value_buffer < BUFFER_SIZE) {
+								*parser->value_pointer++ = c;
 							} else {
-								*value_pointer = 0;
-								blob_pointer += base64_decode_fast((unsigned char*)blob_pointer, (unsigned char*)value_buffer, (int)(value_pointer-value_buffer));
-								value_pointer = value_buffer;
-								*value_pointer++ = c;
+								*parser->value_pointer = 0;
+								parser->blob_pointer += base64_decode_fast((unsigned char*)parser->blob_pointer, (unsigned char*)parser->value_buffer, (int)(parser->value_pointer-parser->value_buffer));
+								parser->value_pointer = parser->value_buffer;
+								*parser->value_pointer++ = c;
 							}
 						}
-						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB", c, depth));
+						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' %d BLOB", c, parser->depth));
 					}
 				}
 				break;
@@ -1521,46 +1821,46 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 				if (isspace(c)) {
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME1", c));
 				} else if (isalpha(c)) {
-					name_pointer = name_buffer;
-					*name_pointer++ = c;
-					state = ATTRIBUTE_NAME;
+					parser->name_pointer = parser->name_buffer;
+					*parser->name_pointer++ = c;
+					parser->state = ATTRIBUTE_NAME;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME1 -> ATTRIBUTE_NAME", c));
 				} else if (c == '/') {
-					state = END_TAG1;
+					parser->state = END_TAG1;
 				} else if (c == '>') {
-					value_pointer = value_buffer;
-					if (handler == set_one_blob_vector_handler) {
-						blob_size = property->items[property->count-1].blob.size;
-						if (blob_size > 0) {
-							state = BLOB;
-							if (blob_buffer != NULL) {
-								unsigned char *ptmp = realloc(blob_buffer, blob_size + 3); /* +3 to handle indi - reason unknown */
+					parser->value_pointer = parser->value_buffer;
+					if (parser->handler == set_one_blob_vector_handler) {
+						parser->blob_size = parser->property->items[parser->property->count-1].blob.size;
+						if (parser->blob_size > 0) {
+							parser->state = BLOB;
+							if (parser->blob_buffer != NULL) {
+								unsigned char *ptmp = realloc(parser->blob_buffer, parser->blob_size + 3); /* +3 to handle indi - reason unknown */
 								assert(ptmp != NULL);
-								blob_buffer = ptmp;
+								parser->blob_buffer = ptmp;
 							} else {
-								blob_buffer = malloc(blob_size + 3); /* +3 to handle indi - reason unknown */
-								assert(blob_buffer != NULL);
+								parser->blob_buffer = malloc(parser->blob_size + 3); /* +3 to handle indi - reason unknown */
+								assert(parser->blob_buffer != NULL);
 							}
-							blob_pointer = blob_buffer;
+							parser->blob_pointer = parser->blob_buffer;
 						} else {
-							state = TEXT;
+							parser->state = TEXT;
 						}
 					} else
-						state = TEXT;
+						parser->state = TEXT;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME1 -> TEXT", c));
 				} else {
-					state = ERROR;
+					parser->state = ERROR;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' error ATTRIBUTE_NAME1", c));
 				}
 				break;
 			case ATTRIBUTE_NAME:
-				if (name_pointer - name_buffer <INDIGO_NAME_SIZE && isalpha(c)) {
-					*name_pointer++ = c;
+				if (parser->name_pointer - parser->name_buffer <INDIGO_NAME_SIZE && isalpha(c)) {
+					*parser->name_pointer++ = c;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME", c));
 				} else {
-					*name_pointer = 0;
+					*parser->name_pointer = 0;
 					if (c == '=') {
-						state = ATTRIBUTE_VALUE1;
+						parser->state = ATTRIBUTE_VALUE1;
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME -> ATTRIBUTE_VALUE1", c));
 					} else {
 						INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_NAME", c));
@@ -1569,22 +1869,22 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 				break;
 			case ATTRIBUTE_VALUE1:
 				if (c == '"' || c == '\'') {
-					q = c;
-					value_pointer = value_buffer;
-					state = ATTRIBUTE_VALUE;
+					parser->q = c;
+					parser->value_pointer = parser->value_buffer;
+					parser->state = ATTRIBUTE_VALUE;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_VALUE1 -> ATTRIBUTE_VALUE2", c));
 				} else {
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_VALUE1", c));
 				}
 				break;
 			case ATTRIBUTE_VALUE:
-				if (c == q && !is_escaped) {
-					*value_pointer = 0;
-					state = ATTRIBUTE_NAME1;
-					handler = handler(ATTRIBUTE_VALUE, context, name_buffer, value_buffer, message);
+				if (c == parser->q && !parser->is_escaped) {
+					*parser->value_pointer = 0;
+					parser->state = ATTRIBUTE_NAME1;
+					parser->handler = parser->handler(ATTRIBUTE_VALUE, parser->context, parser->name_buffer, parser->value_buffer, parser->message);
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_VALUE -> ATTRIBUTE_NAME1", c));
 				} else {
-					*value_pointer++ = c;
+					*parser->value_pointer++ = c;
 					INDIGO_TRACE_PARSER(indigo_trace("XML Parser: '%c' ATTRIBUTE_VALUE", c));
 				}
 				break;
@@ -1592,12 +1892,19 @@ void indigo_xml_parse(indigo_device *device, indigo_client *client) {
 				break;
 		}
 	}
-exit_loop:
+	if (parser->state == ERROR) {
+		indigo_error("XML Parser: syntax error");
+		return false;
+	}
+	return true;
+}
+
+void indigo_xml_parser_release(indigo_xml_parser *parser) {
 	while (true) {
 		indigo_property *property = NULL;
 		int index;
-		for (index = 0; index < context->count; index++) {
-			property = context->properties[index];
+		for (index = 0; index < parser->context->count; index++) {
+			property = parser->context->properties[index];
 			if (property != NULL)
 				break;
 		}
@@ -1609,8 +1916,8 @@ exit_loop:
 		indigo_property *all_properties = indigo_init_text_property(NULL, remote_device.name, "", "", "", INDIGO_OK_STATE, INDIGO_RO_PERM, 0);
 		indigo_delete_property(&remote_device, all_properties, NULL);
 		indigo_release_property(all_properties);
-		for (; index < context->count; index++) {
-			indigo_property *property = context->properties[index];
+		for (; index < parser->context->count; index++) {
+			indigo_property *property = parser->context->properties[index];
 			if (property != NULL && !strncmp(remote_device.name, property->device, INDIGO_NAME_SIZE)) {
 				if (property->type == INDIGO_BLOB_VECTOR) {
 					for (int i = 0; i < property->count; i++) {
@@ -1620,25 +1927,46 @@ exit_loop:
 					}
 				}
 				indigo_release_property(property);
-				context->properties[index] = NULL;
+				parser->context->properties[index] = NULL;
 			}
 		}
 	}
-	if (blob_buffer != NULL)
-		free(blob_buffer);
-	if (context->properties)
-		free(context->properties);
-	free(context);
+	if (parser->blob_buffer != NULL)
+		free(parser->blob_buffer);
+	if (parser->context->properties)
+		free(parser->context->properties);
+	if (parser->context->slots)
+		free(parser->context->slots);
+	free(parser->context);
+	free(parser->value_buffer);
+	free(parser);
+}
+
+void indigo_xml_parse(indigo_device *device, indigo_client *client) {
+	char *buffer = malloc(BUFFER_SIZE+1);
+	assert(buffer != NULL);
+	indigo_xml_parser *parser = indigo_xml_parser_create(device, client);
+	int handle = parser->handle;
+	while (true) {
+		ssize_t count = indigo_recv(handle, (void *)buffer, (ssize_t)BUFFER_SIZE);
+		if (count <= 0)
+			break;
+		buffer[count] = 0;
+		INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %s", handle, buffer));
+		if (!indigo_xml_parser_feed(parser, buffer, count))
+			break;
+	}
+	indigo_xml_parser_release(parser);
 	free(buffer);
-	free(value_buffer);
+	indigo_disable_read_buffer(handle);
 	close(handle);
 	INDIGO_TRACE_PARSER(indigo_trace("XML Parser: parser finished"));
 }
 
 char *indigo_xml_escape(char *string) {
 	if (strpbrk(string, "%<>\"'")) {
-		static char buffers[5][INDIGO_VALUE_SIZE];
-		static int	buffer_index = 0;
+		static INDIGO_THREAD_LOCAL char buffers[5][INDIGO_VALUE_SIZE];
+		static INDIGO_THREAD_LOCAL int	buffer_index = 0;
 		char *buffer = buffers[buffer_index = (buffer_index + 1) % 5];
 		char *in = string;
 		char *out = buffer;
@@ -629,6 +629,7 @@ static bool andor_read_pixels(indigo_device *device) {
 	long num_pixels = (long)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x) *
 	                  (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y);
 
+	PRIVATE_DATA->buffer = indigo_claim_blob_buffer(PRIVATE_DATA->buffer);
 	unsigned char *image = PRIVATE_DATA->buffer + FITS_HEADER_SIZE;
 
 	if (PRIVATE_DATA->exp_bpp > 16) {
@@ -883,7 +884,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 				CCD_FRAME_HEIGHT_ITEM->number.value = CCD_FRAME_HEIGHT_ITEM->number.max = CCD_FRAME_TOP_ITEM->number.max = CCD_INFO_HEIGHT_ITEM->number.value;
 				if (PRIVATE_DATA->buffer == NULL) {
 					PRIVATE_DATA->buffer_size = width * height * 4 + FITS_HEADER_SIZE;
-					PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_blob_buffer(PRIVATE_DATA->buffer_size);
+					PRIVATE_DATA->buffer = (unsigned char*)indigo_alloc_shared_blob_buffer(PRIVATE_DATA->buffer_size);
 				}
 
 				float x_size = 0, y_size = 0;
@@ -1018,7 +1019,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 				}
 
 				if (PRIVATE_DATA->buffer != NULL) {
-					free(PRIVATE_DATA->buffer);
+					indigo_release_blob_buffer(PRIVATE_DATA->buffer);
 					PRIVATE_DATA->buffer = NULL;
 				}
 				device->is_connected = false;
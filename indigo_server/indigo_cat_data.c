@@ -28,9 +28,17 @@
 #include <string.h>
 #include <zlib.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
 
+#include <indigo/indigo_bus.h>
 #include <indigo/indigo_server_tcp.h>
 #include <indigo/indigo_novas.h>
+#include <indigo/indigo_catalog.h>
 #include "indigo_cat_data.h"
 
 indigo_star_entry indigo_star_data[] = {
@@ -41313,18 +41321,37 @@ static void indigo_compress(char *name, char *buffer, unsigned size, unsigned ch
 	*data = realloc(*data, *data_size);
 }
 
-void *indigo_add_star_json_resource(int max_mag) {
+static unsigned char *make_star_json(int max_mag, unsigned *data_size) {
 	int buffer_size = 1024 * 1024;
 	char *buffer =  malloc(buffer_size);
 	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\": [");
 	unsigned size = (unsigned)strlen(buffer);
 	char *sep = "";
+	int count = 0;
+	while (indigo_star_data[count].hip)
+		count++;
+	indigo_catalog_entry *entries = calloc(count, sizeof(indigo_catalog_entry));
+	double *apparent_ra = malloc(count * sizeof(double)), *apparent_dec = malloc(count * sizeof(double));
+	count = 0;
 	for (int i = 0; indigo_star_data[i].hip; i++) {
 		if (indigo_star_data[i].mag > max_mag)
 			continue;
-		double ra = indigo_star_data[i].ra;
-		double dec = indigo_star_data[i].dec;
-		indigo_app_star(indigo_star_data[i].promora, indigo_star_data[i].promodec, indigo_star_data[i].px, indigo_star_data[i].rv, &ra, &dec);
+		indigo_catalog_entry *entry = entries + count++;
+		entry->ra = indigo_star_data[i].ra;
+		entry->dec = indigo_star_data[i].dec;
+		entry->promora = indigo_star_data[i].promora;
+		entry->promodec = indigo_star_data[i].promodec;
+		entry->px = indigo_star_data[i].px;
+		entry->rv = indigo_star_data[i].rv;
+	}
+	indigo_app_star_epoch epoch;
+	indigo_app_star_epoch_init(NULL, &epoch);
+	indigo_app_star_batch(&epoch, entries, count, apparent_ra, apparent_dec);
+	for (int i = 0, j = 0; indigo_star_data[i].hip; i++) {
+		if (indigo_star_data[i].mag > max_mag)
+			continue;
+		double ra = apparent_ra[j];
+		double dec = apparent_dec[j++];
     char desig[256] = "";
     char *name = "";
     if (indigo_star_data[i].name) {
@@ -41343,39 +41370,57 @@ void *indigo_add_star_json_resource(int max_mag) {
 		}
 		sep = ",";
 	}
+	free(entries);
+	free(apparent_ra);
+	free(apparent_dec);
 	size += sprintf(buffer + size, "]}");
 	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("stars.json", buffer, size, &data, &data_size);
+	*data_size = buffer_size;
+	indigo_compress("stars.json", buffer, size, &data, data_size);
 	free(buffer);
-	indigo_server_add_resource("/data/stars.json", data, (int)data_size, "application/json; charset=utf-8");
 	return data;
 }
 
-void *indigo_add_dso_json_resource(int max_mag) {
+static unsigned char *make_dso_json(int max_mag, unsigned *data_size) {
 	int buffer_size = 1024 * 1024;
 	char *buffer =  malloc(buffer_size);
 	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\": [");
 	unsigned size = (unsigned)strlen(buffer);
 	char *sep = "";
+	int count = 0;
+	while (indigo_dso_data[count].id)
+		count++;
+	indigo_catalog_entry *entries = calloc(count, sizeof(indigo_catalog_entry));
+	double *apparent_ra = malloc(count * sizeof(double)), *apparent_dec = malloc(count * sizeof(double));
+	count = 0;
 	for (int i = 0; indigo_dso_data[i].id; i++) {
 		if (indigo_dso_data[i].mag > max_mag)
 			continue;
-		double ra = indigo_dso_data[i].ra;
-		double dec = indigo_dso_data[i].dec;
-		indigo_app_star(0, 0, 0, 0, &ra, &dec);
+		entries[count].ra = indigo_dso_data[i].ra;
+		entries[count++].dec = indigo_dso_data[i].dec;
+	}
+	indigo_app_star_epoch epoch;
+	indigo_app_star_epoch_init(NULL, &epoch);
+	indigo_app_star_batch(&epoch, entries, count, apparent_ra, apparent_dec);
+	for (int i = 0, j = 0; indigo_dso_data[i].id; i++) {
+		if (indigo_dso_data[i].mag > max_mag)
+			continue;
+		double ra = apparent_ra[j];
+		double dec = apparent_dec[j++];
 		size += sprintf(buffer + size, "%s{\"type\":\"Feature\",\"id\":\"%s\",\"properties\":{\"name\": \"%s\",\"desig\": \"%s\",\"type\":\"oc\",\"mag\": %.2f},\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.4f,%.4f]}}", sep, indigo_dso_data[i].id, indigo_dso_data[i].id, indigo_dso_data[i].name, indigo_dso_data[i].mag, h2deg(indigo_dso_data[i].ra = ra), indigo_dso_data[i].dec = dec);
 		if (buffer_size - size < 1024) {
 			buffer = realloc(buffer, buffer_size *= 2);
 		}
 		sep = ",";
 	}
+	free(entries);
+	free(apparent_ra);
+	free(apparent_dec);
 	size += sprintf(buffer + size, "]}");
 	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("stars.json", buffer, size, &data, &data_size);
+	*data_size = buffer_size;
+	indigo_compress("dsos.json", buffer, size, &data, data_size);
 	free(buffer);
-	indigo_server_add_resource("/data/dsos.json", data, (int)data_size, "application/json; charset=utf-8");
 	return data;
 }
 
@@ -41400,7 +41445,7 @@ static int add_multiline(char *buffer, ...) {
 	return size;
 }
 
-void *indigo_add_constellations_lines_json_resource() {
+static unsigned char *make_constellations_lines_json(unsigned *data_size) {
 	int buffer_size = 1024 * 1024;
 	char *buffer =  malloc(buffer_size);
 	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"id\":\"Const\",\"properties\":{},\"geometry\":{\"type\":\"MultiLineString\",\"coordinates\":[");
@@ -41525,9 +41570,267 @@ void *indigo_add_constellations_lines_json_resource() {
 	size += add_multiline(buffer + size, 61585, 61199, 63613, 62322, 61585, 59929, 57363, 0);
 	size += sprintf(buffer + size, "]}}]}");
 	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("constellations.lines.json", buffer, size, &data, &data_size);
+	*data_size = buffer_size;
+	indigo_compress("constellations.lines.json", buffer, size, &data, data_size);
 	free(buffer);
-	indigo_server_add_resource("/data/constellations.lines.json", data, (int)data_size, "application/json; charset=utf-8");
 	return data;
 }
+
+// JSON resources with apparent positions are cached in ~/.indigo/cache, file name contains hash of source data and UTC date, so they are recomputed once per day
+// or if the source tables change, binary catalogs with J2000 positions are stored along them and rebuilt only if source tables change
+
+typedef struct {
+	int max_mag;
+	uint32_t hash;
+	char prefix[64];
+	char file_name[128];
+	unsigned char *data;
+	unsigned size;
+} json_job;
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size) {
+	const unsigned char *bytes = data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * 16777619U;
+	return hash;
+}
+
+static uint32_t star_data_hash() {
+	// computed only once, the table is later updated with apparent positions
+	static uint32_t hash = 0;
+	if (hash)
+		return hash;
+	hash = 2166136261U;
+	for (indigo_star_entry *star = indigo_star_data; star->hip; star++) {
+		hash = fnv1a(hash, &star->hip, sizeof(star->hip));
+		hash = fnv1a(hash, &star->ra, sizeof(star->ra));
+		hash = fnv1a(hash, &star->dec, sizeof(star->dec));
+		hash = fnv1a(hash, &star->promora, sizeof(star->promora));
+		hash = fnv1a(hash, &star->promodec, sizeof(star->promodec));
+		hash = fnv1a(hash, &star->px, sizeof(star->px));
+		hash = fnv1a(hash, &star->rv, sizeof(star->rv));
+		hash = fnv1a(hash, &star->mag, sizeof(star->mag));
+		if (star->name)
+			hash = fnv1a(hash, star->name, strlen(star->name));
+	}
+	return hash;
+}
+
+static uint32_t dso_data_hash() {
+	static uint32_t hash = 0;
+	if (hash)
+		return hash;
+	hash = 2166136261U;
+	for (indigo_dso_entry *dso = indigo_dso_data; dso->id; dso++) {
+		hash = fnv1a(hash, dso->id, strlen(dso->id));
+		hash = fnv1a(hash, &dso->ra, sizeof(dso->ra));
+		hash = fnv1a(hash, &dso->dec, sizeof(dso->dec));
+		hash = fnv1a(hash, &dso->mag, sizeof(dso->mag));
+		if (dso->name)
+			hash = fnv1a(hash, dso->name, strlen(dso->name));
+	}
+	return hash;
+}
+
+static void init_job(json_job *job, const char *prefix, int max_mag, uint32_t hash, const char *date) {
+	memset(job, 0, sizeof(json_job));
+	job->max_mag = max_mag;
+	job->hash = hash;
+	snprintf(job->prefix, sizeof(job->prefix), "%s_", prefix);
+	snprintf(job->file_name, sizeof(job->file_name), "%s_J2000_%08x_%s.json.gz", prefix, hash, date);
+}
+
+static void load_cached_json(json_job *job) {
+	char path[PATH_MAX];
+	if (!indigo_catalog_cache_path(job->file_name, path, sizeof(path)))
+		return;
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size > 0 && (job->data = malloc(size)) && fread(job->data, 1, size, file) == (size_t)size) {
+		job->size = (unsigned)size;
+		INDIGO_DEBUG(indigo_debug("%s loaded from cache", job->file_name));
+	} else {
+		free(job->data);
+		job->data = NULL;
+	}
+	fclose(file);
+}
+
+static void save_cached_json(json_job *job) {
+	char path[PATH_MAX], tmp_path[PATH_MAX + 260];
+	if (!indigo_catalog_cache_path(job->file_name, path, sizeof(path)))
+		return;
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	FILE *file = fopen(tmp_path, "wb");
+	if (file == NULL) {
+		indigo_error("Can't create %s (%s)", tmp_path, strerror(errno));
+		return;
+	}
+	bool result = fwrite(job->data, 1, job->size, file) == job->size;
+	if (fclose(file) != 0 || !result || rename(tmp_path, path) != 0) {
+		indigo_error("Can't write %s (%s)", path, strerror(errno));
+		remove(tmp_path);
+		return;
+	}
+	// remove files for other dates or source data
+	*strrchr(path, '/') = 0;
+	DIR *dir = opendir(path);
+	if (dir) {
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (!strncmp(entry->d_name, job->prefix, strlen(job->prefix)) && strcmp(entry->d_name, job->file_name)) {
+				snprintf(tmp_path, sizeof(tmp_path), "%s/%s", path, entry->d_name);
+				remove(tmp_path);
+			}
+		}
+		closedir(dir);
+	}
+}
+
+static void save_catalog(const char *file_name, indigo_catalog_entry *entries, int count, uint32_t hash) {
+	char path[PATH_MAX];
+	if (!indigo_catalog_cache_path(file_name, path, sizeof(path)))
+		return;
+	indigo_catalog *catalog = indigo_catalog_create(entries, count, JD2000, hash);
+	if (catalog) {
+		indigo_catalog_save(catalog, path);
+		indigo_catalog_free(catalog);
+	}
+}
+
+static bool is_catalog_stale(const char *file_name, uint32_t hash) {
+	char path[PATH_MAX];
+	if (!indigo_catalog_cache_path(file_name, path, sizeof(path)))
+		return false;
+	indigo_catalog *catalog = indigo_catalog_load(path);
+	bool stale = catalog == NULL || indigo_catalog_source_hash(catalog) != hash;
+	indigo_catalog_free(catalog);
+	return stale;
+}
+
+static void make_star_catalog(uint32_t hash) {
+	if (!is_catalog_stale(INDIGO_CATALOG_STARS_FILE, hash))
+		return;
+	int count = 0;
+	while (indigo_star_data[count].hip)
+		count++;
+	indigo_catalog_entry *entries = calloc(count, sizeof(indigo_catalog_entry));
+	char **names = calloc(count, sizeof(char *));
+	for (int i = 0; i < count; i++) {
+		indigo_star_entry *star = indigo_star_data + i;
+		indigo_catalog_entry *entry = entries + i;
+		entry->ra = star->ra;
+		entry->dec = star->dec;
+		entry->promora = star->promora;
+		entry->promodec = star->promodec;
+		entry->px = star->px;
+		entry->rv = star->rv;
+		entry->mag = star->mag;
+		entry->id = star->hip;
+		if (star->name) {
+			// "designation, name" as in JSON resource
+			names[i] = strdup(star->name);
+			char *name = strrchr(names[i], ',');
+			if (name) {
+				*name = 0;
+				entry->name = name + 2;
+			}
+			entry->designation = names[i];
+		}
+	}
+	save_catalog(INDIGO_CATALOG_STARS_FILE, entries, count, hash);
+	for (int i = 0; i < count; i++)
+		free(names[i]);
+	free(names);
+	free(entries);
+}
+
+static void make_dso_catalog(uint32_t hash) {
+	if (!is_catalog_stale(INDIGO_CATALOG_DSOS_FILE, hash))
+		return;
+	int count = 0;
+	while (indigo_dso_data[count].id)
+		count++;
+	indigo_catalog_entry *entries = calloc(count, sizeof(indigo_catalog_entry));
+	for (int i = 0; i < count; i++) {
+		indigo_dso_entry *dso = indigo_dso_data + i;
+		indigo_catalog_entry *entry = entries + i;
+		entry->ra = dso->ra;
+		entry->dec = dso->dec;
+		entry->mag = dso->mag;
+		entry->id = i;
+		entry->designation = dso->id;
+		entry->name = dso->name;
+	}
+	save_catalog(INDIGO_CATALOG_DSOS_FILE, entries, count, hash);
+	free(entries);
+}
+
+static void *star_worker(void *arg) {
+	json_job *job = arg;
+	// binary catalog has to be created before apparent positions overwrite J2000 ones
+	make_star_catalog(job->hash);
+	if (job->data == NULL) {
+		job->data = make_star_json(job->max_mag, &job->size);
+		save_cached_json(job);
+	}
+	return NULL;
+}
+
+static void *dso_worker(void *arg) {
+	json_job *job = arg;
+	make_dso_catalog(job->hash);
+	if (job->data == NULL) {
+		job->data = make_dso_json(job->max_mag, &job->size);
+		save_cached_json(job);
+	}
+	return NULL;
+}
+
+void indigo_add_catalog_json_resources(int star_max_mag, int dso_max_mag, void **star_data, void **dso_data, void **constellation_data) {
+	char prefix[32], date[16];
+	time_t now = time(NULL);
+	struct tm tm;
+	gmtime_r(&now, &tm);
+	strftime(date, sizeof(date), "%Y%m%d", &tm);
+	json_job stars, dsos, constellations;
+	uint32_t star_hash = star_data_hash();
+	snprintf(prefix, sizeof(prefix), "stars_%d", star_max_mag);
+	init_job(&stars, prefix, star_max_mag, star_hash, date);
+	snprintf(prefix, sizeof(prefix), "dsos_%d", dso_max_mag);
+	init_job(&dsos, prefix, dso_max_mag, dso_data_hash(), date);
+	init_job(&constellations, "constellations_lines", 0, star_hash, date);
+	load_cached_json(&stars);
+	load_cached_json(&dsos);
+	load_cached_json(&constellations);
+	// constellation lines use apparent star positions computed while star JSON is made
+	if (constellations.data == NULL && stars.data != NULL) {
+		free(stars.data);
+		stars.data = NULL;
+	}
+	pthread_t star_thread, dso_thread;
+	bool star_thread_started = pthread_create(&star_thread, NULL, star_worker, &stars) == 0;
+	if (!star_thread_started)
+		star_worker(&stars);
+	bool dso_thread_started = pthread_create(&dso_thread, NULL, dso_worker, &dsos) == 0;
+	if (!dso_thread_started)
+		dso_worker(&dsos);
+	if (star_thread_started)
+		pthread_join(star_thread, NULL);
+	if (constellations.data == NULL) {
+		constellations.data = make_constellations_lines_json(&constellations.size);
+		save_cached_json(&constellations);
+	}
+	if (dso_thread_started)
+		pthread_join(dso_thread, NULL);
+	indigo_server_add_resource("/data/stars.json", stars.data, (int)stars.size, "application/json; charset=utf-8");
+	indigo_server_add_resource("/data/dsos.json", dsos.data, (int)dsos.size, "application/json; charset=utf-8");
+	indigo_server_add_resource("/data/constellations.lines.json", constellations.data, (int)constellations.size, "application/json; charset=utf-8");
+	*star_data = stars.data;
+	*dso_data = dsos.data;
+	*constellation_data = constellations.data;
+}
@@ -44,8 +44,9 @@ typedef struct {
 extern indigo_star_entry indigo_star_data[];
 extern indigo_dso_entry indigo_dso_data[];
 
-extern void *indigo_add_star_json_resource(int max_mag);
-extern void *indigo_add_dso_json_resource(int max_mag);
-extern void *indigo_add_constellations_lines_json_resource(void);
+/** Add /data/stars.json, /data/dsos.json and /data/constellations.lines.json resources with apparent positions (cached in ~/.indigo/cache),
+ create stars.icat and dsos.icat binary catalogs in cache folder if missing or stale, return resource data to be released on exit.
+ */
+extern void indigo_add_catalog_json_resources(int star_max_mag, int dso_max_mag, void **star_data, void **dso_data, void **constellation_data);
 
 #endif /* star_data_h */
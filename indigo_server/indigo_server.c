@@ -262,6 +262,8 @@ static indigo_property *unload_property;
 static indigo_property *restart_property;
 static indigo_property *log_level_property;
 static indigo_property *server_features_property;
+static indigo_property *client_queues_property;
+static indigo_timer *client_queues_timer;
 
 #ifdef RPI_MANAGEMENT
 static indigo_property *wifi_ap_property;
@@ -298,6 +300,9 @@ static bool runLoop = true;
 #define CTRL_PANEL_ITEM             (server_features_property->items + 1)
 #define WEB_APPS_ITEM               (server_features_property->items + 2)
 
+#define MAX_CLIENT_QUEUES						32
+#define CLIENT_QUEUES_REFRESH				5
+
 static pid_t server_pid = 0;
 static bool keep_server_running = true;
 static bool use_sigkill = false;
@@ -458,6 +463,36 @@ static void check_versions(indigo_device *device) {
 
 #endif
 
+static void client_queues_handler(indigo_device *device) {
+	indigo_queue_stats stats[MAX_CLIENT_QUEUES];
+	int count = indigo_get_client_queue_stats(stats, MAX_CLIENT_QUEUES);
+	bool redefine = client_queues_property->count != 2 * count;
+	for (int i = 0; i < count && !redefine; i++)
+		redefine = strcmp(client_queues_property->items[2 * i].label, stats[i].client) != 0;
+	if (redefine) {
+		if (client_queues_property->count > 0)
+			indigo_delete_property(&server_device, client_queues_property, NULL);
+		client_queues_property->count = 2 * count;
+		for (int i = 0; i < count; i++) {
+			char name[INDIGO_NAME_SIZE], label[INDIGO_VALUE_SIZE];
+			snprintf(name, sizeof(name), "CLIENT_%d_DEPTH", i);
+			indigo_init_number_item(client_queues_property->items + 2 * i, name, stats[i].client, 0, 1000000, 0, stats[i].depth);
+			snprintf(name, sizeof(name), "CLIENT_%d_DROPPED", i);
+			snprintf(label, sizeof(label), "%s (dropped)", stats[i].client);
+			indigo_init_number_item(client_queues_property->items + 2 * i + 1, name, label, 0, 1e12, 0, stats[i].dropped);
+		}
+		if (client_queues_property->count > 0)
+			indigo_define_property(&server_device, client_queues_property, NULL);
+	} else if (count > 0) {
+		for (int i = 0; i < count; i++) {
+			client_queues_property->items[2 * i].number.value = stats[i].depth;
+			client_queues_property->items[2 * i + 1].number.value = stats[i].dropped;
+		}
+		indigo_update_property(&server_device, client_queues_property, NULL);
+	}
+	indigo_reschedule_timer(device, CLIENT_QUEUES_REFRESH, &client_queues_timer);
+}
+
 static indigo_result attach(indigo_device *device) {
 	assert(device != NULL);
 	info_property = indigo_init_text_property(NULL, server_device.name, "INFO", MAIN_GROUP, "Server info", INDIGO_OK_STATE, INDIGO_RO_PERM, 2);
@@ -503,6 +538,8 @@ static indigo_result attach(indigo_device *device) {
 	indigo_init_switch_item(LOG_LEVEL_DEBUG_ITEM, "DEBUG", "Debug", false);
 	indigo_init_switch_item(LOG_LEVEL_TRACE_ITEM, "TRACE", "Trace", false);
 	server_features_property = indigo_init_switch_property(NULL, device->name, "FEATURES", MAIN_GROUP, "Features", INDIGO_OK_STATE, INDIGO_RO_PERM, INDIGO_ONE_OF_MANY_RULE, 3);
+	client_queues_property = indigo_init_number_property(NULL, device->name, "CLIENT_QUEUES", MAIN_GROUP, "Client queues", INDIGO_OK_STATE, INDIGO_RO_PERM, 2 * MAX_CLIENT_QUEUES);
+	client_queues_property->count = 0;
 	indigo_init_switch_item(BONJOUR_ITEM, "BONJOUR", "Bonjour", use_bonjour);
 	indigo_init_switch_item(CTRL_PANEL_ITEM, "CTRL_PANEL", "Control panel / Server manager", use_ctrl_panel);
 	indigo_init_switch_item(WEB_APPS_ITEM, "WEB_APPS", "Web applications", use_web_apps);
@@ -558,6 +595,7 @@ static indigo_result attach(indigo_device *device) {
 	}
 	if (!command_line_drivers)
 		indigo_load_properties(device, false);
+	client_queues_timer = indigo_set_timer(NULL, CLIENT_QUEUES_REFRESH, client_queues_handler);
 	INDIGO_LOG(indigo_log("%s attached", device->name));
 	return INDIGO_OK;
 }
@@ -573,6 +611,8 @@ static indigo_result enumerate_properties(indigo_device *device, indigo_client *
 	indigo_define_property(device, restart_property, NULL);
 	indigo_define_property(device, log_level_property, NULL);
 	indigo_define_property(device, server_features_property, NULL);
+	if (client_queues_property->count > 0)
+		indigo_define_property(device, client_queues_property, NULL);
 #ifdef RPI_MANAGEMENT
 	if (use_rpi_management) {
 		indigo_define_property(device, wifi_ap_property, NULL);
@@ -774,6 +814,9 @@ static indigo_result detach(indigo_device *device) {
 	indigo_delete_property(device, restart_property, NULL);
 	indigo_delete_property(device, log_level_property, NULL);
 	indigo_delete_property(device, server_features_property, NULL);
+	indigo_cancel_timer(NULL, &client_queues_timer);
+	if (client_queues_property->count > 0)
+		indigo_delete_property(device, client_queues_property, NULL);
 #ifdef RPI_MANAGEMENT
 	if (use_rpi_management) {
 		indigo_delete_property(device, wifi_ap_property, NULL);
@@ -792,6 +835,7 @@ static indigo_result detach(indigo_device *device) {
 	indigo_release_property(restart_property);
 	indigo_release_property(log_level_property);
 	indigo_release_property(server_features_property);
+	indigo_release_property(client_queues_property);
 #ifdef RPI_MANAGEMENT
 	indigo_release_property(wifi_ap_property);
 	indigo_release_property(wifi_infrastructure_property);
@@ -890,6 +934,8 @@ static void server_main() {
 			indigo_reshare_remote_devices = true;
 			indigo_connect_server(NULL, host, port, NULL);
 			i++;
+		} else if (!strcmp(server_argv[i], "-B") || !strcmp(server_argv[i], "--binary-remote")) {
+			indigo_use_binary_protocol = true;
 		} else if ((!strcmp(server_argv[i], "-i") || !strcmp(server_argv[i], "--indi-driver")) && i < server_argc - 1) {
 			char executable[INDIGO_NAME_SIZE];
 			strncpy(executable, server_argv[i + 1], INDIGO_NAME_SIZE);
@@ -907,6 +953,10 @@ static void server_main() {
 			use_web_apps = false;
 		} else if (!strcmp(server_argv[i], "-u-") || !strcmp(server_argv[i], "--disable-blob-urls")) {
 			indigo_use_blob_urls = false;
+#ifdef INDIGO_LINUX
+		} else if (!strcmp(server_argv[i], "-e") || !strcmp(server_argv[i], "--event-driven")) {
+			indigo_server_tcp_reactor = true;
+#endif
 #ifdef RPI_MANAGEMENT
 		} else if (!strcmp(server_argv[i], "-f") || !strcmp(server_argv[i], "--enable-rpi-management")) {
 			FILE *output = popen("which s_rpi_ctrl.sh", "r");
@@ -1040,9 +1090,7 @@ static void server_main() {
 			#include "resource/data/planets.json.data"
 		};
 		indigo_server_add_resource("/data/planets.json", planets_json, sizeof(planets_json), "application/json; charset=utf-8");
-		star_data = indigo_add_star_json_resource(6);
-		dso_data = indigo_add_dso_json_resource(10);
-		constellation_data = indigo_add_constellations_lines_json_resource();
+		indigo_add_catalog_json_resources(6, 10, &star_data, &dso_data, &constellation_data);
 		// INDIGO Guider
 		static unsigned char guider_html[] = {
 			#include "resource/guider.html.data"
@@ -1164,12 +1212,16 @@ int main(int argc, const char * argv[]) {
 			       "       -u- | --disable-blob-urls\n"
 			       "       -w- | --disable-web-apps\n"
 			       "       -c- | --disable-control-panel\n"
+#ifdef INDIGO_LINUX
+			       "       -e  | --event-driven\n"
+#endif
 #ifdef RPI_MANAGEMENT
 			       "       -f  | --enable-rpi-management\n"
 #endif /* RPI_MANAGEMENT */
 			       "       -v  | --enable-info\n"
 			       "       -vv | --enable-debug\n"
 			       "       -vvv| --enable-trace\n"
+			       "       -B  | --binary-remote                 (use binary protocol for following remote servers)\n"
 			       "       -r  | --remote-server host[:port]     (default port: 7624)\n"
 			       "       -i  | --indi-driver driver_executable\n"
 			);
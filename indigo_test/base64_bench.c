@@ -0,0 +1,91 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Base64 benchmark - encodes and decodes a BLOB sized buffer with every implementation supported by the CPU,
+// verifies the results against the LUT implementation and reports throughput.
+//
+// built to build/test by "make test" in the root directory
+// ./base64_bench [size in MB] [repeat count]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <indigo/indigo_base64.h>
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, const char * argv[]) {
+	long size = (argc > 1 ? atol(argv[1]) : 50) * 1024 * 1024;
+	int repeat = argc > 2 ? atoi(argv[2]) : 5;
+	long encoded_size = (size + 2) / 3 * 4;
+	unsigned char *data = malloc(size);
+	unsigned char *reference = malloc(encoded_size + 1);
+	unsigned char *encoded = malloc(encoded_size + 1);
+	unsigned char *decoded = malloc(size + 3);
+	if (data == NULL || reference == NULL || encoded == NULL || decoded == NULL) {
+		printf("Out of memory\n");
+		return 1;
+	}
+	srand(42);
+	for (long i = 0; i < size; i++)
+		data[i] = rand();
+	base64_select_impl(BASE64_LUT);
+	base64_encode(reference, data, size);
+	printf("%ld MB, %d repeats\n", size / 1024 / 1024, repeat);
+	printf("%-8s %12s %12s\n", "", "encode MB/s", "decode MB/s");
+	double base_encode = 0, base_decode = 0;
+	for (base64_impl impl = BASE64_LUT; impl <= BASE64_NEON; impl++) {
+		if (!base64_select_impl(impl))
+			continue;
+		double start = now();
+		for (int i = 0; i < repeat; i++)
+			base64_encode(encoded, data, size);
+		double encode_rate = size * (double)repeat / (now() - start) / 1024 / 1024;
+		if (memcmp(encoded, reference, encoded_size)) {
+			printf("%s encoder output differs from LUT\n", base64_impl_name(impl));
+			return 1;
+		}
+		start = now();
+		for (int i = 0; i < repeat; i++)
+			base64_decode_fast(decoded, reference, encoded_size);
+		double decode_rate = size * (double)repeat / (now() - start) / 1024 / 1024;
+		if (memcmp(decoded, data, size)) {
+			printf("%s decoder output differs from input\n", base64_impl_name(impl));
+			return 1;
+		}
+		if (impl == BASE64_LUT) {
+			base_encode = encode_rate;
+			base_decode = decode_rate;
+		}
+		printf("%-8s %12.0f %12.0f   (%.1fx / %.1fx)\n", base64_impl_name(impl), encode_rate, decode_rate, encode_rate / base_encode, decode_rate / base_decode);
+	}
+	free(data);
+	free(reference);
+	free(encoded);
+	free(decoded);
+	return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Binary protocol frame limit test - the server side parser must reject client frames longer than one property
+// before allocating them, the client side parser accepts frames large enough for BLOBs.
+//
+// built to build/test and run by "make check" in the root directory
+// ./binary_frame_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_binary.h>
+#include <indigo/indigo_driver_binary.h>
+#include <indigo/indigo_client_binary.h>
+
+#define PROPERTY_SIZE	(sizeof(indigo_property) + INDIGO_MAX_ITEMS * sizeof(indigo_item))
+
+static bool feed_frame_header(indigo_binary_parser *parser, unsigned long length) {
+	unsigned char preamble[INDIGO_BINARY_PREAMBLE_SIZE] = { INDIGO_BINARY_MAGIC, 'I', 'B', 1 };
+	unsigned char header[INDIGO_BINARY_HEADER_SIZE] = { INDIGO_BINARY_NEW_VECTOR, length & 0xFF, (length >> 8) & 0xFF, (length >> 16) & 0xFF, (length >> 24) & 0xFF };
+	if (!indigo_binary_parser_feed(parser, (char *)preamble, sizeof(preamble)))
+		return false;
+	return indigo_binary_parser_feed(parser, (char *)header, sizeof(header));
+}
+
+static int check(const char *test, bool result, bool expected) {
+	printf("%-48s %s\n", test, result == expected ? "passed" : "FAILED");
+	return result == expected ? 0 : 1;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_main_argc = argc;
+	indigo_main_argv = argv;
+	indigo_start();
+	int server[2], client[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, server) < 0 || socketpair(AF_UNIX, SOCK_STREAM, 0, client) < 0) {
+		perror("socketpair");
+		return 1;
+	}
+	int failed = 0;
+	indigo_client *protocol_adapter = indigo_binary_device_adapter(server[0], server[0]);
+	indigo_binary_parser *parser = indigo_binary_parser_create(NULL, protocol_adapter);
+	failed += check("client frame of property size is accepted", feed_frame_header(parser, PROPERTY_SIZE), true);
+	indigo_binary_parser_release(parser);
+	parser = indigo_binary_parser_create(NULL, protocol_adapter);
+	failed += check("client frame over property size is rejected", feed_frame_header(parser, PROPERTY_SIZE + 1), false);
+	indigo_binary_parser_release(parser);
+	parser = indigo_binary_parser_create(NULL, protocol_adapter);
+	failed += check("1GB client frame is rejected", feed_frame_header(parser, INDIGO_BINARY_MAX_BLOB_SIZE), false);
+	indigo_binary_parser_release(parser);
+	indigo_device *server_adapter = indigo_binary_client_adapter("Frame test", "", client[0], client[0]);
+	parser = indigo_binary_parser_create(server_adapter, NULL);
+	failed += check("16MB server frame is accepted", feed_frame_header(parser, 16 * 1024 * 1024), true);
+	indigo_binary_parser_release(parser);
+	parser = indigo_binary_parser_create(server_adapter, NULL);
+	failed += check("server frame over BLOB limit is rejected", feed_frame_header(parser, INDIGO_BINARY_MAX_BLOB_SIZE + PROPERTY_SIZE + 1), false);
+	indigo_binary_parser_release(parser);
+	indigo_release_binary_device_adapter(protocol_adapter);
+	indigo_stop();
+	return failed;
+}
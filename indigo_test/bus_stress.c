@@ -0,0 +1,191 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Bus stress test - several driver threads update their properties concurrently while a churn thread keeps
+// attaching and detaching a client. Update throughput is reported for 1 to <number of cores> driver threads.
+// Clients have dispatch queue like protocol adapters (fan-out runs in parallel), "direct" makes them called synchronously like local agents.
+//
+// built to build/test by "make test" in the root directory
+// ./bus_stress [updates per thread] [clients] [max threads] [queued|direct]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <indigo/indigo_bus.h>
+
+#define MAX_THREADS		64
+#define MAX_STRESS_CLIENTS	16
+#define STRESS_QUEUE_SIZE		1024
+
+static int updates_per_thread = 100000;
+static int client_count = 4;
+static bool queued = true;
+static volatile bool churn = false;
+
+static indigo_result stress_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	// roughly the work of a protocol adapter serializing the update
+	char buffer[512];
+	snprintf(buffer, sizeof(buffer), "<setNumberVector device='%s' name='%s'><oneNumber name='%s'>%g</oneNumber></setNumberVector>", property->device, property->name, property->items[0].name, property->items[0].number.value);
+	__atomic_add_fetch((long *)client->client_context, strlen(buffer) > 0, __ATOMIC_RELAXED);
+	return INDIGO_OK;
+}
+
+static indigo_client stress_client_template = {
+	"Stress client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	NULL,
+	stress_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+static void *driver_thread(void *arg) {
+	indigo_device *device = arg;
+	indigo_property *property = indigo_init_number_property(NULL, device->name, "STRESS", "Main", "Stress", INDIGO_OK_STATE, INDIGO_RO_PERM, 1);
+	indigo_init_number_item(property->items, "VALUE", "Value", 0, 1e9, 1, 0);
+	for (int i = 0; i < updates_per_thread; i++) {
+		property->items[0].number.value = i;
+		indigo_update_property(device, property, NULL);
+	}
+	indigo_release_property(property);
+	return NULL;
+}
+
+static void *churn_thread(void *arg) {
+	indigo_client *client = arg;
+	while (churn) {
+		if (queued)
+			indigo_enable_client_queue(client, STRESS_QUEUE_SIZE, INDIGO_QUEUE_BLOCK);
+		indigo_attach_client(client);
+		usleep(1000);
+		indigo_detach_client(client);
+		usleep(1000);
+	}
+	return NULL;
+}
+
+static long coalesced(indigo_client *client) {
+	indigo_queue_stats stats[MAX_STRESS_CLIENTS + 1];
+	int count = indigo_get_client_queue_stats(stats, MAX_STRESS_CLIENTS + 1);
+	for (int i = 0; i < count; i++)
+		if (!strcmp(stats[i].client, client->name))
+			return stats[i].coalesced;
+	return 0;
+}
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_main_argc = argc;
+	indigo_main_argv = argv;
+	if (argc > 1)
+		updates_per_thread = atoi(argv[1]);
+	if (argc > 2)
+		client_count = atoi(argv[2]);
+	if (argc > 4)
+		queued = strcmp(argv[4], "direct") != 0;
+	if (client_count > MAX_STRESS_CLIENTS)
+		client_count = MAX_STRESS_CLIENTS;
+	int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (argc > 3)
+		cores = atoi(argv[3]);
+	if (cores < 1)
+		cores = 1;
+	else if (cores > MAX_THREADS)
+		cores = MAX_THREADS;
+	indigo_start();
+
+	static indigo_client clients[MAX_STRESS_CLIENTS];
+	static long deliveries[MAX_STRESS_CLIENTS];
+	for (int i = 0; i < client_count; i++) {
+		clients[i] = stress_client_template;
+		snprintf(clients[i].name, INDIGO_NAME_SIZE, "Stress client #%d", i);
+		clients[i].client_context = &deliveries[i];
+		if (queued)
+			indigo_enable_client_queue(&clients[i], STRESS_QUEUE_SIZE, INDIGO_QUEUE_BLOCK);
+		indigo_attach_client(&clients[i]);
+	}
+	static long churn_deliveries;
+	static indigo_client churn_client;
+	churn_client = stress_client_template;
+	churn_client.client_context = &churn_deliveries;
+
+	static indigo_device devices[MAX_THREADS];
+	for (int i = 0; i < cores; i++) {
+		snprintf(devices[i].name, INDIGO_NAME_SIZE, "Stress device #%d", i);
+		indigo_attach_device(&devices[i]);
+	}
+
+	printf("%d updates per thread, %d %s clients, up to %d threads\n", updates_per_thread, client_count, queued ? "queued" : "direct", cores);
+	double base = 0;
+	for (int threads = 1; threads <= cores; threads = threads < cores && threads * 2 > cores ? cores : threads * 2) {
+		pthread_t workers[MAX_THREADS], churner;
+		long merged[MAX_STRESS_CLIENTS];
+		for (int i = 0; i < client_count; i++) {
+			deliveries[i] = 0;
+			merged[i] = coalesced(&clients[i]);
+		}
+		churn = true;
+		pthread_create(&churner, NULL, churn_thread, &churn_client);
+		double start = now();
+		for (int i = 0; i < threads; i++)
+			pthread_create(&workers[i], NULL, driver_thread, &devices[i]);
+		for (int i = 0; i < threads; i++)
+			pthread_join(workers[i], NULL);
+		for (int i = 0; i < client_count; i++)
+			while (indigo_client_queue_depth(&clients[i]) > 0)
+				usleep(100);
+		double elapsed = now() - start;
+		churn = false;
+		pthread_join(churner, NULL);
+		long expected = (long)threads * updates_per_thread;
+		for (int i = 0; i < client_count; i++) {
+			// queued updates of the same property are coalesced, each one is either delivered or merged
+			long received = deliveries[i] + coalesced(&clients[i]) - merged[i];
+			if (received != expected) {
+				printf("client %d received %ld updates, %ld expected\n", i, received, expected);
+				return 1;
+			}
+		}
+		double rate = expected / elapsed;
+		if (threads == 1)
+			base = rate;
+		printf("%2d threads: %10.0f updates/s (%.2fx)\n", threads, rate, rate / base);
+		if (threads == cores)
+			break;
+	}
+
+	for (int i = 0; i < cores; i++)
+		indigo_detach_device(&devices[i]);
+	for (int i = 0; i < client_count; i++)
+		indigo_detach_client(&clients[i]);
+	indigo_stop();
+	return 0;
+}
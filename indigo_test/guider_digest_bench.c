@@ -0,0 +1,130 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Guider digest benchmark - renders synthetic star fields of typical guide camera sizes, shifts them by a known
+// subpixel offset and measures time spent in indigo_donuts_frame_digest, indigo_calculate_drift,
+// indigo_centroid_frame_digest and indigo_multistar_frame_digest. Reported are mean times per call and the drift
+// recovered by DONUTS and multi-star digests compared to the injected shift.
+//
+// built to build/test by "make test" in the root directory
+// ./guider_digest_bench [repeat count] [width height]...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_ccd_driver.h>
+#include <indigo/indigo_guider_utils.h>
+
+#define STARS		40
+#define SHIFT_X		3.35
+#define SHIFT_Y		-1.70
+
+static double star_x[STARS], star_y[STARS], star_flux[STARS];
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void render(uint16_t *frame, int width, int height, double dx, double dy) {
+	srand(7);
+	for (int i = 0; i < width * height; i++)
+		frame[i] = 500 + rand() % 50;
+	for (int s = 0; s < STARS; s++) {
+		double x = star_x[s] * width + dx, y = star_y[s] * height + dy;
+		for (int j = (int)y - 8; j <= (int)y + 8; j++) {
+			for (int i = (int)x - 8; i <= (int)x + 8; i++) {
+				if (i < 0 || i >= width || j < 0 || j >= height)
+					continue;
+				double r2 = (i - x) * (i - x) + (j - y) * (j - y);
+				double value = frame[j * width + i] + star_flux[s] * exp(-r2 / 4.5);
+				frame[j * width + i] = value > 65535 ? 65535 : (uint16_t)value;
+			}
+		}
+	}
+}
+
+static void bench(int width, int height, int repeat) {
+	uint16_t *ref_frame = malloc(width * height * sizeof(uint16_t));
+	uint16_t *new_frame = malloc(width * height * sizeof(uint16_t));
+	render(ref_frame, width, height, 0, 0);
+	render(new_frame, width, height, SHIFT_X, SHIFT_Y);
+	indigo_frame_digest ref = { 0 }, new = { 0 };
+	double drift_x = 0, drift_y = 0;
+	double start = now();
+	for (int i = 0; i < repeat; i++) {
+		indigo_delete_frame_digest(&ref);
+		indigo_donuts_frame_digest(INDIGO_RAW_MONO16, ref_frame, width, height, &ref);
+	}
+	double donuts_time = (now() - start) / repeat;
+	indigo_donuts_frame_digest(INDIGO_RAW_MONO16, new_frame, width, height, &new);
+	start = now();
+	for (int i = 0; i < repeat; i++)
+		indigo_calculate_drift(&ref, &new, &drift_x, &drift_y);
+	double drift_time = (now() - start) / repeat;
+	int fft_width = ref.width, fft_height = ref.height;
+	indigo_delete_frame_digest(&ref);
+	indigo_delete_frame_digest(&new);
+	start = now();
+	for (int i = 0; i < repeat; i++)
+		indigo_centroid_frame_digest(INDIGO_RAW_MONO16, ref_frame, width, height, &ref);
+	double centroid_time = (now() - start) / repeat;
+	double multistar_x = 0, multistar_y = 0;
+	start = now();
+	for (int i = 0; i < repeat; i++) {
+		indigo_delete_frame_digest(&ref);
+		indigo_multistar_frame_digest(INDIGO_RAW_MONO16, ref_frame, width, height, 10, &ref);
+	}
+	double multistar_time = (now() - start) / repeat;
+	indigo_multistar_frame_digest(INDIGO_RAW_MONO16, new_frame, width, height, 10, &new);
+	indigo_calculate_drift(&ref, &new, &multistar_x, &multistar_y);
+	indigo_delete_frame_digest(&ref);
+	indigo_delete_frame_digest(&new);
+	printf("%5d x %-5d %5d x %-5d %10.1f %10.1f %10.1f %8.3f %8.3f %12.1f %8.3f %8.3f\n", width, height, fft_width, fft_height, donuts_time * 1e6, drift_time * 1e6, centroid_time * 1e6, drift_x, drift_y, multistar_time * 1e6, multistar_x, multistar_y);
+	free(ref_frame);
+	free(new_frame);
+}
+
+int main(int argc, const char **argv) {
+	int repeat = argc > 1 ? atoi(argv[1]) : 100;
+	srand(1);
+	for (int s = 0; s < STARS; s++) {
+		star_x[s] = 0.05 + 0.9 * rand() / RAND_MAX;
+		star_y[s] = 0.05 + 0.9 * rand() / RAND_MAX;
+		star_flux[s] = 2000 + rand() % 30000;
+	}
+	printf("injected shift %.3f %.3f, %d repeats\n", SHIFT_X, SHIFT_Y, repeat);
+	printf("frame         transform      donuts[us]  drift[us] centroid[us]  drift_x  drift_y multistar[us]  drift_x  drift_y\n");
+	if (argc > 3) {
+		for (int i = 2; i + 1 < argc; i += 2)
+			bench(atoi(argv[i]), atoi(argv[i + 1]), repeat);
+	} else {
+		static int sizes[][2] = { { 640, 480 }, { 1280, 960 }, { 1304, 976 }, { 1936, 1096 }, { 3008, 3008 } };
+		for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+			bench(sizes[i][0], sizes[i][1], repeat);
+	}
+	return 0;
+}
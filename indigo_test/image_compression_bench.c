@@ -0,0 +1,200 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Image compression benchmark - renders frames like CCD simulator does (imager light frame with sky background, stars and
+// 7 bit noise, guider frame with gradient and noise, dark frame, DSLR RGB frame), measures single threaded throughput and
+// ratio of Rice (one row per tile, as in RICE_1 compressed FITS) and byte shuffled LZ4 (as in XISF) codecs with decompression
+// roundtrip check, and then the time indigo_process_image spends on each CCD_IMAGE_FORMAT item.
+//
+// built to build/test by "make test" in the root directory
+// ./image_compression_bench [repeat count] [width height]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_ccd_driver.h>
+#include <indigo/indigo_compression.h>
+
+#define STARS		200
+
+typedef enum { imager, guider, dark, dslr } frame_kind;
+
+static const char *kind_names[] = { "imager", "guider", "dark", "dslr" };
+
+static indigo_device bench_device = { .name = "CCD Bench", .version = INDIGO_VERSION_CURRENT };
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void add_stars(uint16_t *frame, int width, int height) {
+	for (int s = 0; s < STARS; s++) {
+		double x = rand() % width, y = rand() % height, flux = 100 * (rand() % 100);
+		for (int j = (int)y - 6; j <= (int)y + 6; j++) {
+			for (int i = (int)x - 6; i <= (int)x + 6; i++) {
+				if (i < 0 || i >= width || j < 0 || j >= height)
+					continue;
+				double value = frame[j * width + i] + flux * exp(-((i - x) * (i - x) + (j - y) * (j - y)) / 3.0);
+				frame[j * width + i] = value > 65535 ? 65535 : (uint16_t)value;
+			}
+		}
+	}
+}
+
+static void render(void *data, frame_kind kind, int width, int height) {
+	srand(7);
+	if (kind == dslr) {
+		uint8_t *frame = data;
+		for (int j = 0; j < height; j++) {
+			for (int i = 0; i < width; i++) {
+				uint8_t *pixel = frame + 3 * (j * width + i);
+				pixel[0] = 30 + 20 * i / width + (rand() & 0x0F);
+				pixel[1] = 25 + 20 * j / height + (rand() & 0x0F);
+				pixel[2] = 40 + (rand() & 0x0F);
+			}
+		}
+		return;
+	}
+	uint16_t *frame = data;
+	for (int j = 0; j < height; j++) {
+		for (int i = 0; i < width; i++) {
+			switch (kind) {
+				case imager:
+					frame[j * width + i] = 1500 + 400 * exp(-((i - width / 2.0) * (i - width / 2.0) + (j - height / 3.0) * (j - height / 3.0)) / (width * width / 16.0)) + (rand() & 0x7F);
+					break;
+				case guider:
+					frame[j * width + i] = 0.2 * sqrt(i * i + j * j) + rand() % 100 + 500;
+					break;
+				default:
+					frame[j * width + i] = rand() & 0x7F;
+					break;
+			}
+		}
+	}
+	if (kind != dark)
+		add_stars(frame, width, height);
+}
+
+static void bench_codecs(const char *name, const uint8_t *frame, int width, int height, int components, int bytes, int repeat) {
+	long size = (long)width * height * components * bytes, rows = (long)height * components, row_size = (long)width * bytes;
+	long row_bound = INDIGO_RICE_BOUND(width, bytes);
+	uint8_t *big_endian = malloc(size), *out = malloc(rows * row_bound + INDIGO_LZ4_BOUND(size)), *shuffled = malloc(size), *check = malloc(size);
+	uint32_t *hash_table = malloc(INDIGO_LZ4_HASH_SIZE * sizeof(uint32_t));
+	for (long i = 0; i < size; i += bytes) {
+		for (int b = 0; b < bytes; b++)
+			big_endian[i + b] = frame[i + bytes - 1 - b];
+	}
+	long rice_size = 0;
+	double start = now();
+	for (int r = 0; r < repeat; r++) {
+		rice_size = 0;
+		for (long row = 0; row < rows; row++)
+			rice_size += indigo_rice_compress(big_endian + row * row_size, width, bytes, out + rice_size, row_bound);
+	}
+	double rice_time = (now() - start) / repeat;
+	start = now();
+	long offset = 0;
+	bool rice_ok = true;
+	for (long row = 0; row < rows; row++) {
+		long used = indigo_rice_decompress(out + offset, rice_size - offset, check + row * row_size, width, bytes);
+		rice_ok = rice_ok && used > 0;
+		offset += used;
+	}
+	double rice_decompress_time = now() - start;
+	rice_ok = rice_ok && !memcmp(check, big_endian, size);
+	long lz4_size = 0;
+	start = now();
+	for (int r = 0; r < repeat; r++) {
+		const uint8_t *in = frame;
+		if (bytes > 1) {
+			indigo_byte_shuffle(frame, shuffled, size / bytes, bytes);
+			in = shuffled;
+		}
+		lz4_size = indigo_lz4_compress(in, size, out, INDIGO_LZ4_BOUND(size), hash_table);
+	}
+	double lz4_time = (now() - start) / repeat;
+	start = now();
+	bool lz4_ok = indigo_lz4_decompress(out, lz4_size, shuffled, size) == size;
+	if (bytes > 1)
+		indigo_byte_unshuffle(shuffled, check, size / bytes, bytes);
+	else
+		memcpy(check, shuffled, size);
+	double lz4_decompress_time = now() - start;
+	lz4_ok = lz4_ok && !memcmp(check, frame, size);
+	double mb = size / 1048576.0;
+	printf("%-8s %5d x %-5d %-6s %6.2f %9.1f %9.1f %-4s           %6.2f %9.1f %9.1f %-4s\n", name, width, height, components == 3 ? (bytes == 2 ? "RGB48" : "RGB24") : (bytes == 2 ? "MONO16" : "MONO8"), (double)size / rice_size, mb / rice_time, mb / rice_decompress_time, rice_ok ? "ok" : "FAIL", (double)size / lz4_size, mb / lz4_time, mb / lz4_decompress_time, lz4_ok ? "ok" : "FAIL");
+	free(big_endian);
+	free(out);
+	free(shuffled);
+	free(check);
+	free(hash_table);
+}
+
+static void bench_process(const char *name, const uint8_t *frame, int width, int height, int bpp, int repeat) {
+	indigo_device *device = &bench_device;
+	long size = (long)width * height * bpp / 8;
+	char *buffer = malloc(FITS_HEADER_SIZE + size + FITS_HEADER_SIZE);
+	indigo_item *formats[] = { CCD_IMAGE_FORMAT_RAW_ITEM, CCD_IMAGE_FORMAT_FITS_ITEM, CCD_IMAGE_FORMAT_FITS_RICE_ITEM, CCD_IMAGE_FORMAT_XISF_ITEM, CCD_IMAGE_FORMAT_XISF_LZ4_ITEM };
+	printf("%-8s %5d x %-5d", name, width, height);
+	for (int f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+		indigo_set_switch(CCD_IMAGE_FORMAT_PROPERTY, formats[f], true);
+		double time = 0;
+		for (int r = 0; r < repeat; r++) {
+			memcpy(buffer + FITS_HEADER_SIZE, frame, size);
+			double start = now();
+			indigo_process_image(device, buffer, width, height, bpp, true, true, NULL);
+			time += now() - start;
+		}
+		printf(" %8.1f %5.2f", time / repeat * 1000, (double)size / CCD_IMAGE_ITEM->blob.size);
+	}
+	printf("\n");
+	free(buffer);
+}
+
+int main(int argc, const char **argv) {
+	int repeat = argc > 1 ? atoi(argv[1]) : 10;
+	int width = argc > 3 ? atoi(argv[2]) : 1600;
+	int height = argc > 3 ? atoi(argv[3]) : 1200;
+	indigo_start();
+	indigo_ccd_attach(&bench_device, INDIGO_VERSION_CURRENT);
+	uint8_t *frames[4];
+	for (frame_kind kind = imager; kind <= dslr; kind++) {
+		frames[kind] = malloc((long)width * height * 3);
+		render(frames[kind], kind, width, height);
+	}
+	printf("%d repeats, single threaded codecs, MB/s of uncompressed data\n", repeat);
+	printf("frame    size          format  rice  comp[MB/s] dec[MB/s] check           lz4  comp[MB/s] dec[MB/s] check\n");
+	for (frame_kind kind = imager; kind <= dslr; kind++)
+		bench_codecs(kind_names[kind], frames[kind], width, height, kind == dslr ? 3 : 1, kind == dslr ? 1 : 2, repeat);
+	printf("\nindigo_process_image time [ms] and ratio to uncompressed pixel data per CCD_IMAGE_FORMAT item\n");
+	printf("frame    size               RAW          FITS        FITS_RICE         XISF        XISF_LZ4\n");
+	for (frame_kind kind = imager; kind <= dslr; kind++)
+		bench_process(kind_names[kind], frames[kind], width, height, kind == dslr ? 24 : 16, repeat);
+	indigo_ccd_detach(&bench_device);
+	indigo_stop();
+	return 0;
+}
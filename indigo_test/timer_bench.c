@@ -0,0 +1,188 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// Timer benchmark - each simulated device runs periodic timers like a typical driver (guiding 10ms, polling 50ms,
+// countdown 250ms, temperature 1s) rescheduled from their callbacks. Reported are the lateness of callbacks
+// against the ideal schedule, number of process threads and number of concurrent callbacks for one device.
+//
+// built to build/test by "make test" in the root directory
+// ./timer_bench [devices] [seconds] [callback work in ms]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_timer.h>
+
+#define MAX_DEVICES		256
+#define TIMERS				4
+#define MAX_SAMPLES		200000
+
+static const double periods[TIMERS] = { 0.01, 0.05, 0.25, 1.0 };
+static const char *names[TIMERS] = { "guiding", "polling", "countdown", "temperature" };
+
+typedef struct {
+	indigo_timer *timers[TIMERS];
+	double expected[TIMERS];
+	int active;
+	bool running;
+} bench_data;
+
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static double *lateness[TIMERS];
+static int samples[TIMERS];
+static int overlaps;
+static int work_us;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int thread_count() {
+	int count = -1;
+	FILE *file = fopen("/proc/self/status", "r");
+	if (file) {
+		char line[256];
+		while (fgets(line, sizeof(line), file)) {
+			if (!strncmp(line, "Threads:", 8)) {
+				count = atoi(line + 8);
+				break;
+			}
+		}
+		fclose(file);
+	}
+	return count;
+}
+
+static void timer_callback(indigo_device *device, int index) {
+	bench_data *data = device->private_data;
+	double late = now() - data->expected[index];
+	if (__sync_add_and_fetch(&data->active, 1) > 1)
+		__sync_add_and_fetch(&overlaps, 1);
+	if (work_us)
+		usleep(work_us);
+	pthread_mutex_lock(&stats_mutex);
+	if (samples[index] < MAX_SAMPLES)
+		lateness[index][samples[index]++] = late;
+	pthread_mutex_unlock(&stats_mutex);
+	__sync_sub_and_fetch(&data->active, 1);
+	if (data->running) {
+		data->expected[index] = now() + periods[index];
+		indigo_reschedule_timer(device, periods[index], &data->timers[index]);
+	}
+}
+
+static void guiding_callback(indigo_device *device) {
+	timer_callback(device, 0);
+}
+
+static void polling_callback(indigo_device *device) {
+	timer_callback(device, 1);
+}
+
+static void countdown_callback(indigo_device *device) {
+	timer_callback(device, 2);
+}
+
+static void temperature_callback(indigo_device *device) {
+	timer_callback(device, 3);
+}
+
+static indigo_timer_callback callbacks[TIMERS] = { guiding_callback, polling_callback, countdown_callback, temperature_callback };
+
+static int compare(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_main_argc = argc;
+	indigo_main_argv = argv;
+	int device_count = 30;
+	double duration = 5;
+	if (argc > 1)
+		device_count = atoi(argv[1]);
+	if (argc > 2)
+		duration = atof(argv[2]);
+	if (argc > 3)
+		work_us = (int)(atof(argv[3]) * 1000);
+	if (device_count < 1)
+		device_count = 1;
+	else if (device_count > MAX_DEVICES)
+		device_count = MAX_DEVICES;
+	for (int i = 0; i < TIMERS; i++)
+		lateness[i] = malloc(MAX_SAMPLES * sizeof(double));
+	indigo_start();
+
+	static indigo_device devices[MAX_DEVICES];
+	static indigo_device_context contexts[MAX_DEVICES];
+	static bench_data data[MAX_DEVICES];
+	printf("%d devices with %d timers, %gs, %gms work per callback, %d threads before start\n", device_count, TIMERS, duration, work_us / 1000.0, thread_count());
+	for (int i = 0; i < device_count; i++) {
+		snprintf(devices[i].name, INDIGO_NAME_SIZE, "Timer device #%d", i);
+		devices[i].device_context = &contexts[i];
+		devices[i].private_data = &data[i];
+		data[i].running = true;
+		for (int j = 0; j < TIMERS; j++) {
+			// spread the first callbacks over the period
+			double delay = periods[j] * (i + 1) / device_count;
+			data[i].expected[j] = now() + delay;
+			data[i].timers[j] = indigo_set_timer(&devices[i], delay, callbacks[j]);
+		}
+	}
+	int max_threads = 0;
+	double end = now() + duration;
+	while (now() < end) {
+		int count = thread_count();
+		if (count > max_threads)
+			max_threads = count;
+		usleep(100000);
+	}
+	for (int i = 0; i < device_count; i++) {
+		data[i].running = false;
+		indigo_cancel_all_timers(&devices[i]);
+	}
+	usleep(100000);
+
+	printf("%-12s %8s %10s %10s %10s %10s\n", "timer", "count", "mean [ms]", "p50 [ms]", "p99 [ms]", "max [ms]");
+	pthread_mutex_lock(&stats_mutex);
+	for (int i = 0; i < TIMERS; i++) {
+		int count = samples[i];
+		if (count == 0)
+			continue;
+		double sum = 0;
+		for (int j = 0; j < count; j++)
+			sum += lateness[i][j];
+		qsort(lateness[i], count, sizeof(double), compare);
+		printf("%-12s %8d %10.3f %10.3f %10.3f %10.3f\n", names[i], count, 1000 * sum / count, 1000 * lateness[i][count / 2], 1000 * lateness[i][(int)(count * 0.99)], 1000 * lateness[i][count - 1]);
+	}
+	pthread_mutex_unlock(&stats_mutex);
+	printf("max threads %d, concurrent callbacks for one device %d\n", max_threads, overlaps);
+	indigo_stop();
+	return 0;
+}
@@ -0,0 +1,220 @@
+// Copyright (c) 2026 INDIGO contributors
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by INDIGO contributors
+
+// XML parser benchmark - replays a protocol trace (what a remote server sends to a client, e.g. captured with
+// "nc localhost 7624 > trace.xml" after sending <getProperties version='2.0'/>) through the client side parser,
+// once byte by byte and once with the fast tokenizer, and compares throughput and resulting property values.
+// Without a trace file a synthetic one with mount, guider and CCD updates is generated.
+//
+// built to build/test by "make test" in the root directory
+// ./xml_parser_bench [trace file|-] [repeat count] [chunk size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_xml.h>
+
+static long updates;
+static double fingerprint;
+
+static indigo_result bench_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	return INDIGO_OK;
+}
+
+static indigo_result bench_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	updates++;
+	fingerprint += property->state;
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		switch (property->type) {
+			case INDIGO_NUMBER_VECTOR:
+				fingerprint += (i + 1) * (item->number.value + 0.5 * item->number.target);
+				break;
+			case INDIGO_SWITCH_VECTOR:
+				fingerprint += (i + 1) * item->sw.value;
+				break;
+			case INDIGO_LIGHT_VECTOR:
+				fingerprint += (i + 1) * item->light.value;
+				break;
+			case INDIGO_TEXT_VECTOR:
+				fingerprint += strlen(item->text.value);
+				break;
+			default:
+				break;
+		}
+	}
+	if (message)
+		fingerprint += strlen(message);
+	return INDIGO_OK;
+}
+
+static indigo_client bench_client = {
+	"XML parser bench", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	bench_define_property,
+	bench_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+static indigo_result bench_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	return INDIGO_OK;
+}
+
+static char *append(char *buffer, long *length, long *size, const char *format, ...) {
+	va_list args;
+	while (true) {
+		va_start(args, format);
+		long count = vsnprintf(buffer + *length, *size - *length, format, args);
+		va_end(args);
+		if (*length + count < *size) {
+			*length += count;
+			return buffer;
+		}
+		*size *= 2;
+		buffer = realloc(buffer, *size);
+	}
+}
+
+static char *synthetic_trace(long *length) {
+	long size = 1024 * 1024;
+	char *trace = malloc(size);
+	*length = 0;
+	trace = append(trace, length, &size, "<defNumberVector device='Mount' name='MOUNT_EQUATORIAL_COORDINATES' group='Main' label='Coordinates' perm='rw' state='Ok'>\n<defNumber name='RA' label='RA' format='%%12.9m' min='0' max='24' step='0' target='0'>0</defNumber>\n<defNumber name='DEC' label='Dec' format='%%12.9m' min='-90' max='90' step='0' target='0'>0</defNumber>\n</defNumberVector>\n");
+	trace = append(trace, length, &size, "<defSwitchVector device='Mount' name='MOUNT_TRACKING' group='Main' label='Tracking' perm='rw' state='Ok' rule='OneOfMany'>\n<defSwitch name='ON' label='On'>Off</defSwitch>\n<defSwitch name='OFF' label='Off'>On</defSwitch>\n</defSwitchVector>\n");
+	trace = append(trace, length, &size, "<defNumberVector device='Guider' name='AGENT_GUIDER_STATS' group='Main' label='Stats' perm='ro' state='Idle'>\n");
+	static const char *stats[] = { "FRAME", "REFERENCE_X", "REFERENCE_Y", "DRIFT_X", "DRIFT_Y", "DRIFT_RA", "DRIFT_DEC", "CORR_RA", "CORR_DEC", "RMSE_RA", "RMSE_DEC", "SNR" };
+	for (int i = 0; i < 12; i++)
+		trace = append(trace, length, &size, "<defNumber name='%s' label='%s' format='%%g' min='-1e6' max='1e6' step='0'>0</defNumber>\n", stats[i], stats[i]);
+	trace = append(trace, length, &size, "</defNumberVector>\n");
+	trace = append(trace, length, &size, "<defLightVector device='CCD' name='CCD_STATUS' group='Main' label='Status' state='Idle'>\n<defLight name='READY' label='Ready'>Ok</defLight>\n<defLight name='COOLER' label='Cooler'>Idle</defLight>\n</defLightVector>\n");
+	trace = append(trace, length, &size, "<defNumberVector device='CCD' name='CCD_EXPOSURE' group='Main' label='Exposure' perm='rw' state='Idle'>\n<defNumber name='EXPOSURE' label='Exposure' format='%%g' min='0' max='3600' step='1' target='0'>0</defNumber>\n</defNumberVector>\n");
+	trace = append(trace, length, &size, "<defTextVector device='CCD' name='CCD_LOCAL_MODE' group='Main' label='Local mode' perm='rw' state='Ok'>\n<defText name='DIR' label='Directory'>/tmp/</defText>\n</defTextVector>\n");
+	for (int i = 0; i < 20000; i++) {
+		double t = i * 0.01;
+		trace = append(trace, length, &size, "<setNumberVector device='Mount' name='MOUNT_EQUATORIAL_COORDINATES' state='Busy'>\n<oneNumber name='RA' target='%g'>%.9f</oneNumber>\n<oneNumber name='DEC' target='%g'>%.9f</oneNumber>\n</setNumberVector>\n", 5.5, 5.5 + sin(t), 22.0, 22.0 + cos(t));
+		if (i % 4 == 0) {
+			trace = append(trace, length, &size, "<setNumberVector device='Guider' name='AGENT_GUIDER_STATS' state='Busy'>\n");
+			for (int j = 0; j < 12; j++)
+				trace = append(trace, length, &size, "<oneNumber name='%s'>%g</oneNumber>\n", stats[j], (i + j) * 0.125);
+			trace = append(trace, length, &size, "</setNumberVector>\n");
+		}
+		if (i % 10 == 0)
+			trace = append(trace, length, &size, "<setNumberVector device='CCD' name='CCD_EXPOSURE' state='Busy'>\n<oneNumber name='EXPOSURE' target='%d'>%g</oneNumber>\n</setNumberVector>\n", 10, 10 - (i % 100) * 0.1);
+		if (i % 100 == 0) {
+			trace = append(trace, length, &size, "<setSwitchVector device='Mount' name='MOUNT_TRACKING' state='Ok' message='Tracking &apos;%s&apos;'>\n<oneSwitch name='ON'>%s</oneSwitch>\n<oneSwitch name='OFF'>%s</oneSwitch>\n</setSwitchVector>\n", i % 200 ? "on" : "off", i % 200 ? "On" : "Off", i % 200 ? "Off" : "On");
+			trace = append(trace, length, &size, "<setLightVector device='CCD' name='CCD_STATUS' state='Ok'>\n<oneLight name='READY'>%s</oneLight>\n<oneLight name='COOLER'>Busy</oneLight>\n</setLightVector>\n", i % 200 ? "Ok" : "Busy");
+			trace = append(trace, length, &size, "<setTextVector device='CCD' name='CCD_LOCAL_MODE' state='Ok'>\n<oneText name='DIR'>/tmp/&lt;%d&gt;/</oneText>\n</setTextVector>\n", i);
+		}
+	}
+	return trace;
+}
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double replay(char *trace, long length, int repeat, long chunk_size, bool fast) {
+	static indigo_adapter_context adapter_context;
+	static indigo_device remote_device;
+	strcpy(remote_device.name, "Remote server");
+	remote_device.version = INDIGO_VERSION_CURRENT;
+	remote_device.device_context = &adapter_context;
+	remote_device.enumerate_properties = bench_enumerate_properties;
+	adapter_context.input = -1;
+	indigo_use_fast_xml_parser = fast;
+	char *chunk = malloc(chunk_size + 1);
+	updates = 0;
+	fingerprint = 0;
+	double start = now();
+	indigo_xml_parser *parser = indigo_xml_parser_create(&remote_device, NULL);
+	for (int r = 0; r < repeat; r++) {
+		for (long offset = 0; offset < length; offset += chunk_size) {
+			long count = length - offset < chunk_size ? length - offset : chunk_size;
+			// copy like a socket read would do, so that elements split between chunks are exercised too
+			memcpy(chunk, trace + offset, count);
+			chunk[count] = 0;
+			indigo_xml_parser_feed(parser, chunk, count);
+		}
+	}
+	indigo_xml_parser_release(parser);
+	double elapsed = now() - start;
+	free(chunk);
+	return elapsed;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_main_argc = argc;
+	indigo_main_argv = argv;
+	int repeat = 5;
+	long chunk_size = 4096;
+	char *trace;
+	long length;
+	if (argc > 1 && strcmp(argv[1], "-")) {
+		FILE *file = fopen(argv[1], "r");
+		if (file == NULL) {
+			perror(argv[1]);
+			return 1;
+		}
+		fseek(file, 0, SEEK_END);
+		length = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		trace = malloc(length + 1);
+		length = fread(trace, 1, length, file);
+		fclose(file);
+	} else {
+		trace = synthetic_trace(&length);
+	}
+	if (argc > 2)
+		repeat = atoi(argv[2]);
+	if (argc > 3)
+		chunk_size = atol(argv[3]);
+	if (repeat < 1)
+		repeat = 1;
+	if (chunk_size < 1)
+		chunk_size = 1;
+
+	indigo_start();
+	indigo_attach_client(&bench_client);
+	printf("%ld bytes of trace, %d times, %ld byte chunks\n", length, repeat, chunk_size);
+	double slow = replay(trace, length, repeat, chunk_size, false);
+	long slow_updates = updates;
+	double slow_fingerprint = fingerprint;
+	printf("byte by byte: %8.3f s, %10.0f updates/s, %7.1f MB/s\n", slow, slow_updates / slow, length * repeat / slow / 1e6);
+	double fast = replay(trace, length, repeat, chunk_size, true);
+	printf("tokenizer:    %8.3f s, %10.0f updates/s, %7.1f MB/s (%.2fx)\n", fast, updates / fast, length * repeat / fast / 1e6, slow / fast);
+	indigo_detach_client(&bench_client);
+	indigo_stop();
+	free(trace);
+	if (updates != slow_updates || fingerprint != slow_fingerprint) {
+		printf("results differ: %ld updates (%.17g) vs %ld updates (%.17g)\n", updates, fingerprint, slow_updates, slow_fingerprint);
+		return 1;
+	}
+	return 0;
+}